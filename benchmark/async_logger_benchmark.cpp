@@ -0,0 +1,135 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/async_logger.h"
+
+// 单帧后处理中与日志相关的开销：每个检测框一条、每个目标一条以及每帧的汇总
+// 0：不输出；1：每30帧输出一帧；2：每帧输出，与节点的log_mode参数对应
+
+namespace {
+
+constexpr int kSampleInterval = 30;
+
+struct SyntheticRect {
+  float left;
+  float top;
+  float right;
+  float bottom;
+  float conf;
+  int track_id;
+};
+
+std::vector<SyntheticRect> MakeRects(int rect_num) {
+  std::vector<SyntheticRect> rects;
+  for (int idx = 0; idx < rect_num; idx++) {
+    float x = static_cast<float>(idx * 17 % 1800);
+    float y = static_cast<float>(idx * 31 % 1000);
+    rects.push_back(SyntheticRect{x, y, x + 60, y + 120, 0.9f, idx + 1});
+  }
+  return rects;
+}
+
+FILE* NullFile() {
+  static FILE* null_file = fopen("/dev/null", "w");
+  return null_file;
+}
+
+// 修改前的方式：每条日志都使用stringstream格式化并同步输出
+void BM_PostprocessLogSyncStream(benchmark::State& state) {
+  auto rects = MakeRects(static_cast<int>(state.range(0)));
+  FILE* out = NullFile();
+  uint64_t frame = 0;
+  for (auto _ : state) {
+    for (const auto& rect : rects) {
+      std::stringstream ss;
+      ss << "rect: " << rect.left << " " << rect.top << " " << rect.right
+         << " " << rect.bottom << ", " << rect.conf;
+      fprintf(out, "%s\n", ss.str().c_str());
+      fflush(out);
+    }
+    std::stringstream ss;
+    ss << "Publish frame_id: " << frame
+       << ", targets.size: " << rects.size() << "\n";
+    for (const auto& rect : rects) {
+      ss << "target track_id: " << rect.track_id
+         << ", rois.size: 1, body, points.size: 1\n";
+    }
+    fprintf(out, "%s\n", ss.str().c_str());
+    fflush(out);
+    frame++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_PostprocessLogAsync(benchmark::State& state) {
+  auto rects = MakeRects(static_cast<int>(state.range(0)));
+  int log_mode = static_cast<int>(state.range(1));
+  FILE* out = NullFile();
+  AsyncLogger logger(
+      [out](const char* line) {
+        fprintf(out, "%s\n", line);
+        fflush(out);
+      },
+      1024);
+  uint64_t frame = 0;
+  for (auto _ : state) {
+    bool log_frame = log_mode == 2 ||
+                     (log_mode == 1 && frame % kSampleInterval == 0);
+    if (log_frame) {
+      for (const auto& rect : rects) {
+        logger.Log("rect: %f %f %f %f, %f",
+                   static_cast<double>(rect.left),
+                   static_cast<double>(rect.top),
+                   static_cast<double>(rect.right),
+                   static_cast<double>(rect.bottom),
+                   static_cast<double>(rect.conf));
+      }
+      logger.Log("Publish frame_id: %lu, targets.size: %d",
+                 frame,
+                 static_cast<int>(rects.size()));
+      for (const auto& rect : rects) {
+        logger.Log(
+            "target track_id: %d, rois.size: 1, roi type: body, "
+            "points.size: 1",
+            rect.track_id);
+      }
+      // 实际帧率下后台线程有足够的时间输出，测量时不计入等待输出的时间
+      state.PauseTiming();
+      logger.Flush();
+      state.ResumeTiming();
+    }
+    frame++;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["dropped"] = static_cast<double>(logger.Dropped());
+}
+
+}  // namespace
+
+BENCHMARK(BM_PostprocessLogSyncStream)->Arg(10)->Arg(100)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PostprocessLogAsync)
+    ->ArgsProduct({{10, 100}, {0, 1, 2}})
+    ->ArgNames({"rects", "log_mode"})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,115 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "ai_msgs/msg/perception_targets.hpp"
+#include "include/det_result_packer.h"
+#include "rclcpp/serialization.hpp"
+
+// BM_PackDetectionResult测量将一帧PerceptionTargets写入定长BodyDetectionResult的耗时，
+// 即通过共享内存loaned message发布时发布端的额外开销，订阅端直接读取没有开销
+// BM_SerializeTargets和BM_DeserializeTargets为跨进程发布PerceptionTargets时
+// 发布端序列化和订阅端反序列化的耗时，用于对比
+// 每个目标带有人体、人头、人脸、人手4个框和19个人体关键点
+
+namespace {
+
+constexpr int kKpsNum = 19;
+
+ai_msgs::msg::PerceptionTargets MakeTargets(int target_num) {
+  static const char* roi_types[] = {"body", "head", "face", "hand"};
+  ai_msgs::msg::PerceptionTargets msg;
+  msg.header.set__frame_id("0");
+  for (int idx = 0; idx < target_num; idx++) {
+    ai_msgs::msg::Target target;
+    target.set__type("person");
+    target.set__track_id(idx);
+    for (const char* roi_type : roi_types) {
+      ai_msgs::msg::Roi roi;
+      roi.set__type(roi_type);
+      roi.set__confidence(0.9f);
+      roi.rect.set__x_offset(idx * 10);
+      roi.rect.set__y_offset(idx * 5);
+      roi.rect.set__width(100);
+      roi.rect.set__height(200);
+      target.rois.push_back(roi);
+    }
+    ai_msgs::msg::Point kps;
+    kps.set__type("body_kps");
+    kps.point.resize(kKpsNum);
+    kps.confidence.assign(kKpsNum, 0.9f);
+    target.points.push_back(kps);
+    msg.targets.push_back(target);
+  }
+  return msg;
+}
+
+void BM_PackDetectionResult(benchmark::State& state) {
+  const auto msg = MakeTargets(static_cast<int>(state.range(0)));
+  auto result =
+      std::make_unique<mono2d_body_detection::msg::BodyDetectionResult>();
+  for (auto _ : state) {
+    PackDetectionResult(msg, 1920, 1080, false, *result);
+    benchmark::DoNotOptimize(result->box_num);
+  }
+  state.counters["boxes"] = static_cast<double>(result->box_num);
+  state.counters["msg_bytes"] = static_cast<double>(sizeof(*result));
+}
+
+void BM_SerializeTargets(benchmark::State& state) {
+  const auto msg = MakeTargets(static_cast<int>(state.range(0)));
+  rclcpp::Serialization<ai_msgs::msg::PerceptionTargets> serialization;
+  rclcpp::SerializedMessage serialized_msg;
+  for (auto _ : state) {
+    serialization.serialize_message(&msg, &serialized_msg);
+    benchmark::DoNotOptimize(serialized_msg.size());
+  }
+  state.counters["msg_bytes"] = static_cast<double>(serialized_msg.size());
+}
+
+void BM_DeserializeTargets(benchmark::State& state) {
+  const auto msg = MakeTargets(static_cast<int>(state.range(0)));
+  rclcpp::Serialization<ai_msgs::msg::PerceptionTargets> serialization;
+  rclcpp::SerializedMessage serialized_msg;
+  serialization.serialize_message(&msg, &serialized_msg);
+  ai_msgs::msg::PerceptionTargets out_msg;
+  for (auto _ : state) {
+    serialization.deserialize_message(&serialized_msg, &out_msg);
+    benchmark::DoNotOptimize(out_msg.targets.data());
+  }
+  state.counters["msg_bytes"] = static_cast<double>(serialized_msg.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_PackDetectionResult)
+    ->ArgName("targets")
+    ->Arg(10)
+    ->Arg(50)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SerializeTargets)
+    ->ArgName("targets")
+    ->Arg(10)
+    ->Arg(50)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DeserializeTargets)
+    ->ArgName("targets")
+    ->Arg(10)
+    ->Arg(50)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,302 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "include/image_convert.h"
+#include "include/image_utils.h"
+#include "jpeglib.h"
+
+// 输入图片转换为模型输入（960x544 nv12 pyramid）的耗时
+// 输入分辨率覆盖640x480、960x544（与模型输入一致）和1920x1080
+// jpeg输入覆盖mjpeg常见的4:2:0和4:2:2采样，1920x1080以1/2缩放解码
+// BM_ConvertToPyramid覆盖rgb8/bgr8/yuyv/uyvy/mono8直接转换的kernel，
+// 计时之前先与标量参考实现逐像素比较，不一致时报错
+
+namespace {
+
+constexpr int kModelInputWidth = 960;
+constexpr int kModelInputHeight = 544;
+
+// 带有渐变和噪声的图片，避免全0数据导致的不真实的缓存和分支表现
+std::vector<uint8_t> MakeImage(int height, int width, int channels) {
+  std::vector<uint8_t> data(static_cast<size_t>(height) * width * channels);
+  uint32_t seed = 12345;
+  for (size_t idx = 0; idx < data.size(); idx++) {
+    seed = seed * 1103515245 + 12345;
+    data[idx] = static_cast<uint8_t>((idx / channels % width) + (seed >> 28));
+  }
+  return data;
+}
+
+void SetImageCounters(benchmark::State& state, int height, int width) {
+  state.SetItemsProcessed(state.iterations());
+  state.counters["width"] = width;
+  state.counters["height"] = height;
+  state.counters["mpix_per_second"] = benchmark::Counter(
+      static_cast<double>(width) * height * state.iterations() / 1e6,
+      benchmark::Counter::kIsRate);
+}
+
+void BM_BGRToNv12(benchmark::State& state) {
+  int width = static_cast<int>(state.range(0));
+  int height = static_cast<int>(state.range(1));
+  auto data = MakeImage(height, width, 3);
+  cv::Mat bgr_mat(height, width, CV_8UC3, data.data());
+  cv::Mat nv12_mat;
+  for (auto _ : state) {
+    ImageUtils::BGRToNv12(bgr_mat, nv12_mat);
+    benchmark::DoNotOptimize(nv12_mat.data);
+  }
+  SetImageCounters(state, height, width);
+}
+
+void BM_GetNV12Pyramid(benchmark::State& state) {
+  int width = static_cast<int>(state.range(0));
+  int height = static_cast<int>(state.range(1));
+  auto data = MakeImage(height, width, 3);
+  cv::Mat bgr_mat(height, width, CV_8UC3, data.data());
+  for (auto _ : state) {
+    auto pyramid = ImageUtils::GetNV12Pyramid(
+        bgr_mat, kModelInputHeight, kModelInputWidth);
+    benchmark::DoNotOptimize(pyramid.get());
+  }
+  SetImageCounters(state, height, width);
+}
+
+// 第三个参数为ImageResizeType
+void BM_GetNV12PyramidFromNV12Img(benchmark::State& state) {
+  int width = static_cast<int>(state.range(0));
+  int height = static_cast<int>(state.range(1));
+  auto resize_type = static_cast<ImageResizeType>(state.range(2));
+  auto data = MakeImage(height * 3 / 2, width, 1);
+  ImageTransform transform;
+  for (auto _ : state) {
+    auto pyramid = ImageUtils::GetNV12PyramidFromNV12Img(
+        reinterpret_cast<const char*>(data.data()),
+        height,
+        width,
+        width,
+        kModelInputHeight,
+        kModelInputWidth,
+        resize_type,
+        false,
+        &transform);
+    benchmark::DoNotOptimize(pyramid.get());
+  }
+  SetImageCounters(state, height, width);
+}
+
+// 使用libjpeg编码合成图片，v_samp_factor为2时是4:2:0，为1时是4:2:2
+std::vector<uint8_t> MakeJpeg(int height, int width, int v_samp_factor) {
+  auto rgb = MakeImage(height, width, 3);
+  jpeg_compress_struct cinfo;
+  jpeg_error_mgr err;
+  cinfo.err = jpeg_std_error(&err);
+  jpeg_create_compress(&cinfo);
+  unsigned char* out = nullptr;
+  unsigned long out_size = 0;  // NOLINT
+  jpeg_mem_dest(&cinfo, &out, &out_size);
+  cinfo.image_width = width;
+  cinfo.image_height = height;
+  cinfo.input_components = 3;
+  cinfo.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, 85, TRUE);
+  cinfo.comp_info[0].h_samp_factor = 2;
+  cinfo.comp_info[0].v_samp_factor = v_samp_factor;
+  jpeg_start_compress(&cinfo, TRUE);
+  while (cinfo.next_scanline < cinfo.image_height) {
+    JSAMPROW row = rgb.data() + static_cast<size_t>(cinfo.next_scanline) *
+                                    width * 3;
+    jpeg_write_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+  std::vector<uint8_t> data(out, out + out_size);
+  free(out);
+  jpeg_destroy_compress(&cinfo);
+  return data;
+}
+
+// 第三个参数为jpeg的v_samp_factor
+void BM_GetNV12PyramidFromJpeg(benchmark::State& state) {
+  int width = static_cast<int>(state.range(0));
+  int height = static_cast<int>(state.range(1));
+  auto data = MakeJpeg(height, width, static_cast<int>(state.range(2)));
+  ImageTransform transform;
+  for (auto _ : state) {
+    auto pyramid = ImageUtils::GetNV12PyramidFromJpeg(data.data(),
+                                                      data.size(),
+                                                      kModelInputHeight,
+                                                      kModelInputWidth,
+                                                      ImageResizeType::BILINEAR,
+                                                      true,
+                                                      &transform);
+    benchmark::DoNotOptimize(pyramid.get());
+  }
+  SetImageCounters(state, height, width);
+}
+
+// 与节点支持的encoding对应
+enum class InputFormat { RGB8 = 0, BGR8 = 1, YUYV = 2, UYVY = 3, MONO8 = 4 };
+
+int BytesPerPixel(InputFormat format) {
+  switch (format) {
+    case InputFormat::RGB8:
+    case InputFormat::BGR8:
+      return 3;
+    case InputFormat::YUYV:
+    case InputFormat::UYVY:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+int ConvertToNv12(InputFormat format,
+                  bool use_ref,
+                  const std::vector<uint8_t>& data,
+                  int height,
+                  int width,
+                  std::vector<uint8_t>& nv12) {
+  int step = width * BytesPerPixel(format);
+  nv12.resize(kModelInputWidth * kModelInputHeight * 3 / 2);
+  uint8_t* y = nv12.data();
+  uint8_t* uv = y + kModelInputWidth * kModelInputHeight;
+  switch (format) {
+    case InputFormat::RGB8:
+    case InputFormat::BGR8: {
+      auto convert = use_ref ? ImageConvert::RGBToNv12ResizeRef
+                             : ImageConvert::RGBToNv12Resize;
+      return convert(data.data(), height, width, step,
+                     format == InputFormat::BGR8, y, kModelInputWidth, uv,
+                     kModelInputWidth, kModelInputHeight, kModelInputWidth);
+    }
+    case InputFormat::YUYV:
+    case InputFormat::UYVY: {
+      auto convert = use_ref ? ImageConvert::Yuv422ToNv12ResizeRef
+                             : ImageConvert::Yuv422ToNv12Resize;
+      return convert(data.data(), height, width, step,
+                     format == InputFormat::UYVY, y, kModelInputWidth, uv,
+                     kModelInputWidth, kModelInputHeight, kModelInputWidth);
+    }
+    default: {
+      auto convert = use_ref ? ImageConvert::GrayToNv12ResizeRef
+                             : ImageConvert::GrayToNv12Resize;
+      return convert(data.data(), height, width, step, y, kModelInputWidth,
+                     uv, kModelInputWidth, kModelInputHeight,
+                     kModelInputWidth);
+    }
+  }
+}
+
+// 第三个参数为InputFormat
+void BM_ConvertToPyramid(benchmark::State& state) {
+  int width = static_cast<int>(state.range(0));
+  int height = static_cast<int>(state.range(1));
+  auto format = static_cast<InputFormat>(state.range(2));
+  int bytes_per_pixel = BytesPerPixel(format);
+  auto data = MakeImage(height, width, bytes_per_pixel);
+
+  std::vector<uint8_t> nv12;
+  std::vector<uint8_t> nv12_ref;
+  if (ConvertToNv12(format, false, data, height, width, nv12) ||
+      ConvertToNv12(format, true, data, height, width, nv12_ref) ||
+      nv12 != nv12_ref) {
+    state.SkipWithError("converted nv12 differs from reference");
+    return;
+  }
+
+  int step = width * bytes_per_pixel;
+  ImageTransform transform;
+  for (auto _ : state) {
+    std::shared_ptr<NV12PyramidInput> pyramid;
+    switch (format) {
+      case InputFormat::RGB8:
+      case InputFormat::BGR8:
+        pyramid = ImageUtils::GetNV12PyramidFromRGBImg(
+            data.data(), height, width, step, format == InputFormat::BGR8,
+            kModelInputHeight, kModelInputWidth, ImageResizeType::BILINEAR,
+            true, &transform);
+        break;
+      case InputFormat::YUYV:
+      case InputFormat::UYVY:
+        pyramid = ImageUtils::GetNV12PyramidFromYUV422Img(
+            data.data(), height, width, step, format == InputFormat::UYVY,
+            kModelInputHeight, kModelInputWidth, ImageResizeType::BILINEAR,
+            true, &transform);
+        break;
+      default:
+        pyramid = ImageUtils::GetNV12PyramidFromGrayImg(
+            data.data(), height, width, step, kModelInputHeight,
+            kModelInputWidth, ImageResizeType::BILINEAR, true, &transform);
+        break;
+    }
+    benchmark::DoNotOptimize(pyramid.get());
+  }
+  SetImageCounters(state, height, width);
+}
+
+void ConvertArgs(benchmark::internal::Benchmark* bench) {
+  const int resolutions[][2] = {{640, 480}, {960, 544}, {1920, 1080}};
+  for (const auto& resolution : resolutions) {
+    for (int format = static_cast<int>(InputFormat::RGB8);
+         format <= static_cast<int>(InputFormat::MONO8);
+         format++) {
+      bench->Args({resolution[0], resolution[1], format});
+    }
+  }
+}
+
+void NV12Args(benchmark::internal::Benchmark* bench) {
+  const int resolutions[][2] = {{640, 480}, {960, 544}, {1920, 1080}};
+  for (const auto& resolution : resolutions) {
+    for (int resize_type = static_cast<int>(ImageResizeType::CROP);
+         resize_type <= static_cast<int>(ImageResizeType::AREA);
+         resize_type++) {
+      bench->Args({resolution[0], resolution[1], resize_type});
+    }
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_BGRToNv12)
+    ->Args({640, 480})->Args({960, 544})->Args({1920, 1080})
+    ->ArgNames({"w", "h"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetNV12Pyramid)
+    ->Args({640, 480})->Args({960, 544})->Args({1920, 1080})
+    ->ArgNames({"w", "h"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetNV12PyramidFromNV12Img)
+    ->Apply(NV12Args)
+    ->ArgNames({"w", "h", "resize_type"})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_ConvertToPyramid)
+    ->Apply(ConvertArgs)
+    ->ArgNames({"w", "h", "format"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetNV12PyramidFromJpeg)
+    ->Args({640, 480, 2})->Args({1920, 1080, 2})->Args({1920, 1080, 1})
+    ->ArgNames({"w", "h", "v_samp"})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
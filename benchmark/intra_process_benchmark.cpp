@@ -0,0 +1,133 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "ai_msgs/msg/perception_targets.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+// BM_PublishTargets测量同一进程中发布一帧PerceptionTargets到订阅回调收到的延迟
+// intra_process为0时发布者和订阅者在同一进程中经过rmw（序列化、DDS本机回环和反序列化），
+// 为1时打开use_intra_process_comms，UniquePtr发布给唯一的订阅者不拷贝
+// 只比较同一进程内的两种传输方式，不包括跨进程的订阅者（共享内存或者网络传输、进程调度），
+// 也不加载Mono2dBodyDetNode组件，不包括推理和后处理
+// 每个目标带有人体、人头、人脸、人手4个框和19个人体关键点
+
+namespace {
+
+constexpr int kKpsNum = 19;
+constexpr auto kReceiveTimeout = std::chrono::seconds(1);
+
+ai_msgs::msg::PerceptionTargets MakeTargets(int target_num) {
+  static const char* roi_types[] = {"body", "head", "face", "hand"};
+  ai_msgs::msg::PerceptionTargets msg;
+  msg.header.set__frame_id("0");
+  for (int idx = 0; idx < target_num; idx++) {
+    ai_msgs::msg::Target target;
+    target.set__type("person");
+    target.set__track_id(idx);
+    for (const char* roi_type : roi_types) {
+      ai_msgs::msg::Roi roi;
+      roi.set__type(roi_type);
+      roi.rect.set__x_offset(idx * 10);
+      roi.rect.set__y_offset(idx * 5);
+      roi.rect.set__width(100);
+      roi.rect.set__height(200);
+      target.rois.push_back(roi);
+    }
+    ai_msgs::msg::Point kps;
+    kps.set__type("body_kps");
+    kps.point.resize(kKpsNum);
+    kps.confidence.assign(kKpsNum, 0.9f);
+    target.points.push_back(kps);
+    msg.targets.push_back(target);
+  }
+  return msg;
+}
+
+void BM_PublishTargets(benchmark::State& state) {
+  bool intra_process = state.range(0) == 1;
+  int target_num = static_cast<int>(state.range(1));
+  auto options = rclcpp::NodeOptions().use_intra_process_comms(intra_process);
+  auto pub_node = std::make_shared<rclcpp::Node>("targets_pub", options);
+  auto sub_node = std::make_shared<rclcpp::Node>("targets_sub", options);
+  // 每组参数使用单独的topic，避免收到上一组的消息
+  std::string topic = "intra_process_benchmark_" +
+                      std::to_string(state.range(0)) + "_" +
+                      std::to_string(target_num);
+  uint64_t received = 0;
+  auto subscription =
+      sub_node->create_subscription<ai_msgs::msg::PerceptionTargets>(
+          topic,
+          10,
+          [&received](ai_msgs::msg::PerceptionTargets::UniquePtr msg) {
+            benchmark::DoNotOptimize(msg->targets.data());
+            received++;
+          });
+  auto publisher =
+      pub_node->create_publisher<ai_msgs::msg::PerceptionTargets>(topic, 10);
+  rclcpp::executors::SingleThreadedExecutor exec;
+  exec.add_node(sub_node);
+
+  auto deadline = std::chrono::steady_clock::now() + kReceiveTimeout;
+  while (publisher->get_subscription_count() == 0) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      state.SkipWithError("subscription not matched");
+      return;
+    }
+    exec.spin_once(std::chrono::milliseconds(10));
+  }
+
+  const ai_msgs::msg::PerceptionTargets targets = MakeTargets(target_num);
+  for (auto _ : state) {
+    // 组装消息的拷贝不计入耗时
+    state.PauseTiming();
+    auto msg = std::make_unique<ai_msgs::msg::PerceptionTargets>(targets);
+    uint64_t expected = received + 1;
+    state.ResumeTiming();
+    publisher->publish(std::move(msg));
+    deadline = std::chrono::steady_clock::now() + kReceiveTimeout;
+    while (received < expected) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        state.SkipWithError("message not received");
+        return;
+      }
+      exec.spin_once(std::chrono::milliseconds(10));
+    }
+  }
+  state.counters["targets"] = static_cast<double>(target_num);
+}
+
+}  // namespace
+
+BENCHMARK(BM_PublishTargets)
+    ->ArgNames({"intra_process", "targets"})
+    ->Args({0, 10})
+    ->Args({1, 10})
+    ->Args({0, 100})
+    ->Args({1, 100})
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+int main(int argc, char** argv) {
+  rclcpp::init(argc, argv);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "include/motion_gate.h"
+
+// BM_MotionGate测量不同分辨率的nv12（pixel_stride为1，使用SIMD）和yuyv
+// （pixel_stride为2）图片判断一次运动的耗时，两帧交替输入，其中一帧有运动区域
+
+namespace {
+
+void FillFrames(int height,
+                int width,
+                int pixel_stride,
+                std::vector<uint8_t>& still,
+                std::vector<uint8_t>& moving) {
+  size_t step = static_cast<size_t>(width) * pixel_stride;
+  still.resize(step * height);
+  for (int row = 0; row < height; row++) {
+    for (size_t col = 0; col < step; col++) {
+      still[row * step + col] = static_cast<uint8_t>((row * 3 + col * 7) % 200);
+    }
+  }
+  moving = still;
+  // 图像中间1/8宽、1/4高的区域亮度变化
+  for (int row = height * 3 / 8; row < height * 5 / 8; row++) {
+    for (size_t col = step * 7 / 16; col < step * 9 / 16; col++) {
+      moving[row * step + col] ^= 0x80;
+    }
+  }
+}
+
+void BM_MotionGate(benchmark::State& state) {
+  int width = static_cast<int>(state.range(0));
+  int height = static_cast<int>(state.range(1));
+  int pixel_stride = static_cast<int>(state.range(2));
+  std::vector<uint8_t> still;
+  std::vector<uint8_t> moving;
+  FillFrames(height, width, pixel_stride, still, moving);
+
+  MotionGate gate(0.001f);
+  int step = width * pixel_stride;
+  uint64_t frame = 0;
+  for (auto _ : state) {
+    const auto& img = (frame++ % 2 == 0) ? still : moving;
+    bool motion = gate.Check(img.data(), pixel_stride, step, height, width);
+    benchmark::DoNotOptimize(motion);
+  }
+  state.SetItemsProcessed(state.iterations());
+  auto stats = gate.GetStats();
+  state.counters["skip_rate"] =
+      stats.checked > 0 ? static_cast<double>(stats.skipped) / stats.checked
+                        : 0;
+}
+
+}  // namespace
+
+BENCHMARK(BM_MotionGate)
+    ->Args({640, 480, 1})
+    ->Args({1920, 1080, 1})
+    ->Args({3840, 2160, 1})
+    ->Args({1920, 1080, 2})
+    ->ArgNames({"width", "height", "pixel_stride"})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
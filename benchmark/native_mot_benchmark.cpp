@@ -0,0 +1,133 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "include/native_mot.h"
+
+namespace {
+
+constexpr int kImgWidth = 1920;
+constexpr int kImgHeight = 1080;
+constexpr int kFrameGapMs = 40;
+
+// 在图像中均匀分布、匀速运动并带有检测抖动的目标
+class SyntheticScene {
+ public:
+  explicit SyntheticScene(int box_num) : gen_(box_num) {
+    std::uniform_real_distribution<float> x_dist(0, kImgWidth);
+    std::uniform_real_distribution<float> y_dist(0, kImgHeight);
+    std::uniform_real_distribution<float> v_dist(-4, 4);
+    std::uniform_real_distribution<float> size_dist(24, 96);
+    for (int idx = 0; idx < box_num; idx++) {
+      targets_.push_back(Target{x_dist(gen_),
+                                y_dist(gen_),
+                                v_dist(gen_),
+                                v_dist(gen_),
+                                size_dist(gen_)});
+    }
+    boxes_.resize(box_num);
+  }
+
+  const std::vector<native_mot::MotBox>& NextFrame() {
+    std::normal_distribution<float> jitter(0, 1);
+    for (size_t idx = 0; idx < targets_.size(); idx++) {
+      auto& target = targets_[idx];
+      target.cx += target.vx;
+      target.cy += target.vy;
+      // 离开图像的目标反弹，保持目标数不变
+      if (target.cx < 0 || target.cx > kImgWidth) target.vx = -target.vx;
+      if (target.cy < 0 || target.cy > kImgHeight) target.vy = -target.vy;
+      float half = target.size / 2;
+      float cx = target.cx + jitter(gen_);
+      float cy = target.cy + jitter(gen_);
+      boxes_[idx] = native_mot::MotBox(static_cast<int>(cx - half / 2),
+                                       static_cast<int>(cy - half),
+                                       static_cast<int>(cx + half / 2),
+                                       static_cast<int>(cy + half),
+                                       0.9f);
+    }
+    return boxes_;
+  }
+
+ private:
+  struct Target {
+    float cx;
+    float cy;
+    float vx;
+    float vy;
+    float size;
+  };
+  std::mt19937 gen_;
+  std::vector<Target> targets_;
+  std::vector<native_mot::MotBox> boxes_;
+};
+
+void RunTracking(benchmark::State& state,
+                 native_mot::NativeMotConfig::MatchType match_type) {
+  native_mot::NativeMotConfig config;
+  config.match_type = match_type;
+  native_mot::NativeMot mot(config);
+  SyntheticScene scene(static_cast<int>(state.range(0)));
+  std::vector<native_mot::MotBox> out_box_list;
+  std::vector<std::shared_ptr<native_mot::MotTrackId>> disappeared_ids;
+  time_t time_stamp = 1;
+  // 预热，使轨迹数稳定
+  for (int idx = 0; idx < 10; idx++) {
+    mot.DoProcess(scene.NextFrame(),
+                  out_box_list,
+                  disappeared_ids,
+                  time_stamp,
+                  kImgWidth,
+                  kImgHeight);
+    time_stamp += kFrameGapMs;
+  }
+  for (auto _ : state) {
+    state.PauseTiming();
+    const auto& in_box_list = scene.NextFrame();
+    disappeared_ids.clear();
+    state.ResumeTiming();
+    mot.DoProcess(in_box_list,
+                  out_box_list,
+                  disappeared_ids,
+                  time_stamp,
+                  kImgWidth,
+                  kImgHeight);
+    time_stamp += kFrameGapMs;
+    benchmark::DoNotOptimize(out_box_list.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["tracks"] = static_cast<double>(mot.TrackNum());
+}
+
+void BM_NativeMotIou(benchmark::State& state) {
+  RunTracking(state, native_mot::NativeMotConfig::MatchType::IOU);
+}
+
+void BM_NativeMotEuclidean(benchmark::State& state) {
+  RunTracking(state, native_mot::NativeMotConfig::MatchType::EUCLIDEAN);
+}
+
+}  // namespace
+
+BENCHMARK(BM_NativeMotIou)->Arg(10)->Arg(100)->Arg(500)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_NativeMotEuclidean)->Arg(10)->Arg(100)->Arg(500)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
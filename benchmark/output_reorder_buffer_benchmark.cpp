@@ -0,0 +1,275 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "include/output_reorder_buffer.h"
+
+// BM_ReorderFeed：推理输出写入排序缓存并按照输入顺序取出的耗时
+// window为同时在推理的帧数，窗口内的输出逆序到达，1表示按照顺序到达
+// BM_ConcurrentFeed：一个线程按照输入顺序注册帧，feeders个线程并发写入推理输出，
+// 比较OutputReorderBuffer与替换之前基于互斥锁的NodeOutputManage的吞吐
+
+namespace {
+
+constexpr size_t kCacheSize = 16;
+constexpr uint64_t kTimeoutMs = 1000;
+// 每次迭代处理的帧数
+constexpr int kFrames = 4096;
+// 注册之后还没有写入输出的最大帧数，小于两种实现的缓存容量，不会因为缓存已满丢帧
+constexpr int kInflight = 8;
+
+void BM_ReorderFeed(benchmark::State& state) {
+  size_t window = static_cast<size_t>(state.range(0));
+  OutputReorderBuffer buffer(kCacheSize, kTimeoutMs);
+  // 输出对象循环使用，只测量排序缓存本身
+  std::vector<std::shared_ptr<DnnNodeOutput>> outputs;
+  for (size_t idx = 0; idx < window; idx++) {
+    outputs.push_back(std::make_shared<DnnNodeOutput>());
+  }
+  std::vector<uint64_t> seqs(window);
+  uint64_t released = 0;
+  auto handler = [&released](const std::shared_ptr<DnnNodeOutput>& output) {
+    benchmark::DoNotOptimize(output.get());
+    released++;
+  };
+  for (auto _ : state) {
+    for (size_t idx = 0; idx < window; idx++) {
+      seqs[idx] = buffer.Register();
+    }
+    for (size_t idx = window; idx > 0; idx--) {
+      buffer.Feed(seqs[idx - 1], outputs[idx - 1], handler);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * window);
+  auto stats = buffer.GetStats();
+  state.counters["released"] = static_cast<double>(released);
+  state.counters["dropped"] = static_cast<double>(stats.dropped);
+}
+
+struct TsOutput : public DnnNodeOutput {
+  uint64_t ts_ms = 0;
+};
+
+// 替换之前的NodeOutputManage，去掉了调试日志，时间戳从TsOutput中读取，
+// 其余逻辑保持原样（包括输出的是本次写入的输出而不是队首的输出）
+class NodeOutputManage {
+ public:
+  void Feed(uint64_t ts_ms) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    cache_frame_.insert(ts_ms);
+    if (cache_frame_.size() > cache_size_limit_) {
+      cache_frame_.erase(cache_frame_.begin());
+    }
+  }
+
+  std::vector<std::shared_ptr<DnnNodeOutput>> Feed(
+      const std::shared_ptr<DnnNodeOutput>& in_node_output) {
+    std::vector<std::shared_ptr<DnnNodeOutput>> node_outputs{};
+    auto ts_output = std::dynamic_pointer_cast<TsOutput>(in_node_output);
+    if (!ts_output) {
+      return node_outputs;
+    }
+    uint64_t ts_ms = ts_output->ts_ms;
+
+    uint8_t loop_num = cache_size_limit_;
+    {
+      std::unique_lock<std::mutex> lk(mtx_);
+      cache_node_output_[ts_ms] = in_node_output;
+      if (cache_node_output_.size() > cache_size_limit_) {
+        cache_node_output_.erase(cache_node_output_.begin());
+      }
+      if (cache_frame_.empty()) {
+        return node_outputs;
+      }
+
+      loop_num = cache_node_output_.size();
+    }
+
+    // 按照时间戳顺序输出推理结果
+    for (uint8_t idx = 0; idx < loop_num; idx++) {
+      std::shared_ptr<DnnNodeOutput> node_output = nullptr;
+      {
+        std::unique_lock<std::mutex> lk(mtx_);
+        if (cache_frame_.empty() || cache_node_output_.empty()) {
+          break;
+        }
+
+        auto first_frame = cache_frame_.begin();
+        auto first_output = cache_node_output_.begin();
+        if (*first_frame == first_output->first) {
+          node_output = in_node_output;
+          cache_frame_.erase(first_frame);
+          cache_node_output_.erase(first_output);
+        } else {
+          if (first_output->first > *first_frame) {
+            uint64_t time_ms_diff = first_output->first - *first_frame;
+            if (time_ms_diff > smart_output_timeout_ms_) {
+              cache_frame_.erase(first_frame);
+            }
+          } else if (*first_frame > first_output->first) {
+            uint64_t time_ms_diff = *first_frame - first_output->first;
+            if (time_ms_diff > smart_output_timeout_ms_) {
+              cache_node_output_.erase(first_output);
+            }
+          } else {
+            break;
+          }
+        }
+      }
+
+      if (node_output) {
+        node_outputs.emplace_back(node_output);
+      }
+    }
+
+    return node_outputs;
+  }
+
+ private:
+  std::set<uint64_t> cache_frame_;
+  std::map<uint64_t, std::shared_ptr<DnnNodeOutput>> cache_node_output_;
+  const uint8_t cache_size_limit_ = 10;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  const uint64_t smart_output_timeout_ms_ = 1000;
+};
+
+// 两种实现统一为注册和写入两个接口，返回本次调用输出的帧数
+class ReorderBufferAdapter {
+ public:
+  uint64_t Register(uint64_t ts_ms) {
+    (void)ts_ms;
+    return buffer_.Register();
+  }
+
+  uint64_t Feed(uint64_t key, const std::shared_ptr<DnnNodeOutput>& output) {
+    uint64_t released = 0;
+    buffer_.Feed(key,
+                 output,
+                 [&released](const std::shared_ptr<DnnNodeOutput>& out) {
+                   benchmark::DoNotOptimize(out.get());
+                   released++;
+                 });
+    return released;
+  }
+
+ private:
+  OutputReorderBuffer buffer_{kCacheSize, kTimeoutMs};
+};
+
+class NodeOutputManageAdapter {
+ public:
+  uint64_t Register(uint64_t ts_ms) {
+    manage_.Feed(ts_ms);
+    return ts_ms;
+  }
+
+  uint64_t Feed(uint64_t key, const std::shared_ptr<DnnNodeOutput>& output) {
+    (void)key;
+    auto outputs = manage_.Feed(output);
+    benchmark::DoNotOptimize(outputs.data());
+    return outputs.size();
+  }
+
+ private:
+  NodeOutputManage manage_;
+};
+
+// 第idx帧由第idx % feeders个写入线程处理，同一个线程内按照顺序写入，
+// 不同线程之间的写入顺序不确定，与多个推理回调线程并发输出一致
+template <typename Reorder>
+void BM_ConcurrentFeed(benchmark::State& state) {
+  int feeders = static_cast<int>(state.range(0));
+  Reorder reorder;
+  std::vector<std::shared_ptr<TsOutput>> outputs;
+  for (int idx = 0; idx < kFrames; idx++) {
+    outputs.push_back(std::make_shared<TsOutput>());
+  }
+  std::vector<uint64_t> keys(kFrames);
+  // 已经注册的帧数和已经写入的帧数，跨迭代累计
+  std::atomic<uint64_t> registered{0};
+  std::atomic<uint64_t> fed{0};
+  std::atomic<uint64_t> released{0};
+  std::atomic<bool> stopped{false};
+
+  std::vector<std::thread> threads;
+  for (int feeder = 0; feeder < feeders; feeder++) {
+    threads.emplace_back([&, feeder] {
+      uint64_t local_released = 0;
+      for (uint64_t frame = feeder; !stopped; frame += feeders) {
+        while (registered.load(std::memory_order_acquire) <= frame) {
+          if (stopped) {
+            released += local_released;
+            return;
+          }
+          std::this_thread::yield();
+        }
+        int slot = static_cast<int>(frame % kFrames);
+        local_released += reorder.Feed(keys[slot], outputs[slot]);
+        fed.fetch_add(1, std::memory_order_release);
+      }
+      released += local_released;
+    });
+  }
+
+  uint64_t frame = 0;
+  for (auto _ : state) {
+    for (int idx = 0; idx < kFrames; idx++, frame++) {
+      while (frame - fed.load(std::memory_order_acquire) >= kInflight) {
+        std::this_thread::yield();
+      }
+      int slot = static_cast<int>(frame % kFrames);
+      // 时间戳间隔1ms，与排序超时相比足够小，不会因为超时丢帧
+      outputs[slot]->ts_ms = frame;
+      keys[slot] = reorder.Register(frame);
+      registered.store(frame + 1, std::memory_order_release);
+    }
+    while (fed.load(std::memory_order_acquire) < frame) {
+      std::this_thread::yield();
+    }
+  }
+  stopped = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  state.SetItemsProcessed(state.iterations() * kFrames);
+  state.counters["released_ratio"] =
+      frame > 0 ? static_cast<double>(released.load()) / frame : 0;
+}
+
+}  // namespace
+
+BENCHMARK(BM_ReorderFeed)->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+    ->ArgName("window");
+
+BENCHMARK_TEMPLATE(BM_ConcurrentFeed, ReorderBufferAdapter)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+    ->ArgName("feeders")
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentFeed, NodeOutputManageAdapter)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)
+    ->ArgName("feeders")
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
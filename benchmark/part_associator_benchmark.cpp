@@ -0,0 +1,211 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "include/part_associator.h"
+
+// BM_PartAssociate测量1920x1080图片中有N个人（每人一个人体框、人头、人脸和两个人手，
+// 人体带19个关键点）时，每帧将部位框关联到人体框的耗时
+// BM_BruteForceAssociate为下游逐对计算所有部位框和人体框重叠的做法，用于对比
+// 人按照网格排列并带有偏移，相邻的人体框互相重叠，模拟拥挤场景
+// correct_ratio为关联到正确人体的部位框比例
+
+namespace {
+
+constexpr int kImgWidth = 1920;
+constexpr int kImgHeight = 1080;
+constexpr int kKpsNum = 19;
+
+using PartType = PartAssociator::PartType;
+
+struct Box {
+  float x1;
+  float y1;
+  float x2;
+  float y2;
+};
+
+struct Part {
+  Box box;
+  PartType type;
+  int32_t body;
+};
+
+struct Scene {
+  std::vector<Box> bodies;
+  std::vector<ai_msgs::msg::Point> kps;
+  std::vector<Part> parts;
+};
+
+void AddKp(ai_msgs::msg::Point& kps, int idx, float x, float y) {
+  kps.point[idx].set__x(x);
+  kps.point[idx].set__y(y);
+  kps.confidence[idx] = 0.9f;
+}
+
+Scene MakeScene(int person_num) {
+  Scene scene;
+  // 人数越多人体框越小，保持所有人都在图片内
+  int cols = 1;
+  while (cols * cols * 9 / 16 < person_num) {
+    cols++;
+  }
+  int rows = (person_num + cols - 1) / cols;
+  float cell_w = static_cast<float>(kImgWidth) / cols;
+  float cell_h = static_cast<float>(kImgHeight) / rows;
+  for (int idx = 0; idx < person_num; idx++) {
+    // 人体框比网格大，与相邻的人体框重叠
+    float width = cell_w * 1.3f;
+    float height = std::min(cell_h * 1.4f, width * 2.5f);
+    float x1 = (idx % cols) * cell_w + (idx * 37 % 11 - 5) * cell_w / 20;
+    float y1 = (idx / cols) * cell_h + (idx * 53 % 7 - 3) * cell_h / 20;
+    Box body{x1, y1, x1 + width, y1 + height};
+    scene.bodies.push_back(body);
+
+    float head_w = width * 0.3f;
+    float head_x1 = x1 + (width - head_w) / 2;
+    Box head{head_x1, y1, head_x1 + head_w, y1 + head_w * 1.2f};
+    Box face{head.x1 + head_w * 0.15f,
+             head.y1 + head_w * 0.3f,
+             head.x2 - head_w * 0.15f,
+             head.y2 - head_w * 0.05f};
+    float hand = width * 0.15f;
+    float wrist_y = y1 + height * 0.55f;
+    float left_wrist_x = x1 + width * 0.1f;
+    float right_wrist_x = x1 + width * 0.9f;
+    scene.parts.push_back(Part{head, PartType::HEAD, idx});
+    scene.parts.push_back(Part{face, PartType::FACE, idx});
+    scene.parts.push_back(Part{Box{left_wrist_x - hand / 2,
+                                   wrist_y,
+                                   left_wrist_x + hand / 2,
+                                   wrist_y + hand},
+                               PartType::HAND,
+                               idx});
+    scene.parts.push_back(Part{Box{right_wrist_x - hand / 2,
+                                   wrist_y,
+                                   right_wrist_x + hand / 2,
+                                   wrist_y + hand},
+                               PartType::HAND,
+                               idx});
+
+    ai_msgs::msg::Point kps;
+    kps.point.resize(kKpsNum);
+    kps.confidence.assign(kKpsNum, 0.1f);
+    float center_x = (head.x1 + head.x2) / 2;
+    float eye_y = (face.y1 + face.y2) / 2 - head_w * 0.1f;
+    AddKp(kps, 0, center_x, eye_y + head_w * 0.2f);
+    AddKp(kps, 1, center_x - head_w * 0.15f, eye_y);
+    AddKp(kps, 2, center_x + head_w * 0.15f, eye_y);
+    AddKp(kps, 3, head.x1, eye_y);
+    AddKp(kps, 4, head.x2, eye_y);
+    AddKp(kps, 9, left_wrist_x, wrist_y);
+    AddKp(kps, 10, right_wrist_x, wrist_y);
+    scene.kps.push_back(kps);
+  }
+  // 部位框按照类别输出，与模型输出顺序一致
+  std::stable_sort(scene.parts.begin(),
+                   scene.parts.end(),
+                   [](const Part& a, const Part& b) { return a.type < b.type; });
+  return scene;
+}
+
+double CorrectRatio(const Scene& scene, const std::vector<int32_t>& result) {
+  size_t correct = 0;
+  for (size_t idx = 0; idx < scene.parts.size(); idx++) {
+    if (result[idx] == scene.parts[idx].body) {
+      correct++;
+    }
+  }
+  return scene.parts.empty()
+             ? 1.0
+             : static_cast<double>(correct) / scene.parts.size();
+}
+
+void BM_PartAssociate(benchmark::State& state) {
+  Scene scene = MakeScene(static_cast<int>(state.range(0)));
+  PartAssociator associator;
+  std::vector<int32_t> result(scene.parts.size(), -1);
+  for (auto _ : state) {
+    associator.Reset();
+    for (size_t idx = 0; idx < scene.bodies.size(); idx++) {
+      const auto& body = scene.bodies[idx];
+      associator.AddBody(body.x1, body.y1, body.x2, body.y2, &scene.kps[idx]);
+    }
+    for (const auto& part : scene.parts) {
+      associator.AddPart(
+          part.type, part.box.x1, part.box.y1, part.box.x2, part.box.y2);
+    }
+    associator.Associate();
+    benchmark::DoNotOptimize(associator.BodyOf(0));
+  }
+  for (size_t idx = 0; idx < scene.parts.size(); idx++) {
+    result[idx] = associator.BodyOf(idx);
+  }
+  state.SetItemsProcessed(state.iterations() * scene.parts.size());
+  state.counters["correct_ratio"] = CorrectRatio(scene, result);
+}
+
+void BM_BruteForceAssociate(benchmark::State& state) {
+  Scene scene = MakeScene(static_cast<int>(state.range(0)));
+  std::vector<int32_t> result(scene.parts.size(), -1);
+  for (auto _ : state) {
+    // 每个部位框取交集占部位框面积比例最大的人体框
+    for (size_t part_idx = 0; part_idx < scene.parts.size(); part_idx++) {
+      const Box& part = scene.parts[part_idx].box;
+      float part_area = (part.x2 - part.x1) * (part.y2 - part.y1);
+      float best = 0.5f;
+      int32_t best_body = -1;
+      for (size_t body_idx = 0; body_idx < scene.bodies.size(); body_idx++) {
+        const Box& body = scene.bodies[body_idx];
+        float inter_w = std::min(part.x2, body.x2) - std::max(part.x1, body.x1);
+        float inter_h = std::min(part.y2, body.y2) - std::max(part.y1, body.y1);
+        if (inter_w <= 0 || inter_h <= 0) {
+          continue;
+        }
+        float inside = inter_w * inter_h / part_area;
+        if (inside > best) {
+          best = inside;
+          best_body = static_cast<int32_t>(body_idx);
+        }
+      }
+      result[part_idx] = best_body;
+    }
+    benchmark::DoNotOptimize(result.data());
+  }
+  state.SetItemsProcessed(state.iterations() * scene.parts.size());
+  state.counters["correct_ratio"] = CorrectRatio(scene, result);
+}
+
+}  // namespace
+
+BENCHMARK(BM_PartAssociate)
+    ->ArgName("persons")
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(200)
+    ->Arg(400)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BruteForceAssociate)
+    ->ArgName("persons")
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(200)
+    ->Arg(400)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
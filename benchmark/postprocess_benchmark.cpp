@@ -0,0 +1,108 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "include/target_builder.h"
+
+// BM_TargetAssembly测量不同原图分辨率和检测框数下，检测框映射裁剪和消息组装的耗时
+// 稳定后每帧不申请堆内存的检查见test/postprocess_alloc_test.cpp
+
+namespace {
+
+constexpr int32_t kBodyIndex = 1;
+constexpr int kKpsNum = 19;
+
+struct Point {
+  float x;
+  float y;
+  float score;
+};
+
+// 模型输入960x544坐标系下的解析结果，部分检测框超出图像边界需要裁剪
+void BM_TargetAssembly(benchmark::State& state) {
+  int src_width = static_cast<int>(state.range(0));
+  int src_height = static_cast<int>(state.range(1));
+  int box_num = static_cast<int>(state.range(2));
+  ImageTransform transform;
+  transform.scale_x = 960.0f / src_width;
+  transform.scale_y = 544.0f / src_height;
+  transform.src_width = src_width;
+  transform.src_height = src_height;
+  struct Rect {
+    float left;
+    float top;
+    float right;
+    float bottom;
+    float conf;
+  };
+  std::vector<Rect> rects;
+  for (int idx = 0; idx < box_num; idx++) {
+    float x = static_cast<float>(idx * 97 % 1000) - 20;
+    float y = static_cast<float>(idx * 53 % 580) - 20;
+    rects.push_back(Rect{x, y, x + 40, y + 80, 0.9f});
+  }
+  std::vector<std::vector<Point>> kps(box_num, std::vector<Point>(kKpsNum));
+
+  TargetBuilder builder({{kBodyIndex, "body"}}, kBodyIndex);
+  for (auto _ : state) {
+    builder.Reset();
+    builder.AddOutput(kBodyIndex);
+    for (size_t idx = 0; idx < rects.size(); idx++) {
+      const auto& rect = rects[idx];
+      builder.AddBox(kBodyIndex,
+                     rect.left,
+                     rect.top,
+                     rect.right,
+                     rect.bottom,
+                     rect.conf,
+                     transform,
+                     src_width,
+                     src_height);
+      builder.AddBodyKps(kps[idx], transform);
+    }
+    // 跟踪结果直接使用输入框，按照顺序分配id
+    auto& out_boxes = builder.OutRois()[kBodyIndex];
+    out_boxes = builder.InRois()[kBodyIndex];
+    for (size_t idx = 0; idx < out_boxes.size(); idx++) {
+      out_boxes[idx].id = static_cast<int>(idx) + 1;
+      out_boxes[idx].state_ = hobot_mot::DataState::VALID;
+    }
+    ai_msgs::msg::PerceptionTargets msg;
+    builder.Build(msg, nullptr);
+    benchmark::DoNotOptimize(msg.targets.data());
+  }
+  state.SetItemsProcessed(state.iterations() * box_num);
+}
+
+void TargetAssemblyArgs(benchmark::internal::Benchmark* bench) {
+  const int resolutions[][2] = {{640, 480}, {960, 544}, {1920, 1080}};
+  for (const auto& resolution : resolutions) {
+    for (int box_num : {10, 100, 500}) {
+      bench->Args({resolution[0], resolution[1], box_num});
+    }
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_TargetAssembly)
+    ->Apply(TargetAssemblyArgs)
+    ->ArgNames({"w", "h", "boxes"})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
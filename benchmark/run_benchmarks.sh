@@ -0,0 +1,45 @@
+#!/bin/bash
+# Copyright (c) 2022，Horizon Robotics.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# 运行编译生成的所有性能测试，每个测试程序的结果以json格式写入输出目录，用于比较不同版本
+# 用法：run_benchmarks.sh <编译目录> [输出目录，默认benchmark_results]
+
+if [ $# -lt 1 ]; then
+  echo "usage: $0 <build_dir> [output_dir]"
+  exit 1
+fi
+
+build_dir=$1
+output_dir=${2:-benchmark_results}
+mkdir -p "${output_dir}"
+
+ret=0
+for name in image_utils_benchmark output_reorder_buffer_benchmark \
+    postprocess_benchmark native_mot_benchmark async_logger_benchmark \
+    tile_merger_benchmark motion_gate_benchmark part_associator_benchmark \
+    intra_process_benchmark det_result_packer_benchmark; do
+  bin="${build_dir}/${name}"
+  if [ ! -x "${bin}" ]; then
+    echo "skip ${name}, not built"
+    continue
+  fi
+  echo "run ${name}"
+  if ! "${bin}" --benchmark_out="${output_dir}/${name}.json" \
+      --benchmark_out_format=json; then
+    echo "${name} failed"
+    ret=1
+  fi
+done
+exit ${ret}
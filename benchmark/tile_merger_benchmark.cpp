@@ -0,0 +1,118 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "include/tile_merger.h"
+
+// BM_TileMerge测量1920x1080原图切分为cols x rows个tile（加整图）时，
+// 每帧合并所有tile检测框（含人体关键点）的耗时
+// 每个目标在覆盖它的每个tile以及整图中各检测一次，位于重叠区域的目标会被边界截断
+
+namespace {
+
+constexpr int kImgWidth = 1920;
+constexpr int kImgHeight = 1080;
+constexpr int32_t kBodyIndex = 1;
+constexpr int32_t kHeadIndex = 3;
+constexpr int kKpsNum = 19;
+
+struct Target {
+  float x1;
+  float y1;
+  float x2;
+  float y2;
+};
+
+void FillFrame(TileMerger& merger,
+               const std::vector<TileRect>& tiles,
+               const std::vector<Target>& targets) {
+  merger.Reset(tiles, kImgHeight, kImgWidth);
+  for (size_t tile = 0; tile < tiles.size(); tile++) {
+    const auto& rect = tiles[tile];
+    for (size_t idx = 0; idx < targets.size(); idx++) {
+      // 检测框裁剪到tile范围内，模拟被切分边界截断
+      const auto& target = targets[idx];
+      float x1 = std::max(target.x1, static_cast<float>(rect.x));
+      float y1 = std::max(target.y1, static_cast<float>(rect.y));
+      float x2 = std::min(target.x2, static_cast<float>(rect.x + rect.width));
+      float y2 = std::min(target.y2, static_cast<float>(rect.y + rect.height));
+      if (x2 - x1 < 8 || y2 - y1 < 8) {
+        continue;
+      }
+      float score = 0.6f + 0.3f * static_cast<float>((idx + tile) % 4) / 4;
+      size_t box_idx = merger.AddBox(
+          kBodyIndex, static_cast<int>(tile), x1, y1, x2, y2, score);
+      auto& kps = merger.AddKps(kBodyIndex, box_idx);
+      kps.assign(kKpsNum, TileMerger::Point{x1, y1, score});
+      merger.AddBox(kHeadIndex,
+                    static_cast<int>(tile),
+                    x1,
+                    y1,
+                    x1 + (x2 - x1) / 3,
+                    y1 + (y2 - y1) / 5,
+                    score);
+    }
+  }
+}
+
+void BM_TileMerge(benchmark::State& state) {
+  int cols = static_cast<int>(state.range(0));
+  int rows = static_cast<int>(state.range(1));
+  int target_num = static_cast<int>(state.range(2));
+  std::vector<TileRect> tiles;
+  TileLayout::Compute(
+      kImgHeight, kImgWidth, 544, 960, cols, rows, 64, true, tiles);
+  std::vector<Target> targets;
+  for (int idx = 0; idx < target_num; idx++) {
+    float x = static_cast<float>(idx * 197 % (kImgWidth - 60));
+    float y = static_cast<float>(idx * 113 % (kImgHeight - 120));
+    targets.push_back(Target{x, y, x + 40 + idx % 20, y + 90 + idx % 30});
+  }
+
+  TileMerger merger({kBodyIndex, kHeadIndex});
+  size_t merged = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    FillFrame(merger, tiles, targets);
+    state.ResumeTiming();
+    merger.Merge(0.5f);
+    merged = merger.Boxes(kBodyIndex).size();
+    benchmark::DoNotOptimize(merged);
+  }
+  state.SetItemsProcessed(state.iterations() * target_num);
+  state.counters["tiles"] = static_cast<double>(tiles.size());
+  state.counters["merged_bodies"] = static_cast<double>(merged);
+}
+
+void TileMergeArgs(benchmark::internal::Benchmark* bench) {
+  const int layouts[][2] = {{2, 2}, {3, 3}, {0, 0}};
+  for (const auto& layout : layouts) {
+    for (int target_num : {10, 50, 200}) {
+      bench->Args({layout[0], layout[1], target_num});
+    }
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_TileMerge)
+    ->Apply(TileMergeArgs)
+    ->ArgNames({"cols", "rows", "targets"})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
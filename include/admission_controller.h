@@ -0,0 +1,92 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_ADMISSION_CONTROLLER_H
+#define MONO2D_DET_ADMISSION_CONTROLLER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// 推理饱和时的准入控制，位于订阅和预处理之间，被丢弃的帧不做任何预处理
+class AdmissionController {
+ public:
+  enum class Mode {
+    // 所有帧都进入流水线
+    ALL = 0,
+    // 只保留最新帧，新帧覆盖还未开始预处理的帧
+    LATEST_ONLY = 1,
+    // 根据推理耗时和输入帧率，每N帧保留一帧
+    EVERY_NTH = 2,
+  };
+
+  struct Stats {
+    uint64_t admitted = 0;
+    // LATEST_ONLY模式下被新帧覆盖的帧数
+    uint64_t dropped_latest = 0;
+    // EVERY_NTH模式下被跳过的帧数
+    uint64_t dropped_nth = 0;
+    // EVERY_NTH模式下当前的N
+    int keep_every_n = 1;
+  };
+
+  // max_busy：LATEST_ONLY模式下正在预处理和等待提交推理的最大帧数
+  AdmissionController(Mode mode, int max_busy);
+
+  Mode GetMode() const { return mode_; }
+
+  // 订阅到新图片时调用，返回false表示丢弃该帧
+  bool Admit();
+
+  // LATEST_ONLY模式下最新帧覆盖了还未处理的帧
+  void OnLatestDrop();
+
+  // 预处理线程开始处理一帧之前调用，LATEST_ONLY模式下等待正在处理的帧数小于max_busy
+  // 已停止时返回false
+  bool AcquireSlot();
+
+  // 帧已经提交推理或者处理失败时调用，与AcquireSlot成对使用
+  void ReleaseSlot();
+
+  // 推理完成时调用，infer_ms为从提交推理到输出的耗时，concurrency为分配给该输入的推理并发数
+  void UpdateInferTime(float infer_ms, float concurrency);
+
+  void Stop();
+
+  Stats GetStats();
+
+ private:
+  const Mode mode_;
+  const int max_busy_;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  int busy_ = 0;
+  bool stopped_ = false;
+
+  // 输入帧间隔和推理耗时的指数滑动平均
+  float input_interval_ms_ = 0;
+  float infer_ms_ = 0;
+  std::chrono::steady_clock::time_point last_input_;
+  bool has_last_input_ = false;
+  int keep_every_n_ = 1;
+  uint64_t frame_count_ = 0;
+
+  uint64_t admitted_ = 0;
+  uint64_t dropped_latest_ = 0;
+  uint64_t dropped_nth_ = 0;
+};
+
+#endif  // MONO2D_DET_ADMISSION_CONTROLLER_H
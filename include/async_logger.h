@@ -0,0 +1,68 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_ASYNC_LOGGER_H
+#define MONO2D_DET_ASYNC_LOGGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+// 异步日志，调用线程只把日志格式化到无锁环形缓存的固定大小槽位中，
+// 由后台线程按照写入顺序交给sink输出，调用线程不会因为输出日志阻塞
+class AsyncLogger {
+ public:
+  // 单条日志的最大长度，超出部分被截断
+  static constexpr size_t kLineSize = 512;
+
+  using Sink = std::function<void(const char* line)>;
+
+  // capacity向上取整为2的幂
+  AsyncLogger(Sink sink, size_t capacity);
+  // 输出缓存中已经写入的日志后退出
+  ~AsyncLogger();
+
+  // 缓存已满时丢弃该条日志并返回false
+  bool Log(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+  // 等待调用之前写入的日志都已经输出
+  void Flush();
+
+  // 缓存已满被丢弃的日志条数
+  uint64_t Dropped() const { return dropped_.load(); }
+
+ private:
+  struct Slot {
+    // 等于写入位置时可写，等于写入位置+1时可读
+    std::atomic<uint64_t> seq{0};
+    char line[kLineSize];
+  };
+
+  void Consume();
+
+  Sink sink_;
+  size_t capacity_ = 0;
+  size_t mask_ = 0;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  // 只由后台线程修改
+  alignas(64) std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<bool> stopped_{false};
+  std::thread consumer_;
+};
+
+#endif  // MONO2D_DET_ASYNC_LOGGER_H
@@ -0,0 +1,33 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_DET_RESULT_PACKER_H
+#define MONO2D_DET_DET_RESULT_PACKER_H
+
+#include <cstdint>
+
+#include "ai_msgs/msg/perception_targets.hpp"
+#include "mono2d_body_detection/msg/body_detection_result.hpp"
+
+// 将发布的PerceptionTargets转换为定长的BodyDetectionResult，每个roi一个检测框
+// 只写入前box_num个元素，其余元素不清空，loaned message中保持上一次使用时的内容
+// 超过MAX_BOX_NUM的检测框被丢弃，个数记录在dropped_box_num中
+void PackDetectionResult(
+    const ai_msgs::msg::PerceptionTargets& msg,
+    uint32_t img_width,
+    uint32_t img_height,
+    bool is_predicted,
+    mono2d_body_detection::msg::BodyDetectionResult& result);
+
+#endif  // MONO2D_DET_DET_RESULT_PACKER_H
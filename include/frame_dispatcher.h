@@ -0,0 +1,104 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_FRAME_DISPATCHER_H
+#define MONO2D_DET_FRAME_DISPATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "include/admission_controller.h"
+#include "include/latency_histogram.h"
+#include "include/motion_gate.h"
+#include "include/output_reorder_buffer.h"
+
+// 一路输入收到的帧的分发：每N帧推理一次时中间的帧跳过推理，画面没有运动时跳过推理，
+// 其余的帧经过准入后推理。需要发布的帧在输出排序缓存中按照收到的顺序注册序号，
+// 跳过推理的帧不经过准入
+// Dispatch只能在一个线程中调用（该路输入的订阅回调或者回放线程），
+// SetDetectInterval和GetStats可以在任意线程中调用
+class FrameDispatcher {
+ public:
+  enum class Action {
+    // 跳过推理，发布跟踪预测的目标
+    PREDICT = 0,
+    // 画面没有运动，重复发布上一次推理的目标
+    REPUBLISH = 1,
+    // 不发布：画面没有运动并且不重复发布，或者没有被准入
+    DROP = 2,
+    // 送入推理
+    INFER = 3,
+  };
+
+  // 判断运动使用的亮度平面，参数含义与MotionGate::Check一致
+  // data为空表示不能直接读取亮度（如jpeg），总是认为有运动
+  struct LumaPlane {
+    const uint8_t* data = nullptr;
+    int pixel_stride = 0;
+    int step = 0;
+    int height = 0;
+    int width = 0;
+  };
+
+  struct Stats {
+    // 跳过推理、发布跟踪预测结果的帧数
+    uint64_t predicted = 0;
+  };
+
+  // predict：是否每N帧推理一次，间隔由SetDetectInterval更新
+  // motion_gate：为空时不判断运动；republish：画面没有运动时是否重复发布
+  // stage_latency：不为空时记录判断运动的耗时
+  FrameDispatcher(std::shared_ptr<OutputReorderBuffer> output_reorder_buffer,
+                  std::shared_ptr<AdmissionController> admission_controller,
+                  bool predict,
+                  std::shared_ptr<MotionGate> motion_gate,
+                  bool republish,
+                  std::shared_ptr<StageLatency> stage_latency);
+
+  // 返回该帧的处理方式，PREDICT、REPUBLISH和INFER时frame_seq为注册的序号
+  Action Dispatch(const LumaPlane& luma, uint64_t& frame_seq);
+
+  // 下一次推理的间隔，由输出排序回调根据跟踪结果更新，1表示每帧都推理
+  void SetDetectInterval(int detect_interval);
+
+  Stats GetStats() const;
+
+  // 等待dispatchers注册的帧全部发布或者被丢弃，超时或者stopped为true时返回false
+  static bool WaitDrained(
+      const std::vector<std::shared_ptr<FrameDispatcher>>& dispatchers,
+      std::chrono::milliseconds timeout,
+      const std::atomic<bool>& stopped);
+
+ private:
+  // 推理帧没有被准入时计数不清零，下一帧继续尝试推理
+  bool ShouldPredict();
+  bool CheckMotion(const LumaPlane& luma);
+
+  std::shared_ptr<OutputReorderBuffer> output_reorder_buffer_;
+  std::shared_ptr<AdmissionController> admission_controller_;
+  const bool predict_;
+  std::shared_ptr<MotionGate> motion_gate_;
+  const bool republish_;
+  std::shared_ptr<StageLatency> stage_latency_;
+
+  std::atomic<int> detect_interval_{1};
+  // 上一次推理以来收到的帧数
+  int frames_since_detect_ = 0;
+  std::atomic<uint64_t> predicted_{0};
+};
+
+#endif  // MONO2D_DET_FRAME_DISPATCHER_H
@@ -0,0 +1,153 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_FRAME_REPLAY_H
+#define MONO2D_DET_FRAME_REPLAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 录制和回放原始图片帧的文件格式，所有字段为小端
+// 文件头（64字节）：magic "M2DRPLY1"、width、height、step（uint32）、
+// encoding（16字节，以0结尾）、帧数（uint64，录制结束时写入）
+// 每帧：时间戳（uint64，纳秒）、数据长度（uint32）、保留（uint32）、数据，
+// 数据按照8字节对齐补0
+namespace frame_replay {
+
+struct FileHeader {
+  char magic[8];
+  uint32_t width;
+  uint32_t height;
+  uint32_t step;
+  char encoding[16];
+  uint32_t reserved;
+  uint64_t frame_count;
+  uint8_t padding[16];
+};
+static_assert(sizeof(FileHeader) == 64, "replay file header must be 64 bytes");
+
+struct FrameHeader {
+  uint64_t timestamp_ns;
+  uint32_t data_size;
+  uint32_t reserved;
+};
+
+// 使用mmap读取录制文件，帧数据直接指向映射的内存，不做拷贝
+class ReplayFile {
+ public:
+  struct Frame {
+    uint64_t timestamp_ns = 0;
+    const uint8_t* data = nullptr;
+    uint32_t data_size = 0;
+  };
+
+  ReplayFile() = default;
+  ~ReplayFile();
+  ReplayFile(const ReplayFile&) = delete;
+  ReplayFile& operator=(const ReplayFile&) = delete;
+
+  // 成功返回0，失败返回-1
+  // 录制未正常结束（帧数为0）时按照文件内容扫描出完整的帧
+  int Open(const std::string& file_name);
+
+  const std::string& Encoding() const { return encoding_; }
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+  int Step() const { return step_; }
+  const std::vector<Frame>& Frames() const { return frames_; }
+
+ private:
+  void* addr_ = nullptr;
+  size_t size_ = 0;
+  std::string encoding_;
+  int width_ = 0;
+  int height_ = 0;
+  int step_ = 0;
+  std::vector<Frame> frames_;
+};
+
+// 将订阅到的图片追加写入录制文件，可以在多个线程中调用
+// Push只把帧放入队列，由后台线程写文件，订阅回调不会因为写文件阻塞
+class RecordFile {
+ public:
+  // 等待写入的帧，holder持有data所在的消息，写入完成之前data有效
+  struct PendingFrame {
+    std::shared_ptr<const void> holder = nullptr;
+    uint64_t timestamp_ns = 0;
+    std::string encoding;
+    int width = 0;
+    int height = 0;
+    int step = 0;
+    const uint8_t* data = nullptr;
+    uint32_t data_size = 0;
+  };
+
+  RecordFile() = default;
+  ~RecordFile();
+  RecordFile(const RecordFile&) = delete;
+  RecordFile& operator=(const RecordFile&) = delete;
+
+  // 成功返回0，失败返回-1
+  // queue_size为等待写入的最大帧数，大于0时启动后台写入线程
+  int Open(const std::string& file_name, size_t queue_size = 0);
+
+  // 第一帧确定文件的encoding、宽高和step，之后不一致的帧不写入，返回-1
+  int Write(uint64_t timestamp_ns,
+            const std::string& encoding,
+            int width,
+            int height,
+            int step,
+            const uint8_t* data,
+            uint32_t data_size);
+
+  // 放入写入队列，队列已满或者没有启动后台写入线程时丢弃该帧并返回false
+  bool Push(PendingFrame frame);
+
+  // 写完队列中的帧，写入帧数并关闭文件
+  void Close();
+
+  // 队列已满被丢弃的帧数
+  uint64_t Dropped() const { return dropped_.load(); }
+  // 后台线程写入失败（格式不一致或者写文件失败）的帧数
+  uint64_t Failed() const { return failed_.load(); }
+
+ private:
+  void Consume();
+
+  std::mutex mtx_;
+  FILE* file_ = nullptr;
+  FileHeader header_;
+  bool header_written_ = false;
+
+  std::mutex queue_mtx_;
+  std::condition_variable queue_cv_;
+  std::deque<PendingFrame> queue_;
+  size_t queue_size_ = 0;
+  bool stopped_ = false;
+  std::thread writer_;
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> failed_{0};
+};
+
+}  // namespace frame_replay
+
+#endif  // MONO2D_DET_FRAME_REPLAY_H
@@ -0,0 +1,161 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_IMAGE_CONVERT_H
+#define MONO2D_DET_IMAGE_CONVERT_H
+
+#include <cstdint>
+
+// 图像缩放和格式转换kernel，输出直接写入带stride的nv12内存（如pyramid）
+// aarch64平台使用NEON，x86平台使用SSE2加速，其他平台使用标量实现
+// 颜色转换使用BT.601 limited range定点系数，与opencv COLOR_BGR2YUV_I420一致
+class ImageConvert {
+ public:
+  enum class ResizeMode {
+    // 双线性插值
+    BILINEAR = 0,
+    // 区域均值，适合缩小，放大时退化为双线性插值
+    AREA = 1,
+  };
+
+  // 双线性缩放rgb8/bgr8图片并转换为nv12，单次遍历输入数据
+  // src_step为输入图片每行的字节数，dst_h和dst_w必须是偶数
+  // 成功返回0，失败返回-1
+  static int32_t RGBToNv12Resize(const uint8_t *src,
+                                 int src_h,
+                                 int src_w,
+                                 int src_step,
+                                 bool is_bgr,
+                                 uint8_t *dst_y,
+                                 int dst_y_stride,
+                                 uint8_t *dst_uv,
+                                 int dst_uv_stride,
+                                 int dst_h,
+                                 int dst_w);
+
+  // RGBToNv12Resize的标量参考实现，计算结果与加速版本逐像素一致
+  static int32_t RGBToNv12ResizeRef(const uint8_t *src,
+                                    int src_h,
+                                    int src_w,
+                                    int src_step,
+                                    bool is_bgr,
+                                    uint8_t *dst_y,
+                                    int dst_y_stride,
+                                    uint8_t *dst_uv,
+                                    int dst_uv_stride,
+                                    int dst_h,
+                                    int dst_w);
+
+  // 双线性缩放packed yuv422图片（yuyv或uyvy）为nv12，单次遍历输入数据
+  // y和uv分别按照各自的分辨率插值，src_w、dst_h和dst_w必须是偶数
+  // 成功返回0，失败返回-1
+  static int32_t Yuv422ToNv12Resize(const uint8_t *src,
+                                    int src_h,
+                                    int src_w,
+                                    int src_step,
+                                    bool is_uyvy,
+                                    uint8_t *dst_y,
+                                    int dst_y_stride,
+                                    uint8_t *dst_uv,
+                                    int dst_uv_stride,
+                                    int dst_h,
+                                    int dst_w);
+
+  // Yuv422ToNv12Resize的标量参考实现，计算结果与加速版本逐像素一致
+  static int32_t Yuv422ToNv12ResizeRef(const uint8_t *src,
+                                       int src_h,
+                                       int src_w,
+                                       int src_step,
+                                       bool is_uyvy,
+                                       uint8_t *dst_y,
+                                       int dst_y_stride,
+                                       uint8_t *dst_uv,
+                                       int dst_uv_stride,
+                                       int dst_h,
+                                       int dst_w);
+
+  // 双线性缩放mono8灰度图为nv12，y按照r=g=b转换，uv填充128
+  // dst_h和dst_w必须是偶数，成功返回0，失败返回-1
+  static int32_t GrayToNv12Resize(const uint8_t *src,
+                                  int src_h,
+                                  int src_w,
+                                  int src_step,
+                                  uint8_t *dst_y,
+                                  int dst_y_stride,
+                                  uint8_t *dst_uv,
+                                  int dst_uv_stride,
+                                  int dst_h,
+                                  int dst_w);
+
+  // GrayToNv12Resize的标量参考实现，计算结果与加速版本逐像素一致
+  static int32_t GrayToNv12ResizeRef(const uint8_t *src,
+                                     int src_h,
+                                     int src_w,
+                                     int src_step,
+                                     uint8_t *dst_y,
+                                     int dst_y_stride,
+                                     uint8_t *dst_uv,
+                                     int dst_uv_stride,
+                                     int dst_h,
+                                     int dst_w);
+
+  // nv12图片缩放，y和uv平面分别缩放，输入输出都支持stride
+  // src和dst的宽高必须是偶数，成功返回0，失败返回-1
+  static int32_t Nv12Resize(const uint8_t *src_y,
+                            int src_y_stride,
+                            const uint8_t *src_uv,
+                            int src_uv_stride,
+                            int src_h,
+                            int src_w,
+                            uint8_t *dst_y,
+                            int dst_y_stride,
+                            uint8_t *dst_uv,
+                            int dst_uv_stride,
+                            int dst_h,
+                            int dst_w,
+                            ResizeMode mode);
+
+  // jpeg解码得到的full range（JFIF）planar yuv转换为limited range的nv12
+  // uv_shift_x/uv_shift_y为色度平面相对亮度平面在水平/垂直方向的下采样位数（0或1）
+  // src_u和src_v为nullptr时按照灰度图处理，dst_h和dst_w必须是偶数
+  // 成功返回0，失败返回-1
+  static int32_t JpegYuvToNv12(const uint8_t *src_y,
+                               int src_y_stride,
+                               const uint8_t *src_u,
+                               const uint8_t *src_v,
+                               int src_uv_stride,
+                               int uv_shift_x,
+                               int uv_shift_y,
+                               uint8_t *dst_y,
+                               int dst_y_stride,
+                               uint8_t *dst_uv,
+                               int dst_uv_stride,
+                               int dst_h,
+                               int dst_w);
+
+  // 使用固定的y和uv值填充nv12图片中的矩形区域，x/y/h/w必须是偶数
+  static void FillNv12Rect(uint8_t *dst_y,
+                           int dst_y_stride,
+                           uint8_t *dst_uv,
+                           int dst_uv_stride,
+                           int x,
+                           int y,
+                           int h,
+                           int w,
+                           uint8_t y_val,
+                           uint8_t u_val,
+                           uint8_t v_val);
+};
+
+#endif  // MONO2D_DET_IMAGE_CONVERT_H
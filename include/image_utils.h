@@ -33,21 +33,152 @@ using hobot::dnn_node::NV12PyramidInput;
 #define ALIGN_16(w) ALIGNED_2E(w, 16U)
 #define ALIGN_64(w) ALIGNED_2E(w, 64U)
 
+// 输入图片缩放到模型输入size（scale size）的方式
+enum class ImageResizeType {
+  // 输入图片size小于scale size：将输入图片padding到左上区域
+  // 输入图片size大于scale size：crop输入图片左上区域
+  CROP = 0,
+  // 双线性插值缩放
+  BILINEAR = 1,
+  // 区域均值缩放
+  AREA = 2,
+};
+
+// 模型输入图片和原图之间的坐标映射关系
+// 原图坐标 = (模型输入坐标 - offset) / scale + crop
+struct ImageTransform {
+  float scale_x = 1.0f;
+  float scale_y = 1.0f;
+  int offset_x = 0;
+  int offset_y = 0;
+  // 原图在模型输入图片中占据的区域大小
+  int content_width = 0;
+  int content_height = 0;
+  int src_width = 0;
+  int src_height = 0;
+  // 只缩放原图中的一个区域（如tile）时，该区域在原图中的左上角
+  int crop_x = 0;
+  int crop_y = 0;
+
+  float ToSrcX(float x) const { return (x - offset_x) / scale_x + crop_x; }
+  float ToSrcY(float y) const { return (y - offset_y) / scale_y + crop_y; }
+};
+
 class ImageUtils {
  public:
+  // is_letterbox为true时保持宽高比缩放，原图居中放置，其余区域填充黑色
+  static ImageTransform GetImageTransform(int in_img_height,
+                                          int in_img_width,
+                                          int scaled_img_height,
+                                          int scaled_img_width,
+                                          ImageResizeType resize_type,
+                                          bool is_letterbox);
+
   static std::shared_ptr<NV12PyramidInput> GetNV12Pyramid(
       const cv::Mat &image,
       int scaled_img_height,
       int scaled_img_width);
 
-  // 输入图片size小于scale size（模型输入size）：将输入图片padding到左上区域
-  // 输入图片size大于scale size（模型输入size）：crop输入图片左上区域
+  // rgb8/bgr8图片按照resize_type缩放到scale size并转换为nv12，结果直接写入pyramid内存
+  // in_img_step为输入图片每行的字节数
+  // resize_type为AREA并且缩小时先转换为原尺寸的nv12再缩放，其他情况不生成中间图
+  static std::shared_ptr<NV12PyramidInput> GetNV12PyramidFromRGBImg(
+      const uint8_t* in_img_data,
+      int in_img_height,
+      int in_img_width,
+      int in_img_step,
+      bool is_bgr,
+      int scaled_img_height,
+      int scaled_img_width,
+      ImageResizeType resize_type = ImageResizeType::BILINEAR,
+      bool is_letterbox = false,
+      ImageTransform* transform = nullptr);
+
+  // yuyv/uyvy（packed yuv422）图片按照resize_type缩放到scale size并转换为nv12，
+  // 结果直接写入pyramid，in_img_step为输入图片每行的字节数
+  static std::shared_ptr<NV12PyramidInput> GetNV12PyramidFromYUV422Img(
+      const uint8_t* in_img_data,
+      int in_img_height,
+      int in_img_width,
+      int in_img_step,
+      bool is_uyvy,
+      int scaled_img_height,
+      int scaled_img_width,
+      ImageResizeType resize_type = ImageResizeType::BILINEAR,
+      bool is_letterbox = false,
+      ImageTransform* transform = nullptr);
+
+  // mono8灰度图按照resize_type缩放到scale size并转换为nv12，结果直接写入pyramid
+  static std::shared_ptr<NV12PyramidInput> GetNV12PyramidFromGrayImg(
+      const uint8_t* in_img_data,
+      int in_img_height,
+      int in_img_width,
+      int in_img_step,
+      int scaled_img_height,
+      int scaled_img_width,
+      ImageResizeType resize_type = ImageResizeType::BILINEAR,
+      bool is_letterbox = false,
+      ImageTransform* transform = nullptr);
+
+  // 按照resize_type将nv12图片缩放到scale size（模型输入size）
+  // in_img_step为输入图片y和uv平面每行的字节数，小于等于0时等于in_img_width
+  // 输入和scale size一致时不做缩放，直接导入到pyramid
+  // transform不为空时输出模型输入和原图之间的坐标映射关系
   static std::shared_ptr<NV12PyramidInput> GetNV12PyramidFromNV12Img(
       const char* in_img_data,
       int in_img_height,
       int in_img_width,
+      int in_img_step,
       int scaled_img_height,
-      int scaled_img_width);
+      int scaled_img_width,
+      ImageResizeType resize_type = ImageResizeType::CROP,
+      bool is_letterbox = false,
+      ImageTransform* transform = nullptr);
+
+  // 将nv12图片中的一个区域缩放到scale size，y和uv平面可以不连续
+  // 区域的起始坐标和宽高必须是偶数，resize_type为CROP时按照双线性插值缩放
+  // transform为模型输入和整个原图之间的坐标映射关系
+  static std::shared_ptr<NV12PyramidInput> GetNV12PyramidFromNV12Region(
+      const uint8_t* in_img_y,
+      int in_img_y_step,
+      const uint8_t* in_img_uv,
+      int in_img_uv_step,
+      int in_img_height,
+      int in_img_width,
+      int region_x,
+      int region_y,
+      int region_height,
+      int region_width,
+      int scaled_img_height,
+      int scaled_img_width,
+      ImageResizeType resize_type = ImageResizeType::BILINEAR,
+      bool is_letterbox = false,
+      ImageTransform* transform = nullptr);
+
+  // 将rgb8/bgr8/yuyv/uyvy/mono8/jpeg格式的图片转换为原尺寸的nv12（宽高向下取偶数）
+  // 结果写入nv12_buf，y和uv平面的stride等于输出宽度，in_img_step为packed格式每行的字节数
+  // 成功返回0，不支持的格式或者转换失败返回-1
+  static int32_t ConvertToNV12(const std::string& encoding,
+                               const uint8_t* in_img_data,
+                               size_t in_img_size,
+                               int in_img_height,
+                               int in_img_width,
+                               int in_img_step,
+                               std::vector<uint8_t>& nv12_buf,
+                               int& nv12_height,
+                               int& nv12_width);
+
+  // jpeg解码为yuv后直接转换为nv12写入pyramid，不生成bgr中间图
+  // 模型输入小于原图时使用DCT缩放解码，解码尺寸与模型输入区域一致时不再缩放
+  // transform为模型输入和原图（解码前）之间的坐标映射关系
+  static std::shared_ptr<NV12PyramidInput> GetNV12PyramidFromJpeg(
+      const uint8_t* in_img_data,
+      size_t in_img_size,
+      int scaled_img_height,
+      int scaled_img_width,
+      ImageResizeType resize_type = ImageResizeType::BILINEAR,
+      bool is_letterbox = false,
+      ImageTransform* transform = nullptr);
 
   static int32_t BGRToNv12(cv::Mat &bgr_mat, cv::Mat &img_nv12);
 };
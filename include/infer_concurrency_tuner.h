@@ -0,0 +1,68 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_INFER_CONCURRENCY_TUNER_H
+#define MONO2D_DET_INFER_CONCURRENCY_TUNER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 推理并发数自动调优，统计每个并发数下的吞吐和延迟，
+// 选择满足延迟预算的最大吞吐对应的并发数
+class InferConcurrencyTuner {
+ public:
+  struct LevelResult {
+    int concurrency = 0;
+    // 完成推理的帧数
+    int frames = 0;
+    float fps = 0;
+    float mean_ms = 0;
+    float p99_ms = 0;
+  };
+
+  // 开始统计并发数为concurrency的结果，共frames帧
+  void BeginLevel(int concurrency, int frames);
+
+  // 记录一帧从提交推理到输出的延迟
+  void AddSample(float latency_ms);
+
+  // 等待当前并发数的帧全部完成，超时返回false
+  bool WaitLevel(int timeout_ms);
+
+  LevelResult EndLevel();
+
+  // 返回满足p99延迟预算的最大吞吐对应的并发数，都不满足时返回p99延迟最小的并发数
+  // curve为空时返回-1
+  static int Select(const std::vector<LevelResult> &curve,
+                    float latency_budget_ms);
+
+  // 以json格式输出调优结果
+  static std::string ToJson(const std::vector<LevelResult> &curve,
+                            int selected,
+                            float latency_budget_ms);
+
+ private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  int concurrency_ = 0;
+  int expected_frames_ = 0;
+  std::vector<float> latencies_ms_;
+  std::chrono::steady_clock::time_point level_start_;
+  std::chrono::steady_clock::time_point last_sample_;
+};
+
+#endif  // MONO2D_DET_INFER_CONCURRENCY_TUNER_H
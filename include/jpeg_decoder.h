@@ -0,0 +1,76 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_JPEG_DECODER_H
+#define MONO2D_DET_JPEG_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct jpeg_decompress_struct;
+
+// 使用libjpeg将jpeg解码为planar yuv，不做色彩空间转换和色度上采样
+// 目标尺寸小于原图时利用DCT缩放（1/2、1/4、1/8）在解码阶段直接缩小
+// 内部缓存在多次解码之间复用，一个实例只能在一个线程中使用
+class JpegDecoder {
+ public:
+  // 解码结果，数据指向解码器内部缓存，下一次Decode之前有效
+  // y/u/v为full range（JFIF），灰度图的u和v为nullptr
+  struct YuvPlanes {
+    const uint8_t* y = nullptr;
+    int y_stride = 0;
+    const uint8_t* u = nullptr;
+    const uint8_t* v = nullptr;
+    int uv_stride = 0;
+    // 色度平面相对亮度平面在水平/垂直方向的下采样位数（0或1）
+    int uv_shift_x = 0;
+    int uv_shift_y = 0;
+    // 解码后的宽高，向下取偶数
+    int width = 0;
+    int height = 0;
+    // 原图宽高
+    int src_width = 0;
+    int src_height = 0;
+    // 解码使用的缩放分母
+    int scale_denom = 1;
+  };
+
+  // 只解析jpeg头，得到原图宽高，成功返回0，失败返回-1
+  static int ReadHeader(const uint8_t* data,
+                        size_t size,
+                        int& height,
+                        int& width);
+
+  // 选择解码尺寸不小于min_height x min_width（允许小1/16以内，
+  // 之后的缩放略微放大）的最大DCT缩放比例解码
+  // 成功返回0，失败返回-1
+  int Decode(const uint8_t* data,
+             size_t size,
+             int min_height,
+             int min_width,
+             YuvPlanes& planes);
+
+ private:
+  // 按照jpeg的采样格式直接输出yuv平面，支持灰度图和y的采样因子不超过2的yuv图
+  int ReadRawPlanes(jpeg_decompress_struct* cinfo, YuvPlanes& planes);
+  // 其他采样格式按行输出交织的yuv，再拆分为不下采样的平面
+  int ReadScanlines(jpeg_decompress_struct* cinfo, YuvPlanes& planes);
+
+  std::vector<uint8_t> plane_bufs_[3];
+  std::vector<uint8_t> row_buf_;
+  std::vector<uint8_t*> row_ptrs_[3];
+};
+
+#endif  // MONO2D_DET_JPEG_DECODER_H
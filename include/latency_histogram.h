@@ -0,0 +1,121 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_LATENCY_HISTOGRAM_H
+#define MONO2D_DET_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// 无锁的对数线性直方图，单位纳秒
+// 每个2的幂区间再均分为16个桶，分位数的相对误差不超过1/16
+class LatencyHistogram {
+ public:
+  struct Summary {
+    uint64_t count = 0;
+    double mean_ns = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p90_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+  };
+
+  LatencyHistogram();
+
+  // 单调时钟的当前时间，单位纳秒
+  static uint64_t NowNs();
+
+  // 可以在任意线程中并发调用
+  void Record(uint64_t value_ns);
+
+  // 启动以来的统计
+  Summary Total() const;
+  // 上一次调用Interval以来的统计，只能在一个线程中调用
+  Summary Interval();
+
+ private:
+  static constexpr int kSubBits = 4;
+  static constexpr int kSubCount = 1 << kSubBits;
+  static constexpr size_t kBucketNum = (64 - kSubBits + 1) * kSubCount;
+
+  static size_t BucketIndex(uint64_t value);
+  // 桶内的最大值
+  static uint64_t BucketUpper(size_t index);
+
+  template <typename Counts>
+  static Summary Summarize(const Counts& counts,
+                           uint64_t count,
+                           uint64_t sum_ns,
+                           uint64_t max_ns);
+
+  std::array<std::atomic<uint64_t>, kBucketNum> counts_;
+  std::atomic<uint64_t> sum_ns_{0};
+  std::atomic<uint64_t> max_ns_{0};
+  std::atomic<uint64_t> interval_max_ns_{0};
+
+  // Interval使用的上一次统计时的累计值
+  std::array<uint64_t, kBucketNum> last_counts_;
+  std::array<uint64_t, kBucketNum> interval_counts_;
+  uint64_t last_sum_ns_ = 0;
+};
+
+// 单帧处理流程中各个阶段的延迟
+class StageLatency {
+ public:
+  enum class Stage {
+    // 订阅回调中判断画面是否有运动
+    MOTION_GATE = 0,
+    // 订阅回调收到图片到开始预处理
+    RECV_TO_PREPROCESS,
+    PREPROCESS,
+    // 预处理完成到提交推理，包括等待推理并发资源
+    QUEUE_WAIT,
+    INFER,
+    // 切分tile推理时每个tile的推理耗时，每帧记录tile个数次
+    TILE_INFER,
+    // 推理完成到按照输入顺序开始发布
+    REORDER_WAIT,
+    PARSE,
+    // 切分tile推理时合并各个tile的检测结果
+    TILE_MERGE,
+    TRACKING,
+    PUBLISH,
+    // 订阅回调收到图片到发布完成
+    TOTAL,
+    STAGE_NUM,
+  };
+
+  static const char* StageName(Stage stage);
+
+  void Record(Stage stage, uint64_t value_ns) {
+    histograms_[static_cast<size_t>(stage)].Record(value_ns);
+  }
+
+  // 启动以来stage阶段的统计
+  LatencyHistogram::Summary Total(Stage stage) const {
+    return histograms_[static_cast<size_t>(stage)].Total();
+  }
+
+  // 以json格式输出各个阶段的count/mean/p50/p90/p99/max，单位毫秒
+  // interval为true时输出上一次输出以来的统计，否则输出启动以来的统计
+  std::string ToJson(bool interval);
+
+ private:
+  std::array<LatencyHistogram, static_cast<size_t>(Stage::STAGE_NUM)>
+      histograms_;
+};
+
+#endif  // MONO2D_DET_LATENCY_HISTOGRAM_H
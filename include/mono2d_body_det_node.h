@@ -12,30 +12,48 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <map>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
 #include <memory>
-#include <set>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "rclcpp/rclcpp.hpp"
 #include "cv_bridge/cv_bridge.h"
 
+#include "sensor_msgs/msg/compressed_image.hpp"
 #include "sensor_msgs/msg/image.hpp"
+#include "std_msgs/msg/string.hpp"
 
 #ifdef SHARED_MEM_ENABLED
 #include "hbm_img_msgs/msg/hbm_msg1080_p.hpp"
 #endif
 
-#ifndef PLATFORM_X86
-#include "hobot_mot/hobot_mot.h"
-#endif
-
 #include "ai_msgs/msg/capture_targets.hpp"
 #include "ai_msgs/msg/perception_targets.hpp"
 #include "dnn_node/dnn_node.h"
+#include "include/admission_controller.h"
+#include "include/async_logger.h"
+#include "include/det_result_packer.h"
+#include "include/frame_dispatcher.h"
+#include "include/frame_replay.h"
 #include "include/image_utils.h"
+#include "include/infer_concurrency_tuner.h"
+#include "include/latency_histogram.h"
+#include "include/motion_gate.h"
+#include "include/output_reorder_buffer.h"
+#include "include/parallel_runner.h"
+#include "include/pipeline_queue.h"
+#include "include/recycle_pool.h"
+#include "include/target_builder.h"
+#include "include/tile_merger.h"
+#include "include/track_predictor.h"
+#include "include/weighted_stream_queue.h"
 #include "dnn_node/util/output_parser/detection/fasterrcnn_output_parser.h"
 
 #ifndef MONO2D_BODY_DET_NODE_H_
@@ -62,36 +80,174 @@ using hobot::dnn_node::parser_fasterrcnn::FasterRcnnKpsParserPara;
 using hobot::dnn_node::parser_fasterrcnn::LandmarksResult;
 using ai_msgs::msg::PerceptionTargets;
 
-// 使用output manage解决异步多线程情况下模型输出乱序的问题
-class NodeOutputManage {
- public:
-  void Feed(uint64_t ts_ms);
-  std::vector<std::shared_ptr<DnnNodeOutput>> Feed(
-      const std::shared_ptr<DnnNodeOutput>& node_output);
-  void Erase(uint64_t ts_ms);
+// 一帧切分出的所有tile共用，对象由tile_group_pool_循环使用
+// 每个tile推理完成后将推理输出转存到对应位置，最后完成的tile的输出代表整帧发布
+struct TileGroup {
+  struct Tile {
+    // 只转存推理输出的tensor和耗时统计，不引用FasterRcnnOutput，避免循环引用
+    std::shared_ptr<DnnNodeOutput> output = nullptr;
+    ImageTransform image_transform;
+    bool valid = false;
+    uint64_t submit_ns = 0;
+    uint64_t infer_end_ns = 0;
+  };
+  std::vector<TileRect> rects;
+  std::vector<Tile> tiles;
+  // 还没有推理完成或者提交失败的tile数
+  std::atomic<int> pending{0};
 
- private:
-  std::set<uint64_t> cache_frame_;
-  std::map<uint64_t, std::shared_ptr<DnnNodeOutput>> cache_node_output_;
-  // 如果图像采集频率是30fps，能够缓存10帧，对应要求端到端的推理耗时最长不能超过1000/30*10=750ms
-  const uint8_t cache_size_limit_ = 10;
-  std::mutex mtx_;
-  std::condition_variable cv_;
-  const uint64_t smart_output_timeout_ms_ = 1000;
+  bool HasValidTile() const {
+    for (const auto& tile : tiles) {
+      if (tile.valid) {
+        return true;
+      }
+    }
+    return false;
+  }
 };
 
+// 对象由output_pool_循环使用，image_msg_header随对象一起复用
 struct FasterRcnnOutput : public DnnNodeOutput {
   std::shared_ptr<std_msgs::msg::Header> image_msg_header = nullptr;
   struct timespec preprocess_timespec_start;
   struct timespec preprocess_timespec_end;
+  // 模型输入和原图之间的坐标映射，用于将检测结果映射回原图
+  ImageTransform image_transform;
+  // 输入帧的序号，用于按照输入顺序发布推理结果
+  uint64_t frame_seq = 0;
+  // 并发数调优使用的合成帧，推理结果不发布
+  bool is_tune_frame = false;
+  // 输入图片所属的输入路
+  int stream_id = 0;
+  // 各个阶段的单调时钟时间戳，单位纳秒，用于统计各阶段延迟
+  uint64_t recv_ns = 0;
+  uint64_t preprocess_start_ns = 0;
+  uint64_t preprocess_end_ns = 0;
+  uint64_t submit_ns = 0;
+  uint64_t infer_end_ns = 0;
+  // 切分tile推理时该帧所有tile共用的tile_group，以及本输出对应的tile
+  std::shared_ptr<TileGroup> tile_group = nullptr;
+  int tile_index = 0;
+  // 跳过推理的帧，没有模型输出，发布跟踪预测的目标
+  bool is_predicted = false;
+  // 画面没有运动而跳过推理的帧，重复发布上一次推理的目标
+  bool is_motion_skipped = false;
+
+  // 从output_pool_取出后重置上一帧的内容，image_msg_header保留已经申请的对象
+  void Reset() {
+    outputs.clear();
+    rt_stat = nullptr;
+    is_tune_frame = false;
+    tile_group = nullptr;
+    tile_index = 0;
+    is_predicted = false;
+    is_motion_skipped = false;
+    if (!image_msg_header) {
+      image_msg_header = std::make_shared<std_msgs::msg::Header>();
+    }
+  }
+};
+
+// 订阅回调中构造的轻量帧句柄，图片转换在预处理线程中完成
+struct ImageFrame {
+  // 持有订阅到的消息，保证data在预处理完成之前有效
+  std::shared_ptr<const void> msg_holder = nullptr;
+  std::string encoding;
+  const uint8_t* data = nullptr;
+  size_t data_size = 0;
+  int height = 0;
+  int width = 0;
+  int step = 0;
+  std_msgs::msg::Header image_msg_header;
+  uint64_t frame_seq = 0;
+  int stream_id = 0;
+  // 订阅回调收到图片的单调时钟时间，单位纳秒
+  uint64_t recv_ns = 0;
+};
+
+// 预处理完成，等待提交推理的任务
+struct InferTask {
+  std::vector<std::shared_ptr<DNNInput>> inputs;
+  std::shared_ptr<FasterRcnnOutput> dnn_output = nullptr;
+};
+
+// 每路输入独立的订阅、发布、输出排序、准入控制和跟踪，所有输入共用加载的模型
+struct StreamContext {
+  int stream_id = 0;
+  std::string img_topic_name;
+  std::string ai_msg_pub_topic_name;
+  // 推理调度的权重
+  int weight = 1;
+
+#ifdef SHARED_MEM_ENABLED
+  rclcpp::SubscriptionHbmem<hbm_img_msgs::msg::HbmMsg1080P>::ConstSharedPtr
+      sharedmem_img_subscription = nullptr;
+#endif
+  // 该路输入订阅回调的callback group
+  rclcpp::CallbackGroup::SharedPtr sub_callback_group = nullptr;
+  rclcpp::Subscription<sensor_msgs::msg::Image>::ConstSharedPtr
+      ros_img_subscription = nullptr;
+  rclcpp::Subscription<sensor_msgs::msg::CompressedImage>::ConstSharedPtr
+      compressed_img_subscription = nullptr;
+  rclcpp::Publisher<ai_msgs::msg::PerceptionTargets>::SharedPtr msg_publisher =
+      nullptr;
+  // 定长检测结果的发布，只在设置了pod_msg_pub_topic_name时创建
+  std::string pod_msg_pub_topic_name;
+#ifdef SHARED_MEM_ENABLED
+  rclcpp::PublisherHbmem<mono2d_body_detection::msg::BodyDetectionResult>::
+      SharedPtr pod_msg_publisher = nullptr;
+#else
+  rclcpp::Publisher<mono2d_body_detection::msg::BodyDetectionResult>::SharedPtr
+      pod_msg_publisher = nullptr;
+#endif
+
+  std::shared_ptr<OutputReorderBuffer> output_reorder_buffer = nullptr;
+  std::shared_ptr<AdmissionController> admission_controller = nullptr;
+  // 组装发布的目标，只在该路输入的输出排序回调中使用
+  std::shared_ptr<TargetBuilder> target_builder = nullptr;
+  // 各个阶段的延迟直方图
+  std::shared_ptr<StageLatency> stage_latency = nullptr;
+  // 模型输出解析结果，只在该路输入的输出排序回调中使用
+  std::vector<std::shared_ptr<hobot::dnn_node::parser_fasterrcnn::Filter2DResult>>
+      parse_results;
+  // 合并各个tile的检测结果，只在切分tile推理时创建
+  std::shared_ptr<TileMerger> tile_merger = nullptr;
+  // 预测跳过推理的帧的目标位置，只在每N帧推理一次时创建
+  std::shared_ptr<TrackPredictor> track_predictor = nullptr;
+  // 判断画面是否有运动，只在打开运动检测时创建，只在frame_dispatcher中使用
+  std::shared_ptr<MotionGate> motion_gate = nullptr;
+  // 判断收到的帧跳过推理、重复发布、丢弃还是推理，并在输出排序缓存中注册
+  std::shared_ptr<FrameDispatcher> frame_dispatcher = nullptr;
+  // 上一次推理发布的目标，画面没有运动时重复发布，只在该路输入的输出排序回调中使用
+  std::vector<ai_msgs::msg::Target> last_targets;
+
+  // key is mot processing type, body/face/head/hand
+  // val is mot instance
+  std::unordered_map<std::string, std::shared_ptr<HobotMot>> hobot_mots;
+
+  std::atomic<uint64_t> recved_frames{0};
+  std::atomic<uint64_t> published_frames{0};
+  // 从图片时间戳到发布推理结果的延迟
+  std::atomic<uint64_t> latency_ms_sum{0};
+  std::atomic<uint64_t> latency_ms_max{0};
+  // 上一次输出统计时的数据，只在统计定时器中访问
+  std::chrono::steady_clock::time_point last_report_time =
+      std::chrono::steady_clock::now();
+  uint64_t last_published_frames = 0;
+  uint64_t last_latency_ms_sum = 0;
 };
 
 class Mono2dBodyDetNode : public DnnNode {
  public:
   Mono2dBodyDetNode(const std::string& node_name,
                     const NodeOptions& options = NodeOptions());
+  // 作为组件加载到容器中时使用，节点名为mono2d_body_det，可以在加载时重映射
+  explicit Mono2dBodyDetNode(const NodeOptions& options);
   ~Mono2dBodyDetNode() override;
 
+  // 回放完成并且停止流水线后就绪，没有回放录制文件时返回无效的future
+  std::shared_future<void> ReplayDone() const { return replay_done_; }
+
  protected:
   int SetNodePara() override;
   int PostProcess(const std::shared_ptr<DnnNodeOutput>& outputs) override;
@@ -124,56 +280,282 @@ class Mono2dBodyDetNode : public DnnNode {
 
   // key is mot processing type, body/face/head/hand
   // val is config file path
-#ifndef PLATFORM_X86
   std::unordered_map<std::string, std::string> hobot_mot_configs_{
       {"body", "config/iou2_method_param.json"},
       {"face", "config/iou2_method_param.json"},
       {"head", "config/iou2_method_param.json"},
       {"hand", "config/iou2_euclid_method_param.json"}};
 
-  // key is mot processing type, body/face/head/hand
-  // val is mot instance
-  std::unordered_map<std::string, std::shared_ptr<HobotMot>> hobot_mots_;
-#endif
-
   int is_sync_mode_ = 0;
 
   // 使用shared mem通信方式订阅图片
   int is_shared_mem_sub_ = 1;
+  // 不使用shared mem时订阅jpeg压缩图，解码为yuv后直接写入模型输入
+  int is_compressed_img_sub_ = 0;
+
+  // 输入图片缩放到模型输入size的方式，0：crop/padding左上区域；1：双线性插值；2：区域均值
+  int image_resize_type_ = static_cast<int>(ImageResizeType::BILINEAR);
+  // 缩放时是否保持宽高比，空白区域填充黑色
+  int is_letterbox_ = 1;
+
+  // 推理输出排序缓存的帧数，向上取整为2的幂
+  // 如果图像采集频率是30fps，缓存16帧对应要求端到端的推理耗时最长不能超过1000/30*16=533ms
+  int reorder_cache_size_ = 16;
+  // 后续帧已经有输出时，等待当前帧输出的最长时间
+  int reorder_timeout_ms_ = 1000;
+
+  // 预处理（图片转换和缩放）线程数
+  int preprocess_thread_num_ = 2;
+  // 流水线各个stage之间队列的长度，订阅回调在队列满时丢帧
+  int pipeline_queue_size_ = 4;
+  // 推理饱和时的准入策略，0：所有帧；1：只保留最新帧；2：根据推理耗时每N帧保留一帧
+  int admission_mode_ = static_cast<int>(AdmissionController::Mode::ALL);
+
+  // dnn_node的推理任务数，同时也是推理并发数的上限
+  int task_num_ = 2;
+  // 是否在启动时自动调优推理并发数，运行时设置为1重新调优
+  int auto_tune_task_num_ = 0;
+  // 自动调优时p99延迟的预算
+  int auto_tune_latency_budget_ms_ = 100;
+  // 自动调优时每个并发数推理的帧数
+  int auto_tune_frames_ = 50;
+  std::string task_num_tune_pub_topic_name_ =
+      "hobot_mono2d_body_detection_task_num_tune";
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr
+      task_num_tune_publisher_ = nullptr;
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr
+      param_callback_handle_ = nullptr;
+
+  // 各路输入的阶段延迟分位数，每个统计周期发布一次，运行时设置为1立即输出启动以来的统计
+  std::string latency_stats_pub_topic_name_ =
+      "hobot_mono2d_body_detection_latency_stats";
+  int dump_latency_stats_ = 0;
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr
+      latency_stats_publisher_ = nullptr;
+  // interval为true时输出上一次输出以来的统计，只能在统计定时器中使用
+  void PublishLatencyStats(bool interval);
+
+  enum class ReplayMode {
+    // 按照录制时的时间间隔
+    RECORDED = 0,
+    // 按照replay_fps_
+    FIXED_RATE = 1,
+    // 尽可能快，帧队列满时等待，不丢帧
+    AS_FAST_AS_POSSIBLE = 2,
+  };
+  // 不为空时回放录制文件代替订阅，回放完成后输出吞吐、延迟和丢帧统计并停止流水线
+  std::string replay_file_name_ = "";
+  int replay_mode_ = static_cast<int>(ReplayMode::RECORDED);
+  int replay_fps_ = 30;
+  std::shared_ptr<frame_replay::ReplayFile> replay_file_ = nullptr;
+  std::thread replay_thread_;
+  std::promise<void> replay_done_promise_;
+  std::shared_future<void> replay_done_;
+  // 录制的每一帧送入所有输入路
+  void ReplayFrames();
+  // 不为空时将第0路订阅到的图片录制到文件，用于回放
+  std::string record_file_name_ = "";
+  std::shared_ptr<frame_replay::RecordFile> record_file_ = nullptr;
+  // 等待后台线程写入录制文件的最大帧数，写文件跟不上时丢弃录制的帧
+  size_t record_queue_size_ = 30;
+  // 订阅回调中只把帧放入录制队列，不写文件
+  void RecordFrame(const ImageFrame& frame);
+
+  // 切分tile推理，0：关闭；1：将原图切分为相互重叠的tile分别推理，
+  // 检测框和关键点合并后映射回原图，用于高分辨率图片中的小目标
+  int tile_mode_ = 0;
+  // tile的列数和行数，0表示tile与模型输入一样大（不缩放），个数由原图大小决定
+  int tile_cols_ = 0;
+  int tile_rows_ = 0;
+  // 相邻tile之间至少重叠的原图像素数
+  int tile_overlap_ = 64;
+  // 是否额外推理一次缩放后的整图，用于检测跨越多个tile的大目标
+  int tile_with_full_frame_ = 1;
+  // 合并tile检测结果时NMS的iou阈值
+  double tile_nms_iou_threshold_ = 0.5;
+  std::shared_ptr<RecyclePool<TileGroup>> tile_group_pool_ = nullptr;
+  // 生成一帧所有tile的推理任务，成功返回0，失败返回-1
+  int PreprocessTiles(const ImageFrame& frame, std::vector<InferTask>& tasks);
+  // tile推理完成或者提交失败时转存推理输出，所有tile都完成时返回true，
+  // 此时output代表整帧，submit_ns为第一个tile提交推理的时间
+  bool FinishTile(FasterRcnnOutput& output, bool succeeded);
+  // 解析所有tile的推理输出，合并后的原图坐标检测框和关键点加入target_builder
+  void ParseTiles(StreamContext& stream,
+                  TileGroup& tile_group,
+                  int img_width,
+                  int img_height,
+                  bool log_frame);
+
+  // 每N帧推理一次，中间的帧发布跟踪预测的目标（带有predicted属性），1表示每帧都推理
+  int detect_interval_ = 1;
+  // 是否根据目标运动和跟踪预测的不确定度缩短推理间隔，detect_interval为上限
+  int detect_adaptive_ = 0;
+
+  enum class MotionGateMode {
+    // 不判断运动，所有帧都推理
+    OFF = 0,
+    // 没有运动时跳过推理，重复发布上一次推理的目标
+    REPUBLISH = 1,
+    // 没有运动时跳过推理，不发布
+    DROP = 2,
+  };
+  // 固定摄像头的静止场景下，根据降采样亮度与背景的差异跳过推理
+  int motion_gate_mode_ = static_cast<int>(MotionGateMode::OFF);
+  // 亮度变化的采样点占比不小于该值时认为有运动
+  double motion_gate_threshold_ = 0.001;
+  // 是否将人头、人脸、人手框关联到所属的人体，每个人输出一个target
+  int part_association_ = 0;
+  // 判断运动使用的亮度平面，不能直接读取亮度的格式（如jpeg）data为空，总是认为有运动
+  FrameDispatcher::LumaPlane GetMotionLuma(const ImageFrame& frame);
 
   std::string ai_msg_pub_topic_name_ = "hobot_mono2d_body_detection";
-  rclcpp::Publisher<ai_msgs::msg::PerceptionTargets>::SharedPtr msg_publisher_ =
-      nullptr;
+  // 定长检测结果的发布topic，为空时不发布，第i路（i > 0）使用该topic + "_i"
+  std::string pod_msg_pub_topic_name_ = "";
+  // 借用loaned message填充定长检测结果并发布
+  void PublishPodResult(StreamContext& stream,
+                        const ai_msgs::msg::PerceptionTargets& msg,
+                        int img_width,
+                        int img_height,
+                        bool is_predicted);
+
+  // 多路输入订阅的图片topic，为空时只订阅一路默认topic
+  std::vector<std::string> image_topic_names_;
+  // 多路输入对应的AI消息发布topic，个数与image_topic_names_不一致时，
+  // 第i路（i > 0）使用ai_msg_pub_topic_name_ + "_i"
+  std::vector<std::string> ai_msg_pub_topic_names_;
+  // 多路输入推理调度的权重，默认都为1
+  std::vector<int64_t> stream_weights_;
+  std::vector<std::shared_ptr<StreamContext>> streams_;
+  // 根据参数创建每路输入的上下文，不包括订阅
+  void CreateStreams();
+  void SubscribeStreams();
 
   int Predict(std::vector<std::shared_ptr<DNNInput>>& inputs,
               const std::shared_ptr<std::vector<hbDNNRoi>> rois,
               std::shared_ptr<DnnNodeOutput> dnn_output);
 
-#ifdef SHARED_MEM_ENABLED
-  rclcpp::SubscriptionHbmem<hbm_img_msgs::msg::HbmMsg1080P>::ConstSharedPtr
-      sharedmem_img_subscription_ = nullptr;
   std::string sharedmem_img_topic_name_ = "/hbmem_img";
+#ifdef SHARED_MEM_ENABLED
   void SharedMemImgProcess(
-      const hbm_img_msgs::msg::HbmMsg1080P::ConstSharedPtr msg);
+      const hbm_img_msgs::msg::HbmMsg1080P::ConstSharedPtr msg, int stream_id);
 #endif
 
-  rclcpp::Subscription<sensor_msgs::msg::Image>::ConstSharedPtr
-      ros_img_subscription_ = nullptr;
-  // 目前只支持订阅原图，可以使用压缩图"/image_raw/compressed" topic
-  // 和sensor_msgs::msg::CompressedImage格式扩展订阅压缩图
+  // 订阅rgb8/nv12格式的原图
   std::string ros_img_topic_name_ = "/image_raw";
-  void RosImgProcess(const sensor_msgs::msg::Image::ConstSharedPtr msg);
+  void RosImgProcess(const sensor_msgs::msg::Image::ConstSharedPtr msg,
+                     int stream_id);
+
+  // 订阅jpeg压缩图（如usb和网络相机输出的mjpeg），帧的encoding为"jpeg"
+  std::string compressed_img_topic_name_ = "/image_raw/compressed";
+  void CompressedImgProcess(
+      const sensor_msgs::msg::CompressedImage::ConstSharedPtr msg,
+      int stream_id);
+
+  // 解析并发布单帧推理结果，由对应输入路的output_reorder_buffer按照输入顺序调用
+  int PublishOutput(const std::shared_ptr<DnnNodeOutput>& node_output);
+  // 不会有推理输出的帧，通知对应输入路的output_reorder_buffer不再等待
+  void EraseFrame(int stream_id, uint64_t frame_seq);
+  // 推理输出送入对应输入路的output_reorder_buffer，按照输入顺序发布
+  void FeedOutput(int stream_id,
+                  uint64_t frame_seq,
+                  const std::shared_ptr<DnnNodeOutput>& output);
+
+  // 循环使用的推理输出，个数足够覆盖排序缓存和正在推理的帧
+  std::shared_ptr<RecyclePool<FasterRcnnOutput>> output_pool_ = nullptr;
 
-  std::shared_ptr<NodeOutputManage> node_output_manage_ptr_ =
-      std::make_shared<NodeOutputManage>();
-#ifndef PLATFORM_X86
+  // 发布的perf类型名，初始化时生成，避免每帧拼接字符串
+  struct PerfTypes {
+    std::string preprocess;
+    std::string predict_infer;
+    std::string predict_parse;
+    std::string postprocess;
+    std::string pipeline;
+    // 跳过推理的帧预测目标位置的耗时
+    std::string track_predict;
+    // 切分tile推理时每个tile的推理耗时
+    std::vector<std::string> tile_infer;
+  };
+  PerfTypes perf_types_;
+  // key is mot processing type, val is perf type
+  std::unordered_map<std::string, std::string> mot_perf_types_;
+
+  // 订阅回调 -> frame_queue_ -> 预处理线程 -> infer_queue_ -> 推理提交线程
+  // frame_queue_按照输入路的权重调度预处理和推理的顺序
+  std::shared_ptr<WeightedStreamQueue<ImageFrame>> frame_queue_ = nullptr;
+  std::shared_ptr<PipelineQueue<InferTask>> infer_queue_ = nullptr;
+  // 所有输入路共用，只用于限制只保留最新帧时正在预处理的帧数
+  std::shared_ptr<AdmissionController> admission_controller_ = nullptr;
+  std::vector<std::thread> preprocess_workers_;
+  std::thread infer_submitter_;
+  rclcpp::CallbackGroup::SharedPtr timer_callback_group_ = nullptr;
+  rclcpp::TimerBase::SharedPtr pipeline_stats_timer_ = nullptr;
+  void EnqueueFrame(ImageFrame&& frame);
+  // 生成模型输入，成功返回0，失败返回-1
+  int Preprocess(const ImageFrame& frame, InferTask& task);
+  // 从output_pool_中取出推理输出，重置并填充帧的信息
+  std::shared_ptr<FasterRcnnOutput> AcquireOutput(const ImageFrame& frame);
+  void PreprocessWorker();
+  void InferSubmitter();
+  // 提交单帧推理，停止时返回false
+  bool SubmitInferTask(InferTask& task);
+  // 定时输出流水线各个队列的深度统计
+  void PipelineStatsReport();
+
+  // 限制同时推理的帧数，key为推理输出，val为提交推理的时间
+  std::mutex inflight_mtx_;
+  std::condition_variable inflight_cv_;
+  std::unordered_map<const DnnNodeOutput*,
+                     std::chrono::steady_clock::time_point>
+      inflight_outputs_;
+  int infer_concurrency_ = 2;
+  std::atomic<bool> pipeline_stopped_{false};
+  // PostProcess没有被调用（如推理失败）的输出，超过该时间后不再占用并发数
+  const int inflight_timeout_ms_ = 1000;
+  // 等待推理并发数小于infer_concurrency_后记录提交时间，停止时返回false
+  bool AcquireInflight(const DnnNodeOutput* output);
+  // 停止准入和各个队列，等待预处理线程和推理提交线程退出，可以重复调用
+  void StopPipeline();
+  // 返回从提交推理到输出的耗时，找不到对应的输出时返回-1
+  float ReleaseInflight(const DnnNodeOutput* output);
+  void SetInferConcurrency(int concurrency);
+  int GetInferConcurrency();
+
+  std::atomic<bool> auto_tuning_{false};
+  std::thread auto_tune_thread_;
+  InferConcurrencyTuner concurrency_tuner_;
+  void StartAutoTune();
+  // 使用合成帧依次测试1到task_num_的并发数，选择满足延迟预算的最大吞吐
+  void RunAutoTune();
+  rcl_interfaces::msg::SetParametersResult OnSetParameters(
+      const std::vector<rclcpp::Parameter>& parameters);
+
+  // 逐帧明细日志（收到的图片、检测框、发布的目标）的输出方式
+  enum class LogMode {
+    // 不输出
+    OFF = 0,
+    // 每log_sample_interval帧输出一帧
+    SAMPLED = 1,
+    // 每帧都输出
+    FULL = 2,
+  };
+  int log_mode_ = static_cast<int>(LogMode::SAMPLED);
+  int log_sample_interval_ = 30;
+  std::shared_ptr<AsyncLogger> async_logger_ = nullptr;
+  // 判断第frame_index帧是否需要输出明细日志，不需要时不做任何格式化
+  bool ShouldLogFrame(uint64_t frame_index) const;
+
+  // 并发执行各个类别跟踪的工作线程数，调用线程也参与执行，0表示串行跟踪
+  int mot_thread_num_ = 3;
+  std::shared_ptr<ParallelRunner> mot_runner_ = nullptr;
+  // 跟踪target_builder中本帧有解析结果的类别，结果写回target_builder
+  // 各个类别的跟踪耗时记录到perfs中
   int DoMot(
+      std::unordered_map<std::string, std::shared_ptr<HobotMot>>& hobot_mots,
       const time_t& time_stamp,
-      const std::unordered_map<int32_t, std::vector<MotBox>>& in_rois,
-      std::unordered_map<int32_t, std::vector<MotBox>>& out_rois,
-      std::unordered_map<int32_t, std::vector<std::shared_ptr<MotTrackId>>>&
-          out_disappeared_ids);
-#endif
+      int img_width,
+      int img_height,
+      TargetBuilder& target_builder,
+      std::vector<ai_msgs::msg::Perf>& perfs);
 };
 
 #endif  // MONO2D_BODY_DET_NODE_H_
@@ -0,0 +1,71 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_MOTION_GATE_H
+#define MONO2D_DET_MOTION_GATE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// 判断画面是否有运动，用于固定摄像头在静止场景下跳过推理
+// 亮度平面按照kSampleStep x kSampleStep降采样后与背景比较，
+// 亮度差超过kPixelDiffThreshold的采样点占比不小于阈值时认为有运动
+// 背景为降采样亮度的滑动平均，每次判断后以1/8的比例向当前帧更新
+// Check只能在一个线程中调用，GetStats可以在任意线程中调用
+class MotionGate {
+ public:
+  struct Stats {
+    // 判断的帧数和判断为没有运动（可以跳过推理）的帧数
+    uint64_t checked = 0;
+    uint64_t skipped = 0;
+  };
+
+  // threshold：有运动的采样点占比阈值
+  explicit MotionGate(float threshold);
+
+  // luma指向亮度数据，pixel_stride为相邻像素亮度的字节间隔
+  // （nv12/mono8为1，yuyv/uyvy为2，rgb8/bgr8使用g通道近似为3）
+  // 返回true表示有运动需要推理；第一帧、分辨率变化以及连续跳过kMaxSkipFrames帧后返回true
+  bool Check(const uint8_t* luma,
+             int pixel_stride,
+             int step,
+             int height,
+             int width);
+
+  Stats GetStats() const;
+
+ private:
+  static constexpr int kSampleStep = 4;
+  static constexpr int kPixelDiffThreshold = 20;
+  // 连续跳过该帧数后强制推理一次，避免运动停止前的结果一直被重复使用
+  static constexpr int kMaxSkipFrames = 30;
+
+  void Downsample(const uint8_t* luma, int pixel_stride, int step);
+
+  const float threshold_;
+  int height_ = 0;
+  int width_ = 0;
+  // 降采样后的宽高
+  int sample_height_ = 0;
+  int sample_width_ = 0;
+  std::vector<uint8_t> current_;
+  std::vector<uint8_t> background_;
+  int skipped_frames_ = 0;
+
+  std::atomic<uint64_t> checked_{0};
+  std::atomic<uint64_t> skipped_{0};
+};
+
+#endif  // MONO2D_DET_MOTION_GATE_H
@@ -0,0 +1,164 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_NATIVE_MOT_H
+#define MONO2D_DET_NATIVE_MOT_H
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 不依赖hobot_mot的多目标跟踪，用于x86等没有hobot_mot的平台
+// 接口和输出语义与hobot_mot的IOU_2.0跟踪保持一致
+namespace native_mot {
+
+enum class DataState {
+  /// valid
+  VALID = 0,
+  /// filtered
+  FILTERED = 1,
+  /// invisible
+  INVISIBLE = 2,
+  /// disappeared
+  DISAPPEARED = 3,
+  /// invalid
+  INVALID = 4,
+};
+
+struct MotBox {
+  MotBox() {}
+  MotBox(int x1_, int y1_, int x2_, int y2_) {
+    x1 = x1_;
+    y1 = y1_;
+    x2 = x2_;
+    y2 = y2_;
+  }
+  MotBox(int x1_, int y1_, int x2_, int y2_, float score_) {
+    x1 = x1_;
+    y1 = y1_;
+    x2 = x2_;
+    y2 = y2_;
+    score = score_;
+  }
+  int x1 = 0;
+  int y1 = 0;
+  int x2 = 0;
+  int y2 = 0;
+  float score = 1;
+  int id = -1;
+  DataState state_ = DataState::INVALID;
+};
+
+struct MotTrackId {
+  MotTrackId(int32_t value_, DataState state) : value(value_), state_(state) {}
+  int32_t value = -1;
+  DataState state_ = DataState::INVALID;
+};
+
+struct NativeMotConfig {
+  enum class MatchType {
+    // 使用预测框和检测框的IOU匹配
+    IOU = 0,
+    // 使用预测框和检测框中心点的欧式距离匹配
+    EUCLIDEAN = 1,
+  };
+  MatchType match_type = MatchType::IOU;
+  int use_kalman_filter = 1;
+  // 连续未匹配超过该帧数的轨迹不再按照速度外推
+  int missing_time_thres = 2;
+  // 连续未匹配超过该帧数的轨迹输出为消失
+  int vanish_frame_count = 50;
+  // 相邻两帧的时间间隔，单位毫秒，用于计算预测步长
+  int time_gap = 40;
+  float iou_thres = 0.2;
+  // 单位像素
+  float euclidean_thres = 200;
+  // 低于该分数的检测框不参与跟踪
+  float min_score = 0.8;
+  // 检测框被更高分数的检测框覆盖的比例超过该值时不参与跟踪
+  float ignore_overlap_thres = 0.9;
+
+  // 读取hobot_mot格式的json配置文件（单层key-value），
+  // 不存在的key保持默认值，读取文件失败返回-1
+  int Load(const std::string& config_file);
+};
+
+class NativeMot {
+ public:
+  // 配置文件读取失败时使用默认配置
+  explicit NativeMot(const std::string& config_file);
+  explicit NativeMot(const NativeMotConfig& config);
+
+  const NativeMotConfig& GetConfig() const { return config_; }
+  size_t TrackNum() const { return ids_.size(); }
+
+  // out_box_list与in_box_list一一对应，不参与跟踪的框id为-1，状态为FILTERED
+  // time_stamp单位为毫秒，成功返回0，失败返回-1
+  int DoProcess(const std::vector<MotBox>& in_box_list,
+                std::vector<MotBox>& out_box_list,
+                std::vector<std::shared_ptr<MotTrackId>>& disappeared_ids,
+                const time_t& time_stamp,
+                int img_width,
+                int img_height);
+
+ private:
+  // 每条轨迹的状态为中心点x、中心点y、宽、高，每一维独立使用匀速模型的卡尔曼滤波
+  static constexpr int kDim = 4;
+
+  struct Candidate {
+    float cost;
+    int32_t track;
+    int32_t det;
+  };
+
+  // 按照中心点x排序有效的检测框，匹配时只需要比较x方向范围内的检测框
+  void SortDetections(const std::vector<MotBox>& in_box_list);
+  // 返回中心点x在[x_min, x_max]范围内的检测框在det_order_中的下标范围
+  void DetectionRange(float x_min, float x_max, size_t& begin, size_t& end);
+  void Predict(float dt);
+  void Match(const std::vector<MotBox>& in_box_list);
+  void UpdateTrack(size_t track, const MotBox& box);
+  void AddTrack(const MotBox& box);
+  void RemoveTrack(size_t track);
+
+  NativeMotConfig config_;
+  int32_t next_id_ = 1;
+  time_t last_time_stamp_ = 0;
+
+  // 按照structure of arrays存储轨迹，删除轨迹时与最后一条交换
+  std::array<std::vector<float>, kDim> pos_;
+  std::array<std::vector<float>, kDim> vel_;
+  // 每一维2x2协方差矩阵的三个元素
+  std::array<std::vector<float>, kDim> cov_pp_;
+  std::array<std::vector<float>, kDim> cov_pv_;
+  std::array<std::vector<float>, kDim> cov_vv_;
+  std::vector<int32_t> ids_;
+  std::vector<int32_t> lost_frames_;
+
+  // 每帧复用的临时数据，容量只增不减，稳定后不再申请内存
+  std::vector<uint8_t> det_valid_;
+  std::vector<int32_t> det_order_;
+  std::vector<float> det_center_x_;
+  float det_max_width_ = 0;
+  std::vector<int32_t> det_track_;
+  std::vector<uint8_t> track_matched_;
+  std::vector<Candidate> candidates_;
+};
+
+}  // namespace native_mot
+
+#endif  // MONO2D_DET_NATIVE_MOT_H
@@ -0,0 +1,87 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_NV12_PYRAMID_POOL_H
+#define MONO2D_DET_NV12_PYRAMID_POOL_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "dnn/hb_sys.h"
+#include "dnn_node/dnn_node.h"
+
+using hobot::dnn_node::NV12PyramidInput;
+
+// 缓存模型输入使用的nv12 pyramid内存，避免每帧申请和释放hbSysMem
+// 按照width/height/stride区分缓存，pyramid析构时内存归还到pool中
+class NV12PyramidPool : public std::enable_shared_from_this<NV12PyramidPool> {
+ public:
+  struct Stats {
+    // 从缓存中获取到内存的次数
+    uint64_t hits = 0;
+    // 缓存中无可用内存，需要重新申请的次数
+    uint64_t misses = 0;
+    // 当前被pyramid占用（还未归还）的内存大小
+    uint64_t bytes_in_flight = 0;
+    // bytes_in_flight的历史最大值
+    uint64_t high_water_mark = 0;
+  };
+
+  static std::shared_ptr<NV12PyramidPool> Instance();
+
+  ~NV12PyramidPool();
+
+  // 获取一个height x width的pyramid，y和uv的stride为ALIGN_16(width)
+  // 失败返回nullptr
+  std::shared_ptr<NV12PyramidInput> Acquire(int height, int width);
+
+  // 只flush写入的y_rows行y数据和uv_rows行uv数据
+  static void FlushRows(const NV12PyramidInput &pyramid,
+                        int y_rows,
+                        int uv_rows);
+
+  Stats GetStats() const;
+
+  // 每种尺寸最多缓存的空闲内存块个数，超过的内存在归还时直接释放
+  void SetMaxCachedPerKey(size_t max_cached) { max_cached_per_key_ = max_cached; }
+
+ private:
+  struct Buffer {
+    hbSysMem y;
+    hbSysMem uv;
+    uint64_t key = 0;
+    uint64_t bytes = 0;
+    NV12PyramidInput pyramid;
+  };
+
+  NV12PyramidPool() = default;
+
+  void Release(Buffer *buffer);
+  static void FreeBuffer(Buffer *buffer);
+
+  std::mutex mtx_;
+  // key由width/height/stride组合得到，val为空闲的内存块
+  std::unordered_map<uint64_t, std::vector<Buffer *>> free_buffers_;
+  std::atomic<size_t> max_cached_per_key_{8};
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> bytes_in_flight_{0};
+  std::atomic<uint64_t> high_water_mark_{0};
+};
+
+#endif  // MONO2D_DET_NV12_PYRAMID_POOL_H
@@ -0,0 +1,237 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_OUTPUT_REORDER_BUFFER_H
+#define MONO2D_DET_OUTPUT_REORDER_BUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "dnn_node/dnn_node.h"
+
+using hobot::dnn_node::DnnNodeOutput;
+
+// 解决异步多线程情况下模型输出乱序的问题
+// 每帧输入通过Register分配一个单调递增的序号，推理输出按照序号写入固定容量的环形缓存
+// 写入输出不加锁，同一时刻只有一个线程负责按照序号顺序取出输出并调用handler，
+// 其他线程写入后直接返回，由正在取输出的线程代为处理
+class OutputReorderBuffer {
+ public:
+  struct Stats {
+    // 调用Register输入的帧数
+    uint64_t registered = 0;
+    // 按照顺序输出的帧数
+    uint64_t released = 0;
+    // 等待超时或者缓存已满被跳过的帧数
+    uint64_t dropped = 0;
+    // 对应的帧已经被跳过之后才到达，被丢弃的输出个数，这些帧已经计入dropped
+    uint64_t late = 0;
+    // 调用Erase放弃的帧数
+    uint64_t erased = 0;
+  };
+
+  // capacity向上取整为2的幂
+  // timeout_ms：后续帧已经有输出时，等待当前帧输出的最长时间
+  OutputReorderBuffer(size_t capacity, uint64_t timeout_ms);
+
+  // 输入一帧，返回该帧的序号，需要按照输入顺序调用
+  uint64_t Register();
+
+  // 序号为seq的帧不会再有推理输出（如预测失败），不再等待该帧
+  template <typename Handler>
+  void Erase(uint64_t seq, Handler &&handler);
+
+  // 写入序号为seq的推理输出，所有可以按序输出的结果按照序号顺序调用handler
+  // handler的参数类型为const std::shared_ptr<DnnNodeOutput>&
+  template <typename Handler>
+  void Feed(uint64_t seq,
+            std::shared_ptr<DnnNodeOutput> output,
+            Handler &&handler);
+
+  Stats GetStats() const;
+
+  // 所有输入的帧都已经被输出、跳过或者放弃
+  bool Drained() const;
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  enum SlotFlag : uint64_t {
+    // 槽位空闲，等待对应序号的输出
+    kFree = 0,
+    // 正在写入输出
+    kWriting = 1,
+    // 输出已写入
+    kReady = 2,
+    // 对应的帧已放弃
+    kErased = 3,
+  };
+
+  struct Slot {
+    // 高位为槽位当前对应的序号，低2位为SlotFlag
+    std::atomic<uint64_t> state{0};
+    std::shared_ptr<DnnNodeOutput> output = nullptr;
+  };
+
+  static uint64_t Tag(uint64_t seq, SlotFlag flag) { return (seq << 2) | flag; }
+  static uint64_t TagSeq(uint64_t tag) { return tag >> 2; }
+
+  // 将序号为seq的槽位从kFree改为flag，槽位仍被更早的帧占用时等待队首的帧被跳过
+  // 该帧已经被跳过、写入或者放弃时返回false
+  template <typename Handler>
+  bool ClaimSlot(uint64_t seq, SlotFlag flag, Handler &&handler);
+
+  // 竞争取输出的权限，成功后按照序号顺序取出输出
+  template <typename Handler>
+  void Drain(Handler &&handler);
+
+  template <typename Handler>
+  void DrainLocked(Handler &&handler);
+
+  // 队首的帧可以被取出或者被跳过
+  bool HeadReady();
+
+  // 队首的帧还没有输出时，判断是否跳过该帧，只在持有取输出的权限时调用
+  bool ShouldSkip(uint64_t head);
+
+  static uint64_t NowMs();
+
+  size_t capacity_;
+  uint64_t mask_;
+  uint64_t timeout_ms_;
+  std::vector<Slot> slots_;
+
+  std::atomic<uint64_t> next_seq_{0};
+  std::atomic<uint64_t> head_{0};
+  // 已写入输出的最大序号 + 1
+  std::atomic<uint64_t> max_ready_seq_{0};
+  // 由于缓存已满等待写入的最大序号 + 1
+  std::atomic<uint64_t> overflow_seq_{0};
+  std::atomic<bool> draining_{false};
+
+  // 只在持有取输出的权限时访问
+  uint64_t head_wait_seq_ = UINT64_MAX;
+  uint64_t head_wait_start_ms_ = 0;
+
+  std::atomic<uint64_t> released_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> late_{0};
+  std::atomic<uint64_t> erased_{0};
+};
+
+template <typename Handler>
+void OutputReorderBuffer::Erase(uint64_t seq, Handler &&handler) {
+  if (ClaimSlot(seq, kErased, handler)) {
+    erased_++;
+    Drain(handler);
+  }
+}
+
+template <typename Handler>
+void OutputReorderBuffer::Feed(uint64_t seq,
+                               std::shared_ptr<DnnNodeOutput> output,
+                               Handler &&handler) {
+  if (!ClaimSlot(seq, kWriting, handler)) {
+    // 该帧已经被跳过
+    late_++;
+    return;
+  }
+  auto &slot = slots_[seq & mask_];
+  slot.output = std::move(output);
+  slot.state.store(Tag(seq, kReady), std::memory_order_release);
+  uint64_t max_ready = max_ready_seq_.load();
+  while (max_ready < seq + 1 &&
+         !max_ready_seq_.compare_exchange_weak(max_ready, seq + 1)) {
+  }
+  Drain(handler);
+}
+
+template <typename Handler>
+bool OutputReorderBuffer::ClaimSlot(uint64_t seq,
+                                    SlotFlag flag,
+                                    Handler &&handler) {
+  auto &slot = slots_[seq & mask_];
+  while (true) {
+    uint64_t expected = Tag(seq, kFree);
+    if (slot.state.compare_exchange_strong(
+            expected, Tag(seq, flag), std::memory_order_acq_rel)) {
+      return true;
+    }
+    if (TagSeq(expected) >= seq) {
+      // 该帧已经被跳过、写入或者放弃
+      return false;
+    }
+    // 槽位仍被更早的帧占用，通知取输出的线程跳过队首的帧腾出空间
+    uint64_t overflow = overflow_seq_.load();
+    while (overflow < seq + 1 &&
+           !overflow_seq_.compare_exchange_weak(overflow, seq + 1)) {
+    }
+    Drain(handler);
+    std::this_thread::yield();
+  }
+}
+
+template <typename Handler>
+void OutputReorderBuffer::Drain(Handler &&handler) {
+  // 调用者写入槽位之后再检查取输出的权限，与释放权限之后检查队首配对，
+  // 避免两边都看到旧值导致写入的输出没有被取出
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  while (true) {
+    bool expected = false;
+    if (!draining_.compare_exchange_strong(
+            expected, true, std::memory_order_acquire)) {
+      return;
+    }
+    DrainLocked(handler);
+    draining_.store(false, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // 释放权限之前其他线程写入的输出可能没有被处理，需要再次检查
+    if (!HeadReady()) {
+      return;
+    }
+  }
+}
+
+template <typename Handler>
+void OutputReorderBuffer::DrainLocked(Handler &&handler) {
+  while (true) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    auto &slot = slots_[head & mask_];
+    uint64_t state = slot.state.load(std::memory_order_acquire);
+    if (state == Tag(head, kReady)) {
+      std::shared_ptr<DnnNodeOutput> output = std::move(slot.output);
+      slot.output = nullptr;
+      slot.state.store(Tag(head + capacity_, kFree), std::memory_order_release);
+      head_.store(head + 1, std::memory_order_release);
+      released_++;
+      handler(output);
+    } else if (state == Tag(head, kErased)) {
+      slot.state.store(Tag(head + capacity_, kFree), std::memory_order_release);
+      head_.store(head + 1, std::memory_order_release);
+    } else if (state == Tag(head, kFree) && ShouldSkip(head)) {
+      if (slot.state.compare_exchange_strong(state,
+                                             Tag(head + capacity_, kFree),
+                                             std::memory_order_acq_rel)) {
+        head_.store(head + 1, std::memory_order_release);
+        dropped_++;
+      }
+    } else {
+      break;
+    }
+  }
+}
+
+#endif  // MONO2D_DET_OUTPUT_REORDER_BUFFER_H
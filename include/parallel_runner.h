@@ -0,0 +1,64 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_PARALLEL_RUNNER_H
+#define MONO2D_DET_PARALLEL_RUNNER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 常驻的小型线程池，把一组相互独立的任务分发到工作线程和调用线程上并发执行
+// 支持多个线程同时调用Run，各自等待自己的一组任务完成
+// 任务组在调用线程的栈上，按照链表排队，Run本身不申请堆内存
+class ParallelRunner {
+ public:
+  // thread_num为0时所有任务都在调用线程中串行执行
+  explicit ParallelRunner(int thread_num);
+  ~ParallelRunner();
+
+  size_t ThreadNum() const { return workers_.size(); }
+
+  // 执行job(0)到job(job_num - 1)，全部完成后返回
+  void Run(size_t job_num, const std::function<void(size_t)>& job);
+
+ private:
+  struct Batch {
+    const std::function<void(size_t)>* job = nullptr;
+    size_t job_num = 0;
+    // 下一个待领取的任务，只在持有mtx_时访问
+    size_t next = 0;
+    size_t done = 0;
+    // 队列中的下一组任务
+    Batch* next_batch = nullptr;
+  };
+
+  // 从队首的一组任务中领取一个，没有待领取的任务时返回false，需要持有mtx_
+  bool ClaimLocked(Batch*& batch, size_t& index);
+  void Worker();
+
+  std::vector<std::thread> workers_;
+  std::mutex mtx_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  // 待领取任务的队首和队尾，只在持有mtx_时访问
+  Batch* head_ = nullptr;
+  Batch* tail_ = nullptr;
+  bool stopped_ = false;
+};
+
+#endif  // MONO2D_DET_PARALLEL_RUNNER_H
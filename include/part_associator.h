@@ -0,0 +1,115 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_PART_ASSOCIATOR_H
+#define MONO2D_DET_PART_ASSOCIATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ai_msgs/msg/perception_targets.hpp"
+
+// 将人头、人脸、人手框关联到所属的人体框
+// 人体框按照网格索引，每个部位框只与覆盖其中心所在网格的人体框比较
+// 代价为部位框落在人体框外的比例，人体有关键点时加上部位框中心到对应关键点
+// （COCO顺序的头部0-4号点，手腕9、10号点）的归一化距离
+// 按照代价从小到大贪心分配，每个人体最多一个人头、一个人脸和两个人手
+// 帧之间复用已经申请的内存，只在一个线程中使用
+class PartAssociator {
+ public:
+  enum class PartType {
+    HEAD = 0,
+    FACE = 1,
+    HAND = 2,
+    TYPE_NUM,
+  };
+
+  // 开始新的一帧
+  void Reset();
+
+  // 加入一个人体框，kps为该人体的关键点（原图坐标），没有关键点时为nullptr
+  // kps在Associate完成之前需要保持有效
+  void AddBody(float x1,
+               float y1,
+               float x2,
+               float y2,
+               const ai_msgs::msg::Point* kps);
+
+  // 加入一个部位框，按照加入顺序编号
+  void AddPart(PartType type, float x1, float y1, float x2, float y2);
+
+  void Associate();
+
+  // 第part_index个部位框所属人体框的加入顺序，没有关联时为-1
+  int32_t BodyOf(size_t part_index) const { return part_body_[part_index]; }
+
+  size_t BodyNum() const { return bodies_.size(); }
+  size_t PartNum() const { return parts_.size(); }
+
+ private:
+  // 部位框与人体框的交集占部位框面积的比例不小于该值时才可能关联
+  static constexpr float kMinInsideRatio = 0.5f;
+  // 代价超过该值时不关联
+  static constexpr float kMaxCost = 1.5f;
+  // 关键点距离在代价中的权重，距离按照部位框的长边归一化，最大为2
+  static constexpr float kKpsWeight = 0.5f;
+  // 置信度低于该值的关键点不参与关联
+  static constexpr float kKpsScoreThreshold = 0.3f;
+
+  struct Box {
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+  };
+
+  struct Body {
+    Box box;
+    const ai_msgs::msg::Point* kps;
+  };
+
+  struct Part {
+    Box box;
+    PartType type;
+  };
+
+  struct Candidate {
+    float cost;
+    int32_t part;
+    int32_t body;
+  };
+
+  void BuildGrid();
+  float Cost(const Part& part, const Body& body) const;
+
+  std::vector<Body> bodies_;
+  std::vector<Part> parts_;
+  std::vector<int32_t> part_body_;
+
+  // 网格按照CSR格式存储，cell_start_[cell]到cell_start_[cell + 1]为该网格内的人体框
+  float grid_x0_ = 0;
+  float grid_y0_ = 0;
+  float cell_size_ = 1;
+  int grid_cols_ = 0;
+  int grid_rows_ = 0;
+  std::vector<int32_t> cell_start_;
+  std::vector<int32_t> cell_bodies_;
+
+  std::vector<Candidate> candidates_;
+  // 每个人体已经关联的各类部位个数
+  std::vector<uint8_t> body_part_count_;
+};
+
+#endif  // MONO2D_DET_PART_ASSOCIATOR_H
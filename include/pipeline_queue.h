@@ -0,0 +1,126 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_PIPELINE_QUEUE_H
+#define MONO2D_DET_PIPELINE_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// 连接流水线各个stage的有界队列，支持多生产者多消费者
+// 队列满时TryPush直接返回失败，不阻塞生产者（如订阅回调）
+template <typename T>
+class PipelineQueue {
+ public:
+  struct Stats {
+    // 当前队列深度
+    size_t depth = 0;
+    // 队列深度的最大值
+    size_t high_water_mark = 0;
+    uint64_t pushed = 0;
+    // 队列已满被拒绝或者被覆盖的个数
+    uint64_t rejected = 0;
+  };
+
+  explicit PipelineQueue(size_t capacity) : capacity_(capacity) {}
+
+  // 队列已满或者已停止时返回false
+  bool TryPush(T &&item) {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      if (stopped_ || queue_.size() >= capacity_) {
+        rejected_++;
+        return false;
+      }
+      queue_.push_back(std::move(item));
+      pushed_++;
+      if (queue_.size() > high_water_mark_) {
+        high_water_mark_ = queue_.size();
+      }
+    }
+    cv_pop_.notify_one();
+    return true;
+  }
+
+  // 队列已满时阻塞等待，已停止时返回false
+  bool Push(T &&item) {
+    {
+      std::unique_lock<std::mutex> lk(mtx_);
+      cv_push_.wait(lk,
+                    [this] { return stopped_ || queue_.size() < capacity_; });
+      if (stopped_) {
+        return false;
+      }
+      queue_.push_back(std::move(item));
+      pushed_++;
+      if (queue_.size() > high_water_mark_) {
+        high_water_mark_ = queue_.size();
+      }
+    }
+    cv_pop_.notify_one();
+    return true;
+  }
+
+  // 阻塞等待数据，已停止时返回false
+  bool Pop(T &item) {
+    {
+      std::unique_lock<std::mutex> lk(mtx_);
+      cv_pop_.wait(lk, [this] { return stopped_ || !queue_.empty(); });
+      if (stopped_) {
+        return false;
+      }
+      item = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    cv_push_.notify_one();
+    return true;
+  }
+
+  // 唤醒所有等待的线程，之后的Push和Pop都返回失败
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      stopped_ = true;
+      queue_.clear();
+    }
+    cv_pop_.notify_all();
+    cv_push_.notify_all();
+  }
+
+  Stats GetStats() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    Stats stats;
+    stats.depth = queue_.size();
+    stats.high_water_mark = high_water_mark_;
+    stats.pushed = pushed_;
+    stats.rejected = rejected_;
+    return stats;
+  }
+
+ private:
+  const size_t capacity_;
+  std::deque<T> queue_;
+  std::mutex mtx_;
+  std::condition_variable cv_pop_;
+  std::condition_variable cv_push_;
+  bool stopped_ = false;
+  size_t high_water_mark_ = 0;
+  uint64_t pushed_ = 0;
+  uint64_t rejected_ = 0;
+};
+
+#endif  // MONO2D_DET_PIPELINE_QUEUE_H
@@ -0,0 +1,73 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_RECYCLE_POOL_H
+#define MONO2D_DET_RECYCLE_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 可以循环使用的对象池，避免每帧新建对象以及shared_ptr的控制块
+// 池中的对象只被池持有（use_count为1）时说明使用者都已经释放，可以再次取出
+// 取出的对象保留上一次使用时的内容（包括已经申请的内存），由使用者重置
+template <typename T>
+class RecyclePool {
+ public:
+  struct Stats {
+    uint64_t reused = 0;
+    uint64_t created = 0;
+  };
+
+  // 池中最多保留max_size个对象，超出时新建的对象不回收
+  explicit RecyclePool(size_t max_size) : max_size_(max_size) {
+    objects_.reserve(max_size);
+  }
+
+  std::shared_ptr<T> Acquire() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (size_t count = 0; count < objects_.size(); count++) {
+      auto& object = objects_[next_];
+      next_ = (next_ + 1) % objects_.size();
+      if (object.use_count() == 1) {
+        // 与使用者释放引用时的release配对，保证看到使用者对对象的修改
+        std::atomic_thread_fence(std::memory_order_acquire);
+        stats_.reused++;
+        return object;
+      }
+    }
+    stats_.created++;
+    auto object = std::make_shared<T>();
+    if (objects_.size() < max_size_) {
+      objects_.push_back(object);
+    }
+    return object;
+  }
+
+  Stats GetStats() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return stats_;
+  }
+
+ private:
+  const size_t max_size_;
+  std::mutex mtx_;
+  std::vector<std::shared_ptr<T>> objects_;
+  size_t next_ = 0;
+  Stats stats_;
+};
+
+#endif  // MONO2D_DET_RECYCLE_POOL_H
@@ -0,0 +1,215 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_TARGET_BUILDER_H
+#define MONO2D_DET_TARGET_BUILDER_H
+
+#include <time.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef PLATFORM_X86
+#include "hobot_mot/hobot_mot.h"
+#else
+// x86平台没有hobot_mot，使用接口一致的内置跟踪
+#include "include/native_mot.h"
+using HobotMot = native_mot::NativeMot;
+using MotBox = native_mot::MotBox;
+using MotTrackId = native_mot::MotTrackId;
+namespace hobot_mot {
+using DataState = native_mot::DataState;
+}  // namespace hobot_mot
+#endif
+
+#include "ai_msgs/msg/perception_targets.hpp"
+#include "include/async_logger.h"
+#include "include/image_utils.h"
+#include "include/parallel_runner.h"
+#include "include/part_associator.h"
+
+// 将解析后的检测框和关键点组装为发布的PerceptionTargets，每路输入一个实例
+// 跟踪的输入输出和关键点等每帧的中间数据复用上一帧的内存，稳定后不再申请内存
+class TargetBuilder {
+ public:
+  using RoiMap = std::unordered_map<int32_t, std::vector<MotBox>>;
+  using DisappearedMap =
+      std::unordered_map<int32_t, std::vector<std::shared_ptr<MotTrackId>>>;
+  using MotMap = std::unordered_map<std::string, std::shared_ptr<HobotMot>>;
+
+  // 一个类别的跟踪任务，Track返回后time_start/time_end和ret有效
+  struct MotJob {
+    int32_t index = 0;
+    // 类别，指向box_outputs_index_type中的value
+    const std::string* type = nullptr;
+    HobotMot* hobot_mot = nullptr;
+    int ret = 0;
+    struct timespec time_start = {0, 0};
+    struct timespec time_end = {0, 0};
+  };
+
+  // box_outputs_index_type：检测框的模型输出index和类型（body/head/face/hand）
+  TargetBuilder(
+      const std::unordered_map<int32_t, std::string>& box_outputs_index_type,
+      int32_t body_box_output_index);
+
+  // 开始新的一帧，清空上一帧的数据并保留已经申请的内存
+  void Reset();
+
+  // 标记output_index类别本帧有解析结果，只有有解析结果的类别参与跟踪
+  void AddOutput(int32_t output_index);
+  bool HasOutput(int32_t output_index) const;
+
+  // 将模型输入坐标系下的检测框映射回原图并裁剪到图像范围内，
+  // 加入output_index类别的跟踪输入
+  void AddBox(int32_t output_index,
+              float left,
+              float top,
+              float right,
+              float bottom,
+              float conf,
+              const ImageTransform& transform,
+              int img_width,
+              int img_height);
+
+  // 加入一个人体的关键点，坐标映射回原图
+  template <typename LmkList>
+  void AddBodyKps(const LmkList& lmks, const ImageTransform& transform) {
+    if (body_kps_num_ == body_kps_.size()) {
+      body_kps_.emplace_back();
+      body_kps_.back().set__type(kBodyKpsType);
+    }
+    auto& kps = body_kps_[body_kps_num_++];
+    kps.point.resize(lmks.size());
+    kps.confidence.resize(lmks.size());
+    for (size_t idx = 0; idx < lmks.size(); idx++) {
+      kps.point[idx].set__x(transform.ToSrcX(lmks[idx].x));
+      kps.point[idx].set__y(transform.ToSrcY(lmks[idx].y));
+      kps.confidence[idx] = lmks[idx].score;
+    }
+  }
+
+  // 加入一帧的模型解析结果：box_outputs_index中每个类别的检测框，以及人体关键点
+  // results按照模型输出index存放检测框，为空的类别跳过，lmk_result可以为nullptr
+  // index超出results或者不是检测框类别时返回-1
+  template <typename ResultList, typename LmkResult>
+  int AddParseResults(const ResultList& results,
+                      const LmkResult* lmk_result,
+                      const std::vector<int32_t>& box_outputs_index,
+                      const ImageTransform& transform,
+                      int img_width,
+                      int img_height) {
+    for (const auto& idx : box_outputs_index) {
+      if (idx < 0 || static_cast<size_t>(idx) >= results.size() ||
+          box_outputs_index_type_.find(idx) == box_outputs_index_type_.end()) {
+        return -1;
+      }
+      const auto& result = results[idx];
+      if (!result) {
+        continue;
+      }
+      AddOutput(idx);
+      for (const auto& rect : result->boxes) {
+        AddBox(idx,
+               rect.left,
+               rect.top,
+               rect.right,
+               rect.bottom,
+               rect.conf,
+               transform,
+               img_width,
+               img_height);
+      }
+    }
+    if (lmk_result) {
+      for (const auto& value : lmk_result->values) {
+        AddBodyKps(value, transform);
+      }
+    }
+    return 0;
+  }
+
+  // 打开后人头、人脸、人手框关联到所属的人体框，每个人体输出一个包含所有框的target，
+  // target的track_id为人体框的跟踪id，没有关联到人体的部位框单独输出
+  void SetPartAssociation(bool enable) { part_association_ = enable; }
+
+  RoiMap& InRois() { return in_rois_; }
+  RoiMap& OutRois() { return out_rois_; }
+  DisappearedMap& OutDisappearedIds() { return out_disappeared_ids_; }
+
+  // 跟踪本帧有解析结果并且hobot_mots中有对应类别跟踪实例的类别，结果写入OutRois和
+  // OutDisappearedIds。各个类别相互独立，分发到runner上并发执行，跟踪失败的类别
+  // 清空输出。hobot_mots为空时返回-1
+  int Track(ParallelRunner& runner,
+            MotMap& hobot_mots,
+            time_t time_stamp,
+            int img_width,
+            int img_height);
+  // 上一次Track执行的跟踪任务
+  const std::vector<MotJob>& MotJobs() const { return mot_jobs_; }
+
+  // 根据跟踪结果填充targets和disappeared_targets，跳过无效id的检测框
+  // 覆盖msg中已有的targets和disappeared_targets，复用其中元素的内存，
+  // 同一个msg逐帧复用时稳定后不再申请内存。logger不为空时输出被跳过的检测框
+  void Build(ai_msgs::msg::PerceptionTargets& msg, AsyncLogger* logger);
+
+ private:
+  static const std::string kPersonType;
+  static const std::string kBodyKpsType;
+
+  const std::string& RoiType(int32_t output_index) const;
+  // 跟踪id无效时返回false，logger不为空时输出该检测框
+  bool IsValid(const MotBox& rect, AsyncLogger* logger) const;
+  // 加入一个只有rect一个框的target，kps不为空时加入人体关键点
+  ai_msgs::msg::Target& AddTarget(ai_msgs::msg::PerceptionTargets& msg,
+                                  const MotBox& rect,
+                                  const std::string& roi_type,
+                                  const ai_msgs::msg::Point* kps);
+  void BuildAssociated(ai_msgs::msg::PerceptionTargets& msg,
+                       AsyncLogger* logger);
+
+  std::unordered_map<int32_t, std::string> box_outputs_index_type_;
+  int32_t body_box_output_index_ = 0;
+
+  // key为模型输出index，帧之间只清空vector，不删除key
+  RoiMap in_rois_;
+  RoiMap out_rois_;
+  // 本帧有解析结果的类别
+  std::vector<int32_t> active_outputs_;
+  DisappearedMap out_disappeared_ids_;
+  std::vector<ai_msgs::msg::Point> body_kps_;
+  size_t body_kps_num_ = 0;
+
+  bool part_association_ = false;
+  PartAssociator part_associator_;
+  // 参与关联的部位类别，按照模型输出index排序
+  std::vector<std::pair<int32_t, PartAssociator::PartType>> part_outputs_;
+  // 关联时加入的每个人体框对应的target在msg中的位置
+  std::vector<size_t> body_targets_;
+  // 关联时加入的每个部位框和类型
+  std::vector<std::pair<const MotBox*, const std::string*>> part_rects_;
+
+  std::vector<MotJob> mot_jobs_;
+  // Build中已经写入msg的target数量，之后的元素是上一帧留下的
+  size_t targets_num_ = 0;
+  size_t disappeared_num_ = 0;
+  // msg中本帧多出的元素移到这里保留内存，之后的帧再取回
+  std::vector<ai_msgs::msg::Target> spare_targets_;
+};
+
+#endif  // MONO2D_DET_TARGET_BUILDER_H
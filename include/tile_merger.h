@@ -0,0 +1,127 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_TILE_MERGER_H
+#define MONO2D_DET_TILE_MERGER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 原图中的一个tile区域，起始坐标和宽高都是偶数
+struct TileRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// 将高分辨率原图切分为相互重叠的tile分别推理
+class TileLayout {
+ public:
+  // 每帧最多的tile数（不包括整图）
+  static constexpr int kMaxTileCols = 8;
+  static constexpr int kMaxTileRows = 8;
+
+  // 按照cols x rows切分原图，相邻tile至少重叠overlap个像素，tile在原图中均匀分布
+  // cols或者rows为0时tile的宽或者高等于模型输入（不缩放），个数由原图大小决定
+  // with_full_frame为true时最后追加一个覆盖整图的tile，用于检测跨越多个tile的大目标
+  static void Compute(int img_height,
+                      int img_width,
+                      int model_height,
+                      int model_width,
+                      int cols,
+                      int rows,
+                      int overlap,
+                      bool with_full_frame,
+                      std::vector<TileRect>& tiles);
+};
+
+// 合并一帧所有tile映射回原图坐标的检测框和人体关键点
+// 按照类别做NMS去除重叠区域的重复检测，被tile边界截断的检测框与相邻tile的检测框合并
+// 帧之间复用已经申请的内存，只在一个线程中使用
+class TileMerger {
+ public:
+  struct Point {
+    float x;
+    float y;
+    float score;
+  };
+
+  struct Box {
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+    float score;
+    int tile;
+    // 人体关键点在本帧关键点中的index，没有关键点时为-1
+    int kps;
+    // 检测框的边缘靠近tile内部的切分边界，可能只是目标的一部分
+    bool truncated;
+  };
+
+  explicit TileMerger(const std::vector<int32_t>& output_indexes);
+
+  // 开始新的一帧，tiles为本帧的tile划分
+  void Reset(const std::vector<TileRect>& tiles, int img_height, int img_width);
+
+  // 加入tile中的一个原图坐标系下的检测框，返回检测框在该类别中的index
+  size_t AddBox(int32_t output_index,
+                int tile,
+                float x1,
+                float y1,
+                float x2,
+                float y2,
+                float score);
+
+  // 为output_index类别的第box_index个检测框加入人体关键点，坐标为原图坐标系
+  // 返回关键点的存储位置，由调用者填充
+  std::vector<Point>& AddKps(int32_t output_index, size_t box_index);
+
+  // 按照类别合并，iou不小于iou_threshold的检测框只保留置信度最高的一个
+  // 来自不同tile且至少一个被截断的检测框，交集占较小框的比例不小于阈值时合并为外接框
+  void Merge(float iou_threshold);
+
+  // 合并后output_index类别保留的检测框，按照置信度从高到低排列
+  const std::vector<Box>& Boxes(int32_t output_index) const;
+  // 检测框对应的人体关键点，没有关键点时返回空列表
+  const std::vector<Point>& Kps(const Box& box) const;
+
+ private:
+  // 检测框的边缘与tile内部切分边界的距离小于该值时认为被截断
+  static constexpr float kSeamMargin = 4.0f;
+  // 截断的检测框与其他tile检测框的交集占较小框的比例阈值
+  static constexpr float kSeamIosThreshold = 0.6f;
+
+  bool IsTruncated(int tile, float x1, float y1, float x2, float y2) const;
+  void MergeBoxes(std::vector<Box>& boxes, float iou_threshold);
+
+  std::vector<TileRect> tiles_;
+  int img_height_ = 0;
+  int img_width_ = 0;
+  // key为模型输出index，帧之间只清空vector，不删除key
+  std::unordered_map<int32_t, std::vector<Box>> boxes_;
+  std::vector<std::vector<Point>> kps_;
+  size_t kps_num_ = 0;
+  const std::vector<Point> empty_kps_;
+  // 合并使用的临时数据
+  std::vector<size_t> order_;
+  std::vector<float> areas_;
+  std::vector<uint8_t> suppressed_;
+  std::vector<Box> kept_;
+};
+
+#endif  // MONO2D_DET_TILE_MERGER_H
@@ -0,0 +1,109 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_TRACK_PREDICTOR_H
+#define MONO2D_DET_TRACK_PREDICTOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ai_msgs/msg/perception_targets.hpp"
+
+// 每N帧推理一次时，根据推理帧的跟踪结果预测中间帧的目标位置
+// 每条轨迹的中心点x、中心点y、宽、高独立使用匀速模型的卡尔曼滤波，时间单位为帧
+// 每路输入一个实例，只在该路输入的输出排序回调中使用
+class TrackPredictor {
+ public:
+  // 预测的目标带有该类型的属性，value为距离上一次推理的帧数
+  static const std::string kPredictedAttrType;
+
+  // max_interval：两次推理之间最多间隔的帧数（包括推理帧）
+  // adaptive：根据目标运动和预测的不确定度缩短推理间隔，
+  // 只使用gate_roi_type类别（如body）的轨迹判断
+  TrackPredictor(int max_interval, bool adaptive, std::string gate_roi_type);
+
+  // 使用推理帧发布的目标更新轨迹，没有出现在msg中的轨迹被删除
+  // time_stamp_ms为图片时间戳，单位毫秒
+  void Update(const ai_msgs::msg::PerceptionTargets& msg,
+              uint64_t time_stamp_ms,
+              int img_width,
+              int img_height);
+
+  // 预测time_stamp_ms时刻所有轨迹的目标框、关联的部位框和人体关键点，加入msg的targets
+  void Predict(uint64_t time_stamp_ms, ai_msgs::msg::PerceptionTargets& msg);
+
+  // 下一帧推理之前可以预测的帧数加1，即下一次推理的间隔，最小为1
+  int NextInterval() const { return next_interval_; }
+
+  size_t TrackNum() const { return tracks_.size(); }
+
+ private:
+  static constexpr int kDim = 4;
+  // 连续推理更新的次数达到该值之前，速度估计不可靠，不延长推理间隔
+  static constexpr int kMinHits = 3;
+  // 预测的中心点位移不超过目标高度的该比例时才可以跳过推理
+  static constexpr float kMaxShiftRatio = 0.5f;
+  // 预测中心点的标准差不超过目标高度的该比例时才可以跳过推理
+  static constexpr float kMaxStdRatio = 0.15f;
+
+  // 目标中第一个框以外的框（如关联到人体的人头、人手框）
+  struct PartRoi {
+    std::string type;
+    // 左上右下坐标，相对目标框中心归一化到目标框宽高
+    float box[4];
+  };
+
+  struct Track {
+    uint64_t track_id = 0;
+    std::string target_type;
+    std::string roi_type;
+    float pos[kDim];
+    float vel[kDim];
+    // 每一维2x2协方差矩阵的三个元素
+    float cov_pp[kDim];
+    float cov_pv[kDim];
+    float cov_vv[kDim];
+    int hits = 0;
+    bool updated = false;
+    // 关键点坐标相对目标框中心归一化到目标框宽高，预测时随目标框平移缩放
+    std::vector<ai_msgs::msg::Point> points;
+    std::vector<PartRoi> part_rois;
+  };
+
+  Track* FindTrack(uint64_t track_id, const std::string& roi_type);
+  void InitTrack(Track& track, const float* measure);
+  void PredictTrack(Track& track, float dt) const;
+  void UpdateTrack(Track& track, const float* measure) const;
+  void SavePoints(Track& track, const ai_msgs::msg::Target& target) const;
+  void SavePartRois(Track& track, const ai_msgs::msg::Target& target) const;
+  // 返回轨迹在推理间隔内预测可靠的最大帧数加1
+  int TrackInterval(const Track& track) const;
+  void ComputeNextInterval();
+
+  const int max_interval_;
+  const bool adaptive_;
+  const std::string gate_roi_type_;
+  std::vector<Track> tracks_;
+  uint64_t last_time_stamp_ms_ = 0;
+  // 相邻两帧的时间间隔，使用推理帧之间的时间和帧数平滑估计
+  float frame_gap_ms_ = 0;
+  // 上一次推理以来预测的帧数
+  int predicted_frames_ = 0;
+  int img_width_ = 0;
+  int img_height_ = 0;
+  int next_interval_ = 1;
+};
+
+#endif  // MONO2D_DET_TRACK_PREDICTOR_H
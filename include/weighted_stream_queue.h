@@ -0,0 +1,157 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_WEIGHTED_STREAM_QUEUE_H
+#define MONO2D_DET_WEIGHTED_STREAM_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "include/pipeline_queue.h"
+
+// 多路输入共用的有界队列，每路输入一个子队列
+// 出队时在非空的子队列之间按照权重平滑轮询（smooth weighted round-robin），
+// 权重相同时退化为公平轮询
+template <typename T>
+class WeightedStreamQueue {
+ public:
+  using Stats = typename PipelineQueue<T>::Stats;
+
+  // weights的个数为输入路数，capacity为每路子队列的长度
+  WeightedStreamQueue(const std::vector<int> &weights, size_t capacity)
+      : capacity_(capacity), streams_(weights.size()) {
+    for (size_t idx = 0; idx < weights.size(); idx++) {
+      streams_[idx].weight = weights[idx] > 0 ? weights[idx] : 1;
+    }
+  }
+
+  size_t StreamNum() const { return streams_.size(); }
+
+  // 子队列已满或者已停止时返回false
+  bool TryPush(size_t stream, T &&item) {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      auto &sub = streams_[stream];
+      if (stopped_ || sub.queue.size() >= capacity_) {
+        sub.rejected++;
+        return false;
+      }
+      PushLocked(sub, std::move(item));
+    }
+    cv_.notify_one();
+    return true;
+  }
+
+  // 子队列已满时丢弃最早的数据（通过dropped返回），返回是否有数据被丢弃
+  bool PushDropOldest(size_t stream, T &&item, T &dropped) {
+    bool has_dropped = false;
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      if (stopped_) {
+        return false;
+      }
+      auto &sub = streams_[stream];
+      if (sub.queue.size() >= capacity_ && !sub.queue.empty()) {
+        dropped = std::move(sub.queue.front());
+        sub.queue.pop_front();
+        sub.rejected++;
+        has_dropped = true;
+      }
+      PushLocked(sub, std::move(item));
+    }
+    cv_.notify_one();
+    return has_dropped;
+  }
+
+  // 阻塞等待任意一路有数据，已停止时返回false
+  bool Pop(T &item) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    cv_.wait(lk, [this] { return stopped_ || total_size_ > 0; });
+    if (stopped_) {
+      return false;
+    }
+    int total_weight = 0;
+    SubQueue *selected = nullptr;
+    for (auto &sub : streams_) {
+      if (sub.queue.empty()) {
+        continue;
+      }
+      sub.current_weight += sub.weight;
+      total_weight += sub.weight;
+      if (!selected || sub.current_weight > selected->current_weight) {
+        selected = &sub;
+      }
+    }
+    selected->current_weight -= total_weight;
+    item = std::move(selected->queue.front());
+    selected->queue.pop_front();
+    total_size_--;
+    return true;
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      stopped_ = true;
+      for (auto &sub : streams_) {
+        sub.queue.clear();
+      }
+      total_size_ = 0;
+    }
+    cv_.notify_all();
+  }
+
+  Stats GetStats(size_t stream) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    const auto &sub = streams_[stream];
+    Stats stats;
+    stats.depth = sub.queue.size();
+    stats.high_water_mark = sub.high_water_mark;
+    stats.pushed = sub.pushed;
+    stats.rejected = sub.rejected;
+    return stats;
+  }
+
+ private:
+  struct SubQueue {
+    std::deque<T> queue;
+    int weight = 1;
+    int current_weight = 0;
+    size_t high_water_mark = 0;
+    uint64_t pushed = 0;
+    uint64_t rejected = 0;
+  };
+
+  void PushLocked(SubQueue &sub, T &&item) {
+    sub.queue.push_back(std::move(item));
+    total_size_++;
+    sub.pushed++;
+    if (sub.queue.size() > sub.high_water_mark) {
+      sub.high_water_mark = sub.queue.size();
+    }
+  }
+
+  const size_t capacity_;
+  std::vector<SubQueue> streams_;
+  size_t total_size_ = 0;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+};
+
+#endif  // MONO2D_DET_WEIGHTED_STREAM_QUEUE_H
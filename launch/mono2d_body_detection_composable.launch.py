@@ -0,0 +1,81 @@
+# Copyright (c) 2022，Horizon Robotics.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from launch import LaunchDescription
+from launch.actions import DeclareLaunchArgument
+from launch.conditions import IfCondition, UnlessCondition
+from launch.substitutions import LaunchConfiguration, PythonExpression
+from launch_ros.actions import ComposableNodeContainer, LoadComposableNodes
+from launch_ros.descriptions import ComposableNode
+
+
+def body_det_node():
+    # 打开进程内通信，同一容器中的订阅者直接拿到发布的消息，不经过序列化
+    return ComposableNode(
+        package='mono2d_body_detection',
+        plugin='Mono2dBodyDetNode',
+        name='mono2d_body_det',
+        parameters=[
+            {"is_shared_mem_sub": LaunchConfiguration('is_shared_mem_sub')},
+            {"ai_msg_pub_topic_name": LaunchConfiguration(
+                'mono2d_body_pub_topic')}
+        ],
+        extra_arguments=[{'use_intra_process_comms': True}]
+    )
+
+
+def generate_launch_description():
+    container_arg = DeclareLaunchArgument(
+        'container',
+        default_value='',
+        description='load into an existing component container, '
+                    'empty to start a new one')
+    shared_mem_sub_arg = DeclareLaunchArgument(
+        'is_shared_mem_sub',
+        default_value='1',
+        description='subscribe images with shared mem')
+    mono2d_body_pub_topic_arg = DeclareLaunchArgument(
+        'mono2d_body_pub_topic',
+        default_value='/hobot_mono2d_body_detection',
+        description='mono2d body ai message publish topic')
+
+    new_container = PythonExpression(
+        ["'", LaunchConfiguration('container'), "' == ''"])
+
+    # 订阅回调和定时统计在不同的callback group中并行执行，需要使用多线程容器
+    container = ComposableNodeContainer(
+        name='mono2d_body_det_container',
+        namespace='',
+        package='rclcpp_components',
+        executable='component_container_mt',
+        composable_node_descriptions=[body_det_node()],
+        output='screen',
+        arguments=['--ros-args', '--log-level', 'warn'],
+        condition=IfCondition(new_container)
+    )
+
+    # 加载到相机或者下游节点所在的容器中
+    load_into_container = LoadComposableNodes(
+        target_container=LaunchConfiguration('container'),
+        composable_node_descriptions=[body_det_node()],
+        condition=UnlessCondition(new_container)
+    )
+
+    return LaunchDescription([
+        container_arg,
+        shared_mem_sub_arg,
+        mono2d_body_pub_topic_arg,
+        container,
+        load_into_container
+    ])
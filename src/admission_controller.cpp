@@ -0,0 +1,121 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/admission_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 指数滑动平均的权重
+const float kEmaAlpha = 0.1f;
+// EVERY_NTH模式下N的上限
+const int kMaxKeepEveryN = 30;
+}  // namespace
+
+AdmissionController::AdmissionController(Mode mode, int max_busy)
+    : mode_(mode), max_busy_(std::max(1, max_busy)) {}
+
+bool AdmissionController::Admit() {
+  std::lock_guard<std::mutex> lk(mtx_);
+  if (mode_ == Mode::EVERY_NTH) {
+    auto now = std::chrono::steady_clock::now();
+    if (has_last_input_) {
+      float interval_ms =
+          std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                                last_input_)
+              .count() /
+          1000.0f;
+      input_interval_ms_ =
+          input_interval_ms_ > 0
+              ? input_interval_ms_ + kEmaAlpha * (interval_ms - input_interval_ms_)
+              : interval_ms;
+    }
+    last_input_ = now;
+    has_last_input_ = true;
+    if (frame_count_++ % keep_every_n_ != 0) {
+      dropped_nth_++;
+      return false;
+    }
+  }
+  admitted_++;
+  return true;
+}
+
+void AdmissionController::OnLatestDrop() {
+  std::lock_guard<std::mutex> lk(mtx_);
+  dropped_latest_++;
+}
+
+bool AdmissionController::AcquireSlot() {
+  if (mode_ != Mode::LATEST_ONLY) {
+    return true;
+  }
+  std::unique_lock<std::mutex> lk(mtx_);
+  cv_.wait(lk, [this] { return stopped_ || busy_ < max_busy_; });
+  if (stopped_) {
+    return false;
+  }
+  busy_++;
+  return true;
+}
+
+void AdmissionController::ReleaseSlot() {
+  if (mode_ != Mode::LATEST_ONLY) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (busy_ > 0) {
+      busy_--;
+    }
+  }
+  cv_.notify_one();
+}
+
+void AdmissionController::UpdateInferTime(float infer_ms, float concurrency) {
+  if (mode_ != Mode::EVERY_NTH || infer_ms < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(mtx_);
+  infer_ms_ = infer_ms_ > 0 ? infer_ms_ + kEmaAlpha * (infer_ms - infer_ms_)
+                            : infer_ms;
+  if (input_interval_ms_ <= 0) {
+    return;
+  }
+  // 推理能够持续处理的帧间隔为单帧耗时除以并发数
+  float infer_interval_ms =
+      concurrency > 0 ? infer_ms_ / concurrency : infer_ms_;
+  int keep_every_n =
+      static_cast<int>(std::ceil(infer_interval_ms / input_interval_ms_));
+  keep_every_n_ = std::max(1, std::min(keep_every_n, kMaxKeepEveryN));
+}
+
+void AdmissionController::Stop() {
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+}
+
+AdmissionController::Stats AdmissionController::GetStats() {
+  std::lock_guard<std::mutex> lk(mtx_);
+  Stats stats;
+  stats.admitted = admitted_;
+  stats.dropped_latest = dropped_latest_;
+  stats.dropped_nth = dropped_nth_;
+  stats.keep_every_n = keep_every_n_;
+  return stats;
+}
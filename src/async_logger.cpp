@@ -0,0 +1,94 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/async_logger.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <utility>
+
+AsyncLogger::AsyncLogger(Sink sink, size_t capacity) : sink_(std::move(sink)) {
+  capacity_ = 1;
+  while (capacity_ < capacity) {
+    capacity_ <<= 1;
+  }
+  mask_ = capacity_ - 1;
+  slots_.reset(new Slot[capacity_]);
+  for (size_t idx = 0; idx < capacity_; idx++) {
+    slots_[idx].seq.store(idx, std::memory_order_relaxed);
+  }
+  consumer_ = std::thread([this] { Consume(); });
+}
+
+AsyncLogger::~AsyncLogger() {
+  stopped_ = true;
+  if (consumer_.joinable()) {
+    consumer_.join();
+  }
+}
+
+bool AsyncLogger::Log(const char* fmt, ...) {
+  uint64_t pos = tail_.load(std::memory_order_relaxed);
+  Slot* slot = nullptr;
+  while (true) {
+    slot = &slots_[pos & mask_];
+    uint64_t seq = slot->seq.load(std::memory_order_acquire);
+    int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+    if (diff == 0) {
+      if (tail_.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // 后台线程还没有输出该槽位上一轮的日志，缓存已满
+      dropped_++;
+      return false;
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(slot->line, kLineSize, fmt, args);
+  va_end(args);
+  slot->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+void AsyncLogger::Flush() {
+  uint64_t tail = tail_.load();
+  while (head_.load() < tail && !stopped_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+void AsyncLogger::Consume() {
+  while (true) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[head & mask_];
+    if (slot.seq.load(std::memory_order_acquire) == head + 1) {
+      sink_(slot.line);
+      slot.seq.store(head + capacity_, std::memory_order_release);
+      head_.store(head + 1);
+      continue;
+    }
+    if (stopped_) {
+      break;
+    }
+    // 写入端不做任何通知，空闲时轮询
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/det_result_packer.h"
+
+#include <algorithm>
+#include <string>
+
+namespace {
+
+using BodyDetectionResult = mono2d_body_detection::msg::BodyDetectionResult;
+
+uint8_t ClassId(const std::string& roi_type) {
+  if (roi_type == "body") {
+    return BodyDetectionResult::CLASS_BODY;
+  } else if (roi_type == "head") {
+    return BodyDetectionResult::CLASS_HEAD;
+  } else if (roi_type == "face") {
+    return BodyDetectionResult::CLASS_FACE;
+  } else if (roi_type == "hand") {
+    return BodyDetectionResult::CLASS_HAND;
+  }
+  return BodyDetectionResult::CLASS_UNKNOWN;
+}
+
+}  // namespace
+
+void PackDetectionResult(const ai_msgs::msg::PerceptionTargets& msg,
+                         uint32_t img_width,
+                         uint32_t img_height,
+                         bool is_predicted,
+                         BodyDetectionResult& result) {
+  result.stamp = msg.header.stamp;
+  result.img_width = img_width;
+  result.img_height = img_height;
+  result.is_predicted = is_predicted ? 1 : 0;
+
+  uint32_t box_num = 0;
+  uint32_t dropped_box_num = 0;
+  for (size_t target_idx = 0; target_idx < msg.targets.size(); target_idx++) {
+    const auto& target = msg.targets[target_idx];
+    for (const auto& roi : target.rois) {
+      if (box_num >= BodyDetectionResult::MAX_BOX_NUM) {
+        dropped_box_num++;
+        continue;
+      }
+      uint32_t idx = box_num++;
+      const auto& rect = roi.rect;
+      result.boxes[4 * idx] = static_cast<float>(rect.x_offset);
+      result.boxes[4 * idx + 1] = static_cast<float>(rect.y_offset);
+      result.boxes[4 * idx + 2] =
+          static_cast<float>(rect.x_offset + rect.width);
+      result.boxes[4 * idx + 3] =
+          static_cast<float>(rect.y_offset + rect.height);
+      result.class_ids[idx] = ClassId(roi.type);
+      result.track_ids[idx] = target.track_id;
+      result.scores[idx] = roi.confidence;
+      result.target_indices[idx] = static_cast<uint16_t>(target_idx);
+
+      // 人体关键点属于target中的人体框
+      bool with_kps =
+          result.class_ids[idx] == BodyDetectionResult::CLASS_BODY &&
+          !target.points.empty();
+      result.has_kps[idx] = with_kps ? 1 : 0;
+      if (!with_kps) {
+        continue;
+      }
+      // 关键点不足KPS_NUM个时其余补0
+      const auto& points = target.points.front();
+      constexpr size_t kKpsNum = BodyDetectionResult::KPS_NUM;
+      float* kps = result.kps.data() + idx * kKpsNum * 3;
+      std::fill(kps, kps + kKpsNum * 3, 0.0f);
+      size_t kps_num = std::min(kKpsNum, points.point.size());
+      for (size_t kp = 0; kp < kps_num; kp++) {
+        kps[3 * kp] = points.point[kp].x;
+        kps[3 * kp + 1] = points.point[kp].y;
+        if (kp < points.confidence.size()) {
+          kps[3 * kp + 2] = points.confidence[kp];
+        }
+      }
+    }
+  }
+  result.box_num = box_num;
+  result.dropped_box_num = dropped_box_num;
+}
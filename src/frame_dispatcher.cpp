@@ -0,0 +1,110 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/frame_dispatcher.h"
+
+#include <thread>
+#include <utility>
+
+FrameDispatcher::FrameDispatcher(
+    std::shared_ptr<OutputReorderBuffer> output_reorder_buffer,
+    std::shared_ptr<AdmissionController> admission_controller,
+    bool predict,
+    std::shared_ptr<MotionGate> motion_gate,
+    bool republish,
+    std::shared_ptr<StageLatency> stage_latency)
+    : output_reorder_buffer_(std::move(output_reorder_buffer)),
+      admission_controller_(std::move(admission_controller)),
+      predict_(predict),
+      motion_gate_(std::move(motion_gate)),
+      republish_(republish),
+      stage_latency_(std::move(stage_latency)) {}
+
+FrameDispatcher::Action FrameDispatcher::Dispatch(const LumaPlane& luma,
+                                                  uint64_t& frame_seq) {
+  if (ShouldPredict()) {
+    // 跳过推理的帧不占用流水线，按照输入顺序在推理帧之后发布
+    predicted_++;
+    frame_seq = output_reorder_buffer_->Register();
+    return Action::PREDICT;
+  }
+  if (motion_gate_ && !CheckMotion(luma)) {
+    if (!republish_) {
+      return Action::DROP;
+    }
+    frame_seq = output_reorder_buffer_->Register();
+    return Action::REPUBLISH;
+  }
+  if (!admission_controller_->Admit()) {
+    return Action::DROP;
+  }
+  frames_since_detect_ = 0;
+  frame_seq = output_reorder_buffer_->Register();
+  return Action::INFER;
+}
+
+void FrameDispatcher::SetDetectInterval(int detect_interval) {
+  detect_interval_ = detect_interval;
+}
+
+FrameDispatcher::Stats FrameDispatcher::GetStats() const {
+  Stats stats;
+  stats.predicted = predicted_.load();
+  return stats;
+}
+
+bool FrameDispatcher::WaitDrained(
+    const std::vector<std::shared_ptr<FrameDispatcher>>& dispatchers,
+    std::chrono::milliseconds timeout,
+    const std::atomic<bool>& stopped) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!stopped) {
+    bool drained = true;
+    for (const auto& dispatcher : dispatchers) {
+      if (!dispatcher->output_reorder_buffer_->Drained()) {
+        drained = false;
+        break;
+      }
+    }
+    if (drained) {
+      return true;
+    }
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+bool FrameDispatcher::ShouldPredict() {
+  if (!predict_) {
+    return false;
+  }
+  return ++frames_since_detect_ < detect_interval_.load();
+}
+
+bool FrameDispatcher::CheckMotion(const LumaPlane& luma) {
+  if (!luma.data) {
+    return true;
+  }
+  uint64_t start_ns = LatencyHistogram::NowNs();
+  bool motion = motion_gate_->Check(
+      luma.data, luma.pixel_stride, luma.step, luma.height, luma.width);
+  if (stage_latency_) {
+    stage_latency_->Record(StageLatency::Stage::MOTION_GATE,
+                           LatencyHistogram::NowNs() - start_ns);
+  }
+  return motion;
+}
@@ -0,0 +1,244 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/frame_replay.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace frame_replay {
+
+namespace {
+
+const char kMagic[8] = {'M', '2', 'D', 'R', 'P', 'L', 'Y', '1'};
+
+size_t AlignData(size_t size) { return (size + 7) & ~static_cast<size_t>(7); }
+
+}  // namespace
+
+ReplayFile::~ReplayFile() {
+  if (addr_) {
+    munmap(addr_, size_);
+  }
+}
+
+int ReplayFile::Open(const std::string& file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "open replay file " << file_name << " fail" << std::endl;
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+    std::cerr << "invalid replay file " << file_name << std::endl;
+    close(fd);
+    return -1;
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  addr_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr_ == MAP_FAILED) {
+    addr_ = nullptr;
+    std::cerr << "mmap replay file " << file_name << " fail" << std::endl;
+    return -1;
+  }
+  // 按照顺序回放，提示内核预读
+  madvise(addr_, size_, MADV_SEQUENTIAL);
+
+  const uint8_t* base = static_cast<const uint8_t*>(addr_);
+  FileHeader header;
+  memcpy(&header, base, sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    std::cerr << "invalid replay file magic " << file_name << std::endl;
+    return -1;
+  }
+  header.encoding[sizeof(header.encoding) - 1] = '\0';
+  encoding_ = header.encoding;
+  width_ = static_cast<int>(header.width);
+  height_ = static_cast<int>(header.height);
+  step_ = static_cast<int>(header.step);
+
+  frames_.clear();
+  if (header.frame_count > 0) {
+    frames_.reserve(header.frame_count);
+  }
+  size_t offset = sizeof(FileHeader);
+  while (offset + sizeof(FrameHeader) <= size_) {
+    FrameHeader frame_header;
+    memcpy(&frame_header, base + offset, sizeof(frame_header));
+    offset += sizeof(FrameHeader);
+    if (offset + frame_header.data_size > size_) {
+      // 录制中断时最后一帧可能不完整
+      break;
+    }
+    Frame frame;
+    frame.timestamp_ns = frame_header.timestamp_ns;
+    frame.data = base + offset;
+    frame.data_size = frame_header.data_size;
+    frames_.push_back(frame);
+    offset += AlignData(frame_header.data_size);
+    if (header.frame_count > 0 && frames_.size() >= header.frame_count) {
+      break;
+    }
+  }
+  if (frames_.empty()) {
+    std::cerr << "no frame in replay file " << file_name << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+RecordFile::~RecordFile() { Close(); }
+
+int RecordFile::Open(const std::string& file_name, size_t queue_size) {
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    file_ = fopen(file_name.c_str(), "wb");
+    if (!file_) {
+      std::cerr << "open record file " << file_name << " fail" << std::endl;
+      return -1;
+    }
+    memset(&header_, 0, sizeof(header_));
+    memcpy(header_.magic, kMagic, sizeof(kMagic));
+    header_written_ = false;
+  }
+  if (queue_size > 0) {
+    {
+      std::lock_guard<std::mutex> lk(queue_mtx_);
+      queue_size_ = queue_size;
+      stopped_ = false;
+    }
+    writer_ = std::thread([this] { Consume(); });
+  }
+  return 0;
+}
+
+int RecordFile::Write(uint64_t timestamp_ns,
+                      const std::string& encoding,
+                      int width,
+                      int height,
+                      int step,
+                      const uint8_t* data,
+                      uint32_t data_size) {
+  std::lock_guard<std::mutex> lk(mtx_);
+  if (!file_) {
+    return -1;
+  }
+  if (!header_written_) {
+    if (encoding.size() >= sizeof(header_.encoding)) {
+      std::cerr << "invalid record encoding " << encoding << std::endl;
+      return -1;
+    }
+    header_.width = static_cast<uint32_t>(width);
+    header_.height = static_cast<uint32_t>(height);
+    header_.step = static_cast<uint32_t>(step);
+    memcpy(header_.encoding, encoding.c_str(), encoding.size());
+    if (fwrite(&header_, sizeof(header_), 1, file_) != 1) {
+      return -1;
+    }
+    header_written_ = true;
+  } else if (encoding != header_.encoding ||
+             static_cast<uint32_t>(width) != header_.width ||
+             static_cast<uint32_t>(height) != header_.height ||
+             static_cast<uint32_t>(step) != header_.step) {
+    // 回放时所有帧使用文件头中的step，不一致的帧不能写入
+    return -1;
+  }
+
+  FrameHeader frame_header;
+  frame_header.timestamp_ns = timestamp_ns;
+  frame_header.data_size = data_size;
+  frame_header.reserved = 0;
+  static const uint8_t kZeros[8] = {0};
+  size_t padding = AlignData(data_size) - data_size;
+  if (fwrite(&frame_header, sizeof(frame_header), 1, file_) != 1 ||
+      fwrite(data, 1, data_size, file_) != data_size ||
+      fwrite(kZeros, 1, padding, file_) != padding) {
+    return -1;
+  }
+  header_.frame_count++;
+  return 0;
+}
+
+bool RecordFile::Push(PendingFrame frame) {
+  {
+    std::lock_guard<std::mutex> lk(queue_mtx_);
+    if (stopped_ || !writer_.joinable() || queue_.size() >= queue_size_) {
+      dropped_++;
+      return false;
+    }
+    queue_.push_back(std::move(frame));
+  }
+  queue_cv_.notify_one();
+  return true;
+}
+
+void RecordFile::Consume() {
+  while (true) {
+    PendingFrame frame;
+    {
+      std::unique_lock<std::mutex> lk(queue_mtx_);
+      queue_cv_.wait(lk, [this] { return !queue_.empty() || stopped_; });
+      if (queue_.empty()) {
+        break;
+      }
+      frame = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    if (Write(frame.timestamp_ns,
+              frame.encoding,
+              frame.width,
+              frame.height,
+              frame.step,
+              frame.data,
+              frame.data_size) != 0) {
+      if (failed_++ == 0) {
+        std::cerr << "record frame fail, encoding: " << frame.encoding
+                  << ", w: " << frame.width << ", h: " << frame.height
+                  << ", step: " << frame.step << std::endl;
+      }
+    }
+  }
+}
+
+void RecordFile::Close() {
+  {
+    std::lock_guard<std::mutex> lk(queue_mtx_);
+    stopped_ = true;
+  }
+  queue_cv_.notify_all();
+  // 后台线程退出之前写完队列中的帧
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  std::lock_guard<std::mutex> lk(mtx_);
+  if (!file_) {
+    return;
+  }
+  if (header_written_) {
+    fseek(file_, 0, SEEK_SET);
+    fwrite(&header_, sizeof(header_), 1, file_);
+  }
+  fclose(file_);
+  file_ = nullptr;
+}
+
+}  // namespace frame_replay
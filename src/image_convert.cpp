@@ -0,0 +1,1314 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/image_convert.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define IMAGE_CONVERT_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGE_CONVERT_SSE2
+#endif
+
+namespace {
+
+// 缩放使用8bit定点权重
+const int kWeightBits = 8;
+const int kWeightScale = 1 << kWeightBits;
+const int kWeightHalf = kWeightScale >> 1;
+
+// 一个方向上的双线性插值表，idx为乘以通道数后的元素偏移
+struct LinearTable {
+  std::vector<int32_t> idx0;
+  std::vector<int32_t> idx1;
+  // idx1的权重，idx0的权重为kWeightScale - weight
+  std::vector<int32_t> weight;
+};
+
+// 坐标映射方式与cv::resize INTER_LINEAR一致
+void BuildLinearTable(int src_len, int dst_len, int cn, LinearTable &table) {
+  table.idx0.resize(dst_len);
+  table.idx1.resize(dst_len);
+  table.weight.resize(dst_len);
+  double scale = static_cast<double>(src_len) / dst_len;
+  for (int d = 0; d < dst_len; d++) {
+    double fx = (d + 0.5) * scale - 0.5;
+    if (fx < 0) {
+      fx = 0;
+    }
+    int i0 = static_cast<int>(fx);
+    double frac = fx - i0;
+    if (i0 >= src_len - 1) {
+      i0 = src_len - 1;
+      frac = 0;
+    }
+    table.idx0[d] = i0 * cn;
+    table.idx1[d] = std::min(i0 + 1, src_len - 1) * cn;
+    table.weight[d] = static_cast<int32_t>(frac * kWeightScale + 0.5);
+  }
+}
+
+inline uint8_t Lerp(int a, int b, int w) {
+  return static_cast<uint8_t>(
+      (a * (kWeightScale - w) + b * w + kWeightHalf) >> kWeightBits);
+}
+
+inline uint8_t RGBToY(int r, int g, int b) {
+  return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uint8_t RGBToU(int r, int g, int b) {
+  return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uint8_t RGBToV(int r, int g, int b) {
+  return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+// 垂直方向插值：dst = a * (1 - w) + b * w
+void BlendRows(
+    const uint8_t *a, const uint8_t *b, int w, int len, uint8_t *dst) {
+  if (w == 0) {
+    memcpy(dst, a, len);
+    return;
+  }
+  if (w == kWeightScale) {
+    memcpy(dst, b, len);
+    return;
+  }
+  int x = 0;
+#if defined(IMAGE_CONVERT_NEON)
+  uint8x8_t wa = vdup_n_u8(static_cast<uint8_t>(kWeightScale - w));
+  uint8x8_t wb = vdup_n_u8(static_cast<uint8_t>(w));
+  for (; x + 16 <= len; x += 16) {
+    uint8x16_t va = vld1q_u8(a + x);
+    uint8x16_t vb = vld1q_u8(b + x);
+    uint16x8_t lo = vmull_u8(vget_low_u8(va), wa);
+    lo = vmlal_u8(lo, vget_low_u8(vb), wb);
+    uint16x8_t hi = vmull_u8(vget_high_u8(va), wa);
+    hi = vmlal_u8(hi, vget_high_u8(vb), wb);
+    vst1q_u8(dst + x,
+             vcombine_u8(vrshrn_n_u16(lo, kWeightBits),
+                         vrshrn_n_u16(hi, kWeightBits)));
+  }
+#elif defined(IMAGE_CONVERT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i wa = _mm_set1_epi16(static_cast<int16_t>(kWeightScale - w));
+  const __m128i wb = _mm_set1_epi16(static_cast<int16_t>(w));
+  const __m128i half = _mm_set1_epi16(kWeightHalf);
+  for (; x + 16 <= len; x += 16) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+    __m128i lo = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+        _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+    __m128i hi = _mm_add_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+        _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, half), kWeightBits);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, half), kWeightBits);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x),
+                     _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; x < len; x++) {
+    dst[x] = Lerp(a[x], b[x], w);
+  }
+}
+
+// planar的r/g/b转换为一行y
+void PlanarRGBToY(const uint8_t *r,
+                  const uint8_t *g,
+                  const uint8_t *b,
+                  int len,
+                  uint8_t *dst_y) {
+  int x = 0;
+#if defined(IMAGE_CONVERT_NEON)
+  const uint8x8_t cr = vdup_n_u8(66);
+  const uint8x8_t cg = vdup_n_u8(129);
+  const uint8x8_t cb = vdup_n_u8(25);
+  const uint8x16_t offset = vdupq_n_u8(16);
+  for (; x + 16 <= len; x += 16) {
+    uint8x16_t vr = vld1q_u8(r + x);
+    uint8x16_t vg = vld1q_u8(g + x);
+    uint8x16_t vb = vld1q_u8(b + x);
+    uint16x8_t lo = vmull_u8(vget_low_u8(vr), cr);
+    lo = vmlal_u8(lo, vget_low_u8(vg), cg);
+    lo = vmlal_u8(lo, vget_low_u8(vb), cb);
+    uint16x8_t hi = vmull_u8(vget_high_u8(vr), cr);
+    hi = vmlal_u8(hi, vget_high_u8(vg), cg);
+    hi = vmlal_u8(hi, vget_high_u8(vb), cb);
+    uint8x16_t y = vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8));
+    vst1q_u8(dst_y + x, vaddq_u8(y, offset));
+  }
+#elif defined(IMAGE_CONVERT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i cr = _mm_set1_epi16(66);
+  const __m128i cg = _mm_set1_epi16(129);
+  const __m128i cb = _mm_set1_epi16(25);
+  const __m128i half = _mm_set1_epi16(128);
+  const __m128i offset = _mm_set1_epi16(16);
+  for (; x + 16 <= len; x += 16) {
+    __m128i vr = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + x));
+    __m128i vg = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g + x));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(vr, zero), cr);
+    lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(vg, zero), cg));
+    lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), cb));
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(vr, zero), cr);
+    hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(vg, zero), cg));
+    hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), cb));
+    lo = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(lo, half), 8), offset);
+    hi = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(hi, half), 8), offset);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst_y + x),
+                     _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; x < len; x++) {
+    dst_y[x] = RGBToY(r[x], g[x], b[x]);
+  }
+}
+
+// 两行planar的r/g/b按照2x2取均值后转换为一行交织的uv
+// uv_len为输出的uv对个数
+void PlanarRGBToUV(const uint8_t *r0,
+                   const uint8_t *g0,
+                   const uint8_t *b0,
+                   const uint8_t *r1,
+                   const uint8_t *g1,
+                   const uint8_t *b1,
+                   int uv_len,
+                   uint8_t *dst_uv) {
+  int x = 0;
+#if defined(IMAGE_CONVERT_NEON)
+  const int16x8_t offset = vdupq_n_s16(128);
+  for (; x + 8 <= uv_len; x += 8) {
+    int16x8_t r = vreinterpretq_s16_u16(vrshrq_n_u16(
+        vpadalq_u8(vpaddlq_u8(vld1q_u8(r0 + 2 * x)), vld1q_u8(r1 + 2 * x)),
+        2));
+    int16x8_t g = vreinterpretq_s16_u16(vrshrq_n_u16(
+        vpadalq_u8(vpaddlq_u8(vld1q_u8(g0 + 2 * x)), vld1q_u8(g1 + 2 * x)),
+        2));
+    int16x8_t b = vreinterpretq_s16_u16(vrshrq_n_u16(
+        vpadalq_u8(vpaddlq_u8(vld1q_u8(b0 + 2 * x)), vld1q_u8(b1 + 2 * x)),
+        2));
+    int16x8_t u = vmulq_n_s16(r, -38);
+    u = vmlaq_n_s16(u, g, -74);
+    u = vmlaq_n_s16(u, b, 112);
+    int16x8_t v = vmulq_n_s16(r, 112);
+    v = vmlaq_n_s16(v, g, -94);
+    v = vmlaq_n_s16(v, b, -18);
+    uint8x8x2_t uv;
+    uv.val[0] = vqmovun_s16(vaddq_s16(vrshrq_n_s16(u, 8), offset));
+    uv.val[1] = vqmovun_s16(vaddq_s16(vrshrq_n_s16(v, 8), offset));
+    vst2_u8(dst_uv + 2 * x, uv);
+  }
+#elif defined(IMAGE_CONVERT_SSE2)
+  const __m128i mask = _mm_set1_epi16(0x00FF);
+  const __m128i two = _mm_set1_epi16(2);
+  const __m128i half = _mm_set1_epi16(128);
+  auto average = [&](const uint8_t *p0, const uint8_t *p1) {
+    __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p0));
+    __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p1));
+    __m128i sum = _mm_add_epi16(_mm_and_si128(v0, mask), _mm_srli_epi16(v0, 8));
+    sum = _mm_add_epi16(sum, _mm_and_si128(v1, mask));
+    sum = _mm_add_epi16(sum, _mm_srli_epi16(v1, 8));
+    return _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+  };
+  for (; x + 8 <= uv_len; x += 8) {
+    __m128i r = average(r0 + 2 * x, r1 + 2 * x);
+    __m128i g = average(g0 + 2 * x, g1 + 2 * x);
+    __m128i b = average(b0 + 2 * x, b1 + 2 * x);
+    __m128i u = _mm_mullo_epi16(r, _mm_set1_epi16(-38));
+    u = _mm_add_epi16(u, _mm_mullo_epi16(g, _mm_set1_epi16(-74)));
+    u = _mm_add_epi16(u, _mm_mullo_epi16(b, _mm_set1_epi16(112)));
+    __m128i v = _mm_mullo_epi16(r, _mm_set1_epi16(112));
+    v = _mm_add_epi16(v, _mm_mullo_epi16(g, _mm_set1_epi16(-94)));
+    v = _mm_add_epi16(v, _mm_mullo_epi16(b, _mm_set1_epi16(-18)));
+    u = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(u, half), 8), half);
+    v = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(v, half), 8), half);
+    __m128i uv = _mm_unpacklo_epi8(_mm_packus_epi16(u, u),
+                                   _mm_packus_epi16(v, v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst_uv + 2 * x), uv);
+  }
+#endif
+  for (; x < uv_len; x++) {
+    int r = (r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) >> 2;
+    int g = (g0[2 * x] + g0[2 * x + 1] + g1[2 * x] + g1[2 * x + 1] + 2) >> 2;
+    int b = (b0[2 * x] + b0[2 * x + 1] + b1[2 * x] + b1[2 * x + 1] + 2) >> 2;
+    dst_uv[2 * x] = RGBToU(r, g, b);
+    dst_uv[2 * x + 1] = RGBToV(r, g, b);
+  }
+}
+
+// 水平方向缩放一行packed rgb，输出planar的r/g/b
+void HResizeRowRGB(const uint8_t *src_row,
+                   const LinearTable &x_table,
+                   int r_idx,
+                   int b_idx,
+                   int dst_w,
+                   uint8_t *dst) {
+  uint8_t *r = dst;
+  uint8_t *g = dst + dst_w;
+  uint8_t *b = dst + 2 * dst_w;
+  for (int x = 0; x < dst_w; x++) {
+    const uint8_t *p0 = src_row + x_table.idx0[x];
+    const uint8_t *p1 = src_row + x_table.idx1[x];
+    int w = x_table.weight[x];
+    r[x] = Lerp(p0[r_idx], p1[r_idx], w);
+    g[x] = Lerp(p0[1], p1[1], w);
+    b[x] = Lerp(p0[b_idx], p1[b_idx], w);
+  }
+}
+
+// 每个线程复用的缩放表和中间行缓存，稳态下不申请内存
+struct RGBResizeScratch {
+  int src_h = -1;
+  int src_w = -1;
+  int dst_h = -1;
+  int dst_w = -1;
+  LinearTable x_table;
+  LinearTable y_table;
+  // 缓存两行水平缩放结果，hrow_src为对应的输入行号
+  std::vector<uint8_t> hrows[2];
+  int hrow_src[2] = {-1, -1};
+  // 两行垂直插值后的planar r/g/b
+  std::vector<uint8_t> rgb_rows[2];
+
+  void Prepare(int in_h, int in_w, int out_h, int out_w) {
+    if (in_h != src_h || out_h != dst_h) {
+      BuildLinearTable(in_h, out_h, 1, y_table);
+    }
+    if (in_w != src_w || out_w != dst_w) {
+      BuildLinearTable(in_w, out_w, 3, x_table);
+      for (int i = 0; i < 2; i++) {
+        hrows[i].resize(3 * out_w);
+        rgb_rows[i].resize(3 * out_w);
+      }
+    }
+    src_h = in_h;
+    src_w = in_w;
+    dst_h = out_h;
+    dst_w = out_w;
+    hrow_src[0] = -1;
+    hrow_src[1] = -1;
+  }
+
+  // 获取输入第sy行的水平缩放结果，不会覆盖第keep_sy行的缓存
+  const uint8_t *GetHRow(const uint8_t *src,
+                         int src_step,
+                         int r_idx,
+                         int b_idx,
+                         int sy,
+                         int keep_sy) {
+    for (int i = 0; i < 2; i++) {
+      if (hrow_src[i] == sy) {
+        return hrows[i].data();
+      }
+    }
+    int slot = hrow_src[0] == keep_sy ? 1 : 0;
+    HResizeRowRGB(src + static_cast<size_t>(sy) * src_step,
+                  x_table,
+                  r_idx,
+                  b_idx,
+                  dst_w,
+                  hrows[slot].data());
+    hrow_src[slot] = sy;
+    return hrows[slot].data();
+  }
+};
+
+bool CheckRGBToNv12Para(const uint8_t *src,
+                        int src_h,
+                        int src_w,
+                        int src_step,
+                        const uint8_t *dst_y,
+                        const uint8_t *dst_uv,
+                        int dst_h,
+                        int dst_w) {
+  if (!src || !dst_y || !dst_uv || src_h <= 0 || src_w <= 0 || dst_h <= 0 ||
+      dst_w <= 0) {
+    std::cerr << "invalid rgb to nv12 para" << std::endl;
+    return false;
+  }
+  if (dst_h % 2 || dst_w % 2) {
+    std::cerr << "output img height and width must aligned by 2!" << std::endl;
+    return false;
+  }
+  if (src_step < src_w * 3) {
+    std::cerr << "input img step " << src_step << " is less than width * 3"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// 水平方向缩放一行交织存储的数据，cn为通道数
+void HResizeRow(const uint8_t *src_row,
+                const LinearTable &x_table,
+                int cn,
+                int dst_w,
+                uint8_t *dst) {
+  if (cn == 1) {
+    for (int x = 0; x < dst_w; x++) {
+      dst[x] = Lerp(src_row[x_table.idx0[x]],
+                    src_row[x_table.idx1[x]],
+                    x_table.weight[x]);
+    }
+    return;
+  }
+  for (int x = 0; x < dst_w; x++) {
+    const uint8_t *p0 = src_row + x_table.idx0[x];
+    const uint8_t *p1 = src_row + x_table.idx1[x];
+    int w = x_table.weight[x];
+    for (int c = 0; c < cn; c++) {
+      dst[x * cn + c] = Lerp(p0[c], p1[c], w);
+    }
+  }
+}
+
+// 区域均值缩放时每个输出像素对应的输入范围[start, start + count)
+void BuildAreaTable(int src_len,
+                    int dst_len,
+                    std::vector<int32_t> &start,
+                    std::vector<int32_t> &count) {
+  start.resize(dst_len);
+  count.resize(dst_len);
+  for (int d = 0; d < dst_len; d++) {
+    int64_t s0 = static_cast<int64_t>(d) * src_len / dst_len;
+    int64_t s1 = (static_cast<int64_t>(d + 1) * src_len + dst_len - 1) / dst_len;
+    s1 = std::min<int64_t>(s1, src_len);
+    start[d] = static_cast<int32_t>(s0);
+    count[d] = static_cast<int32_t>(std::max<int64_t>(s1 - s0, 1));
+  }
+}
+
+// 单个平面缩放使用的缩放表和中间行缓存
+struct PlaneResizeScratch {
+  int src_h = -1;
+  int src_w = -1;
+  int dst_h = -1;
+  int dst_w = -1;
+  int cn = -1;
+  LinearTable x_table;
+  LinearTable y_table;
+  std::vector<uint8_t> hrows[2];
+  int hrow_src[2] = {-1, -1};
+  // 区域均值缩放使用
+  std::vector<int32_t> x_start;
+  std::vector<int32_t> x_count;
+  std::vector<int32_t> y_start;
+  std::vector<int32_t> y_count;
+  std::vector<uint32_t> col_sum;
+
+  void Prepare(int in_h, int in_w, int out_h, int out_w, int channel) {
+    if (in_h != src_h || out_h != dst_h) {
+      BuildLinearTable(in_h, out_h, 1, y_table);
+      BuildAreaTable(in_h, out_h, y_start, y_count);
+    }
+    if (in_w != src_w || out_w != dst_w || channel != cn) {
+      BuildLinearTable(in_w, out_w, channel, x_table);
+      BuildAreaTable(in_w, out_w, x_start, x_count);
+      for (int i = 0; i < 2; i++) {
+        hrows[i].resize(out_w * channel);
+      }
+      col_sum.resize(in_w * channel);
+    }
+    src_h = in_h;
+    src_w = in_w;
+    dst_h = out_h;
+    dst_w = out_w;
+    cn = channel;
+    hrow_src[0] = -1;
+    hrow_src[1] = -1;
+  }
+
+  const uint8_t *GetHRow(const uint8_t *src, int src_stride, int sy, int keep_sy) {
+    for (int i = 0; i < 2; i++) {
+      if (hrow_src[i] == sy) {
+        return hrows[i].data();
+      }
+    }
+    int slot = hrow_src[0] == keep_sy ? 1 : 0;
+    HResizeRow(src + static_cast<size_t>(sy) * src_stride,
+               x_table,
+               cn,
+               dst_w,
+               hrows[slot].data());
+    hrow_src[slot] = sy;
+    return hrows[slot].data();
+  }
+};
+
+void ResizePlaneBilinear(const uint8_t *src,
+                         int src_stride,
+                         uint8_t *dst,
+                         int dst_stride,
+                         PlaneResizeScratch &scratch) {
+  const auto &y_table = scratch.y_table;
+  int row_len = scratch.dst_w * scratch.cn;
+  for (int dy = 0; dy < scratch.dst_h; dy++) {
+    int y0 = y_table.idx0[dy];
+    int y1 = y_table.idx1[dy];
+    int wy = y_table.weight[dy];
+    const uint8_t *h0 = nullptr;
+    const uint8_t *h1 = nullptr;
+    if (wy < kWeightScale) {
+      h0 = scratch.GetHRow(src, src_stride, y0, y1);
+    }
+    if (wy > 0) {
+      h1 = scratch.GetHRow(src, src_stride, y1, y0);
+    }
+    BlendRows(h0, h1, wy, row_len, dst + static_cast<size_t>(dy) * dst_stride);
+  }
+}
+
+// 宽高都缩小一半的区域均值缩放
+void HalvePlane(const uint8_t *src,
+                int src_stride,
+                uint8_t *dst,
+                int dst_stride,
+                int dst_h,
+                int dst_w,
+                int cn) {
+  for (int dy = 0; dy < dst_h; dy++) {
+    const uint8_t *r0 = src + static_cast<size_t>(2 * dy) * src_stride;
+    const uint8_t *r1 = r0 + src_stride;
+    uint8_t *out = dst + static_cast<size_t>(dy) * dst_stride;
+    int x = 0;
+    if (cn == 1) {
+#if defined(IMAGE_CONVERT_NEON)
+      for (; x + 16 <= dst_w; x += 16) {
+        uint16x8_t lo = vpadalq_u8(vpaddlq_u8(vld1q_u8(r0 + 2 * x)),
+                                   vld1q_u8(r1 + 2 * x));
+        uint16x8_t hi = vpadalq_u8(vpaddlq_u8(vld1q_u8(r0 + 2 * x + 16)),
+                                   vld1q_u8(r1 + 2 * x + 16));
+        vst1q_u8(out + x,
+                 vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+      }
+#elif defined(IMAGE_CONVERT_SSE2)
+      const __m128i mask = _mm_set1_epi16(0x00FF);
+      const __m128i two = _mm_set1_epi16(2);
+      auto average = [&](const uint8_t *p0, const uint8_t *p1) {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p0));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p1));
+        __m128i sum =
+            _mm_add_epi16(_mm_and_si128(v0, mask), _mm_srli_epi16(v0, 8));
+        sum = _mm_add_epi16(sum, _mm_and_si128(v1, mask));
+        sum = _mm_add_epi16(sum, _mm_srli_epi16(v1, 8));
+        return _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+      };
+      for (; x + 16 <= dst_w; x += 16) {
+        __m128i lo = average(r0 + 2 * x, r1 + 2 * x);
+        __m128i hi = average(r0 + 2 * x + 16, r1 + 2 * x + 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x),
+                         _mm_packus_epi16(lo, hi));
+      }
+#endif
+    }
+    for (; x < dst_w; x++) {
+      for (int c = 0; c < cn; c++) {
+        int i0 = 2 * x * cn + c;
+        int i1 = i0 + cn;
+        out[x * cn + c] =
+            static_cast<uint8_t>((r0[i0] + r0[i1] + r1[i0] + r1[i1] + 2) >> 2);
+      }
+    }
+  }
+}
+
+void ResizePlaneArea(const uint8_t *src,
+                     int src_stride,
+                     uint8_t *dst,
+                     int dst_stride,
+                     PlaneResizeScratch &scratch) {
+  int cn = scratch.cn;
+  if (scratch.src_w == 2 * scratch.dst_w && scratch.src_h == 2 * scratch.dst_h) {
+    HalvePlane(
+        src, src_stride, dst, dst_stride, scratch.dst_h, scratch.dst_w, cn);
+    return;
+  }
+
+  int src_row_len = scratch.src_w * cn;
+  uint32_t *col_sum = scratch.col_sum.data();
+  for (int dy = 0; dy < scratch.dst_h; dy++) {
+    // 先累加垂直方向的输入行，再按照水平范围求均值
+    const uint8_t *row =
+        src + static_cast<size_t>(scratch.y_start[dy]) * src_stride;
+    for (int x = 0; x < src_row_len; x++) {
+      col_sum[x] = row[x];
+    }
+    for (int k = 1; k < scratch.y_count[dy]; k++) {
+      row += src_stride;
+      for (int x = 0; x < src_row_len; x++) {
+        col_sum[x] += row[x];
+      }
+    }
+
+    uint8_t *out = dst + static_cast<size_t>(dy) * dst_stride;
+    for (int dx = 0; dx < scratch.dst_w; dx++) {
+      uint32_t area = static_cast<uint32_t>(scratch.x_count[dx]) *
+                      static_cast<uint32_t>(scratch.y_count[dy]);
+      const uint32_t *sum = col_sum + scratch.x_start[dx] * cn;
+      for (int c = 0; c < cn; c++) {
+        uint32_t total = 0;
+        for (int k = 0; k < scratch.x_count[dx]; k++) {
+          total += sum[k * cn + c];
+        }
+        out[dx * cn + c] = static_cast<uint8_t>((total + area / 2) / area);
+      }
+    }
+  }
+}
+
+void ResizePlane(const uint8_t *src,
+                 int src_stride,
+                 int src_h,
+                 int src_w,
+                 int cn,
+                 uint8_t *dst,
+                 int dst_stride,
+                 int dst_h,
+                 int dst_w,
+                 ImageConvert::ResizeMode mode,
+                 PlaneResizeScratch &scratch) {
+  if (src_h == dst_h && src_w == dst_w) {
+    for (int h = 0; h < dst_h; h++) {
+      memcpy(dst + static_cast<size_t>(h) * dst_stride,
+             src + static_cast<size_t>(h) * src_stride,
+             dst_w * cn);
+    }
+    return;
+  }
+  scratch.Prepare(src_h, src_w, dst_h, dst_w, cn);
+  if (mode == ImageConvert::ResizeMode::AREA && dst_h <= src_h &&
+      dst_w <= src_w) {
+    ResizePlaneArea(src, src_stride, dst, dst_stride, scratch);
+  } else {
+    ResizePlaneBilinear(src, src_stride, dst, dst_stride, scratch);
+  }
+}
+
+// 取出交织数据中偶数（parity为0）或者奇数（parity为1）位置的len个字节
+void ExtractBytes(const uint8_t *src, int parity, int len, uint8_t *dst) {
+  int x = 0;
+#if defined(IMAGE_CONVERT_NEON)
+  for (; x + 16 <= len; x += 16) {
+    uint8x16x2_t v = vld2q_u8(src + 2 * x);
+    vst1q_u8(dst + x, parity ? v.val[1] : v.val[0]);
+  }
+#elif defined(IMAGE_CONVERT_SSE2)
+  const __m128i mask = _mm_set1_epi16(0x00FF);
+  for (; x + 16 <= len; x += 16) {
+    __m128i lo =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * x));
+    __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * x + 16));
+    if (parity) {
+      lo = _mm_srli_epi16(lo, 8);
+      hi = _mm_srli_epi16(hi, 8);
+    } else {
+      lo = _mm_and_si128(lo, mask);
+      hi = _mm_and_si128(hi, mask);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x),
+                     _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; x < len; x++) {
+    dst[x] = src[2 * x + parity];
+  }
+}
+
+// 每个像素2字节的packed yuv422中y和uv的字节偏移
+// yuyv：Y0 U Y1 V；uyvy：U Y0 V Y1
+struct Yuv422Layout {
+  int y_off;
+  int u_off;
+  int v_off;
+};
+
+Yuv422Layout GetYuv422Layout(bool is_uyvy) {
+  return is_uyvy ? Yuv422Layout{1, 0, 2} : Yuv422Layout{0, 1, 3};
+}
+
+// 水平方向缩放packed yuv422一行中的y，宽度不变时直接提取
+void HResizeRowYuv422Y(const uint8_t *src_row,
+                       const LinearTable &x_table,
+                       const Yuv422Layout &layout,
+                       bool same_width,
+                       int dst_w,
+                       uint8_t *dst) {
+  if (same_width) {
+    ExtractBytes(src_row, layout.y_off, dst_w, dst);
+    return;
+  }
+  const uint8_t *y = src_row + layout.y_off;
+  for (int x = 0; x < dst_w; x++) {
+    dst[x] = Lerp(y[x_table.idx0[x]], y[x_table.idx1[x]], x_table.weight[x]);
+  }
+}
+
+// 水平方向缩放packed yuv422一行中的uv，输出nv12顺序的交织uv
+// 宽度不变时每4字节中的u和v已经是nv12的顺序，直接提取
+void HResizeRowYuv422UV(const uint8_t *src_row,
+                        const LinearTable &x_table,
+                        const Yuv422Layout &layout,
+                        bool same_width,
+                        int uv_len,
+                        uint8_t *dst) {
+  if (same_width) {
+    ExtractBytes(src_row, layout.u_off, 2 * uv_len, dst);
+    return;
+  }
+  for (int x = 0; x < uv_len; x++) {
+    const uint8_t *p0 = src_row + x_table.idx0[x];
+    const uint8_t *p1 = src_row + x_table.idx1[x];
+    int w = x_table.weight[x];
+    dst[2 * x] = Lerp(p0[layout.u_off], p1[layout.u_off], w);
+    dst[2 * x + 1] = Lerp(p0[layout.v_off], p1[layout.v_off], w);
+  }
+}
+
+// packed yuv422缩放使用的缩放表和中间行缓存
+// y按照每像素2字节、uv按照每2个像素4字节分别建表，输出的uv高度为y的一半
+struct Yuv422ResizeScratch {
+  int src_h = -1;
+  int src_w = -1;
+  int dst_h = -1;
+  int dst_w = -1;
+  bool same_width = false;
+  LinearTable y_x_table;
+  LinearTable y_y_table;
+  LinearTable uv_x_table;
+  LinearTable uv_y_table;
+  std::vector<uint8_t> y_hrows[2];
+  int y_hrow_src[2] = {-1, -1};
+  std::vector<uint8_t> uv_hrows[2];
+  int uv_hrow_src[2] = {-1, -1};
+
+  void Prepare(int in_h, int in_w, int out_h, int out_w) {
+    if (in_h != src_h || out_h != dst_h) {
+      BuildLinearTable(in_h, out_h, 1, y_y_table);
+      BuildLinearTable(in_h, out_h / 2, 1, uv_y_table);
+    }
+    if (in_w != src_w || out_w != dst_w) {
+      BuildLinearTable(in_w, out_w, 2, y_x_table);
+      BuildLinearTable(in_w / 2, out_w / 2, 4, uv_x_table);
+      for (int i = 0; i < 2; i++) {
+        y_hrows[i].resize(out_w);
+        uv_hrows[i].resize(out_w);
+      }
+    }
+    src_h = in_h;
+    src_w = in_w;
+    dst_h = out_h;
+    dst_w = out_w;
+    same_width = in_w == out_w;
+    for (int i = 0; i < 2; i++) {
+      y_hrow_src[i] = -1;
+      uv_hrow_src[i] = -1;
+    }
+  }
+
+  // 获取输入第sy行的水平缩放结果，不会覆盖第keep_sy行的缓存
+  const uint8_t *GetRow(const uint8_t *src,
+                        int src_step,
+                        const Yuv422Layout &layout,
+                        bool is_uv,
+                        int sy,
+                        int keep_sy) {
+    auto *rows = is_uv ? uv_hrows : y_hrows;
+    int *row_src = is_uv ? uv_hrow_src : y_hrow_src;
+    for (int i = 0; i < 2; i++) {
+      if (row_src[i] == sy) {
+        return rows[i].data();
+      }
+    }
+    int slot = row_src[0] == keep_sy ? 1 : 0;
+    const uint8_t *src_row = src + static_cast<size_t>(sy) * src_step;
+    if (is_uv) {
+      HResizeRowYuv422UV(
+          src_row, uv_x_table, layout, same_width, dst_w / 2, rows[slot].data());
+    } else {
+      HResizeRowYuv422Y(
+          src_row, y_x_table, layout, same_width, dst_w, rows[slot].data());
+    }
+    row_src[slot] = sy;
+    return rows[slot].data();
+  }
+};
+
+bool CheckPackedToNv12Para(const uint8_t *src,
+                           int src_h,
+                           int src_w,
+                           int src_step,
+                           int bytes_per_pixel,
+                           const uint8_t *dst_y,
+                           const uint8_t *dst_uv,
+                           int dst_h,
+                           int dst_w) {
+  if (!src || !dst_y || !dst_uv || src_h <= 0 || src_w <= 0 || dst_h <= 0 ||
+      dst_w <= 0) {
+    std::cerr << "invalid img to nv12 para" << std::endl;
+    return false;
+  }
+  if (dst_h % 2 || dst_w % 2) {
+    std::cerr << "output img height and width must aligned by 2!" << std::endl;
+    return false;
+  }
+  if (src_step < src_w * bytes_per_pixel) {
+    std::cerr << "input img step " << src_step << " is less than width * "
+              << bytes_per_pixel << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// 一行灰度值按照r=g=b转换为y，与RGBToY一致
+void GrayToY(const uint8_t *src, int len, uint8_t *dst_y) {
+  int x = 0;
+#if defined(IMAGE_CONVERT_NEON)
+  const uint8x8_t coeff = vdup_n_u8(220);
+  const uint8x16_t offset = vdupq_n_u8(16);
+  for (; x + 16 <= len; x += 16) {
+    uint8x16_t v = vld1q_u8(src + x);
+    uint16x8_t lo = vmull_u8(vget_low_u8(v), coeff);
+    uint16x8_t hi = vmull_u8(vget_high_u8(v), coeff);
+    uint8x16_t y = vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8));
+    vst1q_u8(dst_y + x, vaddq_u8(y, offset));
+  }
+#elif defined(IMAGE_CONVERT_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i coeff = _mm_set1_epi16(220);
+  const __m128i half = _mm_set1_epi16(128);
+  const __m128i offset = _mm_set1_epi16(16);
+  for (; x + 16 <= len; x += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), coeff);
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), coeff);
+    lo = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(lo, half), 8), offset);
+    hi = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(hi, half), 8), offset);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst_y + x),
+                     _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; x < len; x++) {
+    dst_y[x] = RGBToY(src[x], src[x], src[x]);
+  }
+}
+
+void FillUVPlane(uint8_t *dst_uv, int dst_uv_stride, int dst_h, int dst_w) {
+  for (int row = 0; row < dst_h / 2; row++) {
+    memset(dst_uv + static_cast<size_t>(row) * dst_uv_stride, 128, dst_w);
+  }
+}
+
+// full range的y和uv映射到limited range的查找表
+struct RangeTable {
+  uint8_t y[256];
+  uint8_t uv[256];
+
+  RangeTable() {
+    for (int idx = 0; idx < 256; idx++) {
+      y[idx] = static_cast<uint8_t>(16 + (idx * 219 + 127) / 255);
+      int c = idx - 128;
+      int scaled = (std::abs(c) * 224 + 127) / 255;
+      uv[idx] = static_cast<uint8_t>(128 + (c < 0 ? -scaled : scaled));
+    }
+  }
+};
+
+const RangeTable &GetRangeTable() {
+  static const RangeTable table;
+  return table;
+}
+
+// 一行nv12的uv由色度平面的1到4个采样取均值得到
+void JpegUVRow(const uint8_t *u0,
+               const uint8_t *v0,
+               const uint8_t *u1,
+               const uint8_t *v1,
+               int uv_shift_x,
+               const RangeTable &table,
+               uint8_t *dst_uv,
+               int uv_len) {
+  if (uv_shift_x) {
+    for (int col = 0; col < uv_len; col++) {
+      dst_uv[2 * col] = table.uv[(u0[col] + u1[col] + 1) >> 1];
+      dst_uv[2 * col + 1] = table.uv[(v0[col] + v1[col] + 1) >> 1];
+    }
+    return;
+  }
+  for (int col = 0; col < uv_len; col++) {
+    int sx = 2 * col;
+    dst_uv[2 * col] =
+        table.uv[(u0[sx] + u0[sx + 1] + u1[sx] + u1[sx + 1] + 2) >> 2];
+    dst_uv[2 * col + 1] =
+        table.uv[(v0[sx] + v0[sx + 1] + v1[sx] + v1[sx + 1] + 2) >> 2];
+  }
+}
+
+}  // namespace
+
+int32_t ImageConvert::RGBToNv12Resize(const uint8_t *src,
+                                      int src_h,
+                                      int src_w,
+                                      int src_step,
+                                      bool is_bgr,
+                                      uint8_t *dst_y,
+                                      int dst_y_stride,
+                                      uint8_t *dst_uv,
+                                      int dst_uv_stride,
+                                      int dst_h,
+                                      int dst_w) {
+  if (!CheckRGBToNv12Para(
+          src, src_h, src_w, src_step, dst_y, dst_uv, dst_h, dst_w)) {
+    return -1;
+  }
+  static thread_local RGBResizeScratch scratch;
+  scratch.Prepare(src_h, src_w, dst_h, dst_w);
+  int r_idx = is_bgr ? 2 : 0;
+  int b_idx = is_bgr ? 0 : 2;
+  const auto &y_table = scratch.y_table;
+
+  for (int dy = 0; dy < dst_h; dy += 2) {
+    for (int k = 0; k < 2; k++) {
+      int row = dy + k;
+      int y0 = y_table.idx0[row];
+      int y1 = y_table.idx1[row];
+      int wy = y_table.weight[row];
+      const uint8_t *h0 = nullptr;
+      const uint8_t *h1 = nullptr;
+      if (wy < kWeightScale) {
+        h0 = scratch.GetHRow(src, src_step, r_idx, b_idx, y0, y1);
+      }
+      if (wy > 0) {
+        h1 = scratch.GetHRow(src, src_step, r_idx, b_idx, y1, y0);
+      }
+      uint8_t *rgb = scratch.rgb_rows[k].data();
+      BlendRows(h0, h1, wy, 3 * dst_w, rgb);
+      PlanarRGBToY(rgb,
+                   rgb + dst_w,
+                   rgb + 2 * dst_w,
+                   dst_w,
+                   dst_y + static_cast<size_t>(row) * dst_y_stride);
+    }
+    const uint8_t *rgb0 = scratch.rgb_rows[0].data();
+    const uint8_t *rgb1 = scratch.rgb_rows[1].data();
+    PlanarRGBToUV(rgb0,
+                  rgb0 + dst_w,
+                  rgb0 + 2 * dst_w,
+                  rgb1,
+                  rgb1 + dst_w,
+                  rgb1 + 2 * dst_w,
+                  dst_w / 2,
+                  dst_uv + static_cast<size_t>(dy / 2) * dst_uv_stride);
+  }
+  return 0;
+}
+
+int32_t ImageConvert::RGBToNv12ResizeRef(const uint8_t *src,
+                                         int src_h,
+                                         int src_w,
+                                         int src_step,
+                                         bool is_bgr,
+                                         uint8_t *dst_y,
+                                         int dst_y_stride,
+                                         uint8_t *dst_uv,
+                                         int dst_uv_stride,
+                                         int dst_h,
+                                         int dst_w) {
+  if (!CheckRGBToNv12Para(
+          src, src_h, src_w, src_step, dst_y, dst_uv, dst_h, dst_w)) {
+    return -1;
+  }
+  LinearTable x_table;
+  LinearTable y_table;
+  BuildLinearTable(src_w, dst_w, 3, x_table);
+  BuildLinearTable(src_h, dst_h, 1, y_table);
+  int channel_idx[3] = {is_bgr ? 2 : 0, 1, is_bgr ? 0 : 2};
+
+  // 缩放后的rgb图，按照r/g/b顺序packed存储
+  std::vector<uint8_t> rgb(static_cast<size_t>(dst_h) * dst_w * 3);
+  for (int dy = 0; dy < dst_h; dy++) {
+    const uint8_t *row0 = src + static_cast<size_t>(y_table.idx0[dy]) * src_step;
+    const uint8_t *row1 = src + static_cast<size_t>(y_table.idx1[dy]) * src_step;
+    for (int dx = 0; dx < dst_w; dx++) {
+      int wx = x_table.weight[dx];
+      for (int c = 0; c < 3; c++) {
+        int i0 = x_table.idx0[dx] + channel_idx[c];
+        int i1 = x_table.idx1[dx] + channel_idx[c];
+        int h0 = Lerp(row0[i0], row0[i1], wx);
+        int h1 = Lerp(row1[i0], row1[i1], wx);
+        rgb[(static_cast<size_t>(dy) * dst_w + dx) * 3 + c] =
+            Lerp(h0, h1, y_table.weight[dy]);
+      }
+    }
+  }
+
+  for (int dy = 0; dy < dst_h; dy++) {
+    for (int dx = 0; dx < dst_w; dx++) {
+      const uint8_t *p = &rgb[(static_cast<size_t>(dy) * dst_w + dx) * 3];
+      dst_y[static_cast<size_t>(dy) * dst_y_stride + dx] =
+          RGBToY(p[0], p[1], p[2]);
+    }
+  }
+
+  for (int dy = 0; dy < dst_h; dy += 2) {
+    uint8_t *uv = dst_uv + static_cast<size_t>(dy / 2) * dst_uv_stride;
+    for (int dx = 0; dx < dst_w; dx += 2) {
+      int sum[3] = {0, 0, 0};
+      for (int k = 0; k < 2; k++) {
+        for (int j = 0; j < 2; j++) {
+          const uint8_t *p =
+              &rgb[(static_cast<size_t>(dy + k) * dst_w + dx + j) * 3];
+          for (int c = 0; c < 3; c++) {
+            sum[c] += p[c];
+          }
+        }
+      }
+      int r = (sum[0] + 2) >> 2;
+      int g = (sum[1] + 2) >> 2;
+      int b = (sum[2] + 2) >> 2;
+      uv[dx] = RGBToU(r, g, b);
+      uv[dx + 1] = RGBToV(r, g, b);
+    }
+  }
+  return 0;
+}
+
+int32_t ImageConvert::Yuv422ToNv12Resize(const uint8_t *src,
+                                         int src_h,
+                                         int src_w,
+                                         int src_step,
+                                         bool is_uyvy,
+                                         uint8_t *dst_y,
+                                         int dst_y_stride,
+                                         uint8_t *dst_uv,
+                                         int dst_uv_stride,
+                                         int dst_h,
+                                         int dst_w) {
+  if (!CheckPackedToNv12Para(
+          src, src_h, src_w, src_step, 2, dst_y, dst_uv, dst_h, dst_w)) {
+    return -1;
+  }
+  if (src_w % 2) {
+    std::cerr << "yuv422 img width must aligned by 2!" << std::endl;
+    return -1;
+  }
+  static thread_local Yuv422ResizeScratch scratch;
+  scratch.Prepare(src_h, src_w, dst_h, dst_w);
+  auto layout = GetYuv422Layout(is_uyvy);
+
+  // 每次处理两行y和一行uv，水平缩放结果按照输入行号缓存
+  auto blend = [&](const LinearTable &y_table, bool is_uv, int row,
+                   uint8_t *dst) {
+    int y0 = y_table.idx0[row];
+    int y1 = y_table.idx1[row];
+    int wy = y_table.weight[row];
+    const uint8_t *h0 = nullptr;
+    const uint8_t *h1 = nullptr;
+    if (wy < kWeightScale) {
+      h0 = scratch.GetRow(src, src_step, layout, is_uv, y0, y1);
+    }
+    if (wy > 0) {
+      h1 = scratch.GetRow(src, src_step, layout, is_uv, y1, y0);
+    }
+    BlendRows(h0, h1, wy, dst_w, dst);
+  };
+  for (int dy = 0; dy < dst_h; dy += 2) {
+    blend(scratch.y_y_table,
+          false,
+          dy,
+          dst_y + static_cast<size_t>(dy) * dst_y_stride);
+    blend(scratch.y_y_table,
+          false,
+          dy + 1,
+          dst_y + static_cast<size_t>(dy + 1) * dst_y_stride);
+    blend(scratch.uv_y_table,
+          true,
+          dy / 2,
+          dst_uv + static_cast<size_t>(dy / 2) * dst_uv_stride);
+  }
+  return 0;
+}
+
+int32_t ImageConvert::Yuv422ToNv12ResizeRef(const uint8_t *src,
+                                            int src_h,
+                                            int src_w,
+                                            int src_step,
+                                            bool is_uyvy,
+                                            uint8_t *dst_y,
+                                            int dst_y_stride,
+                                            uint8_t *dst_uv,
+                                            int dst_uv_stride,
+                                            int dst_h,
+                                            int dst_w) {
+  if (!CheckPackedToNv12Para(
+          src, src_h, src_w, src_step, 2, dst_y, dst_uv, dst_h, dst_w)) {
+    return -1;
+  }
+  if (src_w % 2) {
+    std::cerr << "yuv422 img width must aligned by 2!" << std::endl;
+    return -1;
+  }
+  auto layout = GetYuv422Layout(is_uyvy);
+  // y按照2字节一个像素，uv按照4字节一个宏像素（u和v共用）
+  LinearTable y_x_table;
+  LinearTable y_y_table;
+  LinearTable uv_x_table;
+  LinearTable uv_y_table;
+  BuildLinearTable(src_w, dst_w, 2, y_x_table);
+  BuildLinearTable(src_h, dst_h, 1, y_y_table);
+  BuildLinearTable(src_w / 2, dst_w / 2, 4, uv_x_table);
+  BuildLinearTable(src_h, dst_h / 2, 1, uv_y_table);
+
+  auto sample = [&](const LinearTable &x_table, const LinearTable &y_table,
+                    int dx, int dy, int offset) {
+    const uint8_t *row0 =
+        src + static_cast<size_t>(y_table.idx0[dy]) * src_step + offset;
+    const uint8_t *row1 =
+        src + static_cast<size_t>(y_table.idx1[dy]) * src_step + offset;
+    int wx = x_table.weight[dx];
+    int h0 = Lerp(row0[x_table.idx0[dx]], row0[x_table.idx1[dx]], wx);
+    int h1 = Lerp(row1[x_table.idx0[dx]], row1[x_table.idx1[dx]], wx);
+    return Lerp(h0, h1, y_table.weight[dy]);
+  };
+  for (int dy = 0; dy < dst_h; dy++) {
+    for (int dx = 0; dx < dst_w; dx++) {
+      dst_y[static_cast<size_t>(dy) * dst_y_stride + dx] =
+          sample(y_x_table, y_y_table, dx, dy, layout.y_off);
+    }
+  }
+  for (int dy = 0; dy < dst_h / 2; dy++) {
+    uint8_t *uv = dst_uv + static_cast<size_t>(dy) * dst_uv_stride;
+    for (int dx = 0; dx < dst_w / 2; dx++) {
+      uv[2 * dx] = sample(uv_x_table, uv_y_table, dx, dy, layout.u_off);
+      uv[2 * dx + 1] = sample(uv_x_table, uv_y_table, dx, dy, layout.v_off);
+    }
+  }
+  return 0;
+}
+
+int32_t ImageConvert::GrayToNv12Resize(const uint8_t *src,
+                                       int src_h,
+                                       int src_w,
+                                       int src_step,
+                                       uint8_t *dst_y,
+                                       int dst_y_stride,
+                                       uint8_t *dst_uv,
+                                       int dst_uv_stride,
+                                       int dst_h,
+                                       int dst_w) {
+  if (!CheckPackedToNv12Para(
+          src, src_h, src_w, src_step, 1, dst_y, dst_uv, dst_h, dst_w)) {
+    return -1;
+  }
+  static thread_local PlaneResizeScratch scratch;
+  ResizePlane(src,
+              src_step,
+              src_h,
+              src_w,
+              1,
+              dst_y,
+              dst_y_stride,
+              dst_h,
+              dst_w,
+              ResizeMode::BILINEAR,
+              scratch);
+  for (int row = 0; row < dst_h; row++) {
+    uint8_t *y = dst_y + static_cast<size_t>(row) * dst_y_stride;
+    GrayToY(y, dst_w, y);
+  }
+  FillUVPlane(dst_uv, dst_uv_stride, dst_h, dst_w);
+  return 0;
+}
+
+int32_t ImageConvert::GrayToNv12ResizeRef(const uint8_t *src,
+                                          int src_h,
+                                          int src_w,
+                                          int src_step,
+                                          uint8_t *dst_y,
+                                          int dst_y_stride,
+                                          uint8_t *dst_uv,
+                                          int dst_uv_stride,
+                                          int dst_h,
+                                          int dst_w) {
+  if (!CheckPackedToNv12Para(
+          src, src_h, src_w, src_step, 1, dst_y, dst_uv, dst_h, dst_w)) {
+    return -1;
+  }
+  LinearTable x_table;
+  LinearTable y_table;
+  BuildLinearTable(src_w, dst_w, 1, x_table);
+  BuildLinearTable(src_h, dst_h, 1, y_table);
+  for (int dy = 0; dy < dst_h; dy++) {
+    const uint8_t *row0 = src + static_cast<size_t>(y_table.idx0[dy]) * src_step;
+    const uint8_t *row1 = src + static_cast<size_t>(y_table.idx1[dy]) * src_step;
+    for (int dx = 0; dx < dst_w; dx++) {
+      int wx = x_table.weight[dx];
+      int h0 = Lerp(row0[x_table.idx0[dx]], row0[x_table.idx1[dx]], wx);
+      int h1 = Lerp(row1[x_table.idx0[dx]], row1[x_table.idx1[dx]], wx);
+      int gray = Lerp(h0, h1, y_table.weight[dy]);
+      dst_y[static_cast<size_t>(dy) * dst_y_stride + dx] =
+          RGBToY(gray, gray, gray);
+    }
+  }
+  FillUVPlane(dst_uv, dst_uv_stride, dst_h, dst_w);
+  return 0;
+}
+
+int32_t ImageConvert::Nv12Resize(const uint8_t *src_y,
+                                 int src_y_stride,
+                                 const uint8_t *src_uv,
+                                 int src_uv_stride,
+                                 int src_h,
+                                 int src_w,
+                                 uint8_t *dst_y,
+                                 int dst_y_stride,
+                                 uint8_t *dst_uv,
+                                 int dst_uv_stride,
+                                 int dst_h,
+                                 int dst_w,
+                                 ResizeMode mode) {
+  if (!src_y || !src_uv || !dst_y || !dst_uv || src_h <= 0 || src_w <= 0 ||
+      dst_h <= 0 || dst_w <= 0) {
+    std::cerr << "invalid nv12 resize para" << std::endl;
+    return -1;
+  }
+  if (src_h % 2 || src_w % 2 || dst_h % 2 || dst_w % 2) {
+    std::cerr << "nv12 img height and width must aligned by 2!" << std::endl;
+    return -1;
+  }
+  if (src_y_stride < src_w || src_uv_stride < src_w) {
+    std::cerr << "input nv12 stride is less than width" << std::endl;
+    return -1;
+  }
+
+  static thread_local PlaneResizeScratch y_scratch;
+  static thread_local PlaneResizeScratch uv_scratch;
+  ResizePlane(src_y,
+              src_y_stride,
+              src_h,
+              src_w,
+              1,
+              dst_y,
+              dst_y_stride,
+              dst_h,
+              dst_w,
+              mode,
+              y_scratch);
+  // uv平面按照2通道、宽高减半的图片缩放
+  ResizePlane(src_uv,
+              src_uv_stride,
+              src_h / 2,
+              src_w / 2,
+              2,
+              dst_uv,
+              dst_uv_stride,
+              dst_h / 2,
+              dst_w / 2,
+              mode,
+              uv_scratch);
+  return 0;
+}
+
+int32_t ImageConvert::JpegYuvToNv12(const uint8_t *src_y,
+                                    int src_y_stride,
+                                    const uint8_t *src_u,
+                                    const uint8_t *src_v,
+                                    int src_uv_stride,
+                                    int uv_shift_x,
+                                    int uv_shift_y,
+                                    uint8_t *dst_y,
+                                    int dst_y_stride,
+                                    uint8_t *dst_uv,
+                                    int dst_uv_stride,
+                                    int dst_h,
+                                    int dst_w) {
+  if (!src_y || !dst_y || !dst_uv || dst_h <= 0 || dst_w <= 0 ||
+      (src_u == nullptr) != (src_v == nullptr) || uv_shift_x < 0 ||
+      uv_shift_x > 1 || uv_shift_y < 0 || uv_shift_y > 1) {
+    std::cerr << "invalid jpeg yuv to nv12 para" << std::endl;
+    return -1;
+  }
+  if (dst_h % 2 || dst_w % 2) {
+    std::cerr << "nv12 img height and width must aligned by 2!" << std::endl;
+    return -1;
+  }
+
+  const auto &table = GetRangeTable();
+  for (int row = 0; row < dst_h; row++) {
+    const uint8_t *src = src_y + static_cast<size_t>(row) * src_y_stride;
+    uint8_t *dst = dst_y + static_cast<size_t>(row) * dst_y_stride;
+    for (int col = 0; col < dst_w; col++) {
+      dst[col] = table.y[src[col]];
+    }
+  }
+
+  int uv_len = dst_w / 2;
+  for (int row = 0; row < dst_h / 2; row++) {
+    uint8_t *dst = dst_uv + static_cast<size_t>(row) * dst_uv_stride;
+    if (!src_u) {
+      memset(dst, 128, dst_w);
+      continue;
+    }
+    // 垂直方向没有下采样时取相邻两行的均值
+    int row0 = uv_shift_y ? row : 2 * row;
+    int row1 = uv_shift_y ? row : 2 * row + 1;
+    JpegUVRow(src_u + static_cast<size_t>(row0) * src_uv_stride,
+              src_v + static_cast<size_t>(row0) * src_uv_stride,
+              src_u + static_cast<size_t>(row1) * src_uv_stride,
+              src_v + static_cast<size_t>(row1) * src_uv_stride,
+              uv_shift_x,
+              table,
+              dst,
+              uv_len);
+  }
+  return 0;
+}
+
+void ImageConvert::FillNv12Rect(uint8_t *dst_y,
+                                int dst_y_stride,
+                                uint8_t *dst_uv,
+                                int dst_uv_stride,
+                                int x,
+                                int y,
+                                int h,
+                                int w,
+                                uint8_t y_val,
+                                uint8_t u_val,
+                                uint8_t v_val) {
+  if (h <= 0 || w <= 0) {
+    return;
+  }
+  for (int row = y; row < y + h; row++) {
+    memset(dst_y + static_cast<size_t>(row) * dst_y_stride + x, y_val, w);
+  }
+  for (int row = y / 2; row < (y + h) / 2; row++) {
+    uint8_t *uv = dst_uv + static_cast<size_t>(row) * dst_uv_stride + x;
+    for (int col = 0; col < w; col += 2) {
+      uv[col] = u_val;
+      uv[col + 1] = v_val;
+    }
+  }
+}
@@ -15,6 +15,7 @@
 #include "include/image_utils.h"
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -22,122 +23,816 @@
 #include <vector>
 
 #include "dnn/hb_sys.h"
+#include "include/image_convert.h"
+#include "include/jpeg_decoder.h"
+#include "include/nv12_pyramid_pool.h"
 
-std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12Pyramid(
-    const cv::Mat &bgr_mat, int scaled_img_height, int scaled_img_width) {
-  cv::Mat nv12_mat;
-  cv::Mat mat_tmp;
-  mat_tmp.create(scaled_img_height, scaled_img_width, bgr_mat.type());
-  cv::resize(bgr_mat, mat_tmp, mat_tmp.size(), 0, 0);
-  auto ret = ImageUtils::BGRToNv12(mat_tmp, nv12_mat);
+namespace {
+
+// letterbox填充区域使用的黑色
+const uint8_t kPaddingY = 16;
+const uint8_t kPaddingUV = 128;
+
+// 填充pyramid中原图区域之外的部分
+void FillLetterboxBorder(const NV12PyramidInput &pyramid,
+                         const ImageTransform &transform) {
+  auto *y = reinterpret_cast<uint8_t *>(pyramid.y_vir_addr);
+  auto *uv = reinterpret_cast<uint8_t *>(pyramid.uv_vir_addr);
+  int content_bottom = transform.offset_y + transform.content_height;
+  int content_right = transform.offset_x + transform.content_width;
+  auto fill = [&](int x, int top, int h, int w) {
+    ImageConvert::FillNv12Rect(y,
+                               pyramid.y_stride,
+                               uv,
+                               pyramid.uv_stride,
+                               x,
+                               top,
+                               h,
+                               w,
+                               kPaddingY,
+                               kPaddingUV,
+                               kPaddingUV);
+  };
+  fill(0, 0, transform.offset_y, pyramid.width);
+  fill(0, content_bottom, pyramid.height - content_bottom, pyramid.width);
+  fill(0, transform.offset_y, transform.content_height, transform.offset_x);
+  fill(content_right,
+       transform.offset_y,
+       transform.content_height,
+       pyramid.width - content_right);
+}
+
+// 按行拷贝一个平面，源和目的stride一致时整块拷贝
+void ImportPlane(const uint8_t *src,
+                 int src_stride,
+                 uint8_t *dst,
+                 int dst_stride,
+                 int rows,
+                 int row_bytes) {
+  if (src_stride == dst_stride) {
+    memcpy(dst, src, static_cast<size_t>(rows) * dst_stride);
+    return;
+  }
+  for (int h = 0; h < rows; ++h) {
+    memcpy(dst + static_cast<size_t>(h) * dst_stride,
+           src + static_cast<size_t>(h) * src_stride,
+           row_bytes);
+  }
+}
+
+// 解码器的内部缓存在同一个线程的多次解码之间复用
+JpegDecoder &ThreadJpegDecoder() {
+  static thread_local JpegDecoder decoder;
+  return decoder;
+}
+
+// 按照resize_type（可选letterbox）计算原图在pyramid中的区域并写入
+// convert(src_h, src_w, y, y_stride, uv, uv_stride, dst_h, dst_w)将输入图片左上
+// src_h x src_w的区域双线性缩放并转换为dst_h x dst_w的nv12
+template <typename ConvertFunc>
+std::shared_ptr<NV12PyramidInput> ConvertToPyramid(int in_img_height,
+                                                   int in_img_width,
+                                                   int scaled_img_height,
+                                                   int scaled_img_width,
+                                                   ImageResizeType resize_type,
+                                                   bool is_letterbox,
+                                                   ImageTransform *transform,
+                                                   ConvertFunc convert) {
+  auto pyramid =
+      NV12PyramidPool::Instance()->Acquire(scaled_img_height, scaled_img_width);
+  if (!pyramid) {
+    std::cout << "get nv12 pyramid from pool failed " << std::endl;
+    return nullptr;
+  }
+
+  auto img_transform = ImageUtils::GetImageTransform(in_img_height,
+                                                     in_img_width,
+                                                     scaled_img_height,
+                                                     scaled_img_width,
+                                                     resize_type,
+                                                     is_letterbox);
+  auto *y = reinterpret_cast<uint8_t *>(pyramid->y_vir_addr) +
+            img_transform.offset_y * pyramid->y_stride + img_transform.offset_x;
+  auto *uv = reinterpret_cast<uint8_t *>(pyramid->uv_vir_addr) +
+             img_transform.offset_y / 2 * pyramid->uv_stride +
+             img_transform.offset_x;
+  // 实际写入pyramid的区域
+  ImageTransform written = img_transform;
+  int32_t ret = 0;
+  if (resize_type == ImageResizeType::CROP) {
+    // 不缩放，拷贝左上区域，宽高按2对齐
+    written.content_height &= ~1;
+    written.content_width &= ~1;
+    ret = convert(written.content_height,
+                  written.content_width,
+                  y,
+                  pyramid->y_stride,
+                  uv,
+                  pyramid->uv_stride,
+                  written.content_height,
+                  written.content_width);
+  } else if (resize_type == ImageResizeType::AREA &&
+             img_transform.content_height <= in_img_height &&
+             img_transform.content_width <= in_img_width &&
+             (img_transform.content_height < in_img_height ||
+              img_transform.content_width < in_img_width)) {
+    // kernel只支持双线性插值，先转换为原尺寸（宽高向下取偶数）的nv12，
+    // 再按照区域均值缩小。放大时区域均值退化为双线性插值，直接写入pyramid
+    static thread_local std::vector<uint8_t> nv12_buf;
+    int nv12_height = in_img_height & ~1;
+    int nv12_width = in_img_width & ~1;
+    nv12_buf.resize(static_cast<size_t>(nv12_width) * nv12_height * 3 / 2);
+    uint8_t *nv12_y = nv12_buf.data();
+    uint8_t *nv12_uv = nv12_y + static_cast<size_t>(nv12_width) * nv12_height;
+    ret = convert(in_img_height,
+                  in_img_width,
+                  nv12_y,
+                  nv12_width,
+                  nv12_uv,
+                  nv12_width,
+                  nv12_height,
+                  nv12_width);
+    if (ret == 0) {
+      ret = ImageConvert::Nv12Resize(nv12_y,
+                                     nv12_width,
+                                     nv12_uv,
+                                     nv12_width,
+                                     nv12_height,
+                                     nv12_width,
+                                     y,
+                                     pyramid->y_stride,
+                                     uv,
+                                     pyramid->uv_stride,
+                                     img_transform.content_height,
+                                     img_transform.content_width,
+                                     ImageConvert::ResizeMode::AREA);
+    }
+  } else {
+    // 缩放和格式转换一次完成，直接写入pyramid
+    ret = convert(in_img_height,
+                  in_img_width,
+                  y,
+                  pyramid->y_stride,
+                  uv,
+                  pyramid->uv_stride,
+                  img_transform.content_height,
+                  img_transform.content_width);
+  }
   if (ret) {
     std::cout << "get nv12 image failed " << std::endl;
     return nullptr;
   }
+  // crop时pyramid从缓存池复用，拷贝区域之外残留上一帧的数据，需要和letterbox一样填充
+  if (is_letterbox || resize_type == ImageResizeType::CROP) {
+    FillLetterboxBorder(*pyramid, written);
+  }
+  if (transform) {
+    *transform = img_transform;
+  }
+
+  NV12PyramidPool::FlushRows(
+      *pyramid, scaled_img_height, scaled_img_height / 2);
+  return pyramid;
+}
 
-  auto *y = new hbSysMem;
-  auto *uv = new hbSysMem;
+}  // namespace
 
-  auto w_stride = ALIGN_16(scaled_img_width);
-  hbSysAllocCachedMem(y, scaled_img_height * w_stride);
-  hbSysAllocCachedMem(uv, scaled_img_height / 2 * w_stride);
+ImageTransform ImageUtils::GetImageTransform(int in_img_height,
+                                             int in_img_width,
+                                             int scaled_img_height,
+                                             int scaled_img_width,
+                                             ImageResizeType resize_type,
+                                             bool is_letterbox) {
+  ImageTransform transform;
+  transform.src_width = in_img_width;
+  transform.src_height = in_img_height;
+  if (in_img_height <= 0 || in_img_width <= 0) {
+    return transform;
+  }
 
-  uint8_t *data = nv12_mat.data;
-  auto *hb_y_addr = reinterpret_cast<uint8_t *>(y->virAddr);
-  auto *hb_uv_addr = reinterpret_cast<uint8_t *>(uv->virAddr);
+  if (resize_type == ImageResizeType::CROP) {
+    transform.content_width = std::min(in_img_width, scaled_img_width);
+    transform.content_height = std::min(in_img_height, scaled_img_height);
+    return transform;
+  }
 
-  // padding y
-  for (int h = 0; h < scaled_img_height; ++h) {
-    auto *raw = hb_y_addr + h * w_stride;
-    for (int w = 0; w < scaled_img_width; ++w) {
-      *raw++ = *data++;
-    }
+  transform.content_width = scaled_img_width;
+  transform.content_height = scaled_img_height;
+  if (is_letterbox) {
+    float scale =
+        std::min(static_cast<float>(scaled_img_width) / in_img_width,
+                 static_cast<float>(scaled_img_height) / in_img_height);
+    // nv12要求宽高和起始坐标都是偶数
+    transform.content_width =
+        std::max(2, std::min(scaled_img_width,
+                             static_cast<int>(in_img_width * scale + 0.5f)) &
+                        ~1);
+    transform.content_height =
+        std::max(2, std::min(scaled_img_height,
+                             static_cast<int>(in_img_height * scale + 0.5f)) &
+                        ~1);
+    transform.offset_x = ((scaled_img_width - transform.content_width) / 2) & ~1;
+    transform.offset_y =
+        ((scaled_img_height - transform.content_height) / 2) & ~1;
   }
+  transform.scale_x =
+      static_cast<float>(transform.content_width) / in_img_width;
+  transform.scale_y =
+      static_cast<float>(transform.content_height) / in_img_height;
+  return transform;
+}
 
-  // padding uv
-  auto uv_data = nv12_mat.data + scaled_img_height * scaled_img_width;
-  for (int32_t h = 0; h < scaled_img_height / 2; ++h) {
-    auto *raw = hb_uv_addr + h * w_stride;
-    for (int32_t w = 0; w < scaled_img_width; ++w) {
-      *raw++ = *uv_data++;
-    }
+std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12Pyramid(
+    const cv::Mat &bgr_mat, int scaled_img_height, int scaled_img_width) {
+  if (bgr_mat.type() != CV_8UC3) {
+    std::cout << "input img must be bgr8" << std::endl;
+    return nullptr;
   }
+  return GetNV12PyramidFromRGBImg(bgr_mat.data,
+                                  bgr_mat.rows,
+                                  bgr_mat.cols,
+                                  static_cast<int>(bgr_mat.step),
+                                  true,
+                                  scaled_img_height,
+                                  scaled_img_width,
+                                  ImageResizeType::BILINEAR);
+}
+
+std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12PyramidFromRGBImg(
+    const uint8_t *in_img_data,
+    int in_img_height,
+    int in_img_width,
+    int in_img_step,
+    bool is_bgr,
+    int scaled_img_height,
+    int scaled_img_width,
+    ImageResizeType resize_type,
+    bool is_letterbox,
+    ImageTransform *transform) {
+  return ConvertToPyramid(
+      in_img_height,
+      in_img_width,
+      scaled_img_height,
+      scaled_img_width,
+      resize_type,
+      is_letterbox,
+      transform,
+      [&](int src_h,
+          int src_w,
+          uint8_t *y,
+          int y_stride,
+          uint8_t *uv,
+          int uv_stride,
+          int h,
+          int w) {
+        return ImageConvert::RGBToNv12Resize(in_img_data,
+                                             src_h,
+                                             src_w,
+                                             in_img_step,
+                                             is_bgr,
+                                             y,
+                                             y_stride,
+                                             uv,
+                                             uv_stride,
+                                             h,
+                                             w);
+      });
+}
 
-  hbSysFlushMem(y, HB_SYS_MEM_CACHE_CLEAN);
-  hbSysFlushMem(uv, HB_SYS_MEM_CACHE_CLEAN);
-  auto pyramid = new NV12PyramidInput;
-  pyramid->width = scaled_img_width;
-  pyramid->height = scaled_img_height;
-  pyramid->y_vir_addr = y->virAddr;
-  pyramid->y_phy_addr = y->phyAddr;
-  pyramid->y_stride = w_stride;
-  pyramid->uv_vir_addr = uv->virAddr;
-  pyramid->uv_phy_addr = uv->phyAddr;
-  pyramid->uv_stride = w_stride;
-  return std::shared_ptr<NV12PyramidInput>(pyramid,
-                                           [y, uv](NV12PyramidInput *pyramid) {
-                                             // Release memory after deletion
-                                             hbSysFreeMem(y);
-                                             hbSysFreeMem(uv);
-                                             delete y;
-                                             delete uv;
-                                             delete pyramid;
-                                           });
+std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12PyramidFromYUV422Img(
+    const uint8_t *in_img_data,
+    int in_img_height,
+    int in_img_width,
+    int in_img_step,
+    bool is_uyvy,
+    int scaled_img_height,
+    int scaled_img_width,
+    ImageResizeType resize_type,
+    bool is_letterbox,
+    ImageTransform *transform) {
+  return ConvertToPyramid(
+      in_img_height,
+      in_img_width,
+      scaled_img_height,
+      scaled_img_width,
+      resize_type,
+      is_letterbox,
+      transform,
+      [&](int src_h,
+          int src_w,
+          uint8_t *y,
+          int y_stride,
+          uint8_t *uv,
+          int uv_stride,
+          int h,
+          int w) {
+        return ImageConvert::Yuv422ToNv12Resize(in_img_data,
+                                                src_h,
+                                                src_w,
+                                                in_img_step,
+                                                is_uyvy,
+                                                y,
+                                                y_stride,
+                                                uv,
+                                                uv_stride,
+                                                h,
+                                                w);
+      });
+}
+
+std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12PyramidFromGrayImg(
+    const uint8_t *in_img_data,
+    int in_img_height,
+    int in_img_width,
+    int in_img_step,
+    int scaled_img_height,
+    int scaled_img_width,
+    ImageResizeType resize_type,
+    bool is_letterbox,
+    ImageTransform *transform) {
+  return ConvertToPyramid(
+      in_img_height,
+      in_img_width,
+      scaled_img_height,
+      scaled_img_width,
+      resize_type,
+      is_letterbox,
+      transform,
+      [&](int src_h,
+          int src_w,
+          uint8_t *y,
+          int y_stride,
+          uint8_t *uv,
+          int uv_stride,
+          int h,
+          int w) {
+        return ImageConvert::GrayToNv12Resize(in_img_data,
+                                              src_h,
+                                              src_w,
+                                              in_img_step,
+                                              y,
+                                              y_stride,
+                                              uv,
+                                              uv_stride,
+                                              h,
+                                              w);
+      });
 }
 
 std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12PyramidFromNV12Img(
     const char *in_img_data,
     int in_img_height,
     int in_img_width,
+    int in_img_step,
     int scaled_img_height,
-    int scaled_img_width) {
-  auto *y = new hbSysMem;
-  auto *uv = new hbSysMem;
-  auto w_stride = ALIGN_16(scaled_img_width);
-  hbSysAllocCachedMem(y, scaled_img_height * w_stride);
-  hbSysAllocCachedMem(uv, scaled_img_height / 2 * w_stride);
+    int scaled_img_width,
+    ImageResizeType resize_type,
+    bool is_letterbox,
+    ImageTransform *transform) {
+  int src_stride = in_img_step > 0 ? in_img_step : in_img_width;
+  if (src_stride < in_img_width) {
+    std::cout << "input img step " << src_stride << " is less than width "
+              << in_img_width << std::endl;
+    return nullptr;
+  }
+
+  auto pyramid =
+      NV12PyramidPool::Instance()->Acquire(scaled_img_height, scaled_img_width);
+  if (!pyramid) {
+    std::cout << "get nv12 pyramid from pool failed " << std::endl;
+    return nullptr;
+  }
 
   const uint8_t *data = reinterpret_cast<const uint8_t *>(in_img_data);
-  auto *hb_y_addr = reinterpret_cast<uint8_t *>(y->virAddr);
-  auto *hb_uv_addr = reinterpret_cast<uint8_t *>(uv->virAddr);
-  int copy_w = std::min(in_img_width, scaled_img_width);
-  int copy_h = std::min(in_img_height, scaled_img_height);
-
-  // padding y
-  for (int h = 0; h < copy_h; ++h) {
-    auto *raw = hb_y_addr + h * w_stride;
-    auto *src = data + h * in_img_width;
-    memcpy(raw, src, copy_w);
-  }
-
-  // padding uv
-  auto uv_data = in_img_data + in_img_height * in_img_width;
-  for (int32_t h = 0; h < copy_h / 2; ++h) {
-    auto *raw = hb_uv_addr + h * w_stride;
-    auto *src = uv_data + h * in_img_width;
-    memcpy(raw, src, copy_w);
-  }
-
-  hbSysFlushMem(y, HB_SYS_MEM_CACHE_CLEAN);
-  hbSysFlushMem(uv, HB_SYS_MEM_CACHE_CLEAN);
-  auto pyramid = new NV12PyramidInput;
-  pyramid->width = scaled_img_width;
-  pyramid->height = scaled_img_height;
-  pyramid->y_vir_addr = y->virAddr;
-  pyramid->y_phy_addr = y->phyAddr;
-  pyramid->y_stride = w_stride;
-  pyramid->uv_vir_addr = uv->virAddr;
-  pyramid->uv_phy_addr = uv->phyAddr;
-  pyramid->uv_stride = w_stride;
-  return std::shared_ptr<NV12PyramidInput>(pyramid,
-                                           [y, uv](NV12PyramidInput *pyramid) {
-                                             // Release memory after deletion
-                                             hbSysFreeMem(y);
-                                             hbSysFreeMem(uv);
-                                             delete y;
-                                             delete uv;
-                                             delete pyramid;
-                                           });
+  const uint8_t *uv_data =
+      data + static_cast<size_t>(in_img_height) * src_stride;
+  auto *hb_y_addr = reinterpret_cast<uint8_t *>(pyramid->y_vir_addr);
+  auto *hb_uv_addr = reinterpret_cast<uint8_t *>(pyramid->uv_vir_addr);
+
+  if (in_img_height == scaled_img_height && in_img_width == scaled_img_width) {
+    // 输入和模型输入尺寸一致，直接导入，stride一致时每个平面只拷贝一次
+    ImportPlane(data,
+                src_stride,
+                hb_y_addr,
+                pyramid->y_stride,
+                in_img_height,
+                in_img_width);
+    ImportPlane(uv_data,
+                src_stride,
+                hb_uv_addr,
+                pyramid->uv_stride,
+                in_img_height / 2,
+                in_img_width);
+    if (transform) {
+      *transform = GetImageTransform(in_img_height,
+                                     in_img_width,
+                                     scaled_img_height,
+                                     scaled_img_width,
+                                     ImageResizeType::CROP,
+                                     false);
+    }
+    NV12PyramidPool::FlushRows(
+        *pyramid, scaled_img_height, scaled_img_height / 2);
+    return pyramid;
+  }
+
+  auto img_transform = GetImageTransform(in_img_height,
+                                         in_img_width,
+                                         scaled_img_height,
+                                         scaled_img_width,
+                                         resize_type,
+                                         is_letterbox);
+  if (transform) {
+    *transform = img_transform;
+  }
+
+  if (resize_type == ImageResizeType::CROP) {
+    int copy_w = img_transform.content_width;
+    int copy_h = img_transform.content_height;
+
+    // padding y
+    for (int h = 0; h < copy_h; ++h) {
+      auto *raw = hb_y_addr + h * pyramid->y_stride;
+      auto *src = data + h * src_stride;
+      memcpy(raw, src, copy_w);
+    }
+
+    // padding uv
+    for (int32_t h = 0; h < copy_h / 2; ++h) {
+      auto *raw = hb_uv_addr + h * pyramid->uv_stride;
+      auto *src = uv_data + h * src_stride;
+      memcpy(raw, src, copy_w);
+    }
+
+    // pyramid从缓存池复用，拷贝区域之外残留上一帧的数据，需要和letterbox一样填充
+    FillLetterboxBorder(*pyramid, img_transform);
+    NV12PyramidPool::FlushRows(
+        *pyramid, scaled_img_height, scaled_img_height / 2);
+    return pyramid;
+  }
+
+  auto ret = ImageConvert::Nv12Resize(
+      data,
+      src_stride,
+      uv_data,
+      src_stride,
+      in_img_height,
+      in_img_width,
+      hb_y_addr + img_transform.offset_y * pyramid->y_stride +
+          img_transform.offset_x,
+      pyramid->y_stride,
+      hb_uv_addr + img_transform.offset_y / 2 * pyramid->uv_stride +
+          img_transform.offset_x,
+      pyramid->uv_stride,
+      img_transform.content_height,
+      img_transform.content_width,
+      resize_type == ImageResizeType::AREA
+          ? ImageConvert::ResizeMode::AREA
+          : ImageConvert::ResizeMode::BILINEAR);
+  if (ret) {
+    std::cout << "resize nv12 image failed " << std::endl;
+    return nullptr;
+  }
+  if (is_letterbox) {
+    FillLetterboxBorder(*pyramid, img_transform);
+  }
+
+  NV12PyramidPool::FlushRows(
+      *pyramid, scaled_img_height, scaled_img_height / 2);
+  return pyramid;
+}
+
+std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12PyramidFromNV12Region(
+    const uint8_t *in_img_y,
+    int in_img_y_step,
+    const uint8_t *in_img_uv,
+    int in_img_uv_step,
+    int in_img_height,
+    int in_img_width,
+    int region_x,
+    int region_y,
+    int region_height,
+    int region_width,
+    int scaled_img_height,
+    int scaled_img_width,
+    ImageResizeType resize_type,
+    bool is_letterbox,
+    ImageTransform *transform) {
+  if ((region_x | region_y | region_height | region_width) & 1 ||
+      region_x < 0 || region_y < 0 || region_width <= 0 ||
+      region_height <= 0 || region_x + region_width > in_img_width ||
+      region_y + region_height > in_img_height) {
+    std::cout << "invalid nv12 region " << region_x << "," << region_y << " "
+              << region_width << "x" << region_height << std::endl;
+    return nullptr;
+  }
+
+  auto pyramid =
+      NV12PyramidPool::Instance()->Acquire(scaled_img_height, scaled_img_width);
+  if (!pyramid) {
+    std::cout << "get nv12 pyramid from pool failed " << std::endl;
+    return nullptr;
+  }
+
+  auto img_transform = GetImageTransform(region_height,
+                                         region_width,
+                                         scaled_img_height,
+                                         scaled_img_width,
+                                         resize_type == ImageResizeType::CROP
+                                             ? ImageResizeType::BILINEAR
+                                             : resize_type,
+                                         is_letterbox);
+  const uint8_t *src_y =
+      in_img_y + static_cast<size_t>(region_y) * in_img_y_step + region_x;
+  const uint8_t *src_uv = in_img_uv +
+                          static_cast<size_t>(region_y / 2) * in_img_uv_step +
+                          region_x;
+  auto *hb_y_addr = reinterpret_cast<uint8_t *>(pyramid->y_vir_addr) +
+                    img_transform.offset_y * pyramid->y_stride +
+                    img_transform.offset_x;
+  auto *hb_uv_addr = reinterpret_cast<uint8_t *>(pyramid->uv_vir_addr) +
+                     img_transform.offset_y / 2 * pyramid->uv_stride +
+                     img_transform.offset_x;
+  if (img_transform.content_height == region_height &&
+      img_transform.content_width == region_width) {
+    // 区域与模型输入区域一样大，直接拷贝
+    ImportPlane(src_y,
+                in_img_y_step,
+                hb_y_addr,
+                pyramid->y_stride,
+                region_height,
+                region_width);
+    ImportPlane(src_uv,
+                in_img_uv_step,
+                hb_uv_addr,
+                pyramid->uv_stride,
+                region_height / 2,
+                region_width);
+  } else if (ImageConvert::Nv12Resize(src_y,
+                                      in_img_y_step,
+                                      src_uv,
+                                      in_img_uv_step,
+                                      region_height,
+                                      region_width,
+                                      hb_y_addr,
+                                      pyramid->y_stride,
+                                      hb_uv_addr,
+                                      pyramid->uv_stride,
+                                      img_transform.content_height,
+                                      img_transform.content_width,
+                                      resize_type == ImageResizeType::AREA
+                                          ? ImageConvert::ResizeMode::AREA
+                                          : ImageConvert::ResizeMode::BILINEAR)) {
+    std::cout << "resize nv12 region failed " << std::endl;
+    return nullptr;
+  }
+  if (is_letterbox) {
+    FillLetterboxBorder(*pyramid, img_transform);
+  }
+  if (transform) {
+    img_transform.crop_x = region_x;
+    img_transform.crop_y = region_y;
+    img_transform.src_width = in_img_width;
+    img_transform.src_height = in_img_height;
+    *transform = img_transform;
+  }
+
+  NV12PyramidPool::FlushRows(
+      *pyramid, scaled_img_height, scaled_img_height / 2);
+  return pyramid;
+}
+
+int32_t ImageUtils::ConvertToNV12(const std::string &encoding,
+                                  const uint8_t *in_img_data,
+                                  size_t in_img_size,
+                                  int in_img_height,
+                                  int in_img_width,
+                                  int in_img_step,
+                                  std::vector<uint8_t> &nv12_buf,
+                                  int &nv12_height,
+                                  int &nv12_width) {
+  JpegDecoder::YuvPlanes planes;
+  if ("jpeg" == encoding) {
+    int src_height = 0;
+    int src_width = 0;
+    if (JpegDecoder::ReadHeader(
+            in_img_data, in_img_size, src_height, src_width)) {
+      std::cout << "read jpeg header failed " << std::endl;
+      return -1;
+    }
+    // 按照原图尺寸解码，不做DCT缩放
+    if (ThreadJpegDecoder().Decode(
+            in_img_data, in_img_size, src_height, src_width, planes)) {
+      return -1;
+    }
+    in_img_height = planes.height;
+    in_img_width = planes.width;
+  }
+
+  nv12_height = in_img_height & ~1;
+  nv12_width = in_img_width & ~1;
+  if (nv12_height < 2 || nv12_width < 2) {
+    std::cout << "input img is too small " << in_img_width << "x"
+              << in_img_height << std::endl;
+    return -1;
+  }
+  nv12_buf.resize(static_cast<size_t>(nv12_width) * nv12_height * 3 / 2);
+  uint8_t *y = nv12_buf.data();
+  uint8_t *uv = y + static_cast<size_t>(nv12_width) * nv12_height;
+
+  int32_t ret = -1;
+  if ("jpeg" == encoding) {
+    ret = ImageConvert::JpegYuvToNv12(planes.y,
+                                      planes.y_stride,
+                                      planes.u,
+                                      planes.v,
+                                      planes.uv_stride,
+                                      planes.uv_shift_x,
+                                      planes.uv_shift_y,
+                                      y,
+                                      nv12_width,
+                                      uv,
+                                      nv12_width,
+                                      nv12_height,
+                                      nv12_width);
+  } else if ("rgb8" == encoding || "bgr8" == encoding) {
+    ret = ImageConvert::RGBToNv12Resize(in_img_data,
+                                        nv12_height,
+                                        nv12_width,
+                                        in_img_step,
+                                        "bgr8" == encoding,
+                                        y,
+                                        nv12_width,
+                                        uv,
+                                        nv12_width,
+                                        nv12_height,
+                                        nv12_width);
+  } else if ("yuyv" == encoding || "yuv422_yuy2" == encoding ||
+             "uyvy" == encoding || "yuv422" == encoding) {
+    ret = ImageConvert::Yuv422ToNv12Resize(
+        in_img_data,
+        nv12_height,
+        nv12_width,
+        in_img_step,
+        "uyvy" == encoding || "yuv422" == encoding,
+        y,
+        nv12_width,
+        uv,
+        nv12_width,
+        nv12_height,
+        nv12_width);
+  } else if ("mono8" == encoding) {
+    ret = ImageConvert::GrayToNv12Resize(in_img_data,
+                                         nv12_height,
+                                         nv12_width,
+                                         in_img_step,
+                                         y,
+                                         nv12_width,
+                                         uv,
+                                         nv12_width,
+                                         nv12_height,
+                                         nv12_width);
+  } else {
+    std::cout << "unsupported img encoding " << encoding << std::endl;
+  }
+  return ret;
+}
+
+std::shared_ptr<NV12PyramidInput> ImageUtils::GetNV12PyramidFromJpeg(
+    const uint8_t *in_img_data,
+    size_t in_img_size,
+    int scaled_img_height,
+    int scaled_img_width,
+    ImageResizeType resize_type,
+    bool is_letterbox,
+    ImageTransform *transform) {
+  int src_height = 0;
+  int src_width = 0;
+  if (JpegDecoder::ReadHeader(in_img_data, in_img_size, src_height, src_width)) {
+    std::cout << "read jpeg header failed " << std::endl;
+    return nullptr;
+  }
+  // 坐标映射按照原图计算，DCT缩放只影响解码后的中间尺寸
+  auto img_transform = GetImageTransform(src_height,
+                                         src_width,
+                                         scaled_img_height,
+                                         scaled_img_width,
+                                         resize_type,
+                                         is_letterbox);
+  // crop需要原图像素，不做DCT缩放
+  bool is_crop = resize_type == ImageResizeType::CROP;
+  JpegDecoder::YuvPlanes planes;
+  if (ThreadJpegDecoder().Decode(
+          in_img_data,
+          in_img_size,
+          is_crop ? src_height : img_transform.content_height,
+          is_crop ? src_width : img_transform.content_width,
+          planes)) {
+    return nullptr;
+  }
+
+  auto pyramid =
+      NV12PyramidPool::Instance()->Acquire(scaled_img_height, scaled_img_width);
+  if (!pyramid) {
+    std::cout << "get nv12 pyramid from pool failed " << std::endl;
+    return nullptr;
+  }
+  auto *hb_y_addr = reinterpret_cast<uint8_t *>(pyramid->y_vir_addr) +
+                    img_transform.offset_y * pyramid->y_stride +
+                    img_transform.offset_x;
+  auto *hb_uv_addr = reinterpret_cast<uint8_t *>(pyramid->uv_vir_addr) +
+                     img_transform.offset_y / 2 * pyramid->uv_stride +
+                     img_transform.offset_x;
+
+  int32_t ret = 0;
+  if (is_crop || (planes.height == img_transform.content_height &&
+                  planes.width == img_transform.content_width)) {
+    // 解码尺寸与模型输入区域一致（或者crop左上区域），直接写入pyramid
+    int copy_h = std::min(img_transform.content_height, planes.height) & ~1;
+    int copy_w = std::min(img_transform.content_width, planes.width) & ~1;
+    ret = ImageConvert::JpegYuvToNv12(planes.y,
+                                      planes.y_stride,
+                                      planes.u,
+                                      planes.v,
+                                      planes.uv_stride,
+                                      planes.uv_shift_x,
+                                      planes.uv_shift_y,
+                                      hb_y_addr,
+                                      pyramid->y_stride,
+                                      hb_uv_addr,
+                                      pyramid->uv_stride,
+                                      copy_h,
+                                      copy_w);
+    if (is_crop) {
+      if (ret) {
+        std::cout << "convert jpeg to nv12 failed " << std::endl;
+        return nullptr;
+      }
+      // pyramid从缓存池复用，拷贝区域（宽高按2对齐）之外残留上一帧的数据，
+      // 需要和letterbox一样填充
+      ImageTransform copied = img_transform;
+      copied.content_height = copy_h;
+      copied.content_width = copy_w;
+      FillLetterboxBorder(*pyramid, copied);
+      if (transform) {
+        *transform = img_transform;
+      }
+      NV12PyramidPool::FlushRows(
+          *pyramid, scaled_img_height, scaled_img_height / 2);
+      return pyramid;
+    }
+  } else {
+    // 解码尺寸与模型输入不一致，先转换为解码尺寸的nv12再缩放
+    static thread_local std::vector<uint8_t> nv12_buf;
+    int stride = planes.width;
+    nv12_buf.resize(static_cast<size_t>(stride) * planes.height * 3 / 2);
+    uint8_t *nv12_y = nv12_buf.data();
+    uint8_t *nv12_uv = nv12_y + static_cast<size_t>(stride) * planes.height;
+    ret = ImageConvert::JpegYuvToNv12(planes.y,
+                                      planes.y_stride,
+                                      planes.u,
+                                      planes.v,
+                                      planes.uv_stride,
+                                      planes.uv_shift_x,
+                                      planes.uv_shift_y,
+                                      nv12_y,
+                                      stride,
+                                      nv12_uv,
+                                      stride,
+                                      planes.height,
+                                      planes.width);
+    if (ret == 0) {
+      ret = ImageConvert::Nv12Resize(nv12_y,
+                                     stride,
+                                     nv12_uv,
+                                     stride,
+                                     planes.height,
+                                     planes.width,
+                                     hb_y_addr,
+                                     pyramid->y_stride,
+                                     hb_uv_addr,
+                                     pyramid->uv_stride,
+                                     img_transform.content_height,
+                                     img_transform.content_width,
+                                     resize_type == ImageResizeType::AREA
+                                         ? ImageConvert::ResizeMode::AREA
+                                         : ImageConvert::ResizeMode::BILINEAR);
+    }
+  }
+  if (ret) {
+    std::cout << "convert jpeg to nv12 failed " << std::endl;
+    return nullptr;
+  }
+  if (is_letterbox) {
+    FillLetterboxBorder(*pyramid, img_transform);
+  }
+  if (transform) {
+    *transform = img_transform;
+  }
+
+  NV12PyramidPool::FlushRows(
+      *pyramid, scaled_img_height, scaled_img_height / 2);
+  return pyramid;
 }
 
 int32_t ImageUtils::BGRToNv12(cv::Mat &bgr_mat, cv::Mat &img_nv12) {
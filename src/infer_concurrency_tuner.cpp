@@ -0,0 +1,118 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/infer_concurrency_tuner.h"
+
+#include <algorithm>
+#include <sstream>
+
+void InferConcurrencyTuner::BeginLevel(int concurrency, int frames) {
+  std::lock_guard<std::mutex> lk(mtx_);
+  concurrency_ = concurrency;
+  expected_frames_ = frames;
+  latencies_ms_.clear();
+  latencies_ms_.reserve(frames);
+  level_start_ = std::chrono::steady_clock::now();
+  last_sample_ = level_start_;
+}
+
+void InferConcurrencyTuner::AddSample(float latency_ms) {
+  bool done = false;
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    latencies_ms_.push_back(latency_ms);
+    last_sample_ = std::chrono::steady_clock::now();
+    done = static_cast<int>(latencies_ms_.size()) >= expected_frames_;
+  }
+  if (done) {
+    cv_.notify_all();
+  }
+}
+
+bool InferConcurrencyTuner::WaitLevel(int timeout_ms) {
+  std::unique_lock<std::mutex> lk(mtx_);
+  return cv_.wait_for(lk, std::chrono::milliseconds(timeout_ms), [this] {
+    return static_cast<int>(latencies_ms_.size()) >= expected_frames_;
+  });
+}
+
+InferConcurrencyTuner::LevelResult InferConcurrencyTuner::EndLevel() {
+  std::lock_guard<std::mutex> lk(mtx_);
+  LevelResult result;
+  result.concurrency = concurrency_;
+  result.frames = latencies_ms_.size();
+  if (latencies_ms_.empty()) {
+    return result;
+  }
+  float duration_ms = std::chrono::duration_cast<std::chrono::microseconds>(
+                          last_sample_ - level_start_)
+                          .count() /
+                      1000.0f;
+  if (duration_ms > 0) {
+    result.fps = result.frames * 1000.0f / duration_ms;
+  }
+  float sum = 0;
+  for (const auto &latency : latencies_ms_) {
+    sum += latency;
+  }
+  result.mean_ms = sum / result.frames;
+  size_t p99_idx = (latencies_ms_.size() * 99 + 99) / 100 - 1;
+  std::nth_element(latencies_ms_.begin(),
+                   latencies_ms_.begin() + p99_idx,
+                   latencies_ms_.end());
+  result.p99_ms = latencies_ms_[p99_idx];
+  return result;
+}
+
+int InferConcurrencyTuner::Select(const std::vector<LevelResult> &curve,
+                                  float latency_budget_ms) {
+  const LevelResult *best = nullptr;
+  for (const auto &result : curve) {
+    if (result.frames <= 0 || result.p99_ms > latency_budget_ms) {
+      continue;
+    }
+    if (!best || result.fps > best->fps) {
+      best = &result;
+    }
+  }
+  if (best) {
+    return best->concurrency;
+  }
+  for (const auto &result : curve) {
+    if (result.frames <= 0) {
+      continue;
+    }
+    if (!best || result.p99_ms < best->p99_ms) {
+      best = &result;
+    }
+  }
+  return best ? best->concurrency : -1;
+}
+
+std::string InferConcurrencyTuner::ToJson(const std::vector<LevelResult> &curve,
+                                          int selected,
+                                          float latency_budget_ms) {
+  std::stringstream ss;
+  ss << "{\"task_num\": " << selected
+     << ", \"latency_budget_ms\": " << latency_budget_ms << ", \"curve\": [";
+  for (size_t idx = 0; idx < curve.size(); idx++) {
+    const auto &result = curve[idx];
+    ss << (idx > 0 ? ", " : "") << "{\"task_num\": " << result.concurrency
+       << ", \"frames\": " << result.frames << ", \"fps\": " << result.fps
+       << ", \"mean_ms\": " << result.mean_ms
+       << ", \"p99_ms\": " << result.p99_ms << "}";
+  }
+  ss << "]}";
+  return ss.str();
+}
@@ -0,0 +1,273 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/jpeg_decoder.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <iostream>
+
+#include "jpeglib.h"
+
+namespace {
+
+// libjpeg出错时跳转回调用处，不使用默认的exit
+struct ErrorMgr {
+  jpeg_error_mgr pub;
+  jmp_buf jump;
+};
+
+void ErrorExit(j_common_ptr cinfo) {
+  char msg[JMSG_LENGTH_MAX];
+  (*cinfo->err->format_message)(cinfo, msg);
+  std::cerr << "decode jpeg failed: " << msg << std::endl;
+  longjmp(reinterpret_cast<ErrorMgr*>(cinfo->err)->jump, 1);
+}
+
+// mjpeg数据常见的可恢复警告（如数据提前结束）不输出，避免每帧打印
+void OutputMessage(j_common_ptr) {}
+
+int Align16(int val) { return (val + 15) & ~15; }
+
+#if JPEG_LIB_VERSION >= 70
+int MinDctVSize(const jpeg_decompress_struct* cinfo) {
+  return cinfo->min_DCT_v_scaled_size;
+}
+int DctHSize(const jpeg_component_info* comp) {
+  return comp->DCT_h_scaled_size;
+}
+int DctVSize(const jpeg_component_info* comp) {
+  return comp->DCT_v_scaled_size;
+}
+#else
+int MinDctVSize(const jpeg_decompress_struct* cinfo) {
+  return cinfo->min_DCT_scaled_size;
+}
+int DctHSize(const jpeg_component_info* comp) { return comp->DCT_scaled_size; }
+int DctVSize(const jpeg_component_info* comp) { return comp->DCT_scaled_size; }
+#endif
+
+// 解码尺寸比目标小不超过1/16时仍然使用更小的缩放比例，
+// 例如1920x1080缩小一半为960x540，可以用于960x544的模型输入
+int ChooseScaleDenom(int src_height, int src_width, int min_height,
+                     int min_width) {
+  int denom = 1;
+  for (int next = 2; next <= 8; next *= 2) {
+    int height = (src_height + next - 1) / next;
+    int width = (src_width + next - 1) / next;
+    if (height * 16 < min_height * 15 || width * 16 < min_width * 15) {
+      break;
+    }
+    denom = next;
+  }
+  return denom;
+}
+
+bool IsRawSupported(const jpeg_decompress_struct& cinfo) {
+  if (cinfo.num_components == 1) {
+    return true;
+  }
+  if (cinfo.num_components != 3 || cinfo.jpeg_color_space != JCS_YCbCr) {
+    return false;
+  }
+  const jpeg_component_info* comp = cinfo.comp_info;
+  return comp[0].h_samp_factor <= 2 && comp[0].v_samp_factor <= 2 &&
+         comp[1].h_samp_factor == 1 && comp[1].v_samp_factor == 1 &&
+         comp[2].h_samp_factor == 1 && comp[2].v_samp_factor == 1;
+}
+
+// 色度平面相对亮度平面的下采样位数，缩放解码时色度可能以更大的DCT尺寸输出
+int ChromaShift(int luma_size, int chroma_size) {
+  if (luma_size == chroma_size) {
+    return 0;
+  }
+  if (luma_size == chroma_size * 2) {
+    return 1;
+  }
+  return -1;
+}
+
+}  // namespace
+
+int JpegDecoder::ReadHeader(const uint8_t* data,
+                            size_t size,
+                            int& height,
+                            int& width) {
+  if (!data || size == 0) {
+    return -1;
+  }
+  jpeg_decompress_struct cinfo;
+  ErrorMgr err;
+  cinfo.err = jpeg_std_error(&err.pub);
+  err.pub.error_exit = ErrorExit;
+  err.pub.output_message = OutputMessage;
+  if (setjmp(err.jump)) {
+    jpeg_destroy_decompress(&cinfo);
+    return -1;
+  }
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo,
+               const_cast<unsigned char*>(data),
+               static_cast<unsigned long>(size));  // NOLINT
+  jpeg_read_header(&cinfo, TRUE);
+  height = static_cast<int>(cinfo.image_height);
+  width = static_cast<int>(cinfo.image_width);
+  jpeg_destroy_decompress(&cinfo);
+  return 0;
+}
+
+int JpegDecoder::Decode(const uint8_t* data,
+                        size_t size,
+                        int min_height,
+                        int min_width,
+                        YuvPlanes& planes) {
+  if (!data || size == 0) {
+    return -1;
+  }
+  jpeg_decompress_struct cinfo;
+  ErrorMgr err;
+  cinfo.err = jpeg_std_error(&err.pub);
+  err.pub.error_exit = ErrorExit;
+  err.pub.output_message = OutputMessage;
+  if (setjmp(err.jump)) {
+    jpeg_destroy_decompress(&cinfo);
+    return -1;
+  }
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo,
+               const_cast<unsigned char*>(data),
+               static_cast<unsigned long>(size));  // NOLINT
+  jpeg_read_header(&cinfo, TRUE);
+
+  planes = YuvPlanes();
+  planes.src_height = static_cast<int>(cinfo.image_height);
+  planes.src_width = static_cast<int>(cinfo.image_width);
+  planes.scale_denom = ChooseScaleDenom(
+      planes.src_height, planes.src_width, min_height, min_width);
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = static_cast<unsigned int>(planes.scale_denom);
+  cinfo.dct_method = JDCT_IFAST;
+  cinfo.do_fancy_upsampling = FALSE;
+
+  int ret = IsRawSupported(cinfo) ? ReadRawPlanes(&cinfo, planes)
+                                  : ReadScanlines(&cinfo, planes);
+  // 不读取图片结束标记，直接释放
+  jpeg_destroy_decompress(&cinfo);
+  if (ret == 0 && (planes.width < 2 || planes.height < 2)) {
+    std::cerr << "decoded jpeg is too small" << std::endl;
+    return -1;
+  }
+  return ret;
+}
+
+int JpegDecoder::ReadRawPlanes(jpeg_decompress_struct* cinfo,
+                               YuvPlanes& planes) {
+  cinfo->raw_data_out = TRUE;
+  jpeg_start_decompress(cinfo);
+
+  int comp_num = cinfo->num_components;
+  int lines_per_call = cinfo->max_v_samp_factor * MinDctVSize(cinfo);
+  int imcu_rows =
+      (static_cast<int>(cinfo->output_height) + lines_per_call - 1) /
+      lines_per_call;
+  // 每次读取一个iMCU行，每个平面按照完整的块分配，末尾不完整的块也可以直接写入
+  int strides[3] = {0, 0, 0};
+  int rows_per_call[3] = {0, 0, 0};
+  for (int idx = 0; idx < comp_num; idx++) {
+    const jpeg_component_info* comp = &cinfo->comp_info[idx];
+    strides[idx] =
+        Align16(static_cast<int>(comp->width_in_blocks) * DctHSize(comp));
+    rows_per_call[idx] = comp->v_samp_factor * DctVSize(comp);
+    int rows = rows_per_call[idx] * imcu_rows;
+    plane_bufs_[idx].resize(static_cast<size_t>(strides[idx]) * rows);
+    row_ptrs_[idx].resize(rows);
+    for (int row = 0; row < rows; row++) {
+      row_ptrs_[idx][row] =
+          plane_bufs_[idx].data() + static_cast<size_t>(row) * strides[idx];
+    }
+  }
+
+  JSAMPARRAY arrays[3] = {nullptr, nullptr, nullptr};
+  for (int imcu_row = 0;
+       imcu_row < imcu_rows && cinfo->output_scanline < cinfo->output_height;
+       imcu_row++) {
+    for (int idx = 0; idx < comp_num; idx++) {
+      arrays[idx] = row_ptrs_[idx].data() + imcu_row * rows_per_call[idx];
+    }
+    if (jpeg_read_raw_data(cinfo, arrays, lines_per_call) == 0) {
+      std::cerr << "read jpeg raw data failed" << std::endl;
+      return -1;
+    }
+  }
+
+  planes.y = plane_bufs_[0].data();
+  planes.y_stride = strides[0];
+  planes.width = static_cast<int>(cinfo->output_width) & ~1;
+  planes.height = static_cast<int>(cinfo->output_height) & ~1;
+  if (comp_num == 3) {
+    const jpeg_component_info* comp = cinfo->comp_info;
+    planes.uv_shift_x = ChromaShift(comp[0].h_samp_factor * DctHSize(&comp[0]),
+                                    comp[1].h_samp_factor * DctHSize(&comp[1]));
+    planes.uv_shift_y = ChromaShift(comp[0].v_samp_factor * DctVSize(&comp[0]),
+                                    comp[1].v_samp_factor * DctVSize(&comp[1]));
+    if (planes.uv_shift_x < 0 || planes.uv_shift_y < 0 ||
+        strides[1] != strides[2]) {
+      std::cerr << "unsupported jpeg chroma sampling" << std::endl;
+      return -1;
+    }
+    planes.u = plane_bufs_[1].data();
+    planes.v = plane_bufs_[2].data();
+    planes.uv_stride = strides[1];
+  }
+  return 0;
+}
+
+int JpegDecoder::ReadScanlines(jpeg_decompress_struct* cinfo,
+                               YuvPlanes& planes) {
+  cinfo->out_color_space = JCS_YCbCr;
+  jpeg_start_decompress(cinfo);
+
+  int width = static_cast<int>(cinfo->output_width);
+  int height = static_cast<int>(cinfo->output_height);
+  int stride = Align16(width);
+  for (auto& buf : plane_bufs_) {
+    buf.resize(static_cast<size_t>(stride) * height);
+  }
+  row_buf_.resize(static_cast<size_t>(width) * 3);
+  while (cinfo->output_scanline < cinfo->output_height) {
+    size_t offset = static_cast<size_t>(cinfo->output_scanline) * stride;
+    JSAMPROW row = row_buf_.data();
+    if (jpeg_read_scanlines(cinfo, &row, 1) != 1) {
+      std::cerr << "read jpeg scanline failed" << std::endl;
+      return -1;
+    }
+    uint8_t* y = plane_bufs_[0].data() + offset;
+    uint8_t* u = plane_bufs_[1].data() + offset;
+    uint8_t* v = plane_bufs_[2].data() + offset;
+    for (int col = 0; col < width; col++) {
+      y[col] = row[3 * col];
+      u[col] = row[3 * col + 1];
+      v[col] = row[3 * col + 2];
+    }
+  }
+
+  planes.y = plane_bufs_[0].data();
+  planes.y_stride = stride;
+  planes.u = plane_bufs_[1].data();
+  planes.v = plane_bufs_[2].data();
+  planes.uv_stride = stride;
+  planes.width = width & ~1;
+  planes.height = height & ~1;
+  return 0;
+}
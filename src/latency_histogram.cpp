@@ -0,0 +1,179 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/latency_histogram.h"
+
+#include <time.h>
+
+#include <sstream>
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  last_counts_.fill(0);
+  interval_counts_.fill(0);
+}
+
+uint64_t LatencyHistogram::NowNs() {
+  struct timespec now = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < static_cast<uint64_t>(kSubCount)) {
+    return static_cast<size_t>(value);
+  }
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - kSubBits;
+  return static_cast<size_t>(shift + 1) * kSubCount +
+         static_cast<size_t>((value >> shift) & (kSubCount - 1));
+}
+
+uint64_t LatencyHistogram::BucketUpper(size_t index) {
+  if (index < static_cast<size_t>(kSubCount)) {
+    return index;
+  }
+  int shift = static_cast<int>(index / kSubCount) - 1;
+  uint64_t sub = index % kSubCount;
+  uint64_t lower = (static_cast<uint64_t>(kSubCount) + sub) << shift;
+  return lower + ((1ULL << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t value_ns) {
+  counts_[BucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+  sum_ns_.fetch_add(value_ns, std::memory_order_relaxed);
+  uint64_t prev_max = max_ns_.load(std::memory_order_relaxed);
+  while (value_ns > prev_max &&
+         !max_ns_.compare_exchange_weak(
+             prev_max, value_ns, std::memory_order_relaxed)) {
+  }
+  prev_max = interval_max_ns_.load(std::memory_order_relaxed);
+  while (value_ns > prev_max &&
+         !interval_max_ns_.compare_exchange_weak(
+             prev_max, value_ns, std::memory_order_relaxed)) {
+  }
+}
+
+template <typename Counts>
+LatencyHistogram::Summary LatencyHistogram::Summarize(const Counts& counts,
+                                                      uint64_t count,
+                                                      uint64_t sum_ns,
+                                                      uint64_t max_ns) {
+  Summary summary;
+  summary.count = count;
+  summary.max_ns = max_ns;
+  if (count == 0) {
+    return summary;
+  }
+  summary.mean_ns = static_cast<double>(sum_ns) / count;
+  // 第rank个（从1开始）样本所在桶的上界即为分位数，不超过最大值
+  const uint64_t ranks[3] = {(count * 50 + 99) / 100,
+                             (count * 90 + 99) / 100,
+                             (count * 99 + 99) / 100};
+  uint64_t* values[3] = {&summary.p50_ns, &summary.p90_ns, &summary.p99_ns};
+  int next = 0;
+  uint64_t accumulated = 0;
+  for (size_t idx = 0; idx < kBucketNum && next < 3; idx++) {
+    accumulated += counts[idx];
+    while (next < 3 && accumulated >= ranks[next]) {
+      uint64_t upper = BucketUpper(idx);
+      *values[next] = upper < max_ns ? upper : max_ns;
+      next++;
+    }
+  }
+  return summary;
+}
+
+LatencyHistogram::Summary LatencyHistogram::Total() const {
+  // 各个桶的计数之和作为样本数，与并发的Record保持一致
+  std::array<uint64_t, kBucketNum> counts;
+  uint64_t count = 0;
+  for (size_t idx = 0; idx < kBucketNum; idx++) {
+    counts[idx] = counts_[idx].load(std::memory_order_relaxed);
+    count += counts[idx];
+  }
+  return Summarize(counts,
+                   count,
+                   sum_ns_.load(std::memory_order_relaxed),
+                   max_ns_.load(std::memory_order_relaxed));
+}
+
+LatencyHistogram::Summary LatencyHistogram::Interval() {
+  uint64_t count = 0;
+  for (size_t idx = 0; idx < kBucketNum; idx++) {
+    uint64_t total = counts_[idx].load(std::memory_order_relaxed);
+    interval_counts_[idx] = total - last_counts_[idx];
+    last_counts_[idx] = total;
+    count += interval_counts_[idx];
+  }
+  uint64_t sum_ns = sum_ns_.load(std::memory_order_relaxed);
+  uint64_t interval_sum_ns = sum_ns - last_sum_ns_;
+  last_sum_ns_ = sum_ns;
+  return Summarize(interval_counts_,
+                   count,
+                   interval_sum_ns,
+                   interval_max_ns_.exchange(0, std::memory_order_relaxed));
+}
+
+const char* StageLatency::StageName(Stage stage) {
+  switch (stage) {
+    case Stage::MOTION_GATE:
+      return "motion_gate";
+    case Stage::RECV_TO_PREPROCESS:
+      return "recv_to_preprocess";
+    case Stage::PREPROCESS:
+      return "preprocess";
+    case Stage::QUEUE_WAIT:
+      return "queue_wait";
+    case Stage::INFER:
+      return "infer";
+    case Stage::TILE_INFER:
+      return "tile_infer";
+    case Stage::REORDER_WAIT:
+      return "reorder_wait";
+    case Stage::PARSE:
+      return "parse";
+    case Stage::TILE_MERGE:
+      return "tile_merge";
+    case Stage::TRACKING:
+      return "tracking";
+    case Stage::PUBLISH:
+      return "publish";
+    case Stage::TOTAL:
+      return "total";
+    default:
+      return "unknown";
+  }
+}
+
+std::string StageLatency::ToJson(bool interval) {
+  std::stringstream ss;
+  ss.precision(3);
+  ss << std::fixed << "{";
+  for (size_t idx = 0; idx < histograms_.size(); idx++) {
+    auto summary =
+        interval ? histograms_[idx].Interval() : histograms_[idx].Total();
+    ss << (idx > 0 ? ", " : "") << "\""
+       << StageName(static_cast<Stage>(idx)) << "\": {\"count\": "
+       << summary.count << ", \"mean_ms\": " << summary.mean_ns / 1e6
+       << ", \"p50_ms\": " << summary.p50_ns / 1e6
+       << ", \"p90_ms\": " << summary.p90_ns / 1e6
+       << ", \"p99_ms\": " << summary.p99_ns / 1e6
+       << ", \"max_ms\": " << summary.max_ns / 1e6 << "}";
+  }
+  ss << "}";
+  return ss.str();
+}
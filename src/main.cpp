@@ -12,8 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <future>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 #include "include/mono2d_body_det_node.h"
 #include "rclcpp/rclcpp.hpp"
@@ -23,7 +27,33 @@ int main(int argc, char** argv) {
   RCLCPP_WARN(rclcpp::get_logger("example"),
               "This is mono2d body det example!");
 
-  rclcpp::spin(std::make_shared<Mono2dBodyDetNode>("mono2d_body_det"));
+  // 使用多线程executor，订阅回调和定时统计在不同的callback group中并行执行
+  rclcpp::executors::MultiThreadedExecutor exec;
+  std::shared_ptr<Mono2dBodyDetNode> node = nullptr;
+  try {
+    node = std::make_shared<Mono2dBodyDetNode>("mono2d_body_det");
+  } catch (const std::exception& e) {
+    RCLCPP_ERROR(rclcpp::get_logger("example"),
+                 "Create node fail: %s",
+                 e.what());
+    rclcpp::shutdown();
+    return -1;
+  }
+  exec.add_node(node);
+
+  auto replay_done = node->ReplayDone();
+  if (replay_done.valid()) {
+    // 回放完成后退出，中断时rclcpp::ok()返回false
+    std::thread spin_thread([&exec] { exec.spin(); });
+    while (rclcpp::ok() &&
+           replay_done.wait_for(std::chrono::milliseconds(100)) !=
+               std::future_status::ready) {
+    }
+    exec.cancel();
+    spin_thread.join();
+  } else {
+    exec.spin();
+  }
 
   rclcpp::shutdown();
   return 0;
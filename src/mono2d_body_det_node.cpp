@@ -16,8 +16,10 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -25,54 +27,15 @@
 
 #include "dnn_node/dnn_node.h"
 #include "dnn_node/util/image_proc.h"
+#include "include/image_convert.h"
 #include "include/image_utils.h"
+#include "include/nv12_pyramid_pool.h"
 #include "rclcpp/rclcpp.hpp"
+#include "rclcpp_components/register_node_macro.hpp"
 #include <cv_bridge/cv_bridge.h>
 
 #include "builtin_interfaces/msg/detail/time__struct.h"
 
-#ifdef PLATFORM_X86
-
-enum class DataState {
-  /// valid
-  VALID = 0,
-  /// filtered
-  FILTERED = 1,
-  /// invisible
-  INVISIBLE = 2,
-  /// disappeared
-  DISAPPEARED = 3,
-  /// invalid
-  INVALID = 4,
-};
-
-struct box_s {
-  box_s() {}
-  box_s(int x1_, int y1_, int x2_, int y2_) {
-    x1 = x1_;
-    y1 = y1_;
-    x2 = x2_;
-    y2 = y2_;
-  }
-  box_s(int x1_, int y1_, int x2_, int y2_, float score_) {
-    x1 = x1_;
-    y1 = y1_;
-    x2 = x2_;
-    y2 = y2_;
-    score = score_;
-  }
-  int x1 = 0;
-  int y1 = 0;
-  int x2 = 0;
-  int y2 = 0;
-  float score = 1;
-  int id = 0;
-  DataState state_ = DataState::VALID;
-};
-
-using MotBox = box_s;
-
-#endif
 builtin_interfaces::msg::Time ConvertToRosTime(
     const struct timespec& time_spec) {
   builtin_interfaces::msg::Time stamp;
@@ -87,142 +50,319 @@ int CalTimeMsDuration(const builtin_interfaces::msg::Time& start,
          start.nanosec / 1000 / 1000;
 }
 
-void NodeOutputManage::Feed(uint64_t ts_ms) {
-  RCLCPP_DEBUG(
-      rclcpp::get_logger("mono2d_body_det"), "feed frame ts: %llu", ts_ms);
-
-  std::unique_lock<std::mutex> lk(mtx_);
-  cache_frame_.insert(ts_ms);
-  if (cache_frame_.size() > cache_size_limit_) {
-    cache_frame_.erase(cache_frame_.begin());
-  }
-  RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
-               "cache_frame_.size(): %d",
-               cache_frame_.size());
-}
-
-std::vector<std::shared_ptr<DnnNodeOutput>> NodeOutputManage::Feed(
-    const std::shared_ptr<DnnNodeOutput>& in_node_output) {
-  std::vector<std::shared_ptr<DnnNodeOutput>> node_outputs{};
-  auto fasterRcnn_output =
-      std::dynamic_pointer_cast<FasterRcnnOutput>(in_node_output);
-  if (!fasterRcnn_output || !fasterRcnn_output->image_msg_header) {
-    return node_outputs;
-  }
-
-  uint64_t ts_ms =
-      fasterRcnn_output->image_msg_header->stamp.sec * 1000 +
-      fasterRcnn_output->image_msg_header->stamp.nanosec / 1000 / 1000;
-  RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"), "feed ts: %llu", ts_ms);
-
-  uint8_t loop_num = cache_size_limit_;
-  {
-    std::unique_lock<std::mutex> lk(mtx_);
-    cache_node_output_[ts_ms] = in_node_output;
-    if (cache_node_output_.size() > cache_size_limit_) {
-      cache_node_output_.erase(cache_node_output_.begin());
-    }
-    if (cache_frame_.empty()) {
-      return node_outputs;
-    }
-
-    loop_num = cache_node_output_.size();
-  }
-
-  RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
-               "node_outputs.size(): %d",
-               node_outputs.size());
-
-  // 按照时间戳顺序输出推理结果
-  for (uint8_t idx = 0; idx < loop_num; idx++) {
-    std::shared_ptr<DnnNodeOutput> node_output = nullptr;
-    {
-      std::unique_lock<std::mutex> lk(mtx_);
-      if (cache_frame_.empty() || cache_node_output_.empty()) {
-        break;
-      }
-
-      auto first_frame = cache_frame_.begin();
-      auto first_output = cache_node_output_.begin();
-      if (*first_frame == first_output->first) {
-        RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
-                     "push ts: %llu",
-                     *first_frame);
-
-        node_output = in_node_output;
-        cache_frame_.erase(first_frame);
-        cache_node_output_.erase(first_output);
-      } else {
-        if (first_output->first > *first_frame) {
-          uint64_t time_ms_diff = first_output->first - *first_frame;
-          if (time_ms_diff > smart_output_timeout_ms_) {
-            cache_frame_.erase(first_frame);
-          }
-        } else if (*first_frame > first_output->first) {
-          uint64_t time_ms_diff = *first_frame - first_output->first;
-          if (time_ms_diff > smart_output_timeout_ms_) {
-            cache_node_output_.erase(first_output);
-          }
-        } else {
-          break;
-        }
-      }
-    }
-
-    if (node_output) {
-      node_outputs.emplace_back(node_output);
-    }
-  }
-
-  return node_outputs;
-}
-
-void NodeOutputManage::Erase(uint64_t ts_ms) {
-  std::unique_lock<std::mutex> lk(mtx_);
-  if (cache_frame_.find(ts_ms) != cache_frame_.end()) {
-    cache_frame_.erase(ts_ms);
-  }
-  if (cache_node_output_.find(ts_ms) != cache_node_output_.end()) {
-    cache_node_output_.erase(ts_ms);
-  }
-}
-
 Mono2dBodyDetNode::Mono2dBodyDetNode(const std::string& node_name,
                                      const NodeOptions& options)
     : DnnNode(node_name, options) {
   this->declare_parameter<int>("is_sync_mode", is_sync_mode_);
   this->declare_parameter<std::string>("model_file_name", model_file_name_);
   this->declare_parameter<int>("is_shared_mem_sub", is_shared_mem_sub_);
+  this->declare_parameter<int>("is_compressed_img_sub",
+                               is_compressed_img_sub_);
   this->declare_parameter<std::string>("ai_msg_pub_topic_name",
                                        ai_msg_pub_topic_name_);
+  this->declare_parameter<std::string>("pod_msg_pub_topic_name",
+                                       pod_msg_pub_topic_name_);
+  this->declare_parameter<int>("image_resize_type", image_resize_type_);
+  this->declare_parameter<int>("is_letterbox", is_letterbox_);
+  this->declare_parameter<int>("reorder_cache_size", reorder_cache_size_);
+  this->declare_parameter<int>("reorder_timeout_ms", reorder_timeout_ms_);
+  this->declare_parameter<int>("preprocess_thread_num",
+                               preprocess_thread_num_);
+  this->declare_parameter<int>("pipeline_queue_size", pipeline_queue_size_);
+  this->declare_parameter<int>("admission_mode", admission_mode_);
+  this->declare_parameter<int>("task_num", task_num_);
+  this->declare_parameter<int>("auto_tune_task_num", auto_tune_task_num_);
+  this->declare_parameter<int>("auto_tune_latency_budget_ms",
+                               auto_tune_latency_budget_ms_);
+  this->declare_parameter<int>("auto_tune_frames", auto_tune_frames_);
+  this->declare_parameter<int>("mot_thread_num", mot_thread_num_);
+  this->declare_parameter<int>("log_mode", log_mode_);
+  this->declare_parameter<int>("log_sample_interval", log_sample_interval_);
+  this->declare_parameter<int>("dump_latency_stats", dump_latency_stats_);
+  this->declare_parameter<std::string>("replay_file", replay_file_name_);
+  this->declare_parameter<int>("replay_mode", replay_mode_);
+  this->declare_parameter<int>("replay_fps", replay_fps_);
+  this->declare_parameter<std::string>("record_file", record_file_name_);
+  this->declare_parameter<int>("tile_mode", tile_mode_);
+  this->declare_parameter<int>("tile_cols", tile_cols_);
+  this->declare_parameter<int>("tile_rows", tile_rows_);
+  this->declare_parameter<int>("tile_overlap", tile_overlap_);
+  this->declare_parameter<int>("tile_with_full_frame", tile_with_full_frame_);
+  this->declare_parameter<double>("tile_nms_iou_threshold",
+                                  tile_nms_iou_threshold_);
+  this->declare_parameter<int>("detect_interval", detect_interval_);
+  this->declare_parameter<int>("detect_adaptive", detect_adaptive_);
+  this->declare_parameter<int>("motion_gate_mode", motion_gate_mode_);
+  this->declare_parameter<double>("motion_gate_threshold",
+                                  motion_gate_threshold_);
+  this->declare_parameter<int>("part_association", part_association_);
+  this->declare_parameter<std::vector<std::string>>("image_topic_names",
+                                                    image_topic_names_);
+  this->declare_parameter<std::vector<std::string>>("ai_msg_pub_topic_names",
+                                                    ai_msg_pub_topic_names_);
+  this->declare_parameter<std::vector<int64_t>>("stream_weights",
+                                                stream_weights_);
 
   this->get_parameter<int>("is_sync_mode", is_sync_mode_);
   this->get_parameter<std::string>("model_file_name", model_file_name_);
   this->get_parameter<int>("is_shared_mem_sub", is_shared_mem_sub_);
+  this->get_parameter<int>("is_compressed_img_sub", is_compressed_img_sub_);
   this->get_parameter<std::string>("ai_msg_pub_topic_name",
                                    ai_msg_pub_topic_name_);
+  this->get_parameter<std::string>("pod_msg_pub_topic_name",
+                                   pod_msg_pub_topic_name_);
+  this->get_parameter<int>("image_resize_type", image_resize_type_);
+  this->get_parameter<int>("is_letterbox", is_letterbox_);
+  this->get_parameter<int>("reorder_cache_size", reorder_cache_size_);
+  this->get_parameter<int>("reorder_timeout_ms", reorder_timeout_ms_);
+  this->get_parameter<int>("preprocess_thread_num", preprocess_thread_num_);
+  this->get_parameter<int>("pipeline_queue_size", pipeline_queue_size_);
+  this->get_parameter<int>("admission_mode", admission_mode_);
+  this->get_parameter<int>("task_num", task_num_);
+  this->get_parameter<int>("auto_tune_task_num", auto_tune_task_num_);
+  this->get_parameter<int>("auto_tune_latency_budget_ms",
+                           auto_tune_latency_budget_ms_);
+  this->get_parameter<int>("auto_tune_frames", auto_tune_frames_);
+  this->get_parameter<int>("mot_thread_num", mot_thread_num_);
+  this->get_parameter<int>("log_mode", log_mode_);
+  this->get_parameter<int>("log_sample_interval", log_sample_interval_);
+  this->get_parameter<int>("dump_latency_stats", dump_latency_stats_);
+  this->get_parameter<std::string>("replay_file", replay_file_name_);
+  this->get_parameter<int>("replay_mode", replay_mode_);
+  this->get_parameter<int>("replay_fps", replay_fps_);
+  this->get_parameter<std::string>("record_file", record_file_name_);
+  this->get_parameter<int>("tile_mode", tile_mode_);
+  this->get_parameter<int>("tile_cols", tile_cols_);
+  this->get_parameter<int>("tile_rows", tile_rows_);
+  this->get_parameter<int>("tile_overlap", tile_overlap_);
+  this->get_parameter<int>("tile_with_full_frame", tile_with_full_frame_);
+  this->get_parameter<double>("tile_nms_iou_threshold",
+                              tile_nms_iou_threshold_);
+  this->get_parameter<int>("detect_interval", detect_interval_);
+  this->get_parameter<int>("detect_adaptive", detect_adaptive_);
+  this->get_parameter<int>("motion_gate_mode", motion_gate_mode_);
+  this->get_parameter<double>("motion_gate_threshold",
+                              motion_gate_threshold_);
+  this->get_parameter<int>("part_association", part_association_);
+  this->get_parameter<std::vector<std::string>>("image_topic_names",
+                                                image_topic_names_);
+  this->get_parameter<std::vector<std::string>>("ai_msg_pub_topic_names",
+                                                ai_msg_pub_topic_names_);
+  this->get_parameter<std::vector<int64_t>>("stream_weights",
+                                            stream_weights_);
+  if (image_resize_type_ < static_cast<int>(ImageResizeType::CROP) ||
+      image_resize_type_ > static_cast<int>(ImageResizeType::AREA)) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid image_resize_type: %d, use bilinear",
+                image_resize_type_);
+    image_resize_type_ = static_cast<int>(ImageResizeType::BILINEAR);
+  }
+  if (reorder_cache_size_ <= 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid reorder_cache_size: %d, use 16",
+                reorder_cache_size_);
+    reorder_cache_size_ = 16;
+  }
+  if (reorder_timeout_ms_ < 0) {
+    reorder_timeout_ms_ = 0;
+  }
+  if (preprocess_thread_num_ <= 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid preprocess_thread_num: %d, use 1",
+                preprocess_thread_num_);
+    preprocess_thread_num_ = 1;
+  }
+  if (pipeline_queue_size_ <= 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid pipeline_queue_size: %d, use 4",
+                pipeline_queue_size_);
+    pipeline_queue_size_ = 4;
+  }
+  if (admission_mode_ < static_cast<int>(AdmissionController::Mode::ALL) ||
+      admission_mode_ > static_cast<int>(AdmissionController::Mode::EVERY_NTH)) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid admission_mode: %d, use 0",
+                admission_mode_);
+    admission_mode_ = static_cast<int>(AdmissionController::Mode::ALL);
+  }
+  if (task_num_ <= 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid task_num: %d, use 2",
+                task_num_);
+    task_num_ = 2;
+  }
+  infer_concurrency_ = task_num_;
+  if (auto_tune_frames_ <= 0) {
+    auto_tune_frames_ = 50;
+  }
+  if (mot_thread_num_ < 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid mot_thread_num: %d, use 0",
+                mot_thread_num_);
+    mot_thread_num_ = 0;
+  }
+  if (log_mode_ < static_cast<int>(LogMode::OFF) ||
+      log_mode_ > static_cast<int>(LogMode::FULL)) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid log_mode: %d, use 1",
+                log_mode_);
+    log_mode_ = static_cast<int>(LogMode::SAMPLED);
+  }
+  if (log_sample_interval_ <= 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid log_sample_interval: %d, use 30",
+                log_sample_interval_);
+    log_sample_interval_ = 30;
+  }
+  if (replay_mode_ < static_cast<int>(ReplayMode::RECORDED) ||
+      replay_mode_ > static_cast<int>(ReplayMode::AS_FAST_AS_POSSIBLE)) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid replay_mode: %d, use recorded rate",
+                replay_mode_);
+    replay_mode_ = static_cast<int>(ReplayMode::RECORDED);
+  }
+  if (replay_fps_ <= 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid replay_fps: %d, use 30",
+                replay_fps_);
+    replay_fps_ = 30;
+  }
+  if (tile_mode_ < 0 || tile_mode_ > 1) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid tile_mode: %d, use 0",
+                tile_mode_);
+    tile_mode_ = 0;
+  }
+  if (tile_cols_ < 0 || tile_cols_ > TileLayout::kMaxTileCols) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid tile_cols: %d, use 0",
+                tile_cols_);
+    tile_cols_ = 0;
+  }
+  if (tile_rows_ < 0 || tile_rows_ > TileLayout::kMaxTileRows) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid tile_rows: %d, use 0",
+                tile_rows_);
+    tile_rows_ = 0;
+  }
+  if (tile_overlap_ < 0) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid tile_overlap: %d, use 64",
+                tile_overlap_);
+    tile_overlap_ = 64;
+  }
+  if (tile_nms_iou_threshold_ <= 0 || tile_nms_iou_threshold_ > 1) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid tile_nms_iou_threshold: %f, use 0.5",
+                tile_nms_iou_threshold_);
+    tile_nms_iou_threshold_ = 0.5;
+  }
+  if (detect_interval_ < 1) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid detect_interval: %d, use 1",
+                detect_interval_);
+    detect_interval_ = 1;
+  }
+  if (detect_adaptive_ < 0 || detect_adaptive_ > 1) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid detect_adaptive: %d, use 0",
+                detect_adaptive_);
+    detect_adaptive_ = 0;
+  }
+  if (motion_gate_mode_ < static_cast<int>(MotionGateMode::OFF) ||
+      motion_gate_mode_ > static_cast<int>(MotionGateMode::DROP)) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid motion_gate_mode: %d, use 0",
+                motion_gate_mode_);
+    motion_gate_mode_ = static_cast<int>(MotionGateMode::OFF);
+  }
+  if (motion_gate_threshold_ <= 0 || motion_gate_threshold_ > 1) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid motion_gate_threshold: %f, use 0.001",
+                motion_gate_threshold_);
+    motion_gate_threshold_ = 0.001;
+  }
+  if (part_association_ < 0 || part_association_ > 1) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Invalid part_association: %d, use 0",
+                part_association_);
+    part_association_ = 0;
+  }
   {
     std::stringstream ss;
     ss << "Parameter:"
       << "\n is_sync_mode_: " << is_sync_mode_
       << "\n model_file_name_: " << model_file_name_
       << "\n is_shared_mem_sub: " << is_shared_mem_sub_
-      << "\n ai_msg_pub_topic_name: " << ai_msg_pub_topic_name_;
+      << "\n is_compressed_img_sub: " << is_compressed_img_sub_
+      << "\n ai_msg_pub_topic_name: " << ai_msg_pub_topic_name_
+      << "\n pod_msg_pub_topic_name: " << pod_msg_pub_topic_name_
+      << "\n image_resize_type: " << image_resize_type_
+      << "\n is_letterbox: " << is_letterbox_
+      << "\n reorder_cache_size: " << reorder_cache_size_
+      << "\n reorder_timeout_ms: " << reorder_timeout_ms_
+      << "\n preprocess_thread_num: " << preprocess_thread_num_
+      << "\n pipeline_queue_size: " << pipeline_queue_size_
+      << "\n admission_mode: " << admission_mode_
+      << "\n task_num: " << task_num_
+      << "\n auto_tune_task_num: " << auto_tune_task_num_
+      << "\n auto_tune_latency_budget_ms: " << auto_tune_latency_budget_ms_
+      << "\n auto_tune_frames: " << auto_tune_frames_
+      << "\n mot_thread_num: " << mot_thread_num_
+      << "\n log_mode: " << log_mode_
+      << "\n log_sample_interval: " << log_sample_interval_
+      << "\n dump_latency_stats: " << dump_latency_stats_
+      << "\n replay_file: " << replay_file_name_
+      << "\n replay_mode: " << replay_mode_
+      << "\n replay_fps: " << replay_fps_
+      << "\n record_file: " << record_file_name_
+      << "\n tile_mode: " << tile_mode_
+      << "\n tile_cols: " << tile_cols_
+      << "\n tile_rows: " << tile_rows_
+      << "\n tile_overlap: " << tile_overlap_
+      << "\n tile_with_full_frame: " << tile_with_full_frame_
+      << "\n tile_nms_iou_threshold: " << tile_nms_iou_threshold_
+      << "\n detect_interval: " << detect_interval_
+      << "\n detect_adaptive: " << detect_adaptive_
+      << "\n motion_gate_mode: " << motion_gate_mode_
+      << "\n motion_gate_threshold: " << motion_gate_threshold_
+      << "\n part_association: " << part_association_
+      << "\n use_intra_process_comms: "
+      << this->get_node_options().use_intra_process_comms()
+      << "\n image_topic_names:";
+    for (const auto& topic : image_topic_names_) {
+      ss << " " << topic;
+    }
+    ss << "\n ai_msg_pub_topic_names:";
+    for (const auto& topic : ai_msg_pub_topic_names_) {
+      ss << " " << topic;
+    }
+    ss << "\n stream_weights:";
+    for (const auto& weight : stream_weights_) {
+      ss << " " << weight;
+    }
     RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
   }
 
+  // 逐帧明细日志由后台线程输出
+  async_logger_ = std::make_shared<AsyncLogger>(
+      [](const char* line) {
+        RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"), "%s", line);
+      },
+      1024);
+
+  // 初始化失败时抛出异常，由加载节点的进程决定是否退出；
+  // 抛出异常之前不能启动任何线程
   if (Init() != 0) {
     RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Init failed!");
-    rclcpp::shutdown();
-    return;
+    throw std::runtime_error("Init failed");
   }
 
   // Init()之后模型已经加载成功，查询kps解析参数
   auto model_manage = GetModel();
   if (!model_manage) {
     RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Invalid model");
-    rclcpp::shutdown();
-    return;
+    throw std::runtime_error("Invalid model");
   }
   parser_para_ = std::make_shared<FasterRcnnKpsParserPara>();
   hbDNNTensorProperties tensor_properties;
@@ -251,53 +391,310 @@ Mono2dBodyDetNode::Mono2dBodyDetNode(const std::string& node_name,
     RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
   }
 
-  msg_publisher_ = this->create_publisher<ai_msgs::msg::PerceptionTargets>(
-      ai_msg_pub_topic_name_, 10);
-
   if (GetModelInputSize(0, model_input_width_, model_input_height_) < 0) {
     RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
                  "Get model input size fail!");
-    rclcpp::shutdown();
-  } else {
-    RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
-                "The model input width is %d and height is %d",
-                model_input_width_,
-                model_input_height_);
+    throw std::runtime_error("Get model input size fail");
+  }
+  RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
+              "The model input width is %d and height is %d",
+              model_input_width_,
+              model_input_height_);
+
+  if (!replay_file_name_.empty()) {
+    replay_file_ = std::make_shared<frame_replay::ReplayFile>();
+    if (replay_file_->Open(replay_file_name_) != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                   "Open replay file %s fail!",
+                   replay_file_name_.c_str());
+      throw std::runtime_error("Open replay file " + replay_file_name_ +
+                               " fail");
+    }
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Replay file: %s, encoding: %s, w: %d, h: %d, frames: %d",
+                replay_file_name_.c_str(),
+                replay_file_->Encoding().c_str(),
+                replay_file_->Width(),
+                replay_file_->Height(),
+                static_cast<int>(replay_file_->Frames().size()));
+    replay_done_ = replay_done_promise_.get_future().share();
   }
 
-  if (is_shared_mem_sub_) {
+  CreateStreams();
+  mot_runner_ = std::make_shared<ParallelRunner>(mot_thread_num_);
+  perf_types_.preprocess = model_name_ + "_preprocess";
+  perf_types_.predict_infer = model_name_ + "_predict_infer";
+  perf_types_.predict_parse = model_name_ + "_predict_parse";
+  perf_types_.postprocess = model_name_ + "_postprocess";
+  perf_types_.pipeline = model_name_ + "_pipeline";
+  perf_types_.track_predict = model_name_ + "_track_predict";
+  for (const auto& config : hobot_mot_configs_) {
+    mot_perf_types_[config.first] = model_name_ + "_mot_" + config.first;
+  }
+  // 正在推理、等待发布以及队列中的帧都可能持有推理输出
+  size_t output_pool_size = streams_.size() * reorder_cache_size_ + task_num_ +
+                            pipeline_queue_size_ + preprocess_thread_num_;
+  if (tile_mode_ == 1) {
+    int max_tile_num =
+        TileLayout::kMaxTileCols * TileLayout::kMaxTileRows + 1;
+    for (int idx = 0; idx < max_tile_num; idx++) {
+      perf_types_.tile_infer.push_back(perf_types_.predict_infer + "_tile" +
+                                       std::to_string(idx));
+    }
+    // 每帧的tile个数由原图大小决定，按照指定的行列数估计，超出时新建的对象不回收
+    size_t tile_num = tile_cols_ > 0 && tile_rows_ > 0
+                          ? tile_cols_ * tile_rows_ + tile_with_full_frame_
+                          : 4;
+    tile_group_pool_ =
+        std::make_shared<RecyclePool<TileGroup>>(output_pool_size);
+    output_pool_size *= tile_num;
+  }
+  output_pool_ =
+      std::make_shared<RecyclePool<FasterRcnnOutput>>(output_pool_size);
+
+  // 启动预处理线程和推理提交线程，订阅回调只负责将帧句柄放入队列
+  auto admission_mode = static_cast<AdmissionController::Mode>(admission_mode_);
+  admission_controller_ = std::make_shared<AdmissionController>(
+      admission_mode, preprocess_thread_num_);
+  std::vector<int> weights;
+  for (const auto& stream : streams_) {
+    weights.push_back(stream->weight);
+  }
+  // 只保留最新帧时，每路输入的子队列作为长度为1的mailbox，新帧覆盖旧帧
+  frame_queue_ = std::make_shared<WeightedStreamQueue<ImageFrame>>(
+      weights,
+      admission_mode == AdmissionController::Mode::LATEST_ONLY
+          ? 1
+          : pipeline_queue_size_);
+  infer_queue_ =
+      std::make_shared<PipelineQueue<InferTask>>(pipeline_queue_size_);
+  for (int idx = 0; idx < preprocess_thread_num_; idx++) {
+    preprocess_workers_.emplace_back(
+        std::thread(&Mono2dBodyDetNode::PreprocessWorker, this));
+  }
+  infer_submitter_ = std::thread(&Mono2dBodyDetNode::InferSubmitter, this);
+
+  // 订阅和定时统计使用不同的callback group，在多线程executor中互不阻塞
+  timer_callback_group_ =
+      this->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  pipeline_stats_timer_ = this->create_wall_timer(
+      std::chrono::seconds(5),
+      std::bind(&Mono2dBodyDetNode::PipelineStatsReport, this),
+      timer_callback_group_);
+
+  if (!replay_file_) {
+    if (!record_file_name_.empty()) {
+      record_file_ = std::make_shared<frame_replay::RecordFile>();
+      if (record_file_->Open(record_file_name_, record_queue_size_) != 0) {
+        RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                     "Open record file %s fail!",
+                     record_file_name_.c_str());
+        record_file_ = nullptr;
+      }
+    }
+    SubscribeStreams();
+  }
+
+  task_num_tune_publisher_ = this->create_publisher<std_msgs::msg::String>(
+      task_num_tune_pub_topic_name_, 10);
+  latency_stats_publisher_ = this->create_publisher<std_msgs::msg::String>(
+      latency_stats_pub_topic_name_, 10);
+  param_callback_handle_ = this->add_on_set_parameters_callback(
+      std::bind(&Mono2dBodyDetNode::OnSetParameters,
+                this,
+                std::placeholders::_1));
+  if (auto_tune_task_num_ == 1) {
+    StartAutoTune();
+  }
+  if (replay_file_) {
+    replay_thread_ = std::thread(&Mono2dBodyDetNode::ReplayFrames, this);
+  }
+}
+
+Mono2dBodyDetNode::Mono2dBodyDetNode(const NodeOptions& options)
+    : Mono2dBodyDetNode("mono2d_body_det", options) {}
+
+Mono2dBodyDetNode::~Mono2dBodyDetNode() {
+  {
+    std::lock_guard<std::mutex> lk(inflight_mtx_);
+    pipeline_stopped_ = true;
+  }
+  inflight_cv_.notify_all();
+  if (replay_thread_.joinable()) {
+    replay_thread_.join();
+  }
+  StopPipeline();
+  if (auto_tune_thread_.joinable()) {
+    auto_tune_thread_.join();
+  }
+}
+
+void Mono2dBodyDetNode::StopPipeline() {
+  {
+    std::lock_guard<std::mutex> lk(inflight_mtx_);
+    pipeline_stopped_ = true;
+  }
+  inflight_cv_.notify_all();
+  if (admission_controller_) {
+    admission_controller_->Stop();
+  }
+  if (frame_queue_) {
+    frame_queue_->Stop();
+  }
+  if (infer_queue_) {
+    infer_queue_->Stop();
+  }
+  for (auto& worker : preprocess_workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  if (infer_submitter_.joinable()) {
+    infer_submitter_.join();
+  }
+}
+
+void Mono2dBodyDetNode::CreateStreams() {
+  if (image_topic_names_.empty()) {
+    if (is_shared_mem_sub_) {
+      image_topic_names_.push_back(sharedmem_img_topic_name_);
+    } else if (is_compressed_img_sub_) {
+      image_topic_names_.push_back(compressed_img_topic_name_);
+    } else {
+      image_topic_names_.push_back(ros_img_topic_name_);
+    }
+  }
+  for (size_t idx = 0; idx < image_topic_names_.size(); idx++) {
+    auto stream = std::make_shared<StreamContext>();
+    stream->stream_id = idx;
+    stream->img_topic_name = image_topic_names_[idx];
+    if (ai_msg_pub_topic_names_.size() == image_topic_names_.size()) {
+      stream->ai_msg_pub_topic_name = ai_msg_pub_topic_names_[idx];
+    } else {
+      stream->ai_msg_pub_topic_name =
+          idx == 0 ? ai_msg_pub_topic_name_
+                   : ai_msg_pub_topic_name_ + "_" + std::to_string(idx);
+    }
+    if (idx < stream_weights_.size() && stream_weights_[idx] > 0) {
+      stream->weight = stream_weights_[idx];
+    }
+    stream->msg_publisher =
+        this->create_publisher<ai_msgs::msg::PerceptionTargets>(
+            stream->ai_msg_pub_topic_name, 10);
+    if (!pod_msg_pub_topic_name_.empty()) {
+      stream->pod_msg_pub_topic_name =
+          idx == 0 ? pod_msg_pub_topic_name_
+                   : pod_msg_pub_topic_name_ + "_" + std::to_string(idx);
 #ifdef SHARED_MEM_ENABLED
-    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
-                "Create hbmem_subscription with topic_name: %s",
-                sharedmem_img_topic_name_.c_str());
-    sharedmem_img_subscription_ =
-        this->create_subscription_hbmem<hbm_img_msgs::msg::HbmMsg1080P>(
-            sharedmem_img_topic_name_,
-            10,
-            std::bind(&Mono2dBodyDetNode::SharedMemImgProcess,
-                      this,
-                      std::placeholders::_1));
+      stream->pod_msg_publisher = this->create_publisher_hbmem<
+          mono2d_body_detection::msg::BodyDetectionResult>(
+          stream->pod_msg_pub_topic_name, 10);
 #else
-    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Unsupport shared mem");
+      // 没有共享内存时使用rmw的loaned message，rmw不支持时由rclcpp申请内存
+      stream->pod_msg_publisher = this->create_publisher<
+          mono2d_body_detection::msg::BodyDetectionResult>(
+          stream->pod_msg_pub_topic_name, 10);
 #endif
-  } else {
+    }
+    stream->output_reorder_buffer = std::make_shared<OutputReorderBuffer>(
+        reorder_cache_size_, reorder_timeout_ms_);
+    stream->admission_controller = std::make_shared<AdmissionController>(
+        static_cast<AdmissionController::Mode>(admission_mode_),
+        preprocess_thread_num_);
+    for (const auto& config : hobot_mot_configs_) {
+      stream->hobot_mots[config.first] =
+          std::make_shared<HobotMot>(config.second);
+    }
+    stream->target_builder = std::make_shared<TargetBuilder>(
+        box_outputs_index_type_, body_box_output_index_);
+    stream->target_builder->SetPartAssociation(part_association_ == 1);
+    stream->stage_latency = std::make_shared<StageLatency>();
+    if (tile_mode_ == 1) {
+      stream->tile_merger = std::make_shared<TileMerger>(box_outputs_index_);
+    }
+    if (detect_interval_ > 1) {
+      stream->track_predictor = std::make_shared<TrackPredictor>(
+          detect_interval_,
+          detect_adaptive_ == 1,
+          box_outputs_index_type_[body_box_output_index_]);
+    }
+    if (motion_gate_mode_ != static_cast<int>(MotionGateMode::OFF)) {
+      stream->motion_gate = std::make_shared<MotionGate>(
+          static_cast<float>(motion_gate_threshold_));
+    }
+    stream->frame_dispatcher = std::make_shared<FrameDispatcher>(
+        stream->output_reorder_buffer,
+        stream->admission_controller,
+        stream->track_predictor != nullptr,
+        stream->motion_gate,
+        motion_gate_mode_ == static_cast<int>(MotionGateMode::REPUBLISH),
+        stream->stage_latency);
     RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
-                "Create subscription with topic_name: %s",
-                ros_img_topic_name_.c_str());
-    ros_img_subscription_ = this->create_subscription<sensor_msgs::msg::Image>(
-        ros_img_topic_name_,
-        10,
-        std::bind(
-            &Mono2dBodyDetNode::RosImgProcess, this, std::placeholders::_1));
-  }
-#ifndef PLATFORM_X86
-  for (const auto& config : hobot_mot_configs_) {
-    hobot_mots_[config.first] = std::make_shared<HobotMot>(config.second);
+                "Stream %d, image topic: %s, ai msg pub topic: %s, weight: %d",
+                stream->stream_id,
+                stream->img_topic_name.c_str(),
+                stream->ai_msg_pub_topic_name.c_str(),
+                stream->weight);
+    streams_.push_back(stream);
   }
-#endif
 }
 
-Mono2dBodyDetNode::~Mono2dBodyDetNode() {}
+void Mono2dBodyDetNode::SubscribeStreams() {
+  for (auto& stream : streams_) {
+    int stream_id = stream->stream_id;
+    // 每路输入使用单独的callback group，不同输入的回调并行执行，
+    // 同一路输入的回调仍然串行，保证帧序号按照接收顺序分配
+    stream->sub_callback_group = this->create_callback_group(
+        rclcpp::CallbackGroupType::MutuallyExclusive);
+    rclcpp::SubscriptionOptions sub_options;
+    sub_options.callback_group = stream->sub_callback_group;
+    if (is_shared_mem_sub_) {
+#ifdef SHARED_MEM_ENABLED
+      RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                  "Create hbmem_subscription with topic_name: %s",
+                  stream->img_topic_name.c_str());
+      stream->sharedmem_img_subscription =
+          this->create_subscription_hbmem<hbm_img_msgs::msg::HbmMsg1080P>(
+              stream->img_topic_name,
+              10,
+              [this, stream_id](
+                  const hbm_img_msgs::msg::HbmMsg1080P::ConstSharedPtr msg) {
+                SharedMemImgProcess(msg, stream_id);
+              },
+              sub_options);
+#else
+      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                   "Unsupport shared mem");
+#endif
+    } else if (is_compressed_img_sub_) {
+      RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                  "Create compressed img subscription with topic_name: %s",
+                  stream->img_topic_name.c_str());
+      stream->compressed_img_subscription =
+          this->create_subscription<sensor_msgs::msg::CompressedImage>(
+              stream->img_topic_name,
+              10,
+              [this, stream_id](
+                  const sensor_msgs::msg::CompressedImage::ConstSharedPtr msg) {
+                CompressedImgProcess(msg, stream_id);
+              },
+              sub_options);
+    } else {
+      RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                  "Create subscription with topic_name: %s",
+                  stream->img_topic_name.c_str());
+      stream->ros_img_subscription =
+          this->create_subscription<sensor_msgs::msg::Image>(
+              stream->img_topic_name,
+              10,
+              [this,
+               stream_id](const sensor_msgs::msg::Image::ConstSharedPtr msg) {
+                RosImgProcess(msg, stream_id);
+              },
+              sub_options);
+    }
+  }
+}
 
 int Mono2dBodyDetNode::SetNodePara() {
   RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"), "Set node para.");
@@ -307,7 +704,7 @@ int Mono2dBodyDetNode::SetNodePara() {
   dnn_node_para_ptr_->model_file = model_file_name_;
   dnn_node_para_ptr_->model_name = model_name_;
   dnn_node_para_ptr_->model_task_type = model_task_type_;
-  dnn_node_para_ptr_->task_num = 2;
+  dnn_node_para_ptr_->task_num = task_num_;
   return 0;
 }
 
@@ -317,242 +714,274 @@ int Mono2dBodyDetNode::PostProcess(
     return 0;
   }
 
-  if (!msg_publisher_) {
-    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
-                 "Invalid msg_publisher_");
-    return -1;
-  }
-
   RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
                "outputs.size():%d",
                output->outputs.size());
 
-  std::vector<std::shared_ptr<DnnNodeOutput>> node_outputs{};
-  if (node_output_manage_ptr_) {
-    node_outputs = node_output_manage_ptr_->Feed(output);
+  uint64_t infer_end_ns = LatencyHistogram::NowNs();
+  float infer_latency_ms = ReleaseInflight(output.get());
+  // 推理输出都由Preprocess和AutoTuneConcurrency创建，类型确定
+  auto fasterRcnn_output = static_cast<FasterRcnnOutput*>(output.get());
+  if (!fasterRcnn_output->image_msg_header) {
+    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "invalid output");
+    return -1;
   }
-
-  if (node_outputs.empty()) {
-    // 直接使用当前帧输出
-    node_outputs.push_back(output);
-    if (node_output_manage_ptr_) {
-      auto fasterRcnn_output =
-          std::dynamic_pointer_cast<FasterRcnnOutput>(output);
-      if (!fasterRcnn_output || !fasterRcnn_output->image_msg_header) {
-        RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "invalid output");
-        return -1;
-      }
-      node_output_manage_ptr_->Erase(
-        fasterRcnn_output->image_msg_header->stamp.sec * 1000 +
-        fasterRcnn_output->image_msg_header->stamp.nanosec / 1000 / 1000);
+  if (fasterRcnn_output->is_tune_frame) {
+    if (infer_latency_ms >= 0) {
+      concurrency_tuner_.AddSample(infer_latency_ms);
     }
+    fasterRcnn_output->outputs.clear();
+    return 0;
   }
-
-  for (const auto node_output : node_outputs) {
-    if (!node_output) {
-      continue;
+  if (fasterRcnn_output->stream_id < 0 ||
+      fasterRcnn_output->stream_id >= static_cast<int>(streams_.size())) {
+    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                 "Invalid stream id: %d",
+                 fasterRcnn_output->stream_id);
+    return -1;
+  }
+  auto& stream = streams_[fasterRcnn_output->stream_id];
+  fasterRcnn_output->infer_end_ns = infer_end_ns;
+  auto& stage_latency = *stream->stage_latency;
+  if (fasterRcnn_output->tile_group) {
+    stage_latency.Record(StageLatency::Stage::TILE_INFER,
+                         infer_end_ns - fasterRcnn_output->submit_ns);
+    // 所有tile都推理完成后整帧只发布一次
+    if (!FinishTile(*fasterRcnn_output, true)) {
+      return 0;
     }
+    infer_latency_ms =
+        (infer_end_ns - fasterRcnn_output->submit_ns) / 1000000.0f;
+  }
+  stage_latency.Record(
+      StageLatency::Stage::RECV_TO_PREPROCESS,
+      fasterRcnn_output->preprocess_start_ns - fasterRcnn_output->recv_ns);
+  stage_latency.Record(StageLatency::Stage::PREPROCESS,
+                       fasterRcnn_output->preprocess_end_ns -
+                           fasterRcnn_output->preprocess_start_ns);
+  stage_latency.Record(
+      StageLatency::Stage::QUEUE_WAIT,
+      fasterRcnn_output->submit_ns - fasterRcnn_output->preprocess_end_ns);
+  stage_latency.Record(StageLatency::Stage::INFER,
+                       infer_end_ns - fasterRcnn_output->submit_ns);
+  // 推理资源由所有输入路共享，每路输入分到的并发数按照路数平分
+  stream->admission_controller->UpdateInferTime(
+      infer_latency_ms,
+      static_cast<float>(GetInferConcurrency()) / streams_.size());
+
+  FeedOutput(
+      fasterRcnn_output->stream_id, fasterRcnn_output->frame_seq, output);
+  return 0;
+}
 
-    auto fasterRcnn_output =
-        std::dynamic_pointer_cast<FasterRcnnOutput>(node_output);
-    {
-      std::stringstream ss;
-      ss << "Output from";
-      ss << ", frame_id: " << fasterRcnn_output->image_msg_header->frame_id
-         << ", stamp: " << fasterRcnn_output->image_msg_header->stamp.sec << "_"
-         << fasterRcnn_output->image_msg_header->stamp.nanosec
-         << ", infer time ms: " << node_output->rt_stat->infer_time_ms;
-      RCLCPP_INFO(
-          rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
+bool Mono2dBodyDetNode::FinishTile(FasterRcnnOutput& output, bool succeeded) {
+  auto& tile_group = *output.tile_group;
+  auto& tile = tile_group.tiles[output.tile_index];
+  tile.valid = succeeded;
+  if (succeeded) {
+    tile.output->outputs.swap(output.outputs);
+    tile.output->rt_stat = output.rt_stat;
+    tile.image_transform = output.image_transform;
+    tile.submit_ns = output.submit_ns;
+    tile.infer_end_ns = output.infer_end_ns;
+  }
+  // 与其他tile的转存配对，最后完成的tile可以看到所有tile的输出
+  if (tile_group.pending.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+    output.tile_group = nullptr;
+    return false;
+  }
+  // 整帧的推理耗时从第一个tile提交推理开始计算
+  for (const auto& other : tile_group.tiles) {
+    if (other.valid && other.submit_ns < output.submit_ns) {
+      output.submit_ns = other.submit_ns;
+    }
+  }
+  // 最后完成的tile提交失败时，使用其他tile的推理统计
+  for (const auto& other : tile_group.tiles) {
+    if (output.rt_stat) {
+      break;
+    }
+    if (other.valid) {
+      output.rt_stat = other.output->rt_stat;
     }
+  }
+  return true;
+}
 
-    // 创建解析输出数据，检测框和关键点数据
-    // results的维度等于检测出来的目标类别数
-    std::vector<std::shared_ptr<hobot::dnn_node::parser_fasterrcnn::Filter2DResult>>
-        results;
-    std::shared_ptr<LandmarksResult> lmk_result = nullptr;
-    
-    // 使用hobot dnn内置的Parse解析方法，解析算法输出的DNNTensor类型数据
+int Mono2dBodyDetNode::PublishOutput(
+    const std::shared_ptr<DnnNodeOutput>& node_output) {
+  // 所有推理输出都由Preprocess创建，PostProcess中已经检查过
+  auto fasterRcnn_output = static_cast<FasterRcnnOutput*>(node_output.get());
+  auto& stream = streams_[fasterRcnn_output->stream_id];
+  auto& stage_latency = *stream->stage_latency;
+  uint64_t publish_start_ns = LatencyHistogram::NowNs();
+  stage_latency.Record(StageLatency::Stage::REORDER_WAIT,
+                       publish_start_ns - fasterRcnn_output->infer_end_ns);
+  bool log_frame = ShouldLogFrame(fasterRcnn_output->frame_seq);
+  if (log_frame) {
+    async_logger_->Log(
+        "Output from stream: %d, frame_id: %s, stamp: %d_%u, "
+        "infer time ms: %d",
+        stream->stream_id,
+        fasterRcnn_output->image_msg_header->frame_id.c_str(),
+        fasterRcnn_output->image_msg_header->stamp.sec,
+        fasterRcnn_output->image_msg_header->stamp.nanosec,
+        node_output->rt_stat ? node_output->rt_stat->infer_time_ms : 0);
+  }
+
+  // 创建解析输出数据，检测框和关键点数据
+  // results的维度等于检测出来的目标类别数，复用该路输入上一帧的vector
+  auto& results = stream->parse_results;
+  results.clear();
+  std::shared_ptr<LandmarksResult> lmk_result = nullptr;
+  // 切分tile推理时各个tile的输出在合并检测结果时解析
+  auto tile_group = std::move(fasterRcnn_output->tile_group);
+  bool is_predicted = fasterRcnn_output->is_predicted;
+  bool is_motion_skipped = fasterRcnn_output->is_motion_skipped;
+  // 跳过推理的帧没有模型输出
+  bool has_infer_output = !is_predicted && !is_motion_skipped;
+
+  // 使用hobot dnn内置的Parse解析方法，解析算法输出的DNNTensor类型数据
+  if (!tile_group && has_infer_output) {
     if (hobot::dnn_node::parser_fasterrcnn::Parse(node_output, parser_para_,
     box_outputs_index_, kps_output_index_, body_box_output_index_, results, lmk_result) < 0) {
       RCLCPP_ERROR(rclcpp::get_logger("dnn_node_sample"),
                   "Parse node_output fail!");
+      fasterRcnn_output->outputs.clear();
       return -1;
     }
+    uint64_t parse_end_ns = LatencyHistogram::NowNs();
+    stage_latency.Record(StageLatency::Stage::PARSE,
+                         parse_end_ns - publish_start_ns);
+  }
 
-    struct timespec time_start = {0, 0};
-    clock_gettime(CLOCK_REALTIME, &time_start);
-
-    ai_msgs::msg::PerceptionTargets::UniquePtr pub_data(
-        new ai_msgs::msg::PerceptionTargets());
-    if (fasterRcnn_output->image_msg_header) {
-      pub_data->header.set__stamp(fasterRcnn_output->image_msg_header->stamp);
-      pub_data->header.set__frame_id(
-          fasterRcnn_output->image_msg_header->frame_id);
-    }
-    if (output->rt_stat) {
-      pub_data->set__fps(round(output->rt_stat->output_fps));
-    }
-
-    // key is model output index
-    std::unordered_map<int32_t, std::vector<MotBox>> rois;
-    std::vector<ai_msgs::msg::Point> body_kps;
-
-    for (const auto& idx : box_outputs_index_) {
-      if (idx >= results.size()) {
-        RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
-                     "Output index: %d exceeds results size %d",
-                     idx, results.size());
-        return -1;
-      }
-
-      auto filter2d_result = results.at(idx);
-      if (!filter2d_result) {
-        continue;
-      }
+  struct timespec time_start = {0, 0};
+  clock_gettime(CLOCK_REALTIME, &time_start);
 
-      if (box_outputs_index_type_.find(idx) == box_outputs_index_type_.end()) {
-        RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
-                     "Invalid output index: %d",
-                     idx);
-        return -1;
-      }
+  ai_msgs::msg::PerceptionTargets::UniquePtr pub_data(
+      new ai_msgs::msg::PerceptionTargets());
+  if (fasterRcnn_output->image_msg_header) {
+    pub_data->header.set__stamp(fasterRcnn_output->image_msg_header->stamp);
+    pub_data->header.set__frame_id(
+        fasterRcnn_output->image_msg_header->frame_id);
+  }
+  if (node_output->rt_stat) {
+    pub_data->set__fps(round(node_output->rt_stat->output_fps));
+  }
 
-      rois[idx].resize(0);
-      std::string roi_type = box_outputs_index_type_[idx];
+  // 跟踪输入输出和关键点复用该路输入上一帧的内存
+  auto& target_builder = *stream->target_builder;
+  target_builder.Reset();
+  const auto& transform = fasterRcnn_output->image_transform;
+  int img_width =
+      transform.src_width > 0 ? transform.src_width : model_input_width_;
+  int img_height =
+      transform.src_height > 0 ? transform.src_height : model_input_height_;
+
+  if (tile_group) {
+    ParseTiles(*stream, *tile_group, img_width, img_height, log_frame);
+  } else if (has_infer_output) {
+    // 检测框映射回原图坐标
+    if (target_builder.AddParseResults(results,
+                                       lmk_result.get(),
+                                       box_outputs_index_,
+                                       transform,
+                                       img_width,
+                                       img_height) != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                   "Invalid output index, results size %d",
+                   static_cast<int>(results.size()));
+      fasterRcnn_output->outputs.clear();
+      return -1;
+    }
 
-      RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
-                  "Output box type: %s, rect size: %d",
-                  roi_type.data(),
-                  filter2d_result->boxes.size());
-
-      for (auto& rect : filter2d_result->boxes) {
-        if (rect.left < 0) rect.left = 0;
-        if (rect.top < 0) rect.top = 0;
-        if (rect.right > model_input_width_) {
-          rect.right = model_input_width_;
+    if (log_frame) {
+      for (const auto& idx : box_outputs_index_) {
+        if (!target_builder.HasOutput(idx)) {
+          continue;
         }
-        if (rect.bottom > model_input_height_) {
-          rect.bottom = model_input_height_;
+        const auto& boxes = target_builder.InRois()[idx];
+        async_logger_->Log("Output box type: %s, rect size: %d",
+                           box_outputs_index_type_.at(idx).c_str(),
+                           static_cast<int>(boxes.size()));
+        for (const auto& box : boxes) {
+          async_logger_->Log("rect: %d %d %d %d, %f",
+                             static_cast<int>(box.x1),
+                             static_cast<int>(box.y1),
+                             static_cast<int>(box.x2),
+                             static_cast<int>(box.y2),
+                             static_cast<double>(box.score));
         }
-        std::stringstream ss;
-        ss << "rect: " << rect.left << " " << rect.top << " " << rect.right
-           << " " << rect.bottom << ", " << rect.conf;
-        RCLCPP_INFO(
-            rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
-
-        rois[idx].emplace_back(
-            MotBox(rect.left, rect.top, rect.right, rect.bottom, rect.conf));
       }
     }
 
-    if (lmk_result) {
-      std::stringstream ss;
+    if (lmk_result && log_frame &&
+        rcutils_logging_logger_is_enabled_for("mono2d_body_det",
+                                              RCUTILS_LOG_SEVERITY_DEBUG)) {
       for (const auto& value : lmk_result->values) {
-        ai_msgs::msg::Point target_point;
-        target_point.set__type("body_kps");
+        std::stringstream ss;
         ss << "kps point: ";
         for (const auto& lmk : value) {
           ss << "\n" << lmk.x << "," << lmk.y << "," << lmk.score;
-          geometry_msgs::msg::Point32 pt;
-          pt.set__x(lmk.x);
-          pt.set__y(lmk.y);
-          target_point.point.emplace_back(pt);
-          target_point.confidence.push_back(lmk.score);
         }
-        ss << "\n";
         RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
                      "FasterRcnnKpsOutputParser parse kps: %s",
                      ss.str().c_str());
-        body_kps.emplace_back(target_point);
       }
     }
+  }
 
-    std::unordered_map<int32_t, std::vector<MotBox>> out_rois;
-#ifndef PLATFORM_X86
-    std::unordered_map<int32_t, std::vector<std::shared_ptr<MotTrackId>>>
-        out_disappeared_ids;
-
-    uint64_t ts_ms =
-        fasterRcnn_output->image_msg_header->stamp.sec * 1000 +
-        fasterRcnn_output->image_msg_header->stamp.nanosec / 1000 / 1000;
-    time_t time_stamp = ts_ms;
-
-    DoMot(time_stamp, rois, out_rois, out_disappeared_ids);
-#endif
-#ifndef PLATFORM_X86
-    for (const auto& out_roi : out_rois) 
-#else
-    for (const auto& out_roi : rois) 
-#endif
-    {
-      std::string roi_type = "";
-      if (box_outputs_index_type_.find(out_roi.first) !=
-          box_outputs_index_type_.end()) {
-        roi_type = box_outputs_index_type_.at(out_roi.first);
-      }
-      for (size_t idx = 0; idx < out_roi.second.size(); idx++) {
-        const auto& rect = out_roi.second.at(idx);
-#ifndef PLATFORM_X86
-        if (rect.id < 0 || hobot_mot::DataState::INVALID == rect.state_) 
-#else
-        if (rect.id < 0 || DataState::INVALID == rect.state_) 
-#endif
-        {
-          std::stringstream ss;
-          ss << "invalid id, rect: " << rect.x1 << " " << rect.y1 << " "
-             << rect.x2 << " " << rect.y2 << ", score: " << rect.score
-             << ", state_: " << static_cast<int>(rect.state_);
-          RCLCPP_INFO(
-              rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
-          continue;
-        }
-        ai_msgs::msg::Target target;
-        target.set__type("person");
-        target.set__track_id(rect.id);
-        ai_msgs::msg::Roi roi;
-        roi.type = roi_type;
-        roi.rect.set__x_offset(rect.x1);
-        roi.rect.set__y_offset(rect.y1);
-        roi.rect.set__width(rect.x2 - rect.x1);
-        roi.rect.set__height(rect.y2 - rect.y1);
-        target.rois.emplace_back(roi);
-        if (out_roi.first == body_box_output_index_ &&
-            out_roi.second.size() == body_kps.size()) {
-          target.points.emplace_back(body_kps.at(idx));
-        }
-        pub_data->targets.emplace_back(std::move(target));
-      }
+  uint64_t ts_ms =
+      fasterRcnn_output->image_msg_header->stamp.sec * 1000 +
+      fasterRcnn_output->image_msg_header->stamp.nanosec / 1000 / 1000;
+  time_t time_stamp = ts_ms;
+
+  uint64_t mot_start_ns = LatencyHistogram::NowNs();
+  if (is_predicted) {
+    // 跳过推理的帧不送入跟踪，由上一次推理帧的跟踪结果预测目标位置
+    struct timespec predict_start = {0, 0};
+    clock_gettime(CLOCK_REALTIME, &predict_start);
+    stream->track_predictor->Predict(ts_ms, *pub_data);
+    stage_latency.Record(StageLatency::Stage::TRACKING,
+                         LatencyHistogram::NowNs() - mot_start_ns);
+    struct timespec predict_end = {0, 0};
+    clock_gettime(CLOCK_REALTIME, &predict_end);
+    ai_msgs::msg::Perf perf;
+    perf.set__type(perf_types_.track_predict);
+    perf.set__stamp_start(ConvertToRosTime(predict_start));
+    perf.set__stamp_end(ConvertToRosTime(predict_end));
+    perf.set__time_ms_duration(
+        CalTimeMsDuration(perf.stamp_start, perf.stamp_end));
+    pub_data->perfs.push_back(perf);
+  } else if (is_motion_skipped) {
+    // 画面没有运动，目标位置不变，不送入跟踪
+    pub_data->targets = stream->last_targets;
+  } else {
+    DoMot(stream->hobot_mots,
+          time_stamp,
+          img_width,
+          img_height,
+          target_builder,
+          pub_data->perfs);
+    stage_latency.Record(StageLatency::Stage::TRACKING,
+                         LatencyHistogram::NowNs() - mot_start_ns);
+    target_builder.Build(*pub_data, log_frame ? async_logger_.get() : nullptr);
+    if (stream->track_predictor) {
+      stream->track_predictor->Update(*pub_data, ts_ms, img_width, img_height);
+      stream->frame_dispatcher->SetDetectInterval(
+          stream->track_predictor->NextInterval());
     }
-#ifndef PLATFORM_X86
-    for (const auto& disappeared_id : out_disappeared_ids) {
-      std::string roi_type = "";
-      if (box_outputs_index_type_.find(disappeared_id.first) !=
-          box_outputs_index_type_.end()) {
-        roi_type = box_outputs_index_type_.at(disappeared_id.first);
-      }
-      for (size_t idx = 0; idx < disappeared_id.second.size(); idx++) {
-        auto id_info = disappeared_id.second.at(idx);
-        if (id_info->value < 0 ||
-            hobot_mot::DataState::INVALID == id_info->state_) {
-          continue;
-        }
-        ai_msgs::msg::Target target;
-        target.set__type("person");
-        target.set__track_id(id_info->value);
-        ai_msgs::msg::Roi roi;
-        roi.type = roi_type;
-        target.rois.emplace_back(roi);
-        pub_data->disappeared_targets.emplace_back(std::move(target));
-      }
+    if (motion_gate_mode_ == static_cast<int>(MotionGateMode::REPUBLISH)) {
+      stream->last_targets = pub_data->targets;
     }
-#endif
-    struct timespec time_now = {0, 0};
-    clock_gettime(CLOCK_REALTIME, &time_now);
+  }
+  struct timespec time_now = {0, 0};
+  clock_gettime(CLOCK_REALTIME, &time_now);
 
-    // preprocess
+  // preprocess
+  if (has_infer_output) {
     ai_msgs::msg::Perf perf_preprocess;
-    perf_preprocess.set__type(model_name_ + "_preprocess");
+    perf_preprocess.set__type(perf_types_.preprocess);
     perf_preprocess.set__stamp_start(
         ConvertToRosTime(fasterRcnn_output->preprocess_timespec_start));
     perf_preprocess.set__stamp_end(
@@ -560,105 +989,254 @@ int Mono2dBodyDetNode::PostProcess(
     perf_preprocess.set__time_ms_duration(CalTimeMsDuration(
         perf_preprocess.stamp_start, perf_preprocess.stamp_end));
     pub_data->perfs.emplace_back(perf_preprocess);
+  }
 
-    // predict
-    if (output->rt_stat) {
+  // predict
+  if (node_output->rt_stat) {
+    ai_msgs::msg::Perf perf;
+    perf.set__type(perf_types_.predict_infer);
+    perf.set__stamp_start(
+        ConvertToRosTime(node_output->rt_stat->infer_timespec_start));
+    perf.set__stamp_end(
+        ConvertToRosTime(node_output->rt_stat->infer_timespec_end));
+    perf.set__time_ms_duration(node_output->rt_stat->infer_time_ms);
+    pub_data->perfs.push_back(perf);
+
+    perf.set__type(perf_types_.predict_parse);
+    perf.set__stamp_start(
+        ConvertToRosTime(node_output->rt_stat->parse_timespec_start));
+    perf.set__stamp_end(
+        ConvertToRosTime(node_output->rt_stat->parse_timespec_end));
+    perf.set__time_ms_duration(node_output->rt_stat->parse_time_ms);
+    pub_data->perfs.push_back(perf);
+  }
+  if (tile_group) {
+    for (size_t idx = 0;
+         idx < tile_group->tiles.size() && idx < perf_types_.tile_infer.size();
+         idx++) {
+      const auto& tile = tile_group->tiles[idx];
+      if (!tile.valid || !tile.output->rt_stat) {
+        continue;
+      }
       ai_msgs::msg::Perf perf;
-      perf.set__type(model_name_ + "_predict_infer");
-      perf.set__stamp_start(
-          ConvertToRosTime(output->rt_stat->infer_timespec_start));
-      perf.set__stamp_end(
-          ConvertToRosTime(output->rt_stat->infer_timespec_end));
-      perf.set__time_ms_duration(output->rt_stat->infer_time_ms);
-      pub_data->perfs.push_back(perf);
-
-      perf.set__type(model_name_ + "_predict_parse");
+      perf.set__type(perf_types_.tile_infer[idx]);
       perf.set__stamp_start(
-          ConvertToRosTime(output->rt_stat->parse_timespec_start));
+          ConvertToRosTime(tile.output->rt_stat->infer_timespec_start));
       perf.set__stamp_end(
-          ConvertToRosTime(output->rt_stat->parse_timespec_end));
-      perf.set__time_ms_duration(output->rt_stat->parse_time_ms);
+          ConvertToRosTime(tile.output->rt_stat->infer_timespec_end));
+      perf.set__time_ms_duration(tile.output->rt_stat->infer_time_ms);
       pub_data->perfs.push_back(perf);
     }
+  }
 
-    // postprocess
-    ai_msgs::msg::Perf perf_postprocess;
-    perf_postprocess.set__type(model_name_ + "_postprocess");
-    perf_postprocess.set__stamp_start(ConvertToRosTime(time_start));
-    clock_gettime(CLOCK_REALTIME, &time_now);
-    perf_postprocess.set__stamp_end(ConvertToRosTime(time_now));
-    perf_postprocess.set__time_ms_duration(CalTimeMsDuration(
-        perf_postprocess.stamp_start, perf_postprocess.stamp_end));
-    pub_data->perfs.emplace_back(perf_postprocess);
-
-    // 从发布图像到发布AI结果的延迟
-    ai_msgs::msg::Perf perf_pipeline;
-    perf_pipeline.set__type(model_name_ + "_pipeline");
-    perf_pipeline.set__stamp_start(pub_data->header.stamp);
-    perf_pipeline.set__stamp_end(perf_postprocess.stamp_end);
-    perf_pipeline.set__time_ms_duration(
-        CalTimeMsDuration(perf_pipeline.stamp_start, perf_pipeline.stamp_end));
-    pub_data->perfs.push_back(perf_pipeline);
-
-    {
-      std::stringstream ss;
-      ss << "Publish frame_id: "
-         << fasterRcnn_output->image_msg_header->frame_id
-         << ", time_stamp: " << std::to_string(pub_data->header.stamp.sec)
-         << "_" << std::to_string(pub_data->header.stamp.nanosec) << "\n";
-      RCLCPP_INFO(
-          rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
-    }
-
-    std::stringstream ss;
-    ss << "Publish frame_id: " << fasterRcnn_output->image_msg_header->frame_id
-       << ", time_stamp: " << std::to_string(pub_data->header.stamp.sec) << "_"
-       << std::to_string(pub_data->header.stamp.nanosec) << "\n";
-    ss << "targets.size: " << pub_data->targets.size() << "\n";
-
-    if (!pub_data->targets.empty()) {
-      for (const auto target : pub_data->targets) {
-        ss << "target track_id: " << target.track_id
-           << ", rois.size: " << target.rois.size();
-        for (const auto& roi : target.rois) {
-          ss << ", " << roi.type.c_str();
-        }
-        ss << ", points.size: " << target.points.size();
-        for (const auto& point : target.points) {
-          ss << ", " << point.type.c_str();
-        }
-        ss << "\n";
-      }
+  // postprocess
+  ai_msgs::msg::Perf perf_postprocess;
+  perf_postprocess.set__type(perf_types_.postprocess);
+  perf_postprocess.set__stamp_start(ConvertToRosTime(time_start));
+  clock_gettime(CLOCK_REALTIME, &time_now);
+  perf_postprocess.set__stamp_end(ConvertToRosTime(time_now));
+  perf_postprocess.set__time_ms_duration(CalTimeMsDuration(
+      perf_postprocess.stamp_start, perf_postprocess.stamp_end));
+  pub_data->perfs.emplace_back(perf_postprocess);
+
+  // 从发布图像到发布AI结果的延迟
+  ai_msgs::msg::Perf perf_pipeline;
+  perf_pipeline.set__type(perf_types_.pipeline);
+  perf_pipeline.set__stamp_start(pub_data->header.stamp);
+  perf_pipeline.set__stamp_end(perf_postprocess.stamp_end);
+  perf_pipeline.set__time_ms_duration(
+      CalTimeMsDuration(perf_pipeline.stamp_start, perf_pipeline.stamp_end));
+  pub_data->perfs.push_back(perf_pipeline);
+
+  if (log_frame) {
+    async_logger_->Log(
+        "Publish frame_id: %s, time_stamp: %d_%u, targets.size: %d, "
+        "disappeared_targets.size: %d",
+        pub_data->header.frame_id.c_str(),
+        pub_data->header.stamp.sec,
+        pub_data->header.stamp.nanosec,
+        static_cast<int>(pub_data->targets.size()),
+        static_cast<int>(pub_data->disappeared_targets.size()));
+    for (const auto& target : pub_data->targets) {
+      async_logger_->Log(
+          "target track_id: %d, rois.size: %d, roi type: %s, "
+          "points.size: %d",
+          static_cast<int>(target.track_id),
+          static_cast<int>(target.rois.size()),
+          target.rois.empty() ? "" : target.rois.front().type.c_str(),
+          static_cast<int>(target.points.size()));
     }
-
-    ss << "disappeared_targets.size: " << pub_data->disappeared_targets.size()
-       << "\n";
-    if (!pub_data->disappeared_targets.empty()) {
-      for (const auto& target : pub_data->disappeared_targets) {
-        ss << "disappeared target track_id: " << target.track_id
-           << ", rois.size: " << target.rois.size();
-        for (const auto& roi : target.rois) {
-          ss << ", " << roi.type.c_str();
-        }
-        ss << "\n";
-      }
+    for (const auto& target : pub_data->disappeared_targets) {
+      async_logger_->Log(
+          "disappeared target track_id: %d, rois.size: %d, roi type: %s",
+          static_cast<int>(target.track_id),
+          static_cast<int>(target.rois.size()),
+          target.rois.empty() ? "" : target.rois.front().type.c_str());
     }
+  }
 
-    RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
+  if (node_output->rt_stat && node_output->rt_stat->fps_updated) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "input fps: %.2f, out fps: %.2f, infer time ms: %d, "
+                "post process time ms: %d",
+                node_output->rt_stat->input_fps,
+                node_output->rt_stat->output_fps,
+                node_output->rt_stat->infer_time_ms,
+                static_cast<int>(perf_postprocess.time_ms_duration));
+    auto pool_stats = NV12PyramidPool::Instance()->GetStats();
+    RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
+                "pyramid pool hits: %lu, misses: %lu, bytes in flight: %lu, "
+                "high water mark: %lu",
+                pool_stats.hits,
+                pool_stats.misses,
+                pool_stats.bytes_in_flight,
+                pool_stats.high_water_mark);
+  }
 
-    if (node_output->rt_stat->fps_updated) {
-      RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
-                  "input fps: %.2f, out fps: %.2f, infer time ms: %d, "
-                  "post process time ms: %d",
-                  node_output->rt_stat->input_fps,
-                  node_output->rt_stat->output_fps,
-                  node_output->rt_stat->infer_time_ms,
-                  static_cast<int>(perf_postprocess.time_ms_duration));
+  stream->published_frames++;
+  uint64_t latency_ms =
+      perf_pipeline.time_ms_duration > 0 ? perf_pipeline.time_ms_duration : 0;
+  stream->latency_ms_sum += latency_ms;
+  uint64_t latency_ms_max = stream->latency_ms_max.load();
+  while (latency_ms > latency_ms_max &&
+         !stream->latency_ms_max.compare_exchange_weak(latency_ms_max,
+                                                      latency_ms)) {
+  }
+  uint64_t publish_ns = LatencyHistogram::NowNs();
+  if (stream->pod_msg_publisher) {
+    PublishPodResult(
+        *stream, *pub_data, img_width, img_height, !has_infer_output);
+  }
+  stream->msg_publisher->publish(std::move(pub_data));
+  uint64_t published_ns = LatencyHistogram::NowNs();
+  stage_latency.Record(StageLatency::Stage::PUBLISH,
+                       published_ns - publish_ns);
+  stage_latency.Record(StageLatency::Stage::TOTAL,
+                       published_ns - fasterRcnn_output->recv_ns);
+  // 对象回到output_pool_之前释放推理输出的tensor
+  fasterRcnn_output->outputs.clear();
+  return 0;
+}
+
+void Mono2dBodyDetNode::ParseTiles(StreamContext& stream,
+                                   TileGroup& tile_group,
+                                   int img_width,
+                                   int img_height,
+                                   bool log_frame) {
+  auto& stage_latency = *stream.stage_latency;
+  uint64_t parse_start_ns = LatencyHistogram::NowNs();
+  auto& tile_merger = *stream.tile_merger;
+  tile_merger.Reset(tile_group.rects, img_height, img_width);
+  auto& results = stream.parse_results;
+  for (size_t tile_idx = 0; tile_idx < tile_group.tiles.size(); tile_idx++) {
+    auto& tile = tile_group.tiles[tile_idx];
+    if (!tile.valid) {
+      continue;
+    }
+    results.clear();
+    std::shared_ptr<LandmarksResult> lmk_result = nullptr;
+    int ret = hobot::dnn_node::parser_fasterrcnn::Parse(tile.output,
+                                                        parser_para_,
+                                                        box_outputs_index_,
+                                                        kps_output_index_,
+                                                        body_box_output_index_,
+                                                        results,
+                                                        lmk_result);
+    // 解析完成后释放推理输出的tensor
+    tile.output->outputs.clear();
+    if (ret < 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                   "Parse tile %d output fail!",
+                   static_cast<int>(tile_idx));
+      continue;
+    }
+    // 检测框和关键点映射回原图坐标后加入合并
+    const auto& transform = tile.image_transform;
+    for (const auto& idx : box_outputs_index_) {
+      if (idx >= static_cast<int32_t>(results.size()) || !results[idx]) {
+        continue;
+      }
+      const auto& boxes = results[idx]->boxes;
+      bool with_kps = idx == body_box_output_index_ && lmk_result &&
+                      lmk_result->values.size() == boxes.size();
+      for (size_t box_idx = 0; box_idx < boxes.size(); box_idx++) {
+        const auto& rect = boxes[box_idx];
+        size_t merged_idx = tile_merger.AddBox(idx,
+                                               static_cast<int>(tile_idx),
+                                               transform.ToSrcX(rect.left),
+                                               transform.ToSrcY(rect.top),
+                                               transform.ToSrcX(rect.right),
+                                               transform.ToSrcY(rect.bottom),
+                                               rect.conf);
+        if (!with_kps) {
+          continue;
+        }
+        const auto& lmks = lmk_result->values[box_idx];
+        auto& kps = tile_merger.AddKps(idx, merged_idx);
+        kps.resize(lmks.size());
+        for (size_t kps_idx = 0; kps_idx < lmks.size(); kps_idx++) {
+          kps[kps_idx] = TileMerger::Point{transform.ToSrcX(lmks[kps_idx].x),
+                                           transform.ToSrcY(lmks[kps_idx].y),
+                                           lmks[kps_idx].score};
+        }
+      }
+    }
+  }
+  uint64_t merge_start_ns = LatencyHistogram::NowNs();
+  stage_latency.Record(StageLatency::Stage::PARSE,
+                       merge_start_ns - parse_start_ns);
+  tile_merger.Merge(static_cast<float>(tile_nms_iou_threshold_));
+  stage_latency.Record(StageLatency::Stage::TILE_MERGE,
+                       LatencyHistogram::NowNs() - merge_start_ns);
+
+  // 合并后的检测框和关键点已经是原图坐标，只需要裁剪到图像范围内
+  ImageTransform src_transform;
+  auto& target_builder = *stream.target_builder;
+  for (const auto& idx : box_outputs_index_) {
+    const auto& boxes = tile_merger.Boxes(idx);
+    if (log_frame) {
+      async_logger_->Log("Output box type: %s, merged rect size: %d",
+                         box_outputs_index_type_[idx].c_str(),
+                         static_cast<int>(boxes.size()));
     }
+    target_builder.AddOutput(idx);
+    for (const auto& box : boxes) {
+      target_builder.AddBox(idx,
+                            box.x1,
+                            box.y1,
+                            box.x2,
+                            box.y2,
+                            box.score,
+                            src_transform,
+                            img_width,
+                            img_height);
+      // 每个人体框都加入关键点（可能为空），保证关键点与人体框一一对应
+      if (idx == body_box_output_index_) {
+        target_builder.AddBodyKps(tile_merger.Kps(box), src_transform);
+      }
+      if (log_frame) {
+        async_logger_->Log("rect: %d %d %d %d, %f, tile: %d",
+                           static_cast<int>(box.x1),
+                           static_cast<int>(box.y1),
+                           static_cast<int>(box.x2),
+                           static_cast<int>(box.y2),
+                           static_cast<double>(box.score),
+                           box.tile);
+      }
+    }
+  }
+}
 
-    msg_publisher_->publish(std::move(pub_data));
+bool Mono2dBodyDetNode::ShouldLogFrame(uint64_t frame_index) const {
+  if (log_mode_ == static_cast<int>(LogMode::OFF) || !async_logger_) {
+    return false;
   }
-  return 0;
+  if (!rcutils_logging_logger_is_enabled_for("mono2d_body_det",
+                                             RCUTILS_LOG_SEVERITY_INFO)) {
+    return false;
+  }
+  return log_mode_ == static_cast<int>(LogMode::FULL) ||
+         frame_index % log_sample_interval_ == 0;
 }
 
 int Mono2dBodyDetNode::Predict(
@@ -671,129 +1249,188 @@ int Mono2dBodyDetNode::Predict(
   return Run(inputs, dnn_output, rois, is_sync_mode_ == 1 ? true : false);
 }
 
+void Mono2dBodyDetNode::FeedOutput(
+    int stream_id,
+    uint64_t frame_seq,
+    const std::shared_ptr<DnnNodeOutput>& output) {
+  // 按照输入顺序发布推理结果
+  streams_[stream_id]->output_reorder_buffer->Feed(
+      frame_seq,
+      output,
+      [this](const std::shared_ptr<DnnNodeOutput>& node_output) {
+        PublishOutput(node_output);
+      });
+}
+
+void Mono2dBodyDetNode::EraseFrame(int stream_id, uint64_t frame_seq) {
+  // 被丢弃或者预测失败的帧不会有输出，避免后续帧等待该帧超时
+  streams_[stream_id]->output_reorder_buffer->Erase(
+      frame_seq, [this](const std::shared_ptr<DnnNodeOutput>& node_output) {
+        PublishOutput(node_output);
+      });
+}
+
+void Mono2dBodyDetNode::EnqueueFrame(ImageFrame&& frame) {
+  if (auto_tuning_) {
+    // 调优期间推理资源被合成帧占用，丢弃订阅到的图片
+    RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
+                 "Auto tuning task_num, drop frame");
+    return;
+  }
+  frame.recv_ns = LatencyHistogram::NowNs();
+  int stream_id = frame.stream_id;
+  auto& stream = streams_[stream_id];
+  stream->recved_frames++;
+  FrameDispatcher::LumaPlane luma;
+  if (stream->motion_gate) {
+    luma = GetMotionLuma(frame);
+  }
+  auto action = stream->frame_dispatcher->Dispatch(luma, frame.frame_seq);
+  if (action == FrameDispatcher::Action::PREDICT) {
+    // 跳过推理的帧不占用流水线，按照输入顺序在推理帧之后发布跟踪预测的目标
+    auto output = AcquireOutput(frame);
+    output->is_predicted = true;
+    output->infer_end_ns = frame.recv_ns;
+    FeedOutput(stream_id, frame.frame_seq, output);
+    return;
+  }
+  if (action == FrameDispatcher::Action::REPUBLISH) {
+    auto output = AcquireOutput(frame);
+    output->is_motion_skipped = true;
+    output->infer_end_ns = LatencyHistogram::NowNs();
+    FeedOutput(stream_id, frame.frame_seq, output);
+    return;
+  }
+  if (action == FrameDispatcher::Action::DROP) {
+    return;
+  }
+  uint64_t frame_seq = frame.frame_seq;
+  if (stream->admission_controller->GetMode() ==
+      AdmissionController::Mode::LATEST_ONLY) {
+    ImageFrame dropped_frame;
+    if (frame_queue_->PushDropOldest(
+            stream_id, std::move(frame), dropped_frame)) {
+      // 被覆盖的帧还未开始预处理
+      stream->admission_controller->OnLatestDrop();
+      EraseFrame(stream_id, dropped_frame.frame_seq);
+    }
+    return;
+  }
+  if (!frame_queue_->TryPush(stream_id, std::move(frame))) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Frame queue of stream %d is full, drop frame seq: %lu",
+                stream_id,
+                frame_seq);
+    EraseFrame(stream_id, frame_seq);
+  }
+}
+
 void Mono2dBodyDetNode::RosImgProcess(
-    const sensor_msgs::msg::Image::ConstSharedPtr img_msg) {
+    const sensor_msgs::msg::Image::ConstSharedPtr img_msg, int stream_id) {
   if (!img_msg || !rclcpp::ok()) {
     return;
   }
 
-  std::stringstream ss;
-  ss << "Recved img encoding: " << img_msg->encoding
-     << ", h: " << img_msg->height << ", w: " << img_msg->width
-     << ", step: " << img_msg->step
-     << ", frame_id: " << img_msg->header.frame_id
-     << ", stamp: " << img_msg->header.stamp.sec << "_"
-     << img_msg->header.stamp.nanosec
-     << ", data size: " << img_msg->data.size();
-  RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
+  if (ShouldLogFrame(streams_[stream_id]->recved_frames.load())) {
+    async_logger_->Log(
+        "Recved img from stream: %d, encoding: %s, h: %u, w: %u, step: %u, "
+        "frame_id: %s, stamp: %d_%u, data size: %d",
+        stream_id,
+        img_msg->encoding.c_str(),
+        img_msg->height,
+        img_msg->width,
+        img_msg->step,
+        img_msg->header.frame_id.c_str(),
+        img_msg->header.stamp.sec,
+        img_msg->header.stamp.nanosec,
+        static_cast<int>(img_msg->data.size()));
+  }
 
   // dump recved img msg
   // std::ofstream ofs("img." + img_msg->encoding);
   // ofs.write(reinterpret_cast<const char*>(img_msg->data.data()),
   //   img_msg->data.size());
 
-  auto tp_start = std::chrono::system_clock::now();
-
-  // 1. 将图片处理成模型输入数据类型DNNInput
-  // 使用图片生成pym，NV12PyramidInput为DNNInput的子类
-  std::shared_ptr<hobot::easy_dnn::NV12PyramidInput> pyramid = nullptr;
-  if ("rgb8" == img_msg->encoding) {
-    auto cv_img =
-        cv_bridge::cvtColorForDisplay(cv_bridge::toCvShare(img_msg), "bgr8");
-    // dump recved img msg after convert
-    // cv::imwrite("dump_raw_" +
-    //     std::to_string(img_msg->header.stamp.sec) + "." +
-    //     std::to_string(img_msg->header.stamp.nanosec) + ".jpg",
-    //     cv_img->image);
-
-    {
-      auto tp_now = std::chrono::system_clock::now();
-      auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          tp_now - tp_start)
-                          .count();
-      RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
-                   "after cvtColorForDisplay cost ms: %d",
-                   interval);
-    }
-
-    pyramid = ImageUtils::GetNV12Pyramid(
-        cv_img->image, model_input_height_, model_input_width_);
-  } else if ("nv12" == img_msg->encoding) {
-    pyramid = ImageUtils::GetNV12PyramidFromNV12Img(
-        reinterpret_cast<const char*>(img_msg->data.data()),
-        img_msg->height,
-        img_msg->width,
-        model_input_height_,
-        model_input_width_);
+  // 回调中只构造帧句柄，图片转换和预测由预处理线程和推理提交线程完成
+  ImageFrame frame;
+  frame.msg_holder = img_msg;
+  frame.encoding = img_msg->encoding;
+  frame.data = img_msg->data.data();
+  frame.data_size = img_msg->data.size();
+  frame.height = img_msg->height;
+  frame.width = img_msg->width;
+  frame.step = img_msg->step;
+  frame.stream_id = stream_id;
+  frame.image_msg_header.set__frame_id(img_msg->header.frame_id);
+  frame.image_msg_header.set__stamp(img_msg->header.stamp);
+  if (record_file_ && stream_id == 0) {
+    RecordFrame(frame);
   }
+  EnqueueFrame(std::move(frame));
+}
 
-  if (!pyramid) {
-    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Get Nv12 pym fail");
+void Mono2dBodyDetNode::CompressedImgProcess(
+    const sensor_msgs::msg::CompressedImage::ConstSharedPtr img_msg,
+    int stream_id) {
+  if (!img_msg || !rclcpp::ok()) {
     return;
   }
 
-  {
-    auto tp_now = std::chrono::system_clock::now();
-    auto interval =
-        std::chrono::duration_cast<std::chrono::milliseconds>(tp_now - tp_start)
-            .count();
-    RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
-                 "after GetNV12Pyramid cost ms: %d",
-                 interval);
-  }
-
-  // 2. 使用pyramid创建DNNInput对象inputs
-  // inputs将会作为模型的输入通过RunInferTask接口传入
-  auto inputs = std::vector<std::shared_ptr<DNNInput>>{pyramid};
-  auto dnn_output = std::make_shared<FasterRcnnOutput>();
-  dnn_output->image_msg_header = std::make_shared<std_msgs::msg::Header>();
-  dnn_output->image_msg_header->set__frame_id(img_msg->header.frame_id);
-  dnn_output->image_msg_header->set__stamp(img_msg->header.stamp);
-
-  if (node_output_manage_ptr_) {
-    node_output_manage_ptr_->Feed(img_msg->header.stamp.sec * 1000 +
-                                  img_msg->header.stamp.nanosec / 1000 / 1000);
+  if (ShouldLogFrame(streams_[stream_id]->recved_frames.load())) {
+    async_logger_->Log(
+        "Recved compressed img from stream: %d, format: %s, frame_id: %s, "
+        "stamp: %d_%u, data size: %d",
+        stream_id,
+        img_msg->format.c_str(),
+        img_msg->header.frame_id.c_str(),
+        img_msg->header.stamp.sec,
+        img_msg->header.stamp.nanosec,
+        static_cast<int>(img_msg->data.size()));
   }
 
-  uint32_t ret = 0;
-  // 3. 开始预测
-  ret = Predict(inputs, nullptr, dnn_output);
-
-  {
-    auto tp_now = std::chrono::system_clock::now();
-    auto interval =
-        std::chrono::duration_cast<std::chrono::milliseconds>(tp_now - tp_start)
-            .count();
-    RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
-                 "after Predict cost ms: %d",
-                 interval);
+  // format可能为"jpeg"或者"bgr8; jpeg compressed bgr8"等形式
+  ImageFrame frame;
+  if (img_msg->format.find("jpeg") != std::string::npos ||
+      img_msg->format.find("jpg") != std::string::npos) {
+    frame.encoding = "jpeg";
+  } else {
+    frame.encoding = img_msg->format;
   }
-
-  // 4. 处理预测结果，如渲染到图片或者发布预测结果
-  if (ret != 0) {
-    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Run predict failed!");
-    return;
+  // 宽高在预处理线程中解析jpeg头得到
+  frame.msg_holder = img_msg;
+  frame.data = img_msg->data.data();
+  frame.data_size = img_msg->data.size();
+  frame.stream_id = stream_id;
+  frame.image_msg_header.set__frame_id(img_msg->header.frame_id);
+  frame.image_msg_header.set__stamp(img_msg->header.stamp);
+  if (record_file_ && stream_id == 0) {
+    RecordFrame(frame);
   }
+  EnqueueFrame(std::move(frame));
 }
 
 #ifdef SHARED_MEM_ENABLED
 void Mono2dBodyDetNode::SharedMemImgProcess(
-    const hbm_img_msgs::msg::HbmMsg1080P::ConstSharedPtr img_msg) {
+    const hbm_img_msgs::msg::HbmMsg1080P::ConstSharedPtr img_msg,
+    int stream_id) {
   if (!img_msg || !rclcpp::ok()) {
     return;
   }
 
-  struct timespec time_start = {0, 0};
-  clock_gettime(CLOCK_REALTIME, &time_start);
-
-  std::stringstream ss;
-  ss << "Recved img encoding: "
-     << std::string(reinterpret_cast<const char*>(img_msg->encoding.data()))
-     << ", h: " << img_msg->height << ", w: " << img_msg->width
-     << ", step: " << img_msg->step << ", index: " << img_msg->index
-     << ", stamp: " << img_msg->time_stamp.sec << "_"
-     << img_msg->time_stamp.nanosec << ", data size: " << img_msg->data_size;
-  RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"), "%s", ss.str().c_str());
+  if (ShouldLogFrame(streams_[stream_id]->recved_frames.load())) {
+    async_logger_->Log(
+        "Recved img from stream: %d, encoding: %s, h: %u, w: %u, step: %u, "
+        "index: %lu, stamp: %d_%u, data size: %u",
+        stream_id,
+        reinterpret_cast<const char*>(img_msg->encoding.data()),
+        img_msg->height,
+        img_msg->width,
+        img_msg->step,
+        static_cast<uint64_t>(img_msg->index),
+        img_msg->time_stamp.sec,
+        img_msg->time_stamp.nanosec,
+        img_msg->data_size);
+  }
 
   // dump recved img msg
   // std::ofstream ofs("img_" + std::to_string(img_msg->index) + "." +
@@ -801,28 +1438,207 @@ void Mono2dBodyDetNode::SharedMemImgProcess(
   // ofs.write(reinterpret_cast<const char*>(img_msg->data.data()),
   //   img_msg->data_size);
 
+  ImageFrame frame;
+  frame.msg_holder = img_msg;
+  frame.encoding =
+      std::string(reinterpret_cast<const char*>(img_msg->encoding.data()));
+  frame.data = img_msg->data.data();
+  frame.data_size = img_msg->data_size;
+  frame.height = img_msg->height;
+  frame.width = img_msg->width;
+  frame.step = img_msg->step;
+  frame.stream_id = stream_id;
+  frame.image_msg_header.set__frame_id(std::to_string(img_msg->index));
+  frame.image_msg_header.set__stamp(img_msg->time_stamp);
+  if (record_file_ && stream_id == 0) {
+    RecordFrame(frame);
+  }
+  EnqueueFrame(std::move(frame));
+}
+#endif
+
+namespace {
+
+// packed格式图片每行的字节数，数据长度不足时返回-1
+int GetPackedStep(const ImageFrame& frame, int bytes_per_pixel) {
+  int step = frame.step > 0 ? frame.step : frame.width * bytes_per_pixel;
+  if (frame.data_size < static_cast<size_t>(step) * frame.height) {
+    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                 "Invalid %s img data size: %d, step: %d, h: %d",
+                 frame.encoding.c_str(),
+                 static_cast<int>(frame.data_size),
+                 step,
+                 frame.height);
+    return -1;
+  }
+  return step;
+}
+
+// packed格式图片每个像素的字节数，不是packed格式时返回0
+int PackedBytesPerPixel(const std::string& encoding) {
+  if ("rgb8" == encoding || "bgr8" == encoding) {
+    return 3;
+  }
+  if ("yuyv" == encoding || "yuv422_yuy2" == encoding ||
+      "uyvy" == encoding || "yuv422" == encoding) {
+    return 2;
+  }
+  if ("mono8" == encoding) {
+    return 1;
+  }
+  return 0;
+}
+
+// nv12图片的数据长度不足时返回false
+bool CheckNv12Size(const ImageFrame& frame, int step) {
+  if (frame.data_size < static_cast<size_t>(step) * frame.height * 3 / 2) {
+    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                 "Invalid nv12 img data size: %d, step: %d, h: %d",
+                 static_cast<int>(frame.data_size),
+                 step,
+                 frame.height);
+    return false;
+  }
+  return true;
+}
+
+// 获取可以直接读取的亮度数据，rgb8/bgr8使用g通道近似
+// 不支持的格式或者数据长度不足时返回false，错误由预处理输出
+bool GetLumaPlane(const ImageFrame& frame,
+                  const uint8_t*& luma,
+                  int& pixel_stride,
+                  int& step) {
+  if ("nv12" == frame.encoding || "mono8" == frame.encoding) {
+    pixel_stride = 1;
+  } else {
+    pixel_stride = PackedBytesPerPixel(frame.encoding);
+  }
+  if (pixel_stride == 0 || !frame.data || frame.height <= 0 ||
+      frame.width <= 0) {
+    return false;
+  }
+  step = frame.step > 0 ? frame.step : frame.width * pixel_stride;
+  if (frame.data_size < static_cast<size_t>(step) * frame.height) {
+    return false;
+  }
+  // sensor_msgs的yuv422为uyvy顺序，亮度在奇数字节
+  bool luma_second = "uyvy" == frame.encoding ||
+                     "yuv422" == frame.encoding || pixel_stride == 3;
+  luma = frame.data + (luma_second ? 1 : 0);
+  return true;
+}
+
+}  // namespace
+
+FrameDispatcher::LumaPlane Mono2dBodyDetNode::GetMotionLuma(
+    const ImageFrame& frame) {
+  FrameDispatcher::LumaPlane luma;
+  if (GetLumaPlane(frame, luma.data, luma.pixel_stride, luma.step)) {
+    luma.height = frame.height;
+    luma.width = frame.width;
+  }
+  return luma;
+}
+
+int Mono2dBodyDetNode::Preprocess(const ImageFrame& frame, InferTask& task) {
+  struct timespec time_start = {0, 0};
+  clock_gettime(CLOCK_REALTIME, &time_start);
+  uint64_t preprocess_start_ns = LatencyHistogram::NowNs();
   auto tp_start = std::chrono::system_clock::now();
 
   // 1. 将图片处理成模型输入数据类型DNNInput
   // 使用图片生成pym，NV12PyramidInput为DNNInput的子类
   std::shared_ptr<hobot::easy_dnn::NV12PyramidInput> pyramid = nullptr;
-  if ("nv12" ==
-      std::string(reinterpret_cast<const char*>(img_msg->encoding.data()))) {
+  ImageTransform transform;
+  auto resize_type = static_cast<ImageResizeType>(image_resize_type_);
+  // 以下格式都直接缩放并转换为nv12写入pyramid，不生成全尺寸的中间图
+  // （resize_type为AREA并且缩小时除外）
+  if ("rgb8" == frame.encoding || "bgr8" == frame.encoding) {
+    int step = GetPackedStep(frame, 3);
+    if (step < 0) {
+      return -1;
+    }
+    pyramid = ImageUtils::GetNV12PyramidFromRGBImg(frame.data,
+                                                   frame.height,
+                                                   frame.width,
+                                                   step,
+                                                   "bgr8" == frame.encoding,
+                                                   model_input_height_,
+                                                   model_input_width_,
+                                                   resize_type,
+                                                   is_letterbox_ == 1,
+                                                   &transform);
+  } else if ("yuyv" == frame.encoding || "yuv422_yuy2" == frame.encoding ||
+             "uyvy" == frame.encoding || "yuv422" == frame.encoding) {
+    // sensor_msgs的yuv422为uyvy顺序，yuv422_yuy2为yuyv顺序
+    int step = GetPackedStep(frame, 2);
+    if (step < 0) {
+      return -1;
+    }
+    pyramid = ImageUtils::GetNV12PyramidFromYUV422Img(
+        frame.data,
+        frame.height,
+        frame.width,
+        step,
+        "uyvy" == frame.encoding || "yuv422" == frame.encoding,
+        model_input_height_,
+        model_input_width_,
+        resize_type,
+        is_letterbox_ == 1,
+        &transform);
+  } else if ("mono8" == frame.encoding) {
+    int step = GetPackedStep(frame, 1);
+    if (step < 0) {
+      return -1;
+    }
+    pyramid = ImageUtils::GetNV12PyramidFromGrayImg(frame.data,
+                                                    frame.height,
+                                                    frame.width,
+                                                    step,
+                                                    model_input_height_,
+                                                    model_input_width_,
+                                                    resize_type,
+                                                    is_letterbox_ == 1,
+                                                    &transform);
+  } else if ("nv12" == frame.encoding) {
+    int step = frame.step > 0 ? frame.step : frame.width;
+    if (!CheckNv12Size(frame, step)) {
+      return -1;
+    }
     pyramid = ImageUtils::GetNV12PyramidFromNV12Img(
-        reinterpret_cast<const char*>(img_msg->data.data()),
-        img_msg->height,
-        img_msg->width,
+        reinterpret_cast<const char*>(frame.data),
+        frame.height,
+        frame.width,
+        step,
+        model_input_height_,
+        model_input_width_,
+        resize_type,
+        is_letterbox_ == 1,
+        &transform);
+  } else if ("jpeg" == frame.encoding) {
+    // 解码为yuv后直接写入pyramid，模型输入较小时在DCT阶段缩小
+    pyramid = ImageUtils::GetNV12PyramidFromJpeg(
+        frame.data,
+        frame.data_size,
         model_input_height_,
-        model_input_width_);
+        model_input_width_,
+        resize_type,
+        is_letterbox_ == 1,
+        &transform);
   } else {
-    RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
-                "Unsupported img encoding: %s",
-                img_msg->encoding);
+    RCLCPP_WARN_THROTTLE(rclcpp::get_logger("mono2d_body_det"),
+                         *this->get_clock(),
+                         5000,
+                         "Unsupported img encoding: %s, supported encodings: "
+                         "rgb8, bgr8, yuyv(yuv422_yuy2), uyvy(yuv422), mono8, "
+                         "nv12, jpeg",
+                         frame.encoding.c_str());
+    return -1;
   }
 
   if (!pyramid) {
     RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Get Nv12 pym fail!");
-    return;
+    return -1;
   }
 
   {
@@ -837,83 +1653,769 @@ void Mono2dBodyDetNode::SharedMemImgProcess(
 
   // 2. 使用pyramid创建DNNInput对象inputs
   // inputs将会作为模型的输入通过RunInferTask接口传入
-  auto inputs = std::vector<std::shared_ptr<DNNInput>>{pyramid};
-  auto dnn_output = std::make_shared<FasterRcnnOutput>();
-  dnn_output->image_msg_header = std::make_shared<std_msgs::msg::Header>();
-  dnn_output->image_msg_header->set__frame_id(std::to_string(img_msg->index));
-  dnn_output->image_msg_header->set__stamp(img_msg->time_stamp);
+  task.inputs = std::vector<std::shared_ptr<DNNInput>>{pyramid};
+  task.dnn_output = AcquireOutput(frame);
+  task.dnn_output->image_transform = transform;
+  task.dnn_output->preprocess_start_ns = preprocess_start_ns;
+  task.dnn_output->preprocess_end_ns = LatencyHistogram::NowNs();
+  task.dnn_output->preprocess_timespec_start = time_start;
+  struct timespec time_now = {0, 0};
+  clock_gettime(CLOCK_REALTIME, &time_now);
+  task.dnn_output->preprocess_timespec_end = time_now;
+  return 0;
+}
 
-  if (node_output_manage_ptr_) {
-    node_output_manage_ptr_->Feed(img_msg->time_stamp.sec * 1000 +
-                                  img_msg->time_stamp.nanosec / 1000 / 1000);
+std::shared_ptr<FasterRcnnOutput> Mono2dBodyDetNode::AcquireOutput(
+    const ImageFrame& frame) {
+  // 复用的推理输出保留上一帧的内容，需要重置所有字段
+  auto dnn_output = output_pool_->Acquire();
+  dnn_output->Reset();
+  *dnn_output->image_msg_header = frame.image_msg_header;
+  dnn_output->frame_seq = frame.frame_seq;
+  dnn_output->stream_id = frame.stream_id;
+  dnn_output->recv_ns = frame.recv_ns;
+  return dnn_output;
+}
+
+int Mono2dBodyDetNode::PreprocessTiles(const ImageFrame& frame,
+                                       std::vector<InferTask>& tasks) {
+  struct timespec time_start = {0, 0};
+  clock_gettime(CLOCK_REALTIME, &time_start);
+  uint64_t preprocess_start_ns = LatencyHistogram::NowNs();
+
+  // 1. 原图转换为全尺寸的nv12（nv12格式直接使用），所有tile从中裁剪缩放
+  const uint8_t* img_y = nullptr;
+  const uint8_t* img_uv = nullptr;
+  int img_step = 0;
+  int img_height = 0;
+  int img_width = 0;
+  if ("nv12" == frame.encoding) {
+    img_step = frame.step > 0 ? frame.step : frame.width;
+    if (!CheckNv12Size(frame, img_step)) {
+      return -1;
+    }
+    img_y = frame.data;
+    img_uv = frame.data + static_cast<size_t>(img_step) * frame.height;
+    img_height = frame.height & ~1;
+    img_width = frame.width & ~1;
+  } else {
+    int step = 0;
+    if ("jpeg" != frame.encoding) {
+      int bytes_per_pixel = PackedBytesPerPixel(frame.encoding);
+      if (bytes_per_pixel == 0) {
+        RCLCPP_WARN_THROTTLE(rclcpp::get_logger("mono2d_body_det"),
+                             *this->get_clock(),
+                             5000,
+                             "Unsupported img encoding: %s",
+                             frame.encoding.c_str());
+        return -1;
+      }
+      step = GetPackedStep(frame, bytes_per_pixel);
+      if (step < 0) {
+        return -1;
+      }
+    }
+    static thread_local std::vector<uint8_t> nv12_buf;
+    if (ImageUtils::ConvertToNV12(frame.encoding,
+                                  frame.data,
+                                  frame.data_size,
+                                  frame.height,
+                                  frame.width,
+                                  step,
+                                  nv12_buf,
+                                  img_height,
+                                  img_width) != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                   "Convert %s img to nv12 fail!",
+                   frame.encoding.c_str());
+      return -1;
+    }
+    img_step = img_width;
+    img_y = nv12_buf.data();
+    img_uv = img_y + static_cast<size_t>(img_step) * img_height;
+  }
+
+  // 2. 每个tile分别缩放到模型输入，所有tile共用一个tile_group
+  auto tile_group = tile_group_pool_->Acquire();
+  TileLayout::Compute(img_height,
+                      img_width,
+                      model_input_height_,
+                      model_input_width_,
+                      tile_cols_,
+                      tile_rows_,
+                      tile_overlap_,
+                      tile_with_full_frame_ == 1,
+                      tile_group->rects);
+  size_t tile_num = tile_group->rects.size();
+  if (tile_num == 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                 "Invalid img size for tiles, w: %d, h: %d",
+                 img_width,
+                 img_height);
+    return -1;
+  }
+  // 复用的tile_group保留上一帧的内容，需要重置
+  tile_group->tiles.resize(tile_num);
+  for (auto& tile : tile_group->tiles) {
+    if (!tile.output) {
+      tile.output = std::make_shared<DnnNodeOutput>();
+    }
+    tile.output->outputs.clear();
+    tile.output->rt_stat = nullptr;
+    tile.valid = false;
+  }
+  tile_group->pending = static_cast<int>(tile_num);
+
+  tasks.resize(tile_num);
+  for (size_t idx = 0; idx < tile_num; idx++) {
+    const auto& rect = tile_group->rects[idx];
+    ImageTransform transform;
+    auto pyramid = ImageUtils::GetNV12PyramidFromNV12Region(
+        img_y,
+        img_step,
+        img_uv,
+        img_step,
+        img_height,
+        img_width,
+        rect.x,
+        rect.y,
+        rect.height,
+        rect.width,
+        model_input_height_,
+        model_input_width_,
+        static_cast<ImageResizeType>(image_resize_type_),
+        is_letterbox_ == 1,
+        &transform);
+    if (!pyramid) {
+      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                   "Get Nv12 pym of tile %d fail!",
+                   static_cast<int>(idx));
+      tasks.clear();
+      return -1;
+    }
+    auto& task = tasks[idx];
+    task.inputs = std::vector<std::shared_ptr<DNNInput>>{pyramid};
+    task.dnn_output = AcquireOutput(frame);
+    task.dnn_output->image_transform = transform;
+    task.dnn_output->tile_group = tile_group;
+    task.dnn_output->tile_index = static_cast<int>(idx);
   }
 
-  dnn_output->preprocess_timespec_start = time_start;
+  uint64_t preprocess_end_ns = LatencyHistogram::NowNs();
   struct timespec time_now = {0, 0};
   clock_gettime(CLOCK_REALTIME, &time_now);
-  dnn_output->preprocess_timespec_end = time_now;
+  for (auto& task : tasks) {
+    task.dnn_output->preprocess_start_ns = preprocess_start_ns;
+    task.dnn_output->preprocess_end_ns = preprocess_end_ns;
+    task.dnn_output->preprocess_timespec_start = time_start;
+    task.dnn_output->preprocess_timespec_end = time_now;
+  }
+  return 0;
+}
 
-  uint32_t ret = 0;
-  // 3. 开始预测
-  ret = Predict(inputs, nullptr, dnn_output);
+void Mono2dBodyDetNode::PreprocessWorker() {
+  ImageFrame frame;
+  std::vector<InferTask> tile_tasks;
+  // 只保留最新帧时，等待有空闲的处理资源后再从mailbox中取最新帧
+  while (admission_controller_->AcquireSlot()) {
+    if (!frame_queue_->Pop(frame)) {
+      admission_controller_->ReleaseSlot();
+      break;
+    }
+    InferTask task;
+    int ret = tile_mode_ == 1 ? PreprocessTiles(frame, tile_tasks)
+                              : Preprocess(frame, task);
+    // 预处理完成后释放订阅到的消息
+    frame.msg_holder = nullptr;
+    if (ret != 0) {
+      admission_controller_->ReleaseSlot();
+      EraseFrame(frame.stream_id, frame.frame_seq);
+      continue;
+    }
+    if (tile_mode_ != 1) {
+      if (!infer_queue_->Push(std::move(task))) {
+        break;
+      }
+      continue;
+    }
+    // 同一帧的tile连续入队，依次提交推理
+    bool stopped = false;
+    for (auto& tile_task : tile_tasks) {
+      if (!stopped && !infer_queue_->Push(std::move(tile_task))) {
+        stopped = true;
+      }
+    }
+    tile_tasks.clear();
+    if (stopped) {
+      break;
+    }
+  }
+}
 
-  {
-    auto tp_now = std::chrono::system_clock::now();
-    auto interval =
-        std::chrono::duration_cast<std::chrono::milliseconds>(tp_now - tp_start)
-            .count();
-    RCLCPP_DEBUG(rclcpp::get_logger("mono2d_body_det"),
-                 "after Predict cost ms: %d",
-                 interval);
+bool Mono2dBodyDetNode::SubmitInferTask(InferTask& task) {
+  uint64_t frame_seq = task.dnn_output->frame_seq;
+  int stream_id = task.dnn_output->stream_id;
+  bool is_tune_frame = task.dnn_output->is_tune_frame;
+  const DnnNodeOutput* output = task.dnn_output.get();
+  // 推理完成后tile_group会在PostProcess中被释放，提交之前记录
+  const TileGroup* tile_group = task.dnn_output->tile_group.get();
+  // 一帧的所有tile都提交之后才释放准入资源
+  bool release_slot =
+      !is_tune_frame &&
+      (!tile_group || static_cast<size_t>(task.dnn_output->tile_index) + 1 ==
+                          tile_group->tiles.size());
+  if (!AcquireInflight(output)) {
+    return false;
+  }
+  task.dnn_output->submit_ns = LatencyHistogram::NowNs();
+  // 3. 开始预测
+  int ret = Predict(task.inputs, nullptr, task.dnn_output);
+  if (release_slot) {
+    admission_controller_->ReleaseSlot();
   }
 
   // 4. 处理预测结果，如渲染到图片或者发布预测结果
   if (ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                 "Run predict failed!");
+    ReleaseInflight(output);
+    if (!is_tune_frame && !tile_group) {
+      EraseFrame(stream_id, frame_seq);
+    } else if (tile_group && FinishTile(*task.dnn_output, false)) {
+      // 其他tile都已经完成，使用已有的tile输出发布整帧
+      if (tile_group->HasValidTile()) {
+        task.dnn_output->infer_end_ns = LatencyHistogram::NowNs();
+        FeedOutput(stream_id, frame_seq, task.dnn_output);
+      } else {
+        EraseFrame(stream_id, frame_seq);
+      }
+    }
+  }
+  task.inputs.clear();
+  task.dnn_output = nullptr;
+  return true;
+}
+
+void Mono2dBodyDetNode::InferSubmitter() {
+  // 模型输入为单帧，不能将多帧合并为一次推理；AcquireInflight已经让BPU上同时有
+  // task_num帧在推理，在这里攒帧只会增加排队延迟
+  InferTask task;
+  while (infer_queue_->Pop(task)) {
+    bool submitted = SubmitInferTask(task);
+    task.inputs.clear();
+    task.dnn_output = nullptr;
+    if (!submitted) {
+      break;
+    }
+  }
+}
+
+void Mono2dBodyDetNode::PipelineStatsReport() {
+  auto infer_stats = infer_queue_->GetStats();
+  RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
+              "infer queue depth: %lu, high water mark: %lu, pushed: %lu",
+              infer_stats.depth,
+              infer_stats.high_water_mark,
+              infer_stats.pushed);
+  auto now = std::chrono::steady_clock::now();
+  for (auto& stream : streams_) {
+    float interval_s = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           now - stream->last_report_time)
+                           .count() /
+                       1000.0f;
+    uint64_t published_frames = stream->published_frames.load();
+    uint64_t latency_ms_sum = stream->latency_ms_sum.load();
+    uint64_t frames = published_frames - stream->last_published_frames;
+    float fps = interval_s > 0 ? frames / interval_s : 0;
+    float latency_ms_mean =
+        frames > 0 ? static_cast<float>(latency_ms_sum -
+                                        stream->last_latency_ms_sum) /
+                         frames
+                   : 0;
+    uint64_t latency_ms_max = stream->latency_ms_max.exchange(0);
+    stream->last_report_time = now;
+    stream->last_published_frames = published_frames;
+    stream->last_latency_ms_sum = latency_ms_sum;
+
+    auto frame_stats = frame_queue_->GetStats(stream->stream_id);
+    auto admission_stats = stream->admission_controller->GetStats();
+    auto reorder_stats = stream->output_reorder_buffer->GetStats();
+    RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
+                "stream %d: recved: %lu, published: %lu, out fps: %.2f, "
+                "latency ms mean: %.2f, max: %lu; "
+                "frame queue depth: %lu, high water mark: %lu, rejected: %lu; "
+                "admission admitted: %lu, dropped latest: %lu, "
+                "dropped nth: %lu, keep every n: %d; "
+                "reorder released: %lu, dropped: %lu, late: %lu, erased: %lu",
+                stream->stream_id,
+                stream->recved_frames.load(),
+                published_frames,
+                fps,
+                latency_ms_mean,
+                latency_ms_max,
+                frame_stats.depth,
+                frame_stats.high_water_mark,
+                frame_stats.rejected,
+                admission_stats.admitted,
+                admission_stats.dropped_latest,
+                admission_stats.dropped_nth,
+                admission_stats.keep_every_n,
+                reorder_stats.released,
+                reorder_stats.dropped,
+                reorder_stats.late,
+                reorder_stats.erased);
+    if (stream->motion_gate) {
+      // 节省的计算按照推理帧的平均预处理和推理耗时估计
+      auto gate_stats = stream->motion_gate->GetStats();
+      auto preprocess = stream->stage_latency->Total(
+          StageLatency::Stage::PREPROCESS);
+      auto infer = stream->stage_latency->Total(StageLatency::Stage::INFER);
+      auto gate =
+          stream->stage_latency->Total(StageLatency::Stage::MOTION_GATE);
+      RCLCPP_INFO(rclcpp::get_logger("mono2d_body_det"),
+                  "stream %d motion gate: checked: %lu, skipped: %lu, "
+                  "hit rate: %.2f%%, "
+                  "saved preprocess and infer ms: %.1f, gate cost ms: %.1f",
+                  stream->stream_id,
+                  gate_stats.checked,
+                  gate_stats.skipped,
+                  gate_stats.checked > 0
+                      ? 100.0 * gate_stats.skipped / gate_stats.checked
+                      : 0.0,
+                  gate_stats.skipped * (preprocess.mean_ns + infer.mean_ns) /
+                      1000000.0,
+                  gate.mean_ns * gate.count / 1000000.0);
+    }
+  }
+  PublishLatencyStats(true);
+}
+
+void Mono2dBodyDetNode::PublishLatencyStats(bool interval) {
+  std::stringstream ss;
+  ss << "{\"window\": \"" << (interval ? "interval" : "total")
+     << "\", \"streams\": [";
+  for (size_t idx = 0; idx < streams_.size(); idx++) {
+    ss << (idx > 0 ? ", " : "") << "{\"stream_id\": "
+       << streams_[idx]->stream_id << ", \"stages\": "
+       << streams_[idx]->stage_latency->ToJson(interval) << "}";
+  }
+  ss << "]}";
+  std::string result = ss.str();
+  if (!interval) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Latency stats: %s",
+                result.c_str());
+  }
+  if (latency_stats_publisher_) {
+    std_msgs::msg::String msg;
+    msg.data = result;
+    latency_stats_publisher_->publish(msg);
+  }
+}
+
+void Mono2dBodyDetNode::RecordFrame(const ImageFrame& frame) {
+  frame_replay::RecordFile::PendingFrame pending;
+  // 持有订阅到的消息，后台线程写入完成之前data有效
+  pending.holder = frame.msg_holder;
+  pending.timestamp_ns =
+      static_cast<uint64_t>(frame.image_msg_header.stamp.sec) * 1000000000ULL +
+      frame.image_msg_header.stamp.nanosec;
+  pending.encoding = frame.encoding;
+  pending.width = frame.width;
+  pending.height = frame.height;
+  pending.step = frame.step;
+  pending.data = frame.data;
+  pending.data_size = static_cast<uint32_t>(frame.data_size);
+  if (!record_file_->Push(std::move(pending))) {
+    RCLCPP_WARN_THROTTLE(rclcpp::get_logger("mono2d_body_det"),
+                         *this->get_clock(),
+                         5000,
+                         "Record queue is full, dropped frames: %lu",
+                         record_file_->Dropped());
+  }
+}
+
+void Mono2dBodyDetNode::ReplayFrames() {
+  const auto& frames = replay_file_->Frames();
+  auto mode = static_cast<ReplayMode>(replay_mode_);
+  // 帧数据指向mmap的内存，msg_holder持有回放文件保证预处理完成之前有效
+  std::shared_ptr<const void> holder = replay_file_;
+  // 与EnqueueFrame使用的帧队列容量一致
+  size_t queue_capacity =
+      static_cast<AdmissionController::Mode>(admission_mode_) ==
+              AdmissionController::Mode::LATEST_ONLY
+          ? 1
+          : static_cast<size_t>(pipeline_queue_size_);
+  uint64_t first_timestamp_ns = frames.front().timestamp_ns;
+  auto replay_start = std::chrono::steady_clock::now();
+
+  // 分段等待，停止时及时退出
+  auto wait_until = [this](std::chrono::steady_clock::time_point deadline) {
+    while (!pipeline_stopped_ && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_until(
+          std::min(deadline,
+                   std::chrono::steady_clock::now() +
+                       std::chrono::milliseconds(100)));
+    }
+  };
+
+  for (size_t idx = 0; idx < frames.size() && !pipeline_stopped_; idx++) {
+    const auto& replay_frame = frames[idx];
+    if (mode == ReplayMode::RECORDED &&
+        replay_frame.timestamp_ns > first_timestamp_ns) {
+      wait_until(replay_start +
+                 std::chrono::nanoseconds(replay_frame.timestamp_ns -
+                                          first_timestamp_ns));
+    } else if (mode == ReplayMode::FIXED_RATE) {
+      wait_until(replay_start +
+                 std::chrono::nanoseconds(idx * 1000000000ULL / replay_fps_));
+    }
+    struct timespec time_now = {0, 0};
+    clock_gettime(CLOCK_REALTIME, &time_now);
+    for (const auto& stream : streams_) {
+      if (mode == ReplayMode::AS_FAST_AS_POSSIBLE) {
+        while (!pipeline_stopped_ &&
+               frame_queue_->GetStats(stream->stream_id).depth >=
+                   queue_capacity) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+      }
+      ImageFrame frame;
+      frame.msg_holder = holder;
+      frame.encoding = replay_file_->Encoding();
+      frame.data = replay_frame.data;
+      frame.data_size = replay_frame.data_size;
+      frame.height = replay_file_->Height();
+      frame.width = replay_file_->Width();
+      frame.step = replay_file_->Step();
+      frame.stream_id = stream->stream_id;
+      frame.image_msg_header.set__frame_id(std::to_string(idx));
+      frame.image_msg_header.stamp.sec = time_now.tv_sec;
+      frame.image_msg_header.stamp.nanosec = time_now.tv_nsec;
+      EnqueueFrame(std::move(frame));
+    }
+  }
+
+  // 等待写入输出排序缓存的帧全部发布或者被丢弃，最长等待排序超时和推理超时之和
+  // 跟踪预测和画面没有运动重复发布的帧不经过准入，不能按照准入的帧数判断
+  auto drain_timeout = std::chrono::milliseconds(
+      reorder_timeout_ms_ + inflight_timeout_ms_ + 1000);
+  std::vector<std::shared_ptr<FrameDispatcher>> dispatchers;
+  for (const auto& stream : streams_) {
+    dispatchers.push_back(stream->frame_dispatcher);
+  }
+  FrameDispatcher::WaitDrained(dispatchers, drain_timeout, pipeline_stopped_);
+  if (pipeline_stopped_) {
+    replay_done_promise_.set_value();
     return;
   }
+
+  float elapsed_s = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - replay_start)
+                        .count() /
+                    1000.0f;
+  RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+              "Replay done, frames: %d, streams: %d, elapsed s: %.2f",
+              static_cast<int>(frames.size()),
+              static_cast<int>(streams_.size()),
+              elapsed_s);
+  for (const auto& stream : streams_) {
+    auto frame_stats = frame_queue_->GetStats(stream->stream_id);
+    auto admission_stats = stream->admission_controller->GetStats();
+    auto reorder_stats = stream->output_reorder_buffer->GetStats();
+    uint64_t published_frames = stream->published_frames.load();
+    // REPUBLISH模式下重复发布，否则不发布
+    uint64_t motion_skipped =
+        stream->motion_gate ? stream->motion_gate->GetStats().skipped : 0;
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Replay stream %d: recved: %lu, registered: %lu, "
+                "admitted: %lu, predicted: %lu, motion skipped: %lu, "
+                "published: %lu, "
+                "sustained fps: %.2f; dropped by admission latest: %lu, "
+                "nth: %lu, frame queue full: %lu, reorder: %lu, late: %lu, "
+                "erased: %lu",
+                stream->stream_id,
+                stream->recved_frames.load(),
+                reorder_stats.registered,
+                admission_stats.admitted,
+                stream->frame_dispatcher->GetStats().predicted,
+                motion_skipped,
+                published_frames,
+                elapsed_s > 0 ? published_frames / elapsed_s : 0,
+                admission_stats.dropped_latest,
+                admission_stats.dropped_nth,
+                frame_stats.rejected,
+                reorder_stats.dropped,
+                reorder_stats.late,
+                reorder_stats.erased);
+  }
+  PublishLatencyStats(false);
+  // 只停止本节点的流水线，是否退出进程由加载节点的一方决定
+  StopPipeline();
+  replay_done_promise_.set_value();
 }
-#endif
-#ifndef PLATFORM_X86
-int Mono2dBodyDetNode::DoMot(
-    const time_t& time_stamp,
-    const std::unordered_map<int32_t, std::vector<MotBox>>& in_rois,
-    std::unordered_map<int32_t, std::vector<MotBox>>& out_rois,
-    std::unordered_map<int32_t, std::vector<std::shared_ptr<MotTrackId>>>&
-        out_disappeared_ids) {
-  if (hobot_mots_.empty()) {
-    return -1;
+
+void Mono2dBodyDetNode::PublishPodResult(
+    StreamContext& stream,
+    const ai_msgs::msg::PerceptionTargets& msg,
+    int img_width,
+    int img_height,
+    bool is_predicted) {
+  auto loaned_msg = stream.pod_msg_publisher->borrow_loaned_message();
+  if (!loaned_msg.is_valid()) {
+    RCLCPP_WARN_THROTTLE(rclcpp::get_logger("mono2d_body_det"),
+                         *this->get_clock(),
+                         5000,
+                         "Borrow loaned message fail, topic: %s",
+                         stream.pod_msg_pub_topic_name.c_str());
+    return;
   }
-  for (auto& roi : in_rois) {
-    std::shared_ptr<HobotMot> hobot_mot = nullptr;
-    if (box_outputs_index_type_.find(roi.first) !=
-        box_outputs_index_type_.end()) {
-      if (hobot_mots_.find(box_outputs_index_type_.at(roi.first)) !=
-          hobot_mots_.end()) {
-        hobot_mot = hobot_mots_.at(box_outputs_index_type_.at(roi.first));
-      } else {
-        continue;
+  auto& result = loaned_msg.get();
+  PackDetectionResult(msg, img_width, img_height, is_predicted, result);
+  if (result.dropped_box_num > 0) {
+    RCLCPP_WARN_THROTTLE(rclcpp::get_logger("mono2d_body_det"),
+                         *this->get_clock(),
+                         5000,
+                         "Box num exceeds %u, dropped: %u, topic: %s",
+                         result.MAX_BOX_NUM,
+                         result.dropped_box_num,
+                         stream.pod_msg_pub_topic_name.c_str());
+  }
+  stream.pod_msg_publisher->publish(std::move(loaned_msg));
+}
+
+bool Mono2dBodyDetNode::AcquireInflight(const DnnNodeOutput* output) {
+  std::unique_lock<std::mutex> lk(inflight_mtx_);
+  while (!pipeline_stopped_ &&
+         static_cast<int>(inflight_outputs_.size()) >= infer_concurrency_) {
+    if (inflight_cv_.wait_for(
+            lk, std::chrono::milliseconds(inflight_timeout_ms_)) ==
+        std::cv_status::timeout) {
+      auto now = std::chrono::steady_clock::now();
+      for (auto itr = inflight_outputs_.begin();
+           itr != inflight_outputs_.end();) {
+        if (now - itr->second >
+            std::chrono::milliseconds(inflight_timeout_ms_)) {
+          itr = inflight_outputs_.erase(itr);
+        } else {
+          ++itr;
+        }
       }
     }
-    if (!hobot_mot) {
-      continue;
+  }
+  if (pipeline_stopped_) {
+    return false;
+  }
+  inflight_outputs_[output] = std::chrono::steady_clock::now();
+  return true;
+}
+
+float Mono2dBodyDetNode::ReleaseInflight(const DnnNodeOutput* output) {
+  float latency_ms = -1;
+  {
+    std::lock_guard<std::mutex> lk(inflight_mtx_);
+    auto itr = inflight_outputs_.find(output);
+    if (itr == inflight_outputs_.end()) {
+      return latency_ms;
     }
+    latency_ms = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - itr->second)
+                     .count() /
+                 1000.0f;
+    inflight_outputs_.erase(itr);
+  }
+  inflight_cv_.notify_one();
+  return latency_ms;
+}
 
-    std::vector<MotBox> out_box_list;
-    std::vector<std::shared_ptr<MotTrackId>> disappeared_ids;
+void Mono2dBodyDetNode::SetInferConcurrency(int concurrency) {
+  {
+    std::lock_guard<std::mutex> lk(inflight_mtx_);
+    infer_concurrency_ = std::max(1, std::min(concurrency, task_num_));
+  }
+  inflight_cv_.notify_all();
+}
 
-    if (hobot_mot->DoProcess(roi.second,
-                             out_box_list,
-                             disappeared_ids,
-                             time_stamp,
+int Mono2dBodyDetNode::GetInferConcurrency() {
+  std::lock_guard<std::mutex> lk(inflight_mtx_);
+  return infer_concurrency_;
+}
+
+void Mono2dBodyDetNode::StartAutoTune() {
+  bool expected = false;
+  if (!auto_tuning_.compare_exchange_strong(expected, true)) {
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Auto tuning task_num is running");
+    return;
+  }
+  if (auto_tune_thread_.joinable()) {
+    auto_tune_thread_.join();
+  }
+  auto_tune_thread_ = std::thread(&Mono2dBodyDetNode::RunAutoTune, this);
+}
+
+void Mono2dBodyDetNode::RunAutoTune() {
+  RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+              "Start auto tuning task_num, max task_num: %d, "
+              "latency budget ms: %d, frames per level: %d",
+              task_num_,
+              auto_tune_latency_budget_ms_,
+              auto_tune_frames_);
+  int origin_concurrency = 0;
+  {
+    std::lock_guard<std::mutex> lk(inflight_mtx_);
+    origin_concurrency = infer_concurrency_;
+  }
+
+  // 所有合成帧共用一个灰色的pyramid，推理只读取输入数据
+  auto pyramid = NV12PyramidPool::Instance()->Acquire(model_input_height_,
+                                                      model_input_width_);
+  if (!pyramid) {
+    RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"),
+                 "Acquire pyramid for auto tuning fail!");
+    auto_tuning_ = false;
+    return;
+  }
+  ImageConvert::FillNv12Rect(reinterpret_cast<uint8_t*>(pyramid->y_vir_addr),
+                             pyramid->y_stride,
+                             reinterpret_cast<uint8_t*>(pyramid->uv_vir_addr),
+                             pyramid->uv_stride,
+                             0,
+                             0,
+                             model_input_height_,
                              model_input_width_,
-                             model_input_height_) < 0) {
-      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Do mot fail");
-      continue;
+                             128,
+                             128,
+                             128);
+  NV12PyramidPool::FlushRows(
+      *pyramid, model_input_height_, model_input_height_ / 2);
+
+  std::vector<InferConcurrencyTuner::LevelResult> curve;
+  for (int concurrency = 1; concurrency <= task_num_ && !pipeline_stopped_;
+       concurrency++) {
+    SetInferConcurrency(concurrency);
+    concurrency_tuner_.BeginLevel(concurrency, auto_tune_frames_);
+    for (int idx = 0; idx < auto_tune_frames_; idx++) {
+      InferTask task;
+      task.inputs = std::vector<std::shared_ptr<DNNInput>>{pyramid};
+      task.dnn_output = std::make_shared<FasterRcnnOutput>();
+      task.dnn_output->image_msg_header =
+          std::make_shared<std_msgs::msg::Header>();
+      task.dnn_output->is_tune_frame = true;
+      if (!infer_queue_->Push(std::move(task))) {
+        break;
+      }
+    }
+    // 推理失败的帧没有输出，最长等待所有帧串行推理超时的时间
+    auto level_start = std::chrono::steady_clock::now();
+    while (!concurrency_tuner_.WaitLevel(100) && !pipeline_stopped_) {
+      if (std::chrono::steady_clock::now() - level_start >
+          std::chrono::milliseconds(auto_tune_frames_ * inflight_timeout_ms_)) {
+        RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                    "Auto tuning task_num %d timeout",
+                    concurrency);
+        break;
+      }
+    }
+    auto result = concurrency_tuner_.EndLevel();
+    RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                "Auto tuning task_num: %d, frames: %d, fps: %.2f, "
+                "mean ms: %.2f, p99 ms: %.2f",
+                result.concurrency,
+                result.frames,
+                result.fps,
+                result.mean_ms,
+                result.p99_ms);
+    curve.push_back(result);
+  }
+
+  int selected = InferConcurrencyTuner::Select(
+      curve, static_cast<float>(auto_tune_latency_budget_ms_));
+  if (selected <= 0) {
+    selected = origin_concurrency;
+  }
+  SetInferConcurrency(selected);
+  std::string result = InferConcurrencyTuner::ToJson(
+      curve, selected, static_cast<float>(auto_tune_latency_budget_ms_));
+  RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+              "Auto tuning task_num done: %s",
+              result.c_str());
+  if (task_num_tune_publisher_) {
+    std_msgs::msg::String msg;
+    msg.data = result;
+    task_num_tune_publisher_->publish(msg);
+  }
+  auto_tuning_ = false;
+}
+
+rcl_interfaces::msg::SetParametersResult Mono2dBodyDetNode::OnSetParameters(
+    const std::vector<rclcpp::Parameter>& parameters) {
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+  for (const auto& parameter : parameters) {
+    if (parameter.get_name() == "auto_tune_task_num") {
+      if (parameter.as_int() == 1) {
+        StartAutoTune();
+      }
+    } else if (parameter.get_name() == "dump_latency_stats") {
+      if (parameter.as_int() == 1) {
+        PublishLatencyStats(false);
+      }
+    } else if (parameter.get_name() == "task_num") {
+      // 运行时只能在初始化的task_num范围内调整并发数，超出范围时拒绝设置
+      int64_t concurrency = parameter.as_int();
+      if (concurrency < 1 || concurrency > task_num_) {
+        result.successful = false;
+        result.reason = "task_num must be in [1, " +
+                        std::to_string(task_num_) +
+                        "] at runtime, got " + std::to_string(concurrency);
+        RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                    "Reject set infer concurrency: %s",
+                    result.reason.c_str());
+        return result;
+      }
+      SetInferConcurrency(static_cast<int>(concurrency));
+      RCLCPP_WARN(rclcpp::get_logger("mono2d_body_det"),
+                  "Set infer concurrency: %d",
+                  GetInferConcurrency());
     }
+  }
+  return result;
+}
 
-    out_rois[roi.first] = out_box_list;
-    out_disappeared_ids[roi.first] = disappeared_ids;
+int Mono2dBodyDetNode::DoMot(
+    std::unordered_map<std::string, std::shared_ptr<HobotMot>>& hobot_mots,
+    const time_t& time_stamp,
+    int img_width,
+    int img_height,
+    TargetBuilder& target_builder,
+    std::vector<ai_msgs::msg::Perf>& perfs) {
+  // 每个类别的跟踪相互独立，分发到mot_runner_上并发执行
+  // 输出直接写入target_builder中已有的vector，稳定后不申请内存
+  if (target_builder.Track(
+          *mot_runner_, hobot_mots, time_stamp, img_width, img_height) < 0) {
+    return -1;
+  }
+
+  for (const auto& job : target_builder.MotJobs()) {
+    ai_msgs::msg::Perf perf;
+    auto perf_iter = mot_perf_types_.find(*job.type);
+    if (perf_iter != mot_perf_types_.end()) {
+      perf.set__type(perf_iter->second);
+    }
+    perf.set__stamp_start(ConvertToRosTime(job.time_start));
+    perf.set__stamp_end(ConvertToRosTime(job.time_end));
+    perf.set__time_ms_duration(
+        (job.time_end.tv_sec - job.time_start.tv_sec) * 1000.0 +
+        (job.time_end.tv_nsec - job.time_start.tv_nsec) / 1000000.0);
+    perfs.push_back(std::move(perf));
+
+    if (job.ret < 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("mono2d_body_det"), "Do mot fail");
+    }
   }
   return 0;
 }
-#endif
\ No newline at end of file
+
+// 注册为组件，可以和相机、下游节点加载到同一个进程中
+RCLCPP_COMPONENTS_REGISTER_NODE(Mono2dBodyDetNode)
@@ -0,0 +1,185 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/motion_gate.h"
+
+#include <cstdlib>
+
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MOTION_GATE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MOTION_GATE_SSE2
+#endif
+
+namespace {
+
+// 每kStep个像素取一个，pixel_stride为1时使用SIMD
+template <int kStep>
+void SampleRow(const uint8_t* src, int pixel_stride, int len, uint8_t* dst) {
+  int x = 0;
+  if (pixel_stride == 1) {
+#if defined(MOTION_GATE_NEON)
+    static_assert(kStep == 4, "neon sampling assumes a step of 4");
+    for (; x + 16 <= len; x += 16) {
+      uint8x16x4_t pixels = vld4q_u8(src + x * kStep);
+      vst1q_u8(dst + x, pixels.val[0]);
+    }
+#elif defined(MOTION_GATE_SSE2)
+    static_assert(kStep == 4, "sse2 sampling assumes a step of 4");
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    for (; x + 16 <= len; x += 16) {
+      const __m128i* ptr = reinterpret_cast<const __m128i*>(src + x * kStep);
+      __m128i p0 = _mm_and_si128(_mm_loadu_si128(ptr), mask);
+      __m128i p1 = _mm_and_si128(_mm_loadu_si128(ptr + 1), mask);
+      __m128i p2 = _mm_and_si128(_mm_loadu_si128(ptr + 2), mask);
+      __m128i p3 = _mm_and_si128(_mm_loadu_si128(ptr + 3), mask);
+      __m128i lo = _mm_packs_epi32(p0, p1);
+      __m128i hi = _mm_packs_epi32(p2, p3);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                       _mm_packus_epi16(lo, hi));
+    }
+#endif
+  }
+  for (; x < len; x++) {
+    dst[x] = src[x * kStep * pixel_stride];
+  }
+}
+
+// 统计亮度差超过threshold的点数，同时将背景以1/8的比例向当前帧更新
+int CompareAndUpdate(const uint8_t* current,
+                     uint8_t* background,
+                     int len,
+                     int threshold) {
+  int changed = 0;
+  int x = 0;
+#if defined(MOTION_GATE_NEON)
+  const uint8x16_t thr = vdupq_n_u8(static_cast<uint8_t>(threshold));
+  // 每个16bit通道每次最多加2，每行单独累加不会溢出
+  uint16x8_t counts = vdupq_n_u16(0);
+  for (; x + 16 <= len; x += 16) {
+    uint8x16_t cur = vld1q_u8(current + x);
+    uint8x16_t bg = vld1q_u8(background + x);
+    uint8x16_t over = vcgtq_u8(vabdq_u8(cur, bg), thr);
+    counts = vpadalq_u8(counts, vshrq_n_u8(over, 7));
+    // 三次取平均：bg + (cur - bg) / 8
+    uint8x16_t avg = vrhaddq_u8(bg, cur);
+    avg = vrhaddq_u8(bg, avg);
+    avg = vrhaddq_u8(bg, avg);
+    vst1q_u8(background + x, avg);
+  }
+  uint32x4_t sum = vpaddlq_u16(counts);
+  changed = static_cast<int>(vgetq_lane_u32(sum, 0) + vgetq_lane_u32(sum, 1) +
+                             vgetq_lane_u32(sum, 2) + vgetq_lane_u32(sum, 3));
+#elif defined(MOTION_GATE_SSE2)
+  const __m128i thr = _mm_set1_epi8(static_cast<char>(threshold));
+  const __m128i zero = _mm_setzero_si128();
+  for (; x + 16 <= len; x += 16) {
+    __m128i cur =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + x));
+    __m128i bg =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + x));
+    __m128i diff =
+        _mm_or_si128(_mm_subs_epu8(cur, bg), _mm_subs_epu8(bg, cur));
+    // 亮度差不超过阈值的点饱和减为0
+    __m128i still = _mm_cmpeq_epi8(_mm_subs_epu8(diff, thr), zero);
+    changed += 16 - __builtin_popcount(_mm_movemask_epi8(still));
+    __m128i avg = _mm_avg_epu8(bg, cur);
+    avg = _mm_avg_epu8(bg, avg);
+    avg = _mm_avg_epu8(bg, avg);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(background + x), avg);
+  }
+#endif
+  for (; x < len; x++) {
+    int cur = current[x];
+    int bg = background[x];
+    if (std::abs(cur - bg) > threshold) {
+      changed++;
+    }
+    // 与SIMD的取平均保持一致，向上取整
+    int avg = (bg + cur + 1) >> 1;
+    avg = (bg + avg + 1) >> 1;
+    background[x] = static_cast<uint8_t>((bg + avg + 1) >> 1);
+  }
+  return changed;
+}
+
+}  // namespace
+
+MotionGate::MotionGate(float threshold) : threshold_(threshold) {}
+
+bool MotionGate::Check(const uint8_t* luma,
+                       int pixel_stride,
+                       int step,
+                       int height,
+                       int width) {
+  checked_.fetch_add(1, std::memory_order_relaxed);
+  if (!luma || height < kSampleStep || width < kSampleStep) {
+    return true;
+  }
+  bool reset = height != height_ || width != width_;
+  if (reset) {
+    height_ = height;
+    width_ = width;
+    sample_height_ = height / kSampleStep;
+    sample_width_ = width / kSampleStep;
+    current_.resize(static_cast<size_t>(sample_height_) * sample_width_);
+  }
+  Downsample(luma, pixel_stride, step);
+  if (reset) {
+    background_ = current_;
+    skipped_frames_ = 0;
+    return true;
+  }
+
+  int changed = 0;
+  for (int row = 0; row < sample_height_; row++) {
+    size_t offset = static_cast<size_t>(row) * sample_width_;
+    changed += CompareAndUpdate(current_.data() + offset,
+                                background_.data() + offset,
+                                sample_width_,
+                                kPixelDiffThreshold);
+  }
+  float motion = static_cast<float>(changed) / current_.size();
+  if (motion >= threshold_ || skipped_frames_ >= kMaxSkipFrames) {
+    skipped_frames_ = 0;
+    return true;
+  }
+  skipped_frames_++;
+  skipped_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void MotionGate::Downsample(const uint8_t* luma, int pixel_stride, int step) {
+  for (int row = 0; row < sample_height_; row++) {
+    // 取每个kSampleStep x kSampleStep块的中心行
+    const uint8_t* src = luma +
+                         static_cast<size_t>(row * kSampleStep +
+                                             kSampleStep / 2) *
+                             step;
+    SampleRow<kSampleStep>(src,
+                           pixel_stride,
+                           sample_width_,
+                           current_.data() +
+                               static_cast<size_t>(row) * sample_width_);
+  }
+}
+
+MotionGate::Stats MotionGate::GetStats() const {
+  Stats stats;
+  stats.checked = checked_.load(std::memory_order_relaxed);
+  stats.skipped = skipped_.load(std::memory_order_relaxed);
+  return stats;
+}
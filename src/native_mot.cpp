@@ -0,0 +1,444 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/native_mot.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace native_mot {
+
+namespace {
+
+// 在单层json中查找key对应的值，字符串值去掉引号
+bool FindJsonValue(const std::string& json,
+                   const std::string& key,
+                   std::string& value) {
+  std::string quoted_key = "\"" + key + "\"";
+  size_t pos = json.find(quoted_key);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  pos = json.find(':', pos + quoted_key.size());
+  if (pos == std::string::npos) {
+    return false;
+  }
+  pos = json.find_first_not_of(" \t\r\n", pos + 1);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  size_t end = std::string::npos;
+  if (json[pos] == '"') {
+    pos++;
+    end = json.find('"', pos);
+    if (end == std::string::npos) {
+      return false;
+    }
+  } else {
+    end = json.find_first_of(",} \t\r\n", pos);
+  }
+  value = json.substr(pos, end == std::string::npos ? end : end - pos);
+  return !value.empty();
+}
+
+void LoadJsonValue(const std::string& json, const std::string& key, int& val) {
+  std::string value;
+  if (FindJsonValue(json, key, value)) {
+    val = std::atoi(value.c_str());
+  }
+}
+
+void LoadJsonValue(const std::string& json,
+                   const std::string& key,
+                   float& val) {
+  std::string value;
+  if (FindJsonValue(json, key, value)) {
+    val = std::strtof(value.c_str(), nullptr);
+  }
+}
+
+// 返回box被other覆盖的面积占box面积的比例
+float OverlapRatio(const MotBox& box, const MotBox& other) {
+  int iw = std::min(box.x2, other.x2) - std::max(box.x1, other.x1);
+  int ih = std::min(box.y2, other.y2) - std::max(box.y1, other.y1);
+  if (iw <= 0 || ih <= 0) {
+    return 0;
+  }
+  float area = static_cast<float>(box.x2 - box.x1) * (box.y2 - box.y1);
+  return static_cast<float>(iw) * ih / area;
+}
+
+}  // namespace
+
+int NativeMotConfig::Load(const std::string& config_file) {
+  std::ifstream ifs(config_file);
+  if (!ifs.is_open()) {
+    return -1;
+  }
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  std::string json = ss.str();
+
+  std::string value;
+  if (FindJsonValue(json, "match_type", value)) {
+    match_type = (value == "Euclidean" || value == "EUCLIDEAN")
+                     ? MatchType::EUCLIDEAN
+                     : MatchType::IOU;
+  }
+  LoadJsonValue(json, "use_kalman_filter", use_kalman_filter);
+  LoadJsonValue(json, "missing_time_thres", missing_time_thres);
+  LoadJsonValue(json, "vanish_frame_count", vanish_frame_count);
+  LoadJsonValue(json, "time_gap", time_gap);
+  LoadJsonValue(json, "iou_thres", iou_thres);
+  LoadJsonValue(json, "euclidean_thres", euclidean_thres);
+  LoadJsonValue(json, "min_score", min_score);
+  LoadJsonValue(json, "ignore_overlap_thres", ignore_overlap_thres);
+  return 0;
+}
+
+NativeMot::NativeMot(const std::string& config_file) {
+  if (config_.Load(config_file) != 0) {
+    std::cerr << "load mot config " << config_file
+              << " failed, use default config" << std::endl;
+  }
+}
+
+NativeMot::NativeMot(const NativeMotConfig& config) : config_(config) {}
+
+int NativeMot::DoProcess(
+    const std::vector<MotBox>& in_box_list,
+    std::vector<MotBox>& out_box_list,
+    std::vector<std::shared_ptr<MotTrackId>>& disappeared_ids,
+    const time_t& time_stamp,
+    int img_width,
+    int img_height) {
+  if (img_width <= 0 || img_height <= 0) {
+    return -1;
+  }
+  size_t det_num = in_box_list.size();
+  out_box_list.assign(in_box_list.begin(), in_box_list.end());
+  det_valid_.assign(det_num, 0);
+  det_track_.assign(det_num, -1);
+
+  // 1. 过滤低分以及被更高分数的框覆盖的检测框
+  for (size_t idx = 0; idx < det_num; idx++) {
+    const auto& box = in_box_list[idx];
+    det_valid_[idx] = box.score >= config_.min_score && box.x2 > box.x1 &&
+                      box.y2 > box.y1;
+  }
+  SortDetections(in_box_list);
+  for (size_t order = 0; order < det_order_.size(); order++) {
+    size_t idx = det_order_[order];
+    const auto& box = in_box_list[idx];
+    size_t begin = 0;
+    size_t end = 0;
+    DetectionRange(box.x1 - det_max_width_ / 2,
+                   box.x2 + det_max_width_ / 2,
+                   begin,
+                   end);
+    for (size_t other_order = begin; other_order < end; other_order++) {
+      size_t other = det_order_[other_order];
+      if (other == idx || !det_valid_[other]) {
+        continue;
+      }
+      const auto& other_box = in_box_list[other];
+      bool higher = other_box.score > box.score ||
+                    (other_box.score == box.score && other < idx);
+      if (higher &&
+          OverlapRatio(box, other_box) > config_.ignore_overlap_thres) {
+        det_valid_[idx] = 0;
+        break;
+      }
+    }
+  }
+
+  // 2. 按照时间间隔预测轨迹，并与检测框匹配
+  float dt = 1;
+  if (last_time_stamp_ > 0 && time_stamp > last_time_stamp_ &&
+      config_.time_gap > 0) {
+    dt = static_cast<float>(time_stamp - last_time_stamp_) / config_.time_gap;
+  }
+  last_time_stamp_ = time_stamp;
+  Predict(dt);
+  size_t track_num = ids_.size();
+  Match(in_box_list);
+
+  // 3. 更新匹配的轨迹，未匹配的检测框创建新轨迹
+  for (size_t idx = 0; idx < det_num; idx++) {
+    auto& out_box = out_box_list[idx];
+    if (!det_valid_[idx]) {
+      out_box.id = -1;
+      out_box.state_ = DataState::FILTERED;
+      continue;
+    }
+    if (det_track_[idx] >= 0) {
+      UpdateTrack(det_track_[idx], in_box_list[idx]);
+      out_box.id = ids_[det_track_[idx]];
+    } else {
+      AddTrack(in_box_list[idx]);
+      out_box.id = ids_.back();
+    }
+    out_box.state_ = DataState::VALID;
+  }
+
+  // 4. 未匹配的轨迹超过vanish_frame_count帧或者离开图像后输出为消失
+  for (size_t track = track_num; track-- > 0;) {
+    if (track_matched_[track]) {
+      continue;
+    }
+    lost_frames_[track]++;
+    float half_w = pos_[2][track] / 2;
+    float half_h = pos_[3][track] / 2;
+    bool out_of_img = pos_[0][track] + half_w < 0 ||
+                      pos_[0][track] - half_w > img_width ||
+                      pos_[1][track] + half_h < 0 ||
+                      pos_[1][track] - half_h > img_height;
+    if (lost_frames_[track] > config_.vanish_frame_count || out_of_img) {
+      disappeared_ids.push_back(
+          std::make_shared<MotTrackId>(ids_[track], DataState::DISAPPEARED));
+      RemoveTrack(track);
+    }
+  }
+  return 0;
+}
+
+void NativeMot::SortDetections(const std::vector<MotBox>& in_box_list) {
+  det_order_.clear();
+  det_max_width_ = 0;
+  for (size_t idx = 0; idx < in_box_list.size(); idx++) {
+    if (det_valid_[idx]) {
+      det_order_.push_back(static_cast<int32_t>(idx));
+      det_max_width_ = std::max(
+          det_max_width_,
+          static_cast<float>(in_box_list[idx].x2 - in_box_list[idx].x1));
+    }
+  }
+  auto center_x = [&in_box_list](int32_t idx) {
+    return (in_box_list[idx].x1 + in_box_list[idx].x2) / 2.0f;
+  };
+  std::sort(det_order_.begin(),
+            det_order_.end(),
+            [&center_x](int32_t lhs, int32_t rhs) {
+              return center_x(lhs) < center_x(rhs);
+            });
+  det_center_x_.clear();
+  for (const auto& idx : det_order_) {
+    det_center_x_.push_back(center_x(idx));
+  }
+}
+
+void NativeMot::DetectionRange(float x_min,
+                               float x_max,
+                               size_t& begin,
+                               size_t& end) {
+  begin = std::lower_bound(det_center_x_.begin(), det_center_x_.end(), x_min) -
+          det_center_x_.begin();
+  end = std::upper_bound(det_center_x_.begin(), det_center_x_.end(), x_max) -
+        det_center_x_.begin();
+}
+
+void NativeMot::Predict(float dt) {
+  size_t track_num = ids_.size();
+  if (!config_.use_kalman_filter) {
+    return;
+  }
+  for (size_t track = 0; track < track_num; track++) {
+    if (lost_frames_[track] > config_.missing_time_thres) {
+      for (int dim = 0; dim < kDim; dim++) {
+        vel_[dim][track] = 0;
+      }
+    }
+  }
+  for (int dim = 0; dim < kDim; dim++) {
+    float* pos = pos_[dim].data();
+    float* vel = vel_[dim].data();
+    float* cov_pp = cov_pp_[dim].data();
+    float* cov_pv = cov_pv_[dim].data();
+    float* cov_vv = cov_vv_[dim].data();
+    const float* height = pos_[3].data();
+    for (size_t track = 0; track < track_num; track++) {
+      // 过程噪声与目标高度成正比
+      float std_pos = height[track] / 20;
+      float std_vel = height[track] / 160;
+      pos[track] += vel[track] * dt;
+      cov_pp[track] += dt * (2 * cov_pv[track] + dt * cov_vv[track]) +
+                       std_pos * std_pos * dt;
+      cov_pv[track] += dt * cov_vv[track];
+      cov_vv[track] += std_vel * std_vel * dt;
+    }
+  }
+}
+
+void NativeMot::Match(const std::vector<MotBox>& in_box_list) {
+  size_t track_num = ids_.size();
+  track_matched_.assign(track_num, 0);
+  candidates_.clear();
+  bool use_iou = config_.match_type == NativeMotConfig::MatchType::IOU;
+  float euclidean_thres_sq = config_.euclidean_thres * config_.euclidean_thres;
+  for (size_t track = 0; track < track_num; track++) {
+    float cx = pos_[0][track];
+    float cy = pos_[1][track];
+    float x1 = cx - pos_[2][track] / 2;
+    float y1 = cy - pos_[3][track] / 2;
+    float x2 = cx + pos_[2][track] / 2;
+    float y2 = cy + pos_[3][track] / 2;
+    float track_area = pos_[2][track] * pos_[3][track];
+    size_t begin = 0;
+    size_t end = 0;
+    if (use_iou) {
+      DetectionRange(
+          x1 - det_max_width_ / 2, x2 + det_max_width_ / 2, begin, end);
+    } else {
+      DetectionRange(
+          cx - config_.euclidean_thres, cx + config_.euclidean_thres, begin, end);
+    }
+    for (size_t order = begin; order < end; order++) {
+      size_t det = det_order_[order];
+      if (!det_valid_[det]) {
+        continue;
+      }
+      const auto& box = in_box_list[det];
+      if (use_iou) {
+        float iw = std::min(x2, static_cast<float>(box.x2)) -
+                   std::max(x1, static_cast<float>(box.x1));
+        float ih = std::min(y2, static_cast<float>(box.y2)) -
+                   std::max(y1, static_cast<float>(box.y1));
+        if (iw <= 0 || ih <= 0) {
+          continue;
+        }
+        float inter = iw * ih;
+        float det_area =
+            static_cast<float>(box.x2 - box.x1) * (box.y2 - box.y1);
+        float iou = inter / (track_area + det_area - inter);
+        if (iou >= config_.iou_thres) {
+          candidates_.push_back(Candidate{-iou,
+                                          static_cast<int32_t>(track),
+                                          static_cast<int32_t>(det)});
+        }
+      } else {
+        float dx = (box.x1 + box.x2) / 2.0f - cx;
+        float dy = (box.y1 + box.y2) / 2.0f - cy;
+        float dist_sq = dx * dx + dy * dy;
+        if (dist_sq <= euclidean_thres_sq) {
+          candidates_.push_back(Candidate{dist_sq,
+                                          static_cast<int32_t>(track),
+                                          static_cast<int32_t>(det)});
+        }
+      }
+    }
+  }
+
+  // 按照代价从小到大贪心匹配
+  std::sort(candidates_.begin(),
+            candidates_.end(),
+            [](const Candidate& lhs, const Candidate& rhs) {
+              if (lhs.cost != rhs.cost) {
+                return lhs.cost < rhs.cost;
+              }
+              if (lhs.track != rhs.track) {
+                return lhs.track < rhs.track;
+              }
+              return lhs.det < rhs.det;
+            });
+  for (const auto& candidate : candidates_) {
+    if (track_matched_[candidate.track] || det_track_[candidate.det] >= 0) {
+      continue;
+    }
+    track_matched_[candidate.track] = 1;
+    det_track_[candidate.det] = candidate.track;
+  }
+}
+
+void NativeMot::UpdateTrack(size_t track, const MotBox& box) {
+  float measure[kDim] = {(box.x1 + box.x2) / 2.0f,
+                         (box.y1 + box.y2) / 2.0f,
+                         static_cast<float>(box.x2 - box.x1),
+                         static_cast<float>(box.y2 - box.y1)};
+  lost_frames_[track] = 0;
+  if (!config_.use_kalman_filter) {
+    for (int dim = 0; dim < kDim; dim++) {
+      pos_[dim][track] = measure[dim];
+    }
+    return;
+  }
+  // 观测噪声与检测框高度成正比
+  float std_measure = measure[3] / 20;
+  float noise = std_measure * std_measure;
+  for (int dim = 0; dim < kDim; dim++) {
+    float cov_pp = cov_pp_[dim][track];
+    float cov_pv = cov_pv_[dim][track];
+    float innovation_cov = cov_pp + noise;
+    if (innovation_cov <= 0) {
+      pos_[dim][track] = measure[dim];
+      continue;
+    }
+    float gain_pos = cov_pp / innovation_cov;
+    float gain_vel = cov_pv / innovation_cov;
+    float residual = measure[dim] - pos_[dim][track];
+    pos_[dim][track] += gain_pos * residual;
+    vel_[dim][track] += gain_vel * residual;
+    cov_pp_[dim][track] = (1 - gain_pos) * cov_pp;
+    cov_pv_[dim][track] = (1 - gain_pos) * cov_pv;
+    cov_vv_[dim][track] -= gain_vel * cov_pv;
+  }
+}
+
+void NativeMot::AddTrack(const MotBox& box) {
+  float measure[kDim] = {(box.x1 + box.x2) / 2.0f,
+                         (box.y1 + box.y2) / 2.0f,
+                         static_cast<float>(box.x2 - box.x1),
+                         static_cast<float>(box.y2 - box.y1)};
+  float std_pos = measure[3] / 10;
+  float std_vel = measure[3] / 16;
+  for (int dim = 0; dim < kDim; dim++) {
+    pos_[dim].push_back(measure[dim]);
+    vel_[dim].push_back(0);
+    cov_pp_[dim].push_back(std_pos * std_pos);
+    cov_pv_[dim].push_back(0);
+    cov_vv_[dim].push_back(std_vel * std_vel);
+  }
+  ids_.push_back(next_id_);
+  lost_frames_.push_back(0);
+  if (next_id_ == std::numeric_limits<int32_t>::max()) {
+    next_id_ = 1;
+  } else {
+    next_id_++;
+  }
+}
+
+void NativeMot::RemoveTrack(size_t track) {
+  size_t last = ids_.size() - 1;
+  for (int dim = 0; dim < kDim; dim++) {
+    pos_[dim][track] = pos_[dim][last];
+    vel_[dim][track] = vel_[dim][last];
+    cov_pp_[dim][track] = cov_pp_[dim][last];
+    cov_pv_[dim][track] = cov_pv_[dim][last];
+    cov_vv_[dim][track] = cov_vv_[dim][last];
+    pos_[dim].pop_back();
+    vel_[dim].pop_back();
+    cov_pp_[dim].pop_back();
+    cov_pv_[dim].pop_back();
+    cov_vv_[dim].pop_back();
+  }
+  ids_[track] = ids_[last];
+  lost_frames_[track] = lost_frames_[last];
+  ids_.pop_back();
+  lost_frames_.pop_back();
+}
+
+}  // namespace native_mot
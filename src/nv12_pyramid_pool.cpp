@@ -0,0 +1,149 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/nv12_pyramid_pool.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "include/image_utils.h"
+
+std::shared_ptr<NV12PyramidPool> NV12PyramidPool::Instance() {
+  // pyramid的deleter持有pool的shared_ptr，保证pool晚于所有pyramid析构
+  static std::shared_ptr<NV12PyramidPool> instance(new NV12PyramidPool());
+  return instance;
+}
+
+NV12PyramidPool::~NV12PyramidPool() {
+  std::unique_lock<std::mutex> lk(mtx_);
+  for (auto &buffers : free_buffers_) {
+    for (auto *buffer : buffers.second) {
+      FreeBuffer(buffer);
+    }
+  }
+  free_buffers_.clear();
+}
+
+std::shared_ptr<NV12PyramidInput> NV12PyramidPool::Acquire(int height,
+                                                           int width) {
+  if (height <= 0 || width <= 0) {
+    return nullptr;
+  }
+  uint32_t w_stride = ALIGN_16(width);
+  uint64_t key = (static_cast<uint64_t>(width) << 42) |
+                 (static_cast<uint64_t>(height) << 21) |
+                 static_cast<uint64_t>(w_stride);
+
+  Buffer *buffer = nullptr;
+  {
+    std::unique_lock<std::mutex> lk(mtx_);
+    auto iter = free_buffers_.find(key);
+    if (iter != free_buffers_.end() && !iter->second.empty()) {
+      buffer = iter->second.back();
+      iter->second.pop_back();
+    }
+  }
+
+  if (buffer) {
+    hits_++;
+  } else {
+    misses_++;
+    buffer = new Buffer;
+    buffer->key = key;
+    buffer->bytes = static_cast<uint64_t>(height) * w_stride * 3 / 2;
+    if (hbSysAllocCachedMem(&buffer->y, height * w_stride) != 0) {
+      std::cerr << "alloc pyramid y mem failed" << std::endl;
+      delete buffer;
+      return nullptr;
+    }
+    if (hbSysAllocCachedMem(&buffer->uv, height / 2 * w_stride) != 0) {
+      std::cerr << "alloc pyramid uv mem failed" << std::endl;
+      hbSysFreeMem(&buffer->y);
+      delete buffer;
+      return nullptr;
+    }
+  }
+
+  auto in_flight = bytes_in_flight_.fetch_add(buffer->bytes) + buffer->bytes;
+  auto high_water_mark = high_water_mark_.load();
+  while (in_flight > high_water_mark &&
+         !high_water_mark_.compare_exchange_weak(high_water_mark, in_flight)) {
+  }
+
+  auto &pyramid = buffer->pyramid;
+  pyramid.width = width;
+  pyramid.height = height;
+  pyramid.y_vir_addr = buffer->y.virAddr;
+  pyramid.y_phy_addr = buffer->y.phyAddr;
+  pyramid.y_stride = w_stride;
+  pyramid.uv_vir_addr = buffer->uv.virAddr;
+  pyramid.uv_phy_addr = buffer->uv.phyAddr;
+  pyramid.uv_stride = w_stride;
+
+  auto pool = shared_from_this();
+  return std::shared_ptr<NV12PyramidInput>(
+      &buffer->pyramid,
+      [pool, buffer](NV12PyramidInput *) { pool->Release(buffer); });
+}
+
+void NV12PyramidPool::FlushRows(const NV12PyramidInput &pyramid,
+                                int y_rows,
+                                int uv_rows) {
+  y_rows = std::min(y_rows, pyramid.height);
+  uv_rows = std::min(uv_rows, pyramid.height / 2);
+  if (y_rows > 0) {
+    hbSysMem y_mem;
+    y_mem.phyAddr = pyramid.y_phy_addr;
+    y_mem.virAddr = pyramid.y_vir_addr;
+    y_mem.memSize = y_rows * pyramid.y_stride;
+    hbSysFlushMem(&y_mem, HB_SYS_MEM_CACHE_CLEAN);
+  }
+  if (uv_rows > 0) {
+    hbSysMem uv_mem;
+    uv_mem.phyAddr = pyramid.uv_phy_addr;
+    uv_mem.virAddr = pyramid.uv_vir_addr;
+    uv_mem.memSize = uv_rows * pyramid.uv_stride;
+    hbSysFlushMem(&uv_mem, HB_SYS_MEM_CACHE_CLEAN);
+  }
+}
+
+NV12PyramidPool::Stats NV12PyramidPool::GetStats() const {
+  Stats stats;
+  stats.hits = hits_.load();
+  stats.misses = misses_.load();
+  stats.bytes_in_flight = bytes_in_flight_.load();
+  stats.high_water_mark = high_water_mark_.load();
+  return stats;
+}
+
+void NV12PyramidPool::Release(Buffer *buffer) {
+  bytes_in_flight_ -= buffer->bytes;
+  {
+    std::unique_lock<std::mutex> lk(mtx_);
+    auto &buffers = free_buffers_[buffer->key];
+    if (buffers.size() < max_cached_per_key_) {
+      buffers.push_back(buffer);
+      return;
+    }
+  }
+  FreeBuffer(buffer);
+}
+
+void NV12PyramidPool::FreeBuffer(Buffer *buffer) {
+  hbSysFreeMem(&buffer->y);
+  hbSysFreeMem(&buffer->uv);
+  delete buffer;
+}
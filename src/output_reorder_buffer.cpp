@@ -0,0 +1,84 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/output_reorder_buffer.h"
+
+#include <chrono>
+
+OutputReorderBuffer::OutputReorderBuffer(size_t capacity, uint64_t timeout_ms)
+    : timeout_ms_(timeout_ms) {
+  capacity_ = 1;
+  while (capacity_ < capacity) {
+    capacity_ <<= 1;
+  }
+  mask_ = capacity_ - 1;
+  slots_ = std::vector<Slot>(capacity_);
+  for (size_t idx = 0; idx < capacity_; idx++) {
+    slots_[idx].state.store(Tag(idx, kFree));
+  }
+}
+
+uint64_t OutputReorderBuffer::Register() { return next_seq_.fetch_add(1); }
+
+OutputReorderBuffer::Stats OutputReorderBuffer::GetStats() const {
+  Stats stats;
+  stats.registered = next_seq_.load();
+  stats.released = released_.load();
+  stats.dropped = dropped_.load();
+  stats.late = late_.load();
+  stats.erased = erased_.load();
+  return stats;
+}
+
+bool OutputReorderBuffer::Drained() const {
+  // 每一帧只有被输出、跳过或者放弃之后队首才会越过该帧
+  return head_.load(std::memory_order_acquire) >= next_seq_.load();
+}
+
+bool OutputReorderBuffer::HeadReady() {
+  uint64_t head = head_.load(std::memory_order_acquire);
+  uint64_t state = slots_[head & mask_].state.load(std::memory_order_acquire);
+  if (state == Tag(head, kReady) || state == Tag(head, kErased)) {
+    return true;
+  }
+  return state == Tag(head, kFree) && head + capacity_ < overflow_seq_.load();
+}
+
+bool OutputReorderBuffer::ShouldSkip(uint64_t head) {
+  if (head >= next_seq_.load()) {
+    // 还未输入的帧
+    return false;
+  }
+  if (head + capacity_ < overflow_seq_.load()) {
+    // 缓存已满，后续帧需要使用队首的槽位
+    return true;
+  }
+  if (max_ready_seq_.load() <= head + 1) {
+    // 后续帧都还没有输出，继续等待
+    head_wait_seq_ = UINT64_MAX;
+    return false;
+  }
+  uint64_t now = NowMs();
+  if (head_wait_seq_ != head) {
+    head_wait_seq_ = head;
+    head_wait_start_ms_ = now;
+  }
+  return now - head_wait_start_ms_ >= timeout_ms_;
+}
+
+uint64_t OutputReorderBuffer::NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
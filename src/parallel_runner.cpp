@@ -0,0 +1,112 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/parallel_runner.h"
+
+ParallelRunner::ParallelRunner(int thread_num) {
+  for (int idx = 0; idx < thread_num; idx++) {
+    workers_.emplace_back([this] { Worker(); });
+  }
+}
+
+ParallelRunner::~ParallelRunner() {
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    stopped_ = true;
+  }
+  job_cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void ParallelRunner::Run(size_t job_num,
+                         const std::function<void(size_t)>& job) {
+  if (workers_.empty() || job_num <= 1) {
+    for (size_t idx = 0; idx < job_num; idx++) {
+      job(idx);
+    }
+    return;
+  }
+
+  Batch batch;
+  batch.job = &job;
+  batch.job_num = job_num;
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (tail_) {
+      tail_->next_batch = &batch;
+    } else {
+      head_ = &batch;
+    }
+    tail_ = &batch;
+  }
+  job_cv_.notify_all();
+
+  // 调用线程也参与执行，直到没有待领取的任务
+  std::unique_lock<std::mutex> lk(mtx_);
+  while (batch.next < batch.job_num) {
+    Batch* claimed = nullptr;
+    size_t index = 0;
+    if (!ClaimLocked(claimed, index)) {
+      break;
+    }
+    lk.unlock();
+    (*claimed->job)(index);
+    lk.lock();
+    if (++claimed->done == claimed->job_num) {
+      done_cv_.notify_all();
+    }
+  }
+  // batch在栈上，必须等待所有领取的任务完成后才能返回
+  done_cv_.wait(lk, [&batch] { return batch.done == batch.job_num; });
+}
+
+bool ParallelRunner::ClaimLocked(Batch*& batch, size_t& index) {
+  if (!head_) {
+    return false;
+  }
+  batch = head_;
+  index = batch->next++;
+  if (batch->next == batch->job_num) {
+    head_ = batch->next_batch;
+    if (!head_) {
+      tail_ = nullptr;
+    }
+  }
+  return true;
+}
+
+void ParallelRunner::Worker() {
+  std::unique_lock<std::mutex> lk(mtx_);
+  while (true) {
+    job_cv_.wait(lk, [this] { return stopped_ || head_ != nullptr; });
+    if (stopped_) {
+      return;
+    }
+    Batch* batch = nullptr;
+    size_t index = 0;
+    if (!ClaimLocked(batch, index)) {
+      continue;
+    }
+    lk.unlock();
+    (*batch->job)(index);
+    lk.lock();
+    if (++batch->done == batch->job_num) {
+      done_cv_.notify_all();
+    }
+  }
+}
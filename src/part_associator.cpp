@@ -0,0 +1,239 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/part_associator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 网格的最大网格数，人体框很小且分布很散时增大网格尺寸
+constexpr int kMaxCellNum = 4096;
+// 网格尺寸不小于该值，单位像素
+constexpr float kMinCellSize = 16.0f;
+// 人头、人脸中心在人体框中的相对高度超过该值时增加代价
+constexpr float kHeadMaxRelativeY = 0.3f;
+
+// 各类部位参与关联的关键点index范围[begin, end)，以及每个人体最多关联的个数
+struct PartRule {
+  size_t kps_begin;
+  size_t kps_end;
+  uint8_t max_per_body;
+};
+// 人头：鼻子、眼睛、耳朵；人脸：鼻子、眼睛；人手：手腕
+constexpr PartRule kPartRules[] = {{0, 5, 1}, {0, 3, 1}, {9, 11, 2}};
+
+constexpr size_t kTypeNum =
+    static_cast<size_t>(PartAssociator::PartType::TYPE_NUM);
+
+int Clamp(int val, int low, int high) {
+  return std::max(low, std::min(high, val));
+}
+
+}  // namespace
+
+void PartAssociator::Reset() {
+  bodies_.clear();
+  parts_.clear();
+}
+
+void PartAssociator::AddBody(float x1,
+                             float y1,
+                             float x2,
+                             float y2,
+                             const ai_msgs::msg::Point* kps) {
+  bodies_.push_back(Body{Box{x1, y1, x2, y2}, kps});
+}
+
+void PartAssociator::AddPart(
+    PartType type, float x1, float y1, float x2, float y2) {
+  parts_.push_back(Part{Box{x1, y1, x2, y2}, type});
+}
+
+void PartAssociator::BuildGrid() {
+  grid_cols_ = 0;
+  grid_rows_ = 0;
+  if (bodies_.empty()) {
+    return;
+  }
+  float x_min = bodies_[0].box.x1;
+  float y_min = bodies_[0].box.y1;
+  float x_max = bodies_[0].box.x2;
+  float y_max = bodies_[0].box.y2;
+  float width_sum = 0;
+  for (const auto& body : bodies_) {
+    x_min = std::min(x_min, body.box.x1);
+    y_min = std::min(y_min, body.box.y1);
+    x_max = std::max(x_max, body.box.x2);
+    y_max = std::max(y_max, body.box.y2);
+    width_sum += body.box.x2 - body.box.x1;
+  }
+  // 网格尺寸为人体框的平均宽度，每个人体框大约覆盖2列、4行网格
+  cell_size_ = std::max(kMinCellSize, width_sum / bodies_.size());
+  float range_x = x_max - x_min;
+  float range_y = y_max - y_min;
+  while ((static_cast<int>(range_x / cell_size_) + 1) *
+             (static_cast<int>(range_y / cell_size_) + 1) >
+         kMaxCellNum) {
+    cell_size_ *= 2;
+  }
+  grid_x0_ = x_min;
+  grid_y0_ = y_min;
+  grid_cols_ = static_cast<int>(range_x / cell_size_) + 1;
+  grid_rows_ = static_cast<int>(range_y / cell_size_) + 1;
+
+  // 第一遍统计每个网格的人体框个数，第二遍写入
+  size_t cell_num = static_cast<size_t>(grid_cols_) * grid_rows_;
+  cell_start_.assign(cell_num + 1, 0);
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t idx = 0; idx < bodies_.size(); idx++) {
+      const auto& box = bodies_[idx].box;
+      int col_begin = Clamp(static_cast<int>((box.x1 - grid_x0_) / cell_size_),
+                            0,
+                            grid_cols_ - 1);
+      int col_end = Clamp(static_cast<int>((box.x2 - grid_x0_) / cell_size_),
+                          0,
+                          grid_cols_ - 1);
+      int row_begin = Clamp(static_cast<int>((box.y1 - grid_y0_) / cell_size_),
+                            0,
+                            grid_rows_ - 1);
+      int row_end = Clamp(static_cast<int>((box.y2 - grid_y0_) / cell_size_),
+                          0,
+                          grid_rows_ - 1);
+      for (int row = row_begin; row <= row_end; row++) {
+        for (int col = col_begin; col <= col_end; col++) {
+          size_t cell = static_cast<size_t>(row) * grid_cols_ + col;
+          if (pass == 0) {
+            cell_start_[cell + 1]++;
+          } else {
+            cell_bodies_[cell_start_[cell]++] = static_cast<int32_t>(idx);
+          }
+        }
+      }
+    }
+    if (pass == 0) {
+      for (size_t cell = 0; cell < cell_num; cell++) {
+        cell_start_[cell + 1] += cell_start_[cell];
+      }
+      cell_bodies_.resize(cell_start_[cell_num]);
+    }
+  }
+  // 写入时cell_start_[cell]前移到了下一个网格的起始位置，整体后移一位恢复
+  for (size_t cell = cell_num; cell > 0; cell--) {
+    cell_start_[cell] = cell_start_[cell - 1];
+  }
+  cell_start_[0] = 0;
+}
+
+float PartAssociator::Cost(const Part& part, const Body& body) const {
+  const Box& pbox = part.box;
+  const Box& bbox = body.box;
+  float inter_w = std::min(pbox.x2, bbox.x2) - std::max(pbox.x1, bbox.x1);
+  float inter_h = std::min(pbox.y2, bbox.y2) - std::max(pbox.y1, bbox.y1);
+  float part_w = pbox.x2 - pbox.x1;
+  float part_h = pbox.y2 - pbox.y1;
+  if (inter_w <= 0 || inter_h <= 0 || part_w <= 0 || part_h <= 0) {
+    return kMaxCost + 1;
+  }
+  float inside = inter_w * inter_h / (part_w * part_h);
+  if (inside < kMinInsideRatio) {
+    return kMaxCost + 1;
+  }
+  float cost = 1 - inside;
+
+  float center_x = (pbox.x1 + pbox.x2) / 2;
+  float center_y = (pbox.y1 + pbox.y2) / 2;
+  const PartRule& rule = kPartRules[static_cast<size_t>(part.type)];
+  // 没有可用的关键点时距离按照1计算
+  float kps_dist = 1;
+  if (body.kps) {
+    const auto& points = body.kps->point;
+    const auto& scores = body.kps->confidence;
+    float min_dist2 = -1;
+    for (size_t idx = rule.kps_begin;
+         idx < rule.kps_end && idx < points.size() && idx < scores.size();
+         idx++) {
+      if (scores[idx] < kKpsScoreThreshold) {
+        continue;
+      }
+      float dx = points[idx].x - center_x;
+      float dy = points[idx].y - center_y;
+      float dist2 = dx * dx + dy * dy;
+      if (min_dist2 < 0 || dist2 < min_dist2) {
+        min_dist2 = dist2;
+      }
+    }
+    if (min_dist2 >= 0) {
+      kps_dist =
+          std::min(2.0f, std::sqrt(min_dist2) / std::max(part_w, part_h));
+    }
+  }
+  cost += kKpsWeight * kps_dist;
+
+  if (part.type != PartType::HAND) {
+    float relative_y = (center_y - bbox.y1) / std::max(1.0f, bbox.y2 - bbox.y1);
+    cost += std::max(0.0f, relative_y - kHeadMaxRelativeY);
+  }
+  return cost;
+}
+
+void PartAssociator::Associate() {
+  part_body_.assign(parts_.size(), -1);
+  candidates_.clear();
+  BuildGrid();
+  if (bodies_.empty()) {
+    return;
+  }
+
+  for (size_t part_idx = 0; part_idx < parts_.size(); part_idx++) {
+    const auto& part = parts_[part_idx];
+    int col = static_cast<int>(
+        std::floor(((part.box.x1 + part.box.x2) / 2 - grid_x0_) / cell_size_));
+    int row = static_cast<int>(
+        std::floor(((part.box.y1 + part.box.y2) / 2 - grid_y0_) / cell_size_));
+    if (col < 0 || col >= grid_cols_ || row < 0 || row >= grid_rows_) {
+      continue;
+    }
+    size_t cell = static_cast<size_t>(row) * grid_cols_ + col;
+    for (int32_t pos = cell_start_[cell]; pos < cell_start_[cell + 1]; pos++) {
+      int32_t body_idx = cell_bodies_[pos];
+      float cost = Cost(part, bodies_[body_idx]);
+      if (cost <= kMaxCost) {
+        candidates_.push_back(
+            Candidate{cost, static_cast<int32_t>(part_idx), body_idx});
+      }
+    }
+  }
+
+  // 候选按照部位框和网格的顺序生成，输入相同时排序结果相同
+  std::sort(candidates_.begin(),
+            candidates_.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return a.cost < b.cost;
+            });
+  body_part_count_.assign(bodies_.size() * kTypeNum, 0);
+  for (const auto& candidate : candidates_) {
+    if (part_body_[candidate.part] >= 0) {
+      continue;
+    }
+    size_t type = static_cast<size_t>(parts_[candidate.part].type);
+    uint8_t& count = body_part_count_[candidate.body * kTypeNum + type];
+    if (count >= kPartRules[type].max_per_body) {
+      continue;
+    }
+    count++;
+    part_body_[candidate.part] = candidate.body;
+  }
+}
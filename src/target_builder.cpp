@@ -0,0 +1,367 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/target_builder.h"
+
+#include <algorithm>
+
+namespace {
+
+void FillRoi(ai_msgs::msg::Roi& roi,
+             const MotBox& rect,
+             const std::string& roi_type) {
+  roi.set__type(roi_type);
+  roi.set__confidence(rect.score);
+  roi.rect.set__x_offset(rect.x1);
+  roi.rect.set__y_offset(rect.y1);
+  roi.rect.set__width(rect.x2 - rect.x1);
+  roi.rect.set__height(rect.y2 - rect.y1);
+}
+
+// 取出targets中第num个元素，已有的元素直接复用，没有时从spare中取回或者新建
+ai_msgs::msg::Target& NextTarget(std::vector<ai_msgs::msg::Target>& targets,
+                                 size_t& num,
+                                 std::vector<ai_msgs::msg::Target>& spare) {
+  if (num == targets.size()) {
+    if (spare.empty()) {
+      targets.emplace_back();
+    } else {
+      targets.emplace_back(std::move(spare.back()));
+      spare.pop_back();
+    }
+  }
+  return targets[num++];
+}
+
+// targets中第num个之后的元素移到spare中
+void TrimTargets(std::vector<ai_msgs::msg::Target>& targets,
+                 size_t num,
+                 std::vector<ai_msgs::msg::Target>& spare) {
+  while (targets.size() > num) {
+    spare.emplace_back(std::move(targets.back()));
+    targets.pop_back();
+  }
+}
+
+}  // namespace
+
+const std::string TargetBuilder::kPersonType = "person";
+const std::string TargetBuilder::kBodyKpsType = "body_kps";
+
+TargetBuilder::TargetBuilder(
+    const std::unordered_map<int32_t, std::string>& box_outputs_index_type,
+    int32_t body_box_output_index)
+    : box_outputs_index_type_(box_outputs_index_type),
+      body_box_output_index_(body_box_output_index) {
+  active_outputs_.reserve(box_outputs_index_type_.size());
+  // 提前创建所有类别的key，每帧只清空vector
+  for (const auto& index_type : box_outputs_index_type_) {
+    in_rois_[index_type.first];
+    out_rois_[index_type.first];
+    out_disappeared_ids_[index_type.first];
+  }
+  static const std::unordered_map<std::string, PartAssociator::PartType>
+      part_types = {{"head", PartAssociator::PartType::HEAD},
+                    {"face", PartAssociator::PartType::FACE},
+                    {"hand", PartAssociator::PartType::HAND}};
+  for (const auto& index_type : box_outputs_index_type_) {
+    auto iter = part_types.find(index_type.second);
+    if (index_type.first != body_box_output_index_ &&
+        iter != part_types.end()) {
+      part_outputs_.emplace_back(index_type.first, iter->second);
+    }
+  }
+  std::sort(part_outputs_.begin(), part_outputs_.end());
+}
+
+void TargetBuilder::Reset() {
+  for (auto& roi : in_rois_) {
+    roi.second.clear();
+  }
+  for (auto& roi : out_rois_) {
+    roi.second.clear();
+  }
+  for (auto& disappeared_id : out_disappeared_ids_) {
+    disappeared_id.second.clear();
+  }
+  body_kps_num_ = 0;
+  active_outputs_.clear();
+}
+
+void TargetBuilder::AddOutput(int32_t output_index) {
+  if (!HasOutput(output_index)) {
+    active_outputs_.push_back(output_index);
+  }
+}
+
+bool TargetBuilder::HasOutput(int32_t output_index) const {
+  return std::find(active_outputs_.begin(),
+                   active_outputs_.end(),
+                   output_index) != active_outputs_.end();
+}
+
+void TargetBuilder::AddBox(int32_t output_index,
+                           float left,
+                           float top,
+                           float right,
+                           float bottom,
+                           float conf,
+                           const ImageTransform& transform,
+                           int img_width,
+                           int img_height) {
+  left = transform.ToSrcX(left);
+  top = transform.ToSrcY(top);
+  right = transform.ToSrcX(right);
+  bottom = transform.ToSrcY(bottom);
+  if (left < 0) left = 0;
+  if (top < 0) top = 0;
+  if (right > img_width) {
+    right = img_width;
+  }
+  if (bottom > img_height) {
+    bottom = img_height;
+  }
+  in_rois_[output_index].emplace_back(MotBox(left, top, right, bottom, conf));
+}
+
+const std::string& TargetBuilder::RoiType(int32_t output_index) const {
+  static const std::string empty_type = "";
+  auto iter = box_outputs_index_type_.find(output_index);
+  return iter == box_outputs_index_type_.end() ? empty_type : iter->second;
+}
+
+bool TargetBuilder::IsValid(const MotBox& rect, AsyncLogger* logger) const {
+  if (rect.id >= 0 && hobot_mot::DataState::INVALID != rect.state_) {
+    return true;
+  }
+  if (logger) {
+    logger->Log("invalid id, rect: %d %d %d %d, score: %f, state_: %d",
+                static_cast<int>(rect.x1),
+                static_cast<int>(rect.y1),
+                static_cast<int>(rect.x2),
+                static_cast<int>(rect.y2),
+                static_cast<double>(rect.score),
+                static_cast<int>(rect.state_));
+  }
+  return false;
+}
+
+int TargetBuilder::Track(ParallelRunner& runner,
+                         MotMap& hobot_mots,
+                         time_t time_stamp,
+                         int img_width,
+                         int img_height) {
+  if (hobot_mots.empty()) {
+    return -1;
+  }
+
+  mot_jobs_.clear();
+  for (const auto& roi : in_rois_) {
+    if (!HasOutput(roi.first)) {
+      continue;
+    }
+    auto type_iter = box_outputs_index_type_.find(roi.first);
+    if (type_iter == box_outputs_index_type_.end()) {
+      continue;
+    }
+    auto mot_iter = hobot_mots.find(type_iter->second);
+    if (mot_iter == hobot_mots.end() || !mot_iter->second) {
+      continue;
+    }
+    mot_jobs_.emplace_back();
+    auto& job = mot_jobs_.back();
+    job.index = roi.first;
+    job.type = &type_iter->second;
+    job.hobot_mot = mot_iter->second.get();
+    out_rois_[roi.first].clear();
+    out_disappeared_ids_[roi.first].clear();
+  }
+
+  // lambda只捕获一个指针，std::function不需要在堆上保存捕获的数据
+  struct MotContext {
+    TargetBuilder* builder;
+    time_t time_stamp;
+    int img_width;
+    int img_height;
+  } context{this, time_stamp, img_width, img_height};
+  MotContext* ctx = &context;
+  runner.Run(mot_jobs_.size(), [ctx](size_t idx) {
+    auto& builder = *ctx->builder;
+    auto& job = builder.mot_jobs_[idx];
+    // key在构造时已经创建，并发查找不会修改map
+    clock_gettime(CLOCK_REALTIME, &job.time_start);
+    job.ret =
+        job.hobot_mot->DoProcess(builder.in_rois_.find(job.index)->second,
+                                 builder.out_rois_.find(job.index)->second,
+                                 builder.out_disappeared_ids_.find(job.index)
+                                     ->second,
+                                 ctx->time_stamp,
+                                 ctx->img_width,
+                                 ctx->img_height);
+    clock_gettime(CLOCK_REALTIME, &job.time_end);
+  });
+
+  for (const auto& job : mot_jobs_) {
+    if (job.ret < 0) {
+      out_rois_[job.index].clear();
+      out_disappeared_ids_[job.index].clear();
+    }
+  }
+  return 0;
+}
+
+ai_msgs::msg::Target& TargetBuilder::AddTarget(
+    ai_msgs::msg::PerceptionTargets& msg,
+    const MotBox& rect,
+    const std::string& roi_type,
+    const ai_msgs::msg::Point* kps) {
+  auto& target = NextTarget(msg.targets, targets_num_, spare_targets_);
+  target.set__type(kPersonType);
+  target.set__track_id(rect.id);
+  // 已有的roi和关键点直接覆盖，不重新创建
+  target.rois.resize(1);
+  FillRoi(target.rois[0], rect, roi_type);
+  if (kps) {
+    target.points.resize(1);
+    target.points[0] = *kps;
+  } else {
+    target.points.clear();
+  }
+  target.attributes.clear();
+  target.captures.clear();
+  return target;
+}
+
+void TargetBuilder::Build(ai_msgs::msg::PerceptionTargets& msg,
+                          AsyncLogger* logger) {
+  targets_num_ = 0;
+  disappeared_num_ = 0;
+  if (part_association_) {
+    BuildAssociated(msg, logger);
+  } else {
+    for (const auto& out_roi : out_rois_) {
+      const std::string& roi_type = RoiType(out_roi.first);
+      bool with_kps = out_roi.first == body_box_output_index_ &&
+                      out_roi.second.size() == body_kps_num_;
+      for (size_t idx = 0; idx < out_roi.second.size(); idx++) {
+        const auto& rect = out_roi.second[idx];
+        if (!IsValid(rect, logger)) {
+          continue;
+        }
+        AddTarget(msg, rect, roi_type, with_kps ? &body_kps_[idx] : nullptr);
+      }
+    }
+  }
+
+  for (const auto& disappeared_id : out_disappeared_ids_) {
+    const std::string& roi_type = RoiType(disappeared_id.first);
+    for (const auto& id_info : disappeared_id.second) {
+      if (!id_info || id_info->value < 0 ||
+          hobot_mot::DataState::INVALID == id_info->state_) {
+        continue;
+      }
+      auto& target = NextTarget(
+          msg.disappeared_targets, disappeared_num_, spare_targets_);
+      target.set__type(kPersonType);
+      target.set__track_id(id_info->value);
+      target.rois.resize(1);
+      auto& roi = target.rois[0];
+      roi.set__type(roi_type);
+      roi.set__confidence(0.0f);
+      roi.set__rect(sensor_msgs::msg::RegionOfInterest());
+      target.points.clear();
+      target.attributes.clear();
+      target.captures.clear();
+    }
+  }
+  TrimTargets(msg.targets, targets_num_, spare_targets_);
+  TrimTargets(msg.disappeared_targets, disappeared_num_, spare_targets_);
+}
+
+void TargetBuilder::BuildAssociated(ai_msgs::msg::PerceptionTargets& msg,
+                                    AsyncLogger* logger) {
+  part_associator_.Reset();
+  body_targets_.clear();
+  part_rects_.clear();
+
+  auto body_iter = out_rois_.find(body_box_output_index_);
+  if (body_iter != out_rois_.end()) {
+    const std::string& roi_type = RoiType(body_box_output_index_);
+    const auto& bodies = body_iter->second;
+    bool with_kps = bodies.size() == body_kps_num_;
+    for (size_t idx = 0; idx < bodies.size(); idx++) {
+      const auto& rect = bodies[idx];
+      if (!IsValid(rect, logger)) {
+        continue;
+      }
+      body_targets_.push_back(targets_num_);
+      AddTarget(msg, rect, roi_type, with_kps ? &body_kps_[idx] : nullptr);
+      part_associator_.AddBody(rect.x1,
+                               rect.y1,
+                               rect.x2,
+                               rect.y2,
+                               with_kps ? &body_kps_[idx] : nullptr);
+    }
+  }
+
+  for (const auto& part_output : part_outputs_) {
+    const std::string& roi_type = RoiType(part_output.first);
+    for (const auto& rect : out_rois_[part_output.first]) {
+      if (!IsValid(rect, logger)) {
+        continue;
+      }
+      part_associator_.AddPart(
+          part_output.second, rect.x1, rect.y1, rect.x2, rect.y2);
+      part_rects_.emplace_back(&rect, &roi_type);
+    }
+  }
+
+  part_associator_.Associate();
+  for (size_t idx = 0; idx < part_rects_.size(); idx++) {
+    const MotBox& rect = *part_rects_[idx].first;
+    const std::string& roi_type = *part_rects_[idx].second;
+    int32_t body = part_associator_.BodyOf(idx);
+    if (body < 0) {
+      AddTarget(msg, rect, roi_type, nullptr);
+      continue;
+    }
+    auto& rois = msg.targets[body_targets_[body]].rois;
+    rois.emplace_back();
+    FillRoi(rois.back(), rect, roi_type);
+  }
+
+  // 其他类别不参与关联，与不关联时的输出一致
+  auto is_associated = [this](int32_t output_index) {
+    if (output_index == body_box_output_index_) {
+      return true;
+    }
+    for (const auto& part_output : part_outputs_) {
+      if (part_output.first == output_index) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (const auto& out_roi : out_rois_) {
+    if (is_associated(out_roi.first)) {
+      continue;
+    }
+    const std::string& roi_type = RoiType(out_roi.first);
+    for (const auto& rect : out_roi.second) {
+      if (IsValid(rect, logger)) {
+        AddTarget(msg, rect, roi_type, nullptr);
+      }
+    }
+  }
+}
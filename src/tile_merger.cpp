@@ -0,0 +1,238 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/tile_merger.h"
+
+#include <algorithm>
+
+namespace {
+
+// 计算一个方向上的tile个数和大小，size和model_size为偶数
+void SplitAxis(int size,
+               int model_size,
+               int count,
+               int max_count,
+               int overlap,
+               int& tile_size,
+               int& tile_count) {
+  if (count <= 0) {
+    // tile与模型输入一样大，个数满足相邻tile至少重叠overlap
+    tile_size = std::max(2, std::min(size, model_size));
+    int stride = tile_size - overlap;
+    tile_count = (size <= tile_size || stride <= 0)
+                     ? 1
+                     : (size - overlap + stride - 1) / stride;
+    if (tile_count <= max_count) {
+      return;
+    }
+    count = max_count;
+  }
+  tile_count = std::min(count, max_count);
+  tile_size = (size + (tile_count - 1) * overlap + tile_count - 1) / tile_count;
+  tile_size = std::min(size, (tile_size + 1) & ~1);
+}
+
+// tile在一个方向上均匀分布，首尾两个tile分别对齐原图边界
+int TilePos(int size, int tile_size, int tile_count, int idx) {
+  if (tile_count <= 1) {
+    return 0;
+  }
+  return static_cast<int>(static_cast<int64_t>(size - tile_size) * idx /
+                          (tile_count - 1)) &
+         ~1;
+}
+
+}  // namespace
+
+void TileLayout::Compute(int img_height,
+                         int img_width,
+                         int model_height,
+                         int model_width,
+                         int cols,
+                         int rows,
+                         int overlap,
+                         bool with_full_frame,
+                         std::vector<TileRect>& tiles) {
+  tiles.clear();
+  int height = img_height & ~1;
+  int width = img_width & ~1;
+  if (height < 2 || width < 2) {
+    return;
+  }
+  overlap = std::max(0, overlap);
+  int tile_w = 0;
+  int tile_h = 0;
+  int tile_cols = 0;
+  int tile_rows = 0;
+  SplitAxis(
+      width, model_width & ~1, cols, kMaxTileCols, overlap, tile_w, tile_cols);
+  SplitAxis(height,
+            model_height & ~1,
+            rows,
+            kMaxTileRows,
+            overlap,
+            tile_h,
+            tile_rows);
+  for (int row = 0; row < tile_rows; row++) {
+    for (int col = 0; col < tile_cols; col++) {
+      TileRect tile;
+      tile.x = TilePos(width, tile_w, tile_cols, col);
+      tile.y = TilePos(height, tile_h, tile_rows, row);
+      tile.width = tile_w;
+      tile.height = tile_h;
+      tiles.push_back(tile);
+    }
+  }
+  // 只有一个tile时已经覆盖整图
+  if (with_full_frame && tiles.size() > 1) {
+    TileRect tile;
+    tile.width = width;
+    tile.height = height;
+    tiles.push_back(tile);
+  }
+}
+
+TileMerger::TileMerger(const std::vector<int32_t>& output_indexes) {
+  // 提前创建所有类别的key，每帧只清空vector
+  for (const auto& output_index : output_indexes) {
+    boxes_[output_index];
+  }
+}
+
+void TileMerger::Reset(const std::vector<TileRect>& tiles,
+                       int img_height,
+                       int img_width) {
+  tiles_ = tiles;
+  img_height_ = img_height & ~1;
+  img_width_ = img_width & ~1;
+  for (auto& boxes : boxes_) {
+    boxes.second.clear();
+  }
+  kps_num_ = 0;
+}
+
+bool TileMerger::IsTruncated(
+    int tile, float x1, float y1, float x2, float y2) const {
+  if (tile < 0 || tile >= static_cast<int>(tiles_.size())) {
+    return false;
+  }
+  // 与原图边界重合的tile边界不是切分边界
+  const auto& rect = tiles_[tile];
+  return (rect.x > 0 && x1 - rect.x < kSeamMargin) ||
+         (rect.y > 0 && y1 - rect.y < kSeamMargin) ||
+         (rect.x + rect.width < img_width_ &&
+          rect.x + rect.width - x2 < kSeamMargin) ||
+         (rect.y + rect.height < img_height_ &&
+          rect.y + rect.height - y2 < kSeamMargin);
+}
+
+size_t TileMerger::AddBox(int32_t output_index,
+                          int tile,
+                          float x1,
+                          float y1,
+                          float x2,
+                          float y2,
+                          float score) {
+  auto& boxes = boxes_[output_index];
+  boxes.push_back(
+      Box{x1, y1, x2, y2, score, tile, -1, IsTruncated(tile, x1, y1, x2, y2)});
+  return boxes.size() - 1;
+}
+
+std::vector<TileMerger::Point>& TileMerger::AddKps(int32_t output_index,
+                                                   size_t box_index) {
+  if (kps_num_ == kps_.size()) {
+    kps_.emplace_back();
+  }
+  boxes_[output_index][box_index].kps = static_cast<int>(kps_num_);
+  return kps_[kps_num_++];
+}
+
+void TileMerger::Merge(float iou_threshold) {
+  for (auto& boxes : boxes_) {
+    MergeBoxes(boxes.second, iou_threshold);
+  }
+}
+
+void TileMerger::MergeBoxes(std::vector<Box>& boxes, float iou_threshold) {
+  size_t box_num = boxes.size();
+  order_.resize(box_num);
+  areas_.resize(box_num);
+  suppressed_.assign(box_num, 0);
+  for (size_t idx = 0; idx < box_num; idx++) {
+    order_[idx] = idx;
+    areas_[idx] = (boxes[idx].x2 - boxes[idx].x1) *
+                  (boxes[idx].y2 - boxes[idx].y1);
+  }
+  std::stable_sort(order_.begin(), order_.end(), [&boxes](size_t a, size_t b) {
+    return boxes[a].score > boxes[b].score;
+  });
+
+  kept_.clear();
+  for (size_t pos = 0; pos < box_num; pos++) {
+    if (suppressed_[order_[pos]]) {
+      continue;
+    }
+    Box keep = boxes[order_[pos]];
+    float keep_area = areas_[order_[pos]];
+    for (size_t next = pos + 1; next < box_num; next++) {
+      size_t idx = order_[next];
+      if (suppressed_[idx]) {
+        continue;
+      }
+      const Box& other = boxes[idx];
+      float inter_w =
+          std::min(keep.x2, other.x2) - std::max(keep.x1, other.x1);
+      float inter_h =
+          std::min(keep.y2, other.y2) - std::max(keep.y1, other.y1);
+      if (inter_w <= 0 || inter_h <= 0) {
+        continue;
+      }
+      // 使用乘法比较，避免除法
+      float inter = inter_w * inter_h;
+      if (other.tile != keep.tile && (keep.truncated || other.truncated) &&
+          inter >= kSeamIosThreshold * std::min(keep_area, areas_[idx])) {
+        // 同一个目标被切分边界截断，合并为外接框
+        keep.x1 = std::min(keep.x1, other.x1);
+        keep.y1 = std::min(keep.y1, other.y1);
+        keep.x2 = std::max(keep.x2, other.x2);
+        keep.y2 = std::max(keep.y2, other.y2);
+        keep.truncated = keep.truncated && other.truncated;
+        if (keep.kps < 0) {
+          keep.kps = other.kps;
+        }
+        keep_area = (keep.x2 - keep.x1) * (keep.y2 - keep.y1);
+        suppressed_[idx] = 1;
+      } else if (inter >= iou_threshold * (keep_area + areas_[idx] - inter)) {
+        suppressed_[idx] = 1;
+      }
+    }
+    kept_.push_back(keep);
+  }
+  boxes.swap(kept_);
+}
+
+const std::vector<TileMerger::Box>& TileMerger::Boxes(
+    int32_t output_index) const {
+  static const std::vector<Box> empty_boxes;
+  auto iter = boxes_.find(output_index);
+  return iter == boxes_.end() ? empty_boxes : iter->second;
+}
+
+const std::vector<TileMerger::Point>& TileMerger::Kps(const Box& box) const {
+  if (box.kps < 0 || box.kps >= static_cast<int>(kps_num_)) {
+    return empty_kps_;
+  }
+  return kps_[box.kps];
+}
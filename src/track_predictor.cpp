@@ -0,0 +1,287 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include/track_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+const std::string TrackPredictor::kPredictedAttrType = "predicted";
+
+TrackPredictor::TrackPredictor(int max_interval,
+                               bool adaptive,
+                               std::string gate_roi_type)
+    : max_interval_(std::max(1, max_interval)),
+      adaptive_(adaptive),
+      gate_roi_type_(std::move(gate_roi_type)) {}
+
+void TrackPredictor::Update(const ai_msgs::msg::PerceptionTargets& msg,
+                            uint64_t time_stamp_ms,
+                            int img_width,
+                            int img_height) {
+  img_width_ = img_width;
+  img_height_ = img_height;
+  // 两次推理之间的时间换算为帧数，丢帧时帧数大于推理间隔
+  float dt = static_cast<float>(predicted_frames_ + 1);
+  if (last_time_stamp_ms_ > 0 && time_stamp_ms > last_time_stamp_ms_) {
+    float elapsed_ms = static_cast<float>(time_stamp_ms - last_time_stamp_ms_);
+    float frame_gap_ms = elapsed_ms / (predicted_frames_ + 1);
+    frame_gap_ms_ = frame_gap_ms_ > 0
+                        ? 0.8f * frame_gap_ms_ + 0.2f * frame_gap_ms
+                        : frame_gap_ms;
+    dt = elapsed_ms / frame_gap_ms_;
+  }
+
+  for (auto& track : tracks_) {
+    track.updated = false;
+  }
+  for (const auto& target : msg.targets) {
+    if (target.rois.empty()) {
+      continue;
+    }
+    const auto& roi = target.rois.front();
+    if (roi.rect.width == 0 || roi.rect.height == 0) {
+      continue;
+    }
+    float measure[kDim] = {roi.rect.x_offset + roi.rect.width / 2.0f,
+                           roi.rect.y_offset + roi.rect.height / 2.0f,
+                           static_cast<float>(roi.rect.width),
+                           static_cast<float>(roi.rect.height)};
+    Track* track = FindTrack(target.track_id, roi.type);
+    if (track) {
+      PredictTrack(*track, dt);
+      UpdateTrack(*track, measure);
+    } else {
+      tracks_.emplace_back();
+      track = &tracks_.back();
+      track->track_id = target.track_id;
+      track->target_type = target.type;
+      track->roi_type = roi.type;
+      InitTrack(*track, measure);
+    }
+    track->hits++;
+    track->updated = true;
+    SavePoints(*track, target);
+    SavePartRois(*track, target);
+  }
+  // 跟踪没有输出的轨迹（不可见或者已经消失）不再预测
+  tracks_.erase(std::remove_if(tracks_.begin(),
+                               tracks_.end(),
+                               [](const Track& track) {
+                                 return !track.updated;
+                               }),
+                tracks_.end());
+
+  last_time_stamp_ms_ = time_stamp_ms;
+  predicted_frames_ = 0;
+  ComputeNextInterval();
+}
+
+void TrackPredictor::Predict(uint64_t time_stamp_ms,
+                             ai_msgs::msg::PerceptionTargets& msg) {
+  predicted_frames_++;
+  float dt = static_cast<float>(predicted_frames_);
+  if (frame_gap_ms_ > 0 && time_stamp_ms > last_time_stamp_ms_) {
+    dt = (time_stamp_ms - last_time_stamp_ms_) / frame_gap_ms_;
+  }
+
+  for (const auto& track : tracks_) {
+    float center_x = track.pos[0] + track.vel[0] * dt;
+    float center_y = track.pos[1] + track.vel[1] * dt;
+    float width = std::max(1.0f, track.pos[2] + track.vel[2] * dt);
+    float height = std::max(1.0f, track.pos[3] + track.vel[3] * dt);
+    float left = std::max(0.0f, center_x - width / 2);
+    float top = std::max(0.0f, center_y - height / 2);
+    float right =
+        std::min(static_cast<float>(img_width_), center_x + width / 2);
+    float bottom =
+        std::min(static_cast<float>(img_height_), center_y + height / 2);
+    // 预测位置已经移出图像
+    if (right - left < 1 || bottom - top < 1) {
+      continue;
+    }
+
+    msg.targets.emplace_back();
+    auto& target = msg.targets.back();
+    target.set__type(track.target_type);
+    target.set__track_id(track.track_id);
+    target.rois.emplace_back();
+    auto& roi = target.rois.back();
+    roi.set__type(track.roi_type);
+    roi.rect.set__x_offset(static_cast<uint32_t>(left));
+    roi.rect.set__y_offset(static_cast<uint32_t>(top));
+    roi.rect.set__width(static_cast<uint32_t>(right - left));
+    roi.rect.set__height(static_cast<uint32_t>(bottom - top));
+    for (const auto& part_roi : track.part_rois) {
+      float part_left = std::max(0.0f, center_x + part_roi.box[0] * width);
+      float part_top = std::max(0.0f, center_y + part_roi.box[1] * height);
+      float part_right = std::min(static_cast<float>(img_width_),
+                                  center_x + part_roi.box[2] * width);
+      float part_bottom = std::min(static_cast<float>(img_height_),
+                                   center_y + part_roi.box[3] * height);
+      if (part_right - part_left < 1 || part_bottom - part_top < 1) {
+        continue;
+      }
+      target.rois.emplace_back();
+      auto& part = target.rois.back();
+      part.set__type(part_roi.type);
+      part.rect.set__x_offset(static_cast<uint32_t>(part_left));
+      part.rect.set__y_offset(static_cast<uint32_t>(part_top));
+      part.rect.set__width(static_cast<uint32_t>(part_right - part_left));
+      part.rect.set__height(static_cast<uint32_t>(part_bottom - part_top));
+    }
+    target.attributes.emplace_back();
+    target.attributes.back().set__type(kPredictedAttrType);
+    target.attributes.back().set__value(static_cast<float>(predicted_frames_));
+
+    target.points = track.points;
+    for (auto& points : target.points) {
+      for (auto& point : points.point) {
+        point.x = center_x + point.x * width;
+        point.y = center_y + point.y * height;
+      }
+    }
+  }
+}
+
+TrackPredictor::Track* TrackPredictor::FindTrack(uint64_t track_id,
+                                                 const std::string& roi_type) {
+  for (auto& track : tracks_) {
+    if (track.track_id == track_id && track.roi_type == roi_type) {
+      return &track;
+    }
+  }
+  return nullptr;
+}
+
+void TrackPredictor::InitTrack(Track& track, const float* measure) {
+  // 与内置跟踪的初始化保持一致，噪声与目标高度成正比
+  float std_pos = measure[3] / 10;
+  float std_vel = measure[3] / 16;
+  for (int dim = 0; dim < kDim; dim++) {
+    track.pos[dim] = measure[dim];
+    track.vel[dim] = 0;
+    track.cov_pp[dim] = std_pos * std_pos;
+    track.cov_pv[dim] = 0;
+    track.cov_vv[dim] = std_vel * std_vel;
+  }
+}
+
+void TrackPredictor::PredictTrack(Track& track, float dt) const {
+  float std_pos = track.pos[3] / 20;
+  float std_vel = track.pos[3] / 160;
+  for (int dim = 0; dim < kDim; dim++) {
+    track.pos[dim] += track.vel[dim] * dt;
+    track.cov_pp[dim] += dt * (2 * track.cov_pv[dim] + dt * track.cov_vv[dim]) +
+                         std_pos * std_pos * dt;
+    track.cov_pv[dim] += dt * track.cov_vv[dim];
+    track.cov_vv[dim] += std_vel * std_vel * dt;
+  }
+}
+
+void TrackPredictor::UpdateTrack(Track& track, const float* measure) const {
+  float std_measure = measure[3] / 20;
+  float noise = std_measure * std_measure;
+  for (int dim = 0; dim < kDim; dim++) {
+    float cov_pp = track.cov_pp[dim];
+    float cov_pv = track.cov_pv[dim];
+    float innovation_cov = cov_pp + noise;
+    if (innovation_cov <= 0) {
+      track.pos[dim] = measure[dim];
+      continue;
+    }
+    float gain_pos = cov_pp / innovation_cov;
+    float gain_vel = cov_pv / innovation_cov;
+    float residual = measure[dim] - track.pos[dim];
+    track.pos[dim] += gain_pos * residual;
+    track.vel[dim] += gain_vel * residual;
+    track.cov_pp[dim] = (1 - gain_pos) * cov_pp;
+    track.cov_pv[dim] = (1 - gain_pos) * cov_pv;
+    track.cov_vv[dim] -= gain_vel * cov_pv;
+  }
+}
+
+void TrackPredictor::SavePoints(Track& track,
+                                const ai_msgs::msg::Target& target) const {
+  track.points = target.points;
+  const auto& rect = target.rois.front().rect;
+  float center_x = rect.x_offset + rect.width / 2.0f;
+  float center_y = rect.y_offset + rect.height / 2.0f;
+  for (auto& points : track.points) {
+    for (auto& point : points.point) {
+      point.x = (point.x - center_x) / rect.width;
+      point.y = (point.y - center_y) / rect.height;
+    }
+  }
+}
+
+int TrackPredictor::TrackInterval(const Track& track) const {
+  if (track.hits < kMinHits) {
+    return 1;
+  }
+  float height = std::max(1.0f, track.pos[3]);
+  float max_shift = kMaxShiftRatio * height;
+  float max_var = kMaxStdRatio * kMaxStdRatio * height * height;
+  float std_pos = height / 20;
+  float speed = std::sqrt(track.vel[0] * track.vel[0] +
+                          track.vel[1] * track.vel[1]);
+  for (int frames = 1; frames < max_interval_; frames++) {
+    float dt = static_cast<float>(frames);
+    if (speed * dt > max_shift) {
+      return frames;
+    }
+    // 中心点x和y方向中较大的预测方差
+    for (int dim = 0; dim < 2; dim++) {
+      float var = track.cov_pp[dim] +
+                  dt * (2 * track.cov_pv[dim] + dt * track.cov_vv[dim]) +
+                  std_pos * std_pos * dt;
+      if (var > max_var) {
+        return frames;
+      }
+    }
+  }
+  return max_interval_;
+}
+
+void TrackPredictor::ComputeNextInterval() {
+  next_interval_ = max_interval_;
+  if (!adaptive_) {
+    return;
+  }
+  for (const auto& track : tracks_) {
+    if (track.roi_type == gate_roi_type_) {
+      next_interval_ = std::min(next_interval_, TrackInterval(track));
+    }
+  }
+}
+
+void TrackPredictor::SavePartRois(Track& track,
+                                  const ai_msgs::msg::Target& target) const {
+  const auto& rect = target.rois.front().rect;
+  float center_x = rect.x_offset + rect.width / 2.0f;
+  float center_y = rect.y_offset + rect.height / 2.0f;
+  track.part_rois.resize(target.rois.size() - 1);
+  for (size_t idx = 1; idx < target.rois.size(); idx++) {
+    const auto& part = target.rois[idx];
+    auto& part_roi = track.part_rois[idx - 1];
+    part_roi.type = part.type;
+    part_roi.box[0] = (part.rect.x_offset - center_x) / rect.width;
+    part_roi.box[1] = (part.rect.y_offset - center_y) / rect.height;
+    part_roi.box[2] =
+        (part.rect.x_offset + part.rect.width - center_x) / rect.width;
+    part_roi.box[3] =
+        (part.rect.y_offset + part.rect.height - center_y) / rect.height;
+  }
+}
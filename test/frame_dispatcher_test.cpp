@@ -0,0 +1,146 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "include/admission_controller.h"
+#include "include/frame_dispatcher.h"
+#include "include/motion_gate.h"
+#include "include/output_reorder_buffer.h"
+
+// 每N帧推理一次、画面没有运动时重复发布或者丢弃，以及两者同时打开时每一帧的处理方式，
+// 需要发布的帧按照收到的顺序注册连续的序号，丢弃的帧不注册
+
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 32;
+constexpr size_t kCacheSize = 64;
+constexpr uint64_t kReorderTimeoutMs = 1000;
+
+using Action = FrameDispatcher::Action;
+
+class FrameDispatcherTest : public testing::Test {
+ protected:
+  void CreateDispatcher(bool predict,
+                        std::shared_ptr<MotionGate> motion_gate,
+                        bool republish) {
+    buffer_ =
+        std::make_shared<OutputReorderBuffer>(kCacheSize, kReorderTimeoutMs);
+    admission_controller_ = std::make_shared<AdmissionController>(
+        AdmissionController::Mode::ALL, 1);
+    dispatcher_ = std::make_shared<FrameDispatcher>(buffer_,
+                                                    admission_controller_,
+                                                    predict,
+                                                    std::move(motion_gate),
+                                                    republish,
+                                                    nullptr);
+  }
+
+  // 分发一帧，需要注册的帧检查序号连续
+  Action Dispatch(const FrameDispatcher::LumaPlane& luma) {
+    uint64_t seq = UINT64_MAX;
+    Action action = dispatcher_->Dispatch(luma, seq);
+    if (action != Action::DROP) {
+      EXPECT_EQ(next_seq_, seq);
+      next_seq_++;
+    }
+    return action;
+  }
+
+  // 静止场景，每帧的亮度相同
+  FrameDispatcher::LumaPlane StaticLuma() {
+    FrameDispatcher::LumaPlane luma;
+    luma.data = luma_.data();
+    luma.pixel_stride = 1;
+    luma.step = kWidth;
+    luma.height = kHeight;
+    luma.width = kWidth;
+    return luma;
+  }
+
+  std::vector<uint8_t> luma_ =
+      std::vector<uint8_t>(static_cast<size_t>(kWidth) * kHeight, 100);
+  std::shared_ptr<OutputReorderBuffer> buffer_;
+  std::shared_ptr<AdmissionController> admission_controller_;
+  std::shared_ptr<FrameDispatcher> dispatcher_;
+  uint64_t next_seq_ = 0;
+};
+
+}  // namespace
+
+TEST_F(FrameDispatcherTest, PredictBetweenDetections) {
+  CreateDispatcher(true, nullptr, false);
+  dispatcher_->SetDetectInterval(3);
+  FrameDispatcher::LumaPlane luma;
+  // 每3帧的最后一帧推理
+  for (int idx = 0; idx < 9; idx++) {
+    EXPECT_EQ(idx % 3 == 2 ? Action::INFER : Action::PREDICT, Dispatch(luma));
+  }
+  EXPECT_EQ(6u, dispatcher_->GetStats().predicted);
+  EXPECT_EQ(3u, admission_controller_->GetStats().admitted);
+
+  // 间隔缩短为1之后每帧都推理
+  dispatcher_->SetDetectInterval(1);
+  for (int idx = 0; idx < 3; idx++) {
+    EXPECT_EQ(Action::INFER, Dispatch(luma));
+  }
+  EXPECT_EQ(6u, dispatcher_->GetStats().predicted);
+  EXPECT_EQ(12u, buffer_->GetStats().registered);
+}
+
+TEST_F(FrameDispatcherTest, StaticSceneDrop) {
+  auto motion_gate = std::make_shared<MotionGate>(0.02f);
+  CreateDispatcher(false, motion_gate, false);
+  // 第一帧推理，之后画面没有运动的帧不发布也不注册
+  EXPECT_EQ(Action::INFER, Dispatch(StaticLuma()));
+  for (int idx = 0; idx < 5; idx++) {
+    EXPECT_EQ(Action::DROP, Dispatch(StaticLuma()));
+  }
+  EXPECT_EQ(1u, buffer_->GetStats().registered);
+  EXPECT_EQ(1u, admission_controller_->GetStats().admitted);
+  EXPECT_EQ(5u, motion_gate->GetStats().skipped);
+}
+
+TEST_F(FrameDispatcherTest, PredictBeforeMotionGate) {
+  auto motion_gate = std::make_shared<MotionGate>(0.02f);
+  CreateDispatcher(true, motion_gate, true);
+  dispatcher_->SetDetectInterval(2);
+  // 跳过推理的帧不判断运动，推理帧画面没有运动时重复发布
+  EXPECT_EQ(Action::PREDICT, Dispatch(StaticLuma()));
+  EXPECT_EQ(Action::INFER, Dispatch(StaticLuma()));
+  EXPECT_EQ(Action::PREDICT, Dispatch(StaticLuma()));
+  EXPECT_EQ(Action::REPUBLISH, Dispatch(StaticLuma()));
+  // 重复发布不算一次推理，下一帧继续尝试推理
+  EXPECT_EQ(Action::REPUBLISH, Dispatch(StaticLuma()));
+  EXPECT_EQ(3u, motion_gate->GetStats().checked);
+  EXPECT_EQ(2u, dispatcher_->GetStats().predicted);
+  EXPECT_EQ(5u, buffer_->GetStats().registered);
+}
+
+TEST_F(FrameDispatcherTest, UnreadableLumaAlwaysInfers) {
+  auto motion_gate = std::make_shared<MotionGate>(0.02f);
+  CreateDispatcher(false, motion_gate, true);
+  // 不能直接读取亮度的格式不判断运动
+  FrameDispatcher::LumaPlane luma;
+  for (int idx = 0; idx < 3; idx++) {
+    EXPECT_EQ(Action::INFER, Dispatch(luma));
+  }
+  EXPECT_EQ(0u, motion_gate->GetStats().checked);
+}
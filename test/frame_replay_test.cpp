@@ -0,0 +1,125 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/frame_replay.h"
+
+// 录制文件：后台线程按照放入队列的顺序写入，回放读取到相同的帧；
+// 格式（encoding、宽高、step）与第一帧不一致的帧不写入
+
+namespace {
+
+constexpr int kWidth = 6;
+constexpr int kHeight = 4;
+// 每行带有padding
+constexpr int kStep = kWidth * 3 + 2;
+
+std::string TempFileName() {
+  return testing::TempDir() + "frame_replay_test_" +
+         std::to_string(getpid()) + ".rply";
+}
+
+std::shared_ptr<std::vector<uint8_t>> MakeFrame(uint8_t val, int step) {
+  return std::make_shared<std::vector<uint8_t>>(
+      static_cast<size_t>(kHeight) * step, val);
+}
+
+frame_replay::RecordFile::PendingFrame MakePending(
+    uint64_t timestamp_ns, const std::shared_ptr<std::vector<uint8_t>>& data,
+    int step) {
+  frame_replay::RecordFile::PendingFrame frame;
+  frame.holder = data;
+  frame.timestamp_ns = timestamp_ns;
+  frame.encoding = "bgr8";
+  frame.width = kWidth;
+  frame.height = kHeight;
+  frame.step = step;
+  frame.data = data->data();
+  frame.data_size = static_cast<uint32_t>(data->size());
+  return frame;
+}
+
+}  // namespace
+
+TEST(FrameReplayTest, AsyncRecordAndReplay) {
+  auto file_name = TempFileName();
+  constexpr int kFrames = 20;
+  {
+    frame_replay::RecordFile record_file;
+    ASSERT_EQ(0, record_file.Open(file_name, kFrames));
+    for (int idx = 0; idx < kFrames; idx++) {
+      // 放入队列后调用方不再持有数据，由队列中的holder保证写入之前有效
+      EXPECT_TRUE(record_file.Push(
+          MakePending(idx * 1000, MakeFrame(static_cast<uint8_t>(idx), kStep),
+                      kStep)));
+    }
+    record_file.Close();
+    EXPECT_EQ(0u, record_file.Dropped());
+    EXPECT_EQ(0u, record_file.Failed());
+  }
+
+  frame_replay::ReplayFile replay_file;
+  ASSERT_EQ(0, replay_file.Open(file_name));
+  EXPECT_EQ("bgr8", replay_file.Encoding());
+  EXPECT_EQ(kWidth, replay_file.Width());
+  EXPECT_EQ(kHeight, replay_file.Height());
+  EXPECT_EQ(kStep, replay_file.Step());
+  const auto& frames = replay_file.Frames();
+  ASSERT_EQ(static_cast<size_t>(kFrames), frames.size());
+  for (int idx = 0; idx < kFrames; idx++) {
+    EXPECT_EQ(static_cast<uint64_t>(idx * 1000), frames[idx].timestamp_ns);
+    ASSERT_EQ(static_cast<uint32_t>(kHeight * kStep), frames[idx].data_size);
+    EXPECT_EQ(idx, frames[idx].data[0]);
+    EXPECT_EQ(idx, frames[idx].data[frames[idx].data_size - 1]);
+  }
+  std::remove(file_name.c_str());
+}
+
+TEST(FrameReplayTest, RejectsStepChange) {
+  auto file_name = TempFileName();
+  {
+    frame_replay::RecordFile record_file;
+    ASSERT_EQ(0, record_file.Open(file_name));
+    auto first = MakeFrame(1, kStep);
+    EXPECT_EQ(0,
+              record_file.Write(0, "bgr8", kWidth, kHeight, kStep,
+                                first->data(),
+                                static_cast<uint32_t>(first->size())));
+    // 宽高相同，step不同
+    auto second = MakeFrame(2, kWidth * 3);
+    EXPECT_EQ(-1,
+              record_file.Write(1, "bgr8", kWidth, kHeight, kWidth * 3,
+                                second->data(),
+                                static_cast<uint32_t>(second->size())));
+    // 没有启动后台写入线程时不能放入队列
+    EXPECT_FALSE(record_file.Push(MakePending(2, first, kStep)));
+    EXPECT_EQ(1u, record_file.Dropped());
+    record_file.Close();
+  }
+
+  frame_replay::ReplayFile replay_file;
+  ASSERT_EQ(0, replay_file.Open(file_name));
+  EXPECT_EQ(kStep, replay_file.Step());
+  ASSERT_EQ(1u, replay_file.Frames().size());
+  EXPECT_EQ(1, replay_file.Frames()[0].data[0]);
+  std::remove(file_name.c_str());
+}
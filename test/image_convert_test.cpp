@@ -0,0 +1,211 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "include/image_convert.h"
+#include "opencv2/imgproc.hpp"
+#include "test/image_test_utils.h"
+
+// 缩放和格式转换kernel的正确性：加速版本（NEON/SSE2）与标量参考实现逐像素一致，
+// 与cv::resize INTER_LINEAR + cv::cvtColor的结果在容差范围内一致
+// 覆盖rgb8/bgr8/yuyv/uyvy/mono8，输入宽高覆盖奇数，输入和输出都带有额外的stride
+
+namespace {
+
+using image_test::InputFormat;
+using image_test::MakeImage;
+using image_test::Nv12View;
+
+// 输入每行和输出每行额外的字节数
+constexpr int kSrcPadding = 5;
+constexpr int kDstPadding = 16;
+
+struct ResizeCase {
+  int src_h;
+  int src_w;
+  int dst_h;
+  int dst_w;
+};
+
+const ResizeCase kResizeCases[] = {
+    {361, 641, 224, 320},
+    {37, 53, 20, 30},
+    {5, 7, 4, 4},
+    {481, 645, 544, 960},
+    {99, 101, 98, 100},
+};
+
+// 带有stride的nv12输出
+struct Nv12Image {
+  Nv12Image(int h, int w)
+      : height(h),
+        width(w),
+        stride(w + kDstPadding),
+        y(static_cast<size_t>(h) * stride, 0),
+        uv(static_cast<size_t>(h / 2) * stride, 0) {}
+
+  Nv12View View() const {
+    Nv12View view;
+    view.y = y.data();
+    view.y_stride = stride;
+    view.uv = uv.data();
+    view.uv_stride = stride;
+    view.height = height;
+    view.width = width;
+    return view;
+  }
+
+  int height;
+  int width;
+  int stride;
+  std::vector<uint8_t> y;
+  std::vector<uint8_t> uv;
+};
+
+int32_t ConvertToNv12(InputFormat format,
+                      bool is_ref,
+                      const uint8_t* src,
+                      int src_h,
+                      int src_w,
+                      int src_step,
+                      Nv12Image& dst) {
+  switch (format) {
+    case InputFormat::BGR8:
+    case InputFormat::RGB8: {
+      auto convert = is_ref ? ImageConvert::RGBToNv12ResizeRef
+                            : ImageConvert::RGBToNv12Resize;
+      return convert(src,
+                     src_h,
+                     src_w,
+                     src_step,
+                     format == InputFormat::BGR8,
+                     dst.y.data(),
+                     dst.stride,
+                     dst.uv.data(),
+                     dst.stride,
+                     dst.height,
+                     dst.width);
+    }
+    case InputFormat::YUYV:
+    case InputFormat::UYVY: {
+      auto convert = is_ref ? ImageConvert::Yuv422ToNv12ResizeRef
+                            : ImageConvert::Yuv422ToNv12Resize;
+      return convert(src,
+                     src_h,
+                     src_w,
+                     src_step,
+                     format == InputFormat::UYVY,
+                     dst.y.data(),
+                     dst.stride,
+                     dst.uv.data(),
+                     dst.stride,
+                     dst.height,
+                     dst.width);
+    }
+    default: {
+      auto convert = is_ref ? ImageConvert::GrayToNv12ResizeRef
+                            : ImageConvert::GrayToNv12Resize;
+      return convert(src,
+                     src_h,
+                     src_w,
+                     src_step,
+                     dst.y.data(),
+                     dst.stride,
+                     dst.uv.data(),
+                     dst.stride,
+                     dst.height,
+                     dst.width);
+    }
+  }
+}
+
+void TestToNv12Resize(InputFormat format) {
+  uint32_t seed = 1;
+  for (const auto& test_case : kResizeCases) {
+    int src_w = image_test::AlignWidth(format, test_case.src_w);
+    SCOPED_TRACE(testing::Message()
+                 << "src: " << src_w << "x" << test_case.src_h
+                 << ", dst: " << test_case.dst_w << "x" << test_case.dst_h);
+    int src_step = src_w * image_test::BytesPerPixel(format) + kSrcPadding;
+    auto src = MakeImage(test_case.src_h, src_step, seed++);
+    Nv12Image accel(test_case.dst_h, test_case.dst_w);
+    Nv12Image ref(test_case.dst_h, test_case.dst_w);
+    ASSERT_EQ(0,
+              ConvertToNv12(format,
+                            false,
+                            src.data(),
+                            test_case.src_h,
+                            src_w,
+                            src_step,
+                            accel));
+    ASSERT_EQ(0,
+              ConvertToNv12(format,
+                            true,
+                            src.data(),
+                            test_case.src_h,
+                            src_w,
+                            src_step,
+                            ref));
+    image_test::ExpectSameNv12(ref.View(), accel.View());
+
+    auto cv_ref = image_test::MakeReference(format,
+                                            src.data(),
+                                            test_case.src_h,
+                                            src_w,
+                                            src_step,
+                                            test_case.dst_h,
+                                            test_case.dst_w,
+                                            cv::INTER_LINEAR);
+    image_test::ExpectNearReference(cv_ref, accel.View());
+  }
+}
+
+}  // namespace
+
+TEST(ImageConvertTest, BGRToNv12Resize) { TestToNv12Resize(InputFormat::BGR8); }
+
+TEST(ImageConvertTest, RGBToNv12Resize) { TestToNv12Resize(InputFormat::RGB8); }
+
+TEST(ImageConvertTest, YUYVToNv12Resize) {
+  TestToNv12Resize(InputFormat::YUYV);
+}
+
+TEST(ImageConvertTest, UYVYToNv12Resize) {
+  TestToNv12Resize(InputFormat::UYVY);
+}
+
+TEST(ImageConvertTest, GrayToNv12Resize) {
+  TestToNv12Resize(InputFormat::MONO8);
+}
+
+TEST(ImageConvertTest, RGBToNv12ResizeRejectsOddOutput) {
+  auto src = MakeImage(8, 8 * 3, 1);
+  Nv12Image dst(8, 8);
+  EXPECT_EQ(-1,
+            ImageConvert::RGBToNv12Resize(src.data(),
+                                          8,
+                                          8,
+                                          8 * 3,
+                                          true,
+                                          dst.y.data(),
+                                          dst.stride,
+                                          dst.uv.data(),
+                                          dst.stride,
+                                          7,
+                                          8));
+}
@@ -0,0 +1,232 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MONO2D_DET_TEST_IMAGE_TEST_UTILS_H
+#define MONO2D_DET_TEST_IMAGE_TEST_UTILS_H
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "opencv2/core/mat.hpp"
+#include "opencv2/imgproc.hpp"
+
+// image_convert_test和image_utils_test共用的输入图片生成和opencv参考结果
+
+namespace image_test {
+
+// kernel使用8bit定点插值权重，opencv使用11bit，y和uv的最大允许误差
+constexpr int kYTolerance = 2;
+constexpr int kUVTolerance = 3;
+
+enum class InputFormat { BGR8, RGB8, YUYV, UYVY, MONO8 };
+
+inline int BytesPerPixel(InputFormat format) {
+  switch (format) {
+    case InputFormat::BGR8:
+    case InputFormat::RGB8:
+      return 3;
+    case InputFormat::YUYV:
+    case InputFormat::UYVY:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+// packed yuv422的宽度必须是偶数
+inline int AlignWidth(InputFormat format, int width) {
+  return BytesPerPixel(format) == 2 ? width & ~1 : width;
+}
+
+// 随机噪声图片，每行末尾的padding也填充随机数，读取越界时结果会不一致
+inline std::vector<uint8_t> MakeImage(int height, int step, uint32_t seed) {
+  std::vector<uint8_t> data(static_cast<size_t>(height) * step);
+  for (auto& val : data) {
+    seed = seed * 1103515245 + 12345;
+    val = static_cast<uint8_t>(seed >> 24);
+  }
+  return data;
+}
+
+// 平滑变化的图片，区域均值缩放的积分区间与opencv的小数权重不同，
+// 只有在平滑的图片上结果才接近
+inline std::vector<uint8_t> MakeSmoothImage(int height, int step, int seed) {
+  std::vector<uint8_t> data(static_cast<size_t>(height) * step);
+  for (int row = 0; row < height; row++) {
+    for (int col = 0; col < step; col++) {
+      double val = std::sin(col / (97.0 + seed)) * 50 +
+                   std::cos(row / (83.0 + seed)) * 50 + 128;
+      data[static_cast<size_t>(row) * step + col] =
+          static_cast<uint8_t>(std::min(255.0, std::max(0.0, val)));
+    }
+  }
+  return data;
+}
+
+// 带有stride的nv12图片，可以指向pyramid中的一个区域
+struct Nv12View {
+  const uint8_t* y = nullptr;
+  int y_stride = 0;
+  const uint8_t* uv = nullptr;
+  int uv_stride = 0;
+  int height = 0;
+  int width = 0;
+
+  uint8_t Y(int row, int col) const {
+    return y[static_cast<size_t>(row) * y_stride + col];
+  }
+  uint8_t UV(int row, int col) const {
+    return uv[static_cast<size_t>(row) * uv_stride + col];
+  }
+};
+
+inline void ExpectSameNv12(const Nv12View& expected, const Nv12View& actual) {
+  for (int row = 0; row < expected.height; row++) {
+    for (int col = 0; col < expected.width; col++) {
+      ASSERT_EQ(expected.Y(row, col), actual.Y(row, col))
+          << "y row: " << row << ", col: " << col;
+    }
+  }
+  for (int row = 0; row < expected.height / 2; row++) {
+    for (int col = 0; col < expected.width; col++) {
+      ASSERT_EQ(expected.UV(row, col), actual.UV(row, col))
+          << "uv row: " << row << ", col: " << col;
+    }
+  }
+}
+
+// opencv计算的参考结果，u和v的宽高为y的一半
+struct Nv12Reference {
+  cv::Mat y;
+  cv::Mat u;
+  cv::Mat v;
+};
+
+// rgb：cv::resize后转换为i420
+// cvtColor的色度不是取2x2块的均值，先把每个2x2块替换为块内均值再计算色度，
+// 与kernel的色度下采样方式一致
+inline Nv12Reference ReferenceFromRGB(const cv::Mat& resized, bool is_bgr) {
+  int height = resized.rows;
+  int width = resized.cols;
+  int color_code = is_bgr ? cv::COLOR_BGR2YUV_I420 : cv::COLOR_RGB2YUV_I420;
+  cv::Mat yuv;
+  cv::cvtColor(resized, yuv, color_code);
+  cv::Mat block_mean;
+  cv::resize(resized,
+             block_mean,
+             cv::Size(width / 2, height / 2),
+             0,
+             0,
+             cv::INTER_AREA);
+  cv::resize(block_mean,
+             block_mean,
+             cv::Size(width, height),
+             0,
+             0,
+             cv::INTER_NEAREST);
+  cv::Mat block_yuv;
+  cv::cvtColor(block_mean, block_yuv, color_code);
+  uint8_t* u_plane = block_yuv.data + static_cast<size_t>(height) * width;
+  uint8_t* v_plane = u_plane + static_cast<size_t>(height / 2) * width / 2;
+
+  Nv12Reference ref;
+  ref.y = cv::Mat(height, width, CV_8UC1, yuv.data).clone();
+  ref.u = cv::Mat(height / 2, width / 2, CV_8UC1, u_plane).clone();
+  ref.v = cv::Mat(height / 2, width / 2, CV_8UC1, v_plane).clone();
+  return ref;
+}
+
+// 输入图片左上src_h x src_w的区域按照interpolation缩放到dst_h x dst_w的参考结果
+// packed yuv422的y、u、v分别在各自的分辨率上缩放，mono8的uv为128
+inline Nv12Reference MakeReference(InputFormat format,
+                                   const uint8_t* src,
+                                   int src_h,
+                                   int src_w,
+                                   int src_step,
+                                   int dst_h,
+                                   int dst_w,
+                                   int interpolation) {
+  auto* data = const_cast<uint8_t*>(src);
+  cv::Size dst_size(dst_w, dst_h);
+  Nv12Reference ref;
+  if (format == InputFormat::BGR8 || format == InputFormat::RGB8) {
+    cv::Mat src_mat(src_h, src_w, CV_8UC3, data, src_step);
+    cv::Mat resized;
+    cv::resize(src_mat, resized, dst_size, 0, 0, interpolation);
+    return ReferenceFromRGB(resized, format == InputFormat::BGR8);
+  }
+  if (format == InputFormat::YUYV || format == InputFormat::UYVY) {
+    bool is_uyvy = format == InputFormat::UYVY;
+    int y_off = is_uyvy ? 1 : 0;
+    int u_off = is_uyvy ? 0 : 1;
+    int v_off = is_uyvy ? 2 : 3;
+    cv::Mat y(src_h, src_w, CV_8UC1);
+    cv::Mat u(src_h, src_w / 2, CV_8UC1);
+    cv::Mat v(src_h, src_w / 2, CV_8UC1);
+    for (int row = 0; row < src_h; row++) {
+      const uint8_t* line = src + static_cast<size_t>(row) * src_step;
+      for (int col = 0; col < src_w; col++) {
+        y.at<uint8_t>(row, col) = line[2 * col + y_off];
+      }
+      for (int col = 0; col < src_w / 2; col++) {
+        u.at<uint8_t>(row, col) = line[4 * col + u_off];
+        v.at<uint8_t>(row, col) = line[4 * col + v_off];
+      }
+    }
+    cv::Size uv_size(dst_w / 2, dst_h / 2);
+    cv::resize(y, ref.y, dst_size, 0, 0, interpolation);
+    cv::resize(u, ref.u, uv_size, 0, 0, interpolation);
+    cv::resize(v, ref.v, uv_size, 0, 0, interpolation);
+    return ref;
+  }
+  cv::Mat src_mat(src_h, src_w, CV_8UC1, data, src_step);
+  cv::Mat resized;
+  cv::resize(src_mat, resized, dst_size, 0, 0, interpolation);
+  cv::Mat bgr;
+  cv::cvtColor(resized, bgr, cv::COLOR_GRAY2BGR);
+  ref = ReferenceFromRGB(bgr, true);
+  ref.u = cv::Mat(dst_h / 2, dst_w / 2, CV_8UC1, cv::Scalar(128));
+  ref.v = cv::Mat(dst_h / 2, dst_w / 2, CV_8UC1, cv::Scalar(128));
+  return ref;
+}
+
+inline void ExpectNearReference(const Nv12Reference& ref,
+                                const Nv12View& actual) {
+  for (int row = 0; row < actual.height; row++) {
+    for (int col = 0; col < actual.width; col++) {
+      ASSERT_NEAR(ref.y.at<uint8_t>(row, col), actual.Y(row, col), kYTolerance)
+          << "y row: " << row << ", col: " << col;
+    }
+  }
+  for (int row = 0; row < actual.height / 2; row++) {
+    for (int col = 0; col < actual.width / 2; col++) {
+      ASSERT_NEAR(ref.u.at<uint8_t>(row, col),
+                  actual.UV(row, 2 * col),
+                  kUVTolerance)
+          << "u row: " << row << ", col: " << col;
+      ASSERT_NEAR(ref.v.at<uint8_t>(row, col),
+                  actual.UV(row, 2 * col + 1),
+                  kUVTolerance)
+          << "v row: " << row << ", col: " << col;
+    }
+  }
+}
+
+}  // namespace image_test
+
+#endif  // MONO2D_DET_TEST_IMAGE_TEST_UTILS_H
@@ -0,0 +1,278 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "include/image_utils.h"
+#include "include/nv12_pyramid_pool.h"
+#include "test/image_test_utils.h"
+
+// rgb8/bgr8/yuyv/uyvy/mono8直接写入pyramid的路径：每种resize_type（可选letterbox）
+// 写入的区域与opencv的参考结果在容差范围内一致，区域之外填充黑色，
+// 不残留缓存池中上一帧的数据
+
+namespace {
+
+using image_test::InputFormat;
+using image_test::Nv12View;
+
+constexpr int kModelInputHeight = 224;
+constexpr int kModelInputWidth = 320;
+constexpr int kSrcPadding = 5;
+// letterbox填充区域使用的黑色
+constexpr uint8_t kPaddingY = 16;
+constexpr uint8_t kPaddingUV = 128;
+// 缓存池中残留的数据
+constexpr uint8_t kStaleValue = 0xAA;
+
+struct SrcSize {
+  int height;
+  int width;
+};
+
+// 缩小（奇数宽高、整数倍）、放大，以及crop时原图大于和小于模型输入
+const SrcSize kSrcSizes[] = {
+    {361, 641},
+    {720, 1280},
+    {99, 101},
+    {481, 645},
+};
+
+const ImageResizeType kResizeTypes[] = {
+    ImageResizeType::CROP, ImageResizeType::BILINEAR, ImageResizeType::AREA};
+
+// 把缓存池中模型输入尺寸的pyramid写满残留数据
+void DirtyPool() {
+  auto pyramid = NV12PyramidPool::Instance()->Acquire(kModelInputHeight,
+                                                      kModelInputWidth);
+  ASSERT_TRUE(pyramid);
+  memset(pyramid->y_vir_addr,
+         kStaleValue,
+         static_cast<size_t>(pyramid->y_stride) * kModelInputHeight);
+  memset(pyramid->uv_vir_addr,
+         kStaleValue,
+         static_cast<size_t>(pyramid->uv_stride) * kModelInputHeight / 2);
+}
+
+std::shared_ptr<NV12PyramidInput> GetPyramid(InputFormat format,
+                                             const std::vector<uint8_t>& src,
+                                             int src_h,
+                                             int src_w,
+                                             int src_step,
+                                             ImageResizeType resize_type,
+                                             bool is_letterbox,
+                                             ImageTransform* transform) {
+  switch (format) {
+    case InputFormat::BGR8:
+    case InputFormat::RGB8:
+      return ImageUtils::GetNV12PyramidFromRGBImg(src.data(),
+                                                  src_h,
+                                                  src_w,
+                                                  src_step,
+                                                  format == InputFormat::BGR8,
+                                                  kModelInputHeight,
+                                                  kModelInputWidth,
+                                                  resize_type,
+                                                  is_letterbox,
+                                                  transform);
+    case InputFormat::YUYV:
+    case InputFormat::UYVY:
+      return ImageUtils::GetNV12PyramidFromYUV422Img(
+          src.data(),
+          src_h,
+          src_w,
+          src_step,
+          format == InputFormat::UYVY,
+          kModelInputHeight,
+          kModelInputWidth,
+          resize_type,
+          is_letterbox,
+          transform);
+    default:
+      return ImageUtils::GetNV12PyramidFromGrayImg(src.data(),
+                                                   src_h,
+                                                   src_w,
+                                                   src_step,
+                                                   kModelInputHeight,
+                                                   kModelInputWidth,
+                                                   resize_type,
+                                                   is_letterbox,
+                                                   transform);
+  }
+}
+
+// 写入区域[top, top + height) x [left, left + width)之外都是填充的黑色
+void ExpectPadding(const NV12PyramidInput& pyramid,
+                   int top,
+                   int left,
+                   int height,
+                   int width) {
+  auto* y = reinterpret_cast<const uint8_t*>(pyramid.y_vir_addr);
+  auto* uv = reinterpret_cast<const uint8_t*>(pyramid.uv_vir_addr);
+  auto inside = [&](int row, int col) {
+    return row >= top && row < top + height && col >= left &&
+           col < left + width;
+  };
+  for (int row = 0; row < kModelInputHeight; row++) {
+    for (int col = 0; col < kModelInputWidth; col++) {
+      if (!inside(row, col)) {
+        ASSERT_EQ(kPaddingY,
+                  y[static_cast<size_t>(row) * pyramid.y_stride + col])
+            << "y row: " << row << ", col: " << col;
+      }
+    }
+  }
+  for (int row = 0; row < kModelInputHeight / 2; row++) {
+    for (int col = 0; col < kModelInputWidth; col++) {
+      if (!inside(2 * row, col)) {
+        ASSERT_EQ(kPaddingUV,
+                  uv[static_cast<size_t>(row) * pyramid.uv_stride + col])
+            << "uv row: " << row << ", col: " << col;
+      }
+    }
+  }
+}
+
+void TestConvertToPyramid(InputFormat format) {
+  int seed = 1;
+  for (const auto& size : kSrcSizes) {
+    int src_h = size.height;
+    int src_w = image_test::AlignWidth(format, size.width);
+    int src_step = src_w * image_test::BytesPerPixel(format) + kSrcPadding;
+    auto src = image_test::MakeSmoothImage(src_h, src_step, seed++);
+    for (auto resize_type : kResizeTypes) {
+      for (bool is_letterbox : {false, true}) {
+        SCOPED_TRACE(testing::Message()
+                     << "src: " << src_w << "x" << src_h << ", resize type: "
+                     << static_cast<int>(resize_type)
+                     << ", letterbox: " << is_letterbox);
+        DirtyPool();
+        ImageTransform transform;
+        auto pyramid = GetPyramid(format,
+                                  src,
+                                  src_h,
+                                  src_w,
+                                  src_step,
+                                  resize_type,
+                                  is_letterbox,
+                                  &transform);
+        ASSERT_TRUE(pyramid);
+        auto expected_transform =
+            ImageUtils::GetImageTransform(src_h,
+                                          src_w,
+                                          kModelInputHeight,
+                                          kModelInputWidth,
+                                          resize_type,
+                                          is_letterbox);
+        ASSERT_EQ(expected_transform.offset_x, transform.offset_x);
+        ASSERT_EQ(expected_transform.offset_y, transform.offset_y);
+        ASSERT_EQ(expected_transform.content_width, transform.content_width);
+        ASSERT_EQ(expected_transform.content_height, transform.content_height);
+
+        Nv12View view;
+        view.y_stride = pyramid->y_stride;
+        view.uv_stride = pyramid->uv_stride;
+        view.y = reinterpret_cast<const uint8_t*>(pyramid->y_vir_addr) +
+                 transform.offset_y * view.y_stride + transform.offset_x;
+        view.uv = reinterpret_cast<const uint8_t*>(pyramid->uv_vir_addr) +
+                  transform.offset_y / 2 * view.uv_stride + transform.offset_x;
+        image_test::Nv12Reference ref;
+        if (resize_type == ImageResizeType::CROP) {
+          // 不缩放，拷贝左上区域，宽高按2对齐
+          view.height = transform.content_height & ~1;
+          view.width = transform.content_width & ~1;
+          ref = image_test::MakeReference(format,
+                                          src.data(),
+                                          view.height,
+                                          view.width,
+                                          src_step,
+                                          view.height,
+                                          view.width,
+                                          cv::INTER_LINEAR);
+        } else {
+          view.height = transform.content_height;
+          view.width = transform.content_width;
+          ref = image_test::MakeReference(
+              format,
+              src.data(),
+              src_h,
+              src_w,
+              src_step,
+              view.height,
+              view.width,
+              resize_type == ImageResizeType::AREA ? cv::INTER_AREA
+                                                   : cv::INTER_LINEAR);
+        }
+        image_test::ExpectNearReference(ref, view);
+        ExpectPadding(*pyramid,
+                      transform.offset_y,
+                      transform.offset_x,
+                      view.height,
+                      view.width);
+      }
+    }
+  }
+
+  // 整数倍缩小时区域均值与opencv的积分区间一致，噪声图片上也在容差范围内，
+  // 双线性插值的结果则相差很大
+  SCOPED_TRACE("area resize on noise");
+  int src_h = kModelInputHeight * 3;
+  int src_w = kModelInputWidth * 3;
+  int src_step = src_w * image_test::BytesPerPixel(format) + kSrcPadding;
+  auto src = image_test::MakeImage(src_h, src_step, seed);
+  auto pyramid = GetPyramid(format,
+                            src,
+                            src_h,
+                            src_w,
+                            src_step,
+                            ImageResizeType::AREA,
+                            false,
+                            nullptr);
+  ASSERT_TRUE(pyramid);
+  Nv12View view;
+  view.y = reinterpret_cast<const uint8_t*>(pyramid->y_vir_addr);
+  view.y_stride = pyramid->y_stride;
+  view.uv = reinterpret_cast<const uint8_t*>(pyramid->uv_vir_addr);
+  view.uv_stride = pyramid->uv_stride;
+  view.height = kModelInputHeight;
+  view.width = kModelInputWidth;
+  auto ref = image_test::MakeReference(format,
+                                       src.data(),
+                                       src_h,
+                                       src_w,
+                                       src_step,
+                                       kModelInputHeight,
+                                       kModelInputWidth,
+                                       cv::INTER_AREA);
+  image_test::ExpectNearReference(ref, view);
+}
+
+}  // namespace
+
+TEST(ImageUtilsTest, BGRToPyramid) { TestConvertToPyramid(InputFormat::BGR8); }
+
+TEST(ImageUtilsTest, RGBToPyramid) { TestConvertToPyramid(InputFormat::RGB8); }
+
+TEST(ImageUtilsTest, YUYVToPyramid) { TestConvertToPyramid(InputFormat::YUYV); }
+
+TEST(ImageUtilsTest, UYVYToPyramid) { TestConvertToPyramid(InputFormat::UYVY); }
+
+TEST(ImageUtilsTest, GrayToPyramid) {
+  TestConvertToPyramid(InputFormat::MONO8);
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "include/output_reorder_buffer.h"
+
+// 多个线程并发写入和放弃输出时，排序缓存按照序号顺序输出，
+// 每一帧最终被输出、跳过或者放弃之一，统计数据与写入的帧数一致
+
+namespace {
+
+constexpr int kStreams = 3;
+constexpr int kFeederThreads = 6;
+constexpr int kFramesPerStream = 20000;
+// 容量较小并且超时较短，覆盖缓存已满和等待超时跳过的情况
+constexpr size_t kCacheSize = 8;
+constexpr uint64_t kTimeoutMs = 1;
+// 放弃的帧的比例（百分比）
+constexpr int kErasePercent = 10;
+
+struct SeqOutput : public DnnNodeOutput {
+  uint64_t seq = 0;
+};
+
+struct StreamState {
+  StreamState() : buffer(kCacheSize, kTimeoutMs) {}
+
+  OutputReorderBuffer buffer;
+  // 只在持有取输出权限的线程中访问，原子变量用于在线程之间可见
+  std::atomic<int64_t> last_released{-1};
+  std::atomic<uint64_t> out_of_order{0};
+  std::atomic<uint64_t> handled{0};
+  std::atomic<uint64_t> fed{0};
+  std::atomic<uint64_t> erase_calls{0};
+};
+
+// 待写入输出的帧，模拟推理完成的顺序与输入顺序不一致
+struct PendingFrame {
+  int stream_id;
+  uint64_t seq;
+};
+
+class PendingQueue {
+ public:
+  void Push(const PendingFrame& frame) {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      frames_.push_back(frame);
+    }
+    cv_.notify_one();
+  }
+
+  // 队列为空并且不会再有输入时返回false
+  bool Pop(std::mt19937& rng, PendingFrame& frame) {
+    std::unique_lock<std::mutex> lk(mtx_);
+    cv_.wait(lk, [this] { return !frames_.empty() || closed_; });
+    if (frames_.empty()) {
+      return false;
+    }
+    // 从队首附近随机取出一帧
+    size_t window = std::min<size_t>(frames_.size(), kCacheSize * 2);
+    size_t idx = rng() % window;
+    frame = frames_[idx];
+    frames_.erase(frames_.begin() + idx);
+    return true;
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      closed_ = true;
+    }
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<PendingFrame> frames_;
+  bool closed_ = false;
+};
+
+}  // namespace
+
+TEST(OutputReorderBufferTest, ConcurrentFeedAndErase) {
+  std::vector<std::unique_ptr<StreamState>> streams;
+  for (int idx = 0; idx < kStreams; idx++) {
+    streams.emplace_back(new StreamState());
+  }
+  PendingQueue pending;
+
+  auto handler_for = [](StreamState& stream) {
+    return [&stream](const std::shared_ptr<DnnNodeOutput>& output) {
+      auto seq = static_cast<int64_t>(
+          std::static_pointer_cast<SeqOutput>(output)->seq);
+      if (seq <= stream.last_released.load()) {
+        stream.out_of_order++;
+      }
+      stream.last_released = seq;
+      stream.handled++;
+    };
+  };
+
+  std::vector<std::thread> feeders;
+  for (int idx = 0; idx < kFeederThreads; idx++) {
+    feeders.emplace_back([&, idx] {
+      std::mt19937 rng(idx + 1);
+      PendingFrame frame;
+      while (pending.Pop(rng, frame)) {
+        auto& stream = *streams[frame.stream_id];
+        if (rng() % 100 < static_cast<uint32_t>(kErasePercent)) {
+          stream.erase_calls++;
+          stream.buffer.Erase(frame.seq, handler_for(stream));
+          continue;
+        }
+        if (rng() % 64 == 0) {
+          // 偶尔慢一些，触发后续帧等待超时
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        auto output = std::make_shared<SeqOutput>();
+        output->seq = frame.seq;
+        stream.fed++;
+        stream.buffer.Feed(frame.seq, output, handler_for(stream));
+      }
+    });
+  }
+
+  // 每路输入在各自的线程中按照输入顺序注册
+  std::vector<std::thread> registers;
+  for (int stream_id = 0; stream_id < kStreams; stream_id++) {
+    registers.emplace_back([&, stream_id] {
+      for (int frame = 0; frame < kFramesPerStream; frame++) {
+        uint64_t seq = streams[stream_id]->buffer.Register();
+        pending.Push({stream_id, seq});
+      }
+    });
+  }
+  for (auto& thread : registers) {
+    thread.join();
+  }
+  pending.Close();
+  for (auto& thread : feeders) {
+    thread.join();
+  }
+
+  for (int stream_id = 0; stream_id < kStreams; stream_id++) {
+    SCOPED_TRACE(testing::Message() << "stream: " << stream_id);
+    auto& stream = *streams[stream_id];
+    auto stats = stream.buffer.GetStats();
+    EXPECT_EQ(0u, stream.out_of_order.load());
+    EXPECT_EQ(static_cast<uint64_t>(kFramesPerStream), stats.registered);
+    EXPECT_EQ(stats.released, stream.handled.load());
+    // 每一帧被输出、跳过或者放弃，跳过之后到达的输出计入late
+    EXPECT_EQ(stats.registered,
+              stats.released + stats.dropped + stats.erased);
+    EXPECT_EQ(stream.fed.load(), stats.released + stats.late);
+    EXPECT_LE(stats.late, stats.dropped);
+    EXPECT_LE(stats.erased, stream.erase_calls.load());
+    EXPECT_TRUE(stream.buffer.Drained());
+  }
+}
+
+TEST(OutputReorderBufferTest, ReleasesInInputOrder) {
+  OutputReorderBuffer buffer(kCacheSize, 1000);
+  std::vector<uint64_t> released;
+  auto handler = [&released](const std::shared_ptr<DnnNodeOutput>& output) {
+    released.push_back(std::static_pointer_cast<SeqOutput>(output)->seq);
+  };
+  std::vector<uint64_t> seqs;
+  for (int idx = 0; idx < 4; idx++) {
+    seqs.push_back(buffer.Register());
+  }
+  // 逆序写入，第0帧放弃
+  for (int idx = 3; idx > 0; idx--) {
+    auto output = std::make_shared<SeqOutput>();
+    output->seq = seqs[idx];
+    buffer.Feed(seqs[idx], output, handler);
+    EXPECT_TRUE(released.empty());
+    EXPECT_FALSE(buffer.Drained());
+  }
+  buffer.Erase(seqs[0], handler);
+  EXPECT_EQ(std::vector<uint64_t>({1, 2, 3}), released);
+  EXPECT_TRUE(buffer.Drained());
+}
@@ -0,0 +1,247 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/mono2d_body_det_node.h"
+
+// 后处理稳定后每帧不申请堆内存：推理输出从RecyclePool取出并重置，
+// 解析结果写入复用的results，检测框映射和关键点写入该路输入的TargetBuilder，
+// 各个类别的跟踪通过ParallelRunner并发执行，打开部位关联后组装到逐帧复用的
+// PerceptionTargets中。节点每帧发布新的消息，这里逐帧复用同一个消息，只统计组装本身
+// 模型解析（dnn_node）在本package之外，不在统计范围内
+
+namespace {
+
+std::atomic<uint64_t> g_alloc_count{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+using hobot::dnn_node::parser_fasterrcnn::Filter2DResult;
+
+constexpr int kImgWidth = 1920;
+constexpr int kImgHeight = 1080;
+constexpr int kFrameGapMs = 40;
+constexpr int kKpsNum = 19;
+constexpr int kModelOutputCount = 9;
+// 与节点的模型输出index一致
+constexpr int32_t kBodyIndex = 1;
+const std::vector<int32_t> kBoxOutputsIndex = {1, 3, 5, 7};
+const std::unordered_map<int32_t, std::string> kBoxOutputsIndexType = {
+    {1, "body"}, {3, "head"}, {5, "face"}, {7, "hand"}};
+// 同时在排序缓存和推理中的输出数
+constexpr size_t kInflight = 6;
+// 与节点mot_thread_num的默认值一致
+constexpr int kMotThreadNum = 3;
+// 目标按照固定周期往复运动，预热两个周期后跟踪和中间数据的容量都已经达到最大
+constexpr int kMotionPeriod = 100;
+constexpr int kWarmupFrames = 2 * kMotionPeriod;
+constexpr int kTestFrames = 5 * kMotionPeriod;
+
+// 模拟模型解析结果，目标按照正弦往复运动，检测框和关键点在原对象上更新
+class SyntheticParser {
+ public:
+  explicit SyntheticParser(int person_num) {
+    for (int idx = 0; idx < person_num; idx++) {
+      float x = static_cast<float>(idx * 97 % 800);
+      float y = static_cast<float>(idx * 53 % 400);
+      persons_.push_back(
+          Person{x, y, 20.0f + idx % 3 * 10.0f, 10.0f + idx % 2 * 10.0f});
+    }
+    for (auto idx : kBoxOutputsIndex) {
+      auto result = std::make_shared<Filter2DResult>();
+      result->boxes.resize(persons_.size());
+      box_results_[idx] = result;
+    }
+    lmk_result_ = std::make_shared<LandmarksResult>();
+    lmk_result_->values.resize(persons_.size());
+    for (auto& value : lmk_result_->values) {
+      value.resize(kKpsNum);
+    }
+  }
+
+  // 生成第frame帧的解析结果，写入results，不改变results的容量
+  void Next(uint64_t frame,
+            std::vector<std::shared_ptr<Filter2DResult>>& results) {
+    float phase = std::sin(2.0f * static_cast<float>(M_PI) *
+                           static_cast<float>(frame % kMotionPeriod) /
+                           kMotionPeriod);
+    for (auto& person : persons_) {
+      person.x = person.x0 + person.amplitude_x * phase;
+      person.y = person.y0 + person.amplitude_y * phase;
+    }
+    results.clear();
+    results.resize(kModelOutputCount);
+    for (auto idx : kBoxOutputsIndex) {
+      auto& boxes = box_results_[idx]->boxes;
+      for (size_t person = 0; person < persons_.size(); person++) {
+        const auto& p = persons_[person];
+        // 人体框最大，部位框在人体框内部
+        float shrink = idx == kBodyIndex ? 0.0f : 10.0f + idx;
+        boxes[person].left = p.x + shrink;
+        boxes[person].top = p.y + shrink;
+        boxes[person].right = p.x + 60 - shrink;
+        boxes[person].bottom = p.y + 120 - shrink;
+        boxes[person].conf = 0.9f;
+      }
+      results[idx] = box_results_[idx];
+    }
+    for (size_t person = 0; person < persons_.size(); person++) {
+      for (auto& point : lmk_result_->values[person]) {
+        point.x = persons_[person].x + 30;
+        point.y = persons_[person].y + 60;
+        point.score = 0.9f;
+      }
+    }
+  }
+
+  const LandmarksResult* Landmarks() const { return lmk_result_.get(); }
+
+ private:
+  struct Person {
+    float x0;
+    float y0;
+    float amplitude_x;
+    float amplitude_y;
+    float x = 0;
+    float y = 0;
+  };
+  std::vector<Person> persons_;
+  std::unordered_map<int32_t, std::shared_ptr<Filter2DResult>> box_results_;
+  std::shared_ptr<LandmarksResult> lmk_result_;
+};
+
+// 与Mono2dBodyDetNode::CreateStreams一致，每个类别一个跟踪实例
+TargetBuilder::MotMap CreateMots() {
+  const std::string config_dir = MOT_CONFIG_DIR;
+  TargetBuilder::MotMap mots;
+  for (const auto& index_type : kBoxOutputsIndexType) {
+    const std::string& type = index_type.second;
+    std::string config_file = type == "hand"
+                                  ? config_dir + "iou2_euclid_method_param.json"
+                                  : config_dir + "iou2_method_param.json";
+    mots[type] = std::make_shared<HobotMot>(config_file);
+  }
+  return mots;
+}
+
+void RunFrames(int person_num) {
+  RecyclePool<FasterRcnnOutput> output_pool(kInflight * 2);
+  TargetBuilder target_builder(kBoxOutputsIndexType, kBodyIndex);
+  target_builder.SetPartAssociation(true);
+  std::vector<std::shared_ptr<Filter2DResult>> results;
+  SyntheticParser parser(person_num);
+  ParallelRunner mot_runner(kMotThreadNum);
+  auto mots = CreateMots();
+  // 逐帧复用的消息，预留所有类别的检测框都单独输出时的数量
+  ai_msgs::msg::PerceptionTargets msg;
+  msg.targets.reserve(person_num * kBoxOutputsIndex.size());
+  msg.disappeared_targets.reserve(person_num * kBoxOutputsIndex.size());
+  // 模拟排序缓存中还未发布的输出，循环覆盖
+  std::vector<std::shared_ptr<FasterRcnnOutput>> inflight(kInflight);
+  std_msgs::msg::Header header;
+  header.frame_id = "camera";
+  ImageTransform transform;
+  transform.scale_x = 960.0f / kImgWidth;
+  transform.scale_y = 544.0f / kImgHeight;
+  transform.src_width = kImgWidth;
+  transform.src_height = kImgHeight;
+  time_t time_stamp = 1;
+
+  auto run_frame = [&](uint64_t frame_seq) {
+    // 与Mono2dBodyDetNode::AcquireOutput一致
+    auto output = output_pool.Acquire();
+    output->Reset();
+    *output->image_msg_header = header;
+    output->frame_seq = frame_seq;
+    output->image_transform = transform;
+    inflight[frame_seq % kInflight] = output;
+
+    // 与Mono2dBodyDetNode::PublishOutput和DoMot一致
+    parser.Next(frame_seq, results);
+    target_builder.Reset();
+    ASSERT_EQ(0,
+              target_builder.AddParseResults(results,
+                                             parser.Landmarks(),
+                                             kBoxOutputsIndex,
+                                             output->image_transform,
+                                             kImgWidth,
+                                             kImgHeight));
+    ASSERT_EQ(0,
+              target_builder.Track(
+                  mot_runner, mots, time_stamp, kImgWidth, kImgHeight));
+    ASSERT_EQ(kBoxOutputsIndex.size(), target_builder.MotJobs().size());
+    for (const auto& job : target_builder.MotJobs()) {
+      ASSERT_EQ(0, job.ret);
+    }
+    target_builder.Build(msg, nullptr);
+    time_stamp += kFrameGapMs;
+    output->outputs.clear();
+  };
+
+  uint64_t frame_seq = 0;
+  for (int idx = 0; idx < kWarmupFrames; idx++) {
+    run_frame(frame_seq++);
+  }
+  uint64_t created = output_pool.GetStats().created;
+  uint64_t count_start = g_alloc_count.load();
+  for (int idx = 0; idx < kTestFrames; idx++) {
+    run_frame(frame_seq++);
+  }
+  uint64_t scratch_allocs = g_alloc_count.load() - count_start;
+  EXPECT_EQ(0u, scratch_allocs)
+      << "heap allocations in " << kTestFrames << " steady-state frames";
+  EXPECT_EQ(created, output_pool.GetStats().created);
+  EXPECT_EQ(static_cast<size_t>(person_num),
+            target_builder.InRois()[kBodyIndex].size());
+  // 部位框都在人体框内部，关联后每个人体一个target
+  ASSERT_EQ(static_cast<size_t>(person_num), msg.targets.size());
+  for (const auto& target : msg.targets) {
+    EXPECT_EQ(kBoxOutputsIndex.size(), target.rois.size());
+    EXPECT_EQ(1u, target.points.size());
+  }
+}
+
+}  // namespace
+
+TEST(PostprocessAllocTest, SteadyStateHasNoScratchAllocs) {
+  for (int person_num : {1, 10, 100}) {
+    SCOPED_TRACE(testing::Message() << "person num: " << person_num);
+    RunFrames(person_num);
+  }
+}
@@ -0,0 +1,327 @@
+// Copyright (c) 2022，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/admission_controller.h"
+#include "include/frame_dispatcher.h"
+#include "include/frame_replay.h"
+#include "include/motion_gate.h"
+#include "include/output_reorder_buffer.h"
+
+// 回放录制文件，每一帧经过节点使用的FrameDispatcher分发：跟踪预测和画面没有运动重复发布的帧
+// 直接写入输出排序缓存，推理帧由推理线程异步写入输出。
+// 回放结束时按照FrameDispatcher::WaitDrained判断是否处理完成，每一帧都有输出，
+// 不会在推理帧还没有输出时提前结束
+
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 32;
+constexpr int kStep = kWidth * 3;
+constexpr size_t kCacheSize = 64;
+// 排序超时足够长，推理帧不会被跳过
+constexpr uint64_t kReorderTimeoutMs = 10000;
+constexpr auto kDrainTimeout = std::chrono::milliseconds(5000);
+
+struct ReplayOutput : public DnnNodeOutput {
+  int frame_idx = 0;
+  bool is_predicted = false;
+  bool is_motion_skipped = false;
+};
+
+std::string TempFileName() {
+  return testing::TempDir() + "replay_drain_test_" + std::to_string(getpid()) +
+         ".rply";
+}
+
+// 写入frame_count帧，静止场景每帧的数据相同，否则每帧的亮度都有变化
+void RecordFrames(const std::string& file_name,
+                  int frame_count,
+                  bool static_scene) {
+  frame_replay::RecordFile record_file;
+  ASSERT_EQ(0, record_file.Open(file_name));
+  std::vector<uint8_t> data(static_cast<size_t>(kHeight) * kStep);
+  for (int idx = 0; idx < frame_count; idx++) {
+    std::fill(data.begin(),
+              data.end(),
+              static_cast<uint8_t>(static_scene ? 100 : idx * 50));
+    ASSERT_EQ(0,
+              record_file.Write(idx * 33000000ULL,
+                                "bgr8",
+                                kWidth,
+                                kHeight,
+                                kStep,
+                                data.data(),
+                                static_cast<uint32_t>(data.size())));
+  }
+  record_file.Close();
+}
+
+// 与节点的EnqueueFrame一致，按照FrameDispatcher的结果写入输出或者交给推理线程，
+// motion_gate不为空时按照REPUBLISH模式重复发布，推理线程在调用ReleaseHeld之前不写入hold_idx帧的输出
+class ReplayPipeline {
+ public:
+  ReplayPipeline(int detect_interval,
+                 std::shared_ptr<MotionGate> motion_gate,
+                 int hold_idx)
+      : buffer_(std::make_shared<OutputReorderBuffer>(kCacheSize,
+                                                      kReorderTimeoutMs)),
+        admission_controller_(std::make_shared<AdmissionController>(
+            AdmissionController::Mode::ALL, 1)),
+        motion_gate_(std::move(motion_gate)),
+        dispatcher_(std::make_shared<FrameDispatcher>(buffer_,
+                                                      admission_controller_,
+                                                      detect_interval > 1,
+                                                      motion_gate_,
+                                                      true,
+                                                      nullptr)),
+        hold_idx_(hold_idx),
+        infer_thread_([this] { InferLoop(); }) {
+    dispatcher_->SetDetectInterval(detect_interval);
+  }
+
+  ~ReplayPipeline() {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      stopped_ = true;
+      holding_ = false;
+    }
+    cv_.notify_all();
+    infer_thread_.join();
+  }
+
+  void EnqueueFrame(int frame_idx, const uint8_t* data) {
+    // 与GetLumaPlane一致，bgr8使用g通道近似亮度
+    FrameDispatcher::LumaPlane luma;
+    luma.data = data + 1;
+    luma.pixel_stride = 3;
+    luma.step = kStep;
+    luma.height = kHeight;
+    luma.width = kWidth;
+    uint64_t seq = 0;
+    auto action = dispatcher_->Dispatch(luma, seq);
+    if (action == FrameDispatcher::Action::PREDICT ||
+        action == FrameDispatcher::Action::REPUBLISH) {
+      auto output = std::make_shared<ReplayOutput>();
+      output->frame_idx = frame_idx;
+      output->is_predicted = action == FrameDispatcher::Action::PREDICT;
+      output->is_motion_skipped =
+          action == FrameDispatcher::Action::REPUBLISH;
+      buffer_->Feed(seq, output, Handler());
+      return;
+    }
+    if (action == FrameDispatcher::Action::DROP) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      pending_.push_back({frame_idx, seq});
+    }
+    cv_.notify_all();
+  }
+
+  // 推理线程停在hold_idx帧，并且之前的帧都已经发布
+  void WaitHeld() {
+    std::unique_lock<std::mutex> lk(mtx_);
+    cv_.wait(lk, [this] {
+      return !pending_.empty() && pending_.front().frame_idx == hold_idx_ &&
+             released_.size() == static_cast<size_t>(hold_idx_);
+    });
+  }
+
+  void ReleaseHeld() {
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      holding_ = false;
+    }
+    cv_.notify_all();
+  }
+
+  // 与ReplayFrames的等待方式一致
+  bool WaitDrained() {
+    std::atomic<bool> stopped{false};
+    return FrameDispatcher::WaitDrained({dispatcher_}, kDrainTimeout, stopped);
+  }
+
+  OutputReorderBuffer& Buffer() { return *buffer_; }
+  AdmissionController& Admission() { return *admission_controller_; }
+  FrameDispatcher& Dispatcher() { return *dispatcher_; }
+
+  std::vector<std::shared_ptr<ReplayOutput>> Released() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    return released_;
+  }
+
+ private:
+  struct PendingFrame {
+    int frame_idx;
+    uint64_t seq;
+  };
+
+  std::function<void(const std::shared_ptr<DnnNodeOutput>&)> Handler() {
+    return [this](const std::shared_ptr<DnnNodeOutput>& output) {
+      {
+        std::lock_guard<std::mutex> lk(mtx_);
+        released_.push_back(std::static_pointer_cast<ReplayOutput>(output));
+      }
+      cv_.notify_all();
+    };
+  }
+
+  void InferLoop() {
+    while (true) {
+      PendingFrame frame;
+      {
+        std::unique_lock<std::mutex> lk(mtx_);
+        cv_.wait(lk, [this] {
+          return stopped_ ||
+                 (!pending_.empty() &&
+                  !(holding_ && pending_.front().frame_idx == hold_idx_));
+        });
+        if (stopped_) {
+          return;
+        }
+        frame = pending_.front();
+        pending_.pop_front();
+      }
+      // 推理耗时
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      auto output = std::make_shared<ReplayOutput>();
+      output->frame_idx = frame.frame_idx;
+      buffer_->Feed(frame.seq, output, Handler());
+    }
+  }
+
+  std::shared_ptr<OutputReorderBuffer> buffer_;
+  std::shared_ptr<AdmissionController> admission_controller_;
+  std::shared_ptr<MotionGate> motion_gate_;
+  std::shared_ptr<FrameDispatcher> dispatcher_;
+  const int hold_idx_;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<PendingFrame> pending_;
+  std::vector<std::shared_ptr<ReplayOutput>> released_;
+  bool holding_ = true;
+  bool stopped_ = false;
+  std::thread infer_thread_;
+};
+
+}  // namespace
+
+TEST(ReplayDrainTest, DetectEveryNFrames) {
+  constexpr int kFrames = 32;
+  constexpr int kDetectInterval = 3;
+  auto file_name = TempFileName();
+  RecordFrames(file_name, kFrames, false);
+  frame_replay::ReplayFile replay_file;
+  ASSERT_EQ(0, replay_file.Open(file_name));
+  const auto& frames = replay_file.Frames();
+  ASSERT_EQ(static_cast<size_t>(kFrames), frames.size());
+
+  // 每kDetectInterval帧的最后一帧推理，最后一个推理帧之后还有跳过推理的帧
+  int last_detect_idx = kFrames / kDetectInterval * kDetectInterval - 1;
+  ReplayPipeline pipeline(kDetectInterval, nullptr, last_detect_idx);
+  for (int idx = 0; idx < kFrames; idx++) {
+    pipeline.EnqueueFrame(idx, frames[idx].data);
+  }
+
+  // 最后一个推理帧还没有输出时，发布和丢弃的帧数已经超过准入的帧数，
+  // 但是该帧和之后跳过推理的帧都还在排序缓存中
+  pipeline.WaitHeld();
+  auto stats = pipeline.Buffer().GetStats();
+  auto admission_stats = pipeline.Admission().GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(kFrames / kDetectInterval),
+            admission_stats.admitted);
+  EXPECT_EQ(static_cast<uint64_t>(kFrames - kFrames / kDetectInterval),
+            pipeline.Dispatcher().GetStats().predicted);
+  EXPECT_EQ(static_cast<uint64_t>(kFrames), stats.registered);
+  EXPECT_GE(stats.released + stats.dropped + stats.erased,
+            admission_stats.admitted);
+  EXPECT_FALSE(pipeline.Buffer().Drained());
+
+  pipeline.ReleaseHeld();
+  ASSERT_TRUE(pipeline.WaitDrained());
+  stats = pipeline.Buffer().GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(kFrames), stats.released);
+  EXPECT_EQ(0u, stats.dropped);
+  EXPECT_EQ(0u, stats.erased);
+  auto released = pipeline.Released();
+  ASSERT_EQ(static_cast<size_t>(kFrames), released.size());
+  for (int idx = 0; idx < kFrames; idx++) {
+    EXPECT_EQ(idx, released[idx]->frame_idx);
+    EXPECT_EQ((idx + 1) % kDetectInterval != 0, released[idx]->is_predicted);
+  }
+  std::remove(file_name.c_str());
+}
+
+TEST(ReplayDrainTest, StaticSceneRepublish) {
+  constexpr int kFrames = 40;
+  // 第一帧推理，连续跳过30帧之后强制推理一次
+  constexpr int kForcedDetectIdx = 31;
+  auto file_name = TempFileName();
+  RecordFrames(file_name, kFrames, true);
+  frame_replay::ReplayFile replay_file;
+  ASSERT_EQ(0, replay_file.Open(file_name));
+  const auto& frames = replay_file.Frames();
+  ASSERT_EQ(static_cast<size_t>(kFrames), frames.size());
+
+  auto motion_gate = std::make_shared<MotionGate>(0.02f);
+  ReplayPipeline pipeline(1, motion_gate, kForcedDetectIdx);
+  for (int idx = 0; idx < kFrames; idx++) {
+    pipeline.EnqueueFrame(idx, frames[idx].data);
+  }
+
+  // 强制推理的帧还没有输出时，重复发布的帧数已经超过准入的帧数
+  pipeline.WaitHeld();
+  auto stats = pipeline.Buffer().GetStats();
+  auto admission_stats = pipeline.Admission().GetStats();
+  auto gate_stats = motion_gate->GetStats();
+  EXPECT_EQ(2u, admission_stats.admitted);
+  EXPECT_EQ(static_cast<uint64_t>(kFrames - 2), gate_stats.skipped);
+  EXPECT_EQ(static_cast<uint64_t>(kFrames), stats.registered);
+  EXPECT_GE(stats.released + stats.dropped + stats.erased,
+            admission_stats.admitted);
+  EXPECT_FALSE(pipeline.Buffer().Drained());
+
+  pipeline.ReleaseHeld();
+  ASSERT_TRUE(pipeline.WaitDrained());
+  stats = pipeline.Buffer().GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(kFrames), stats.released);
+  EXPECT_EQ(0u, stats.dropped);
+  auto released = pipeline.Released();
+  ASSERT_EQ(static_cast<size_t>(kFrames), released.size());
+  for (int idx = 0; idx < kFrames; idx++) {
+    EXPECT_EQ(idx, released[idx]->frame_idx);
+    EXPECT_EQ(idx != 0 && idx != kForcedDetectIdx,
+              released[idx]->is_motion_skipped);
+  }
+  std::remove(file_name.c_str());
+}